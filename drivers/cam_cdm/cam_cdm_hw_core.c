@@ -755,8 +755,8 @@ end:
 }
 
 bool cam_hw_cdm_bl_write(
-		struct cam_hw_info *cdm_hw, uint32_t src,
-		uint32_t len, uint32_t tag, bool set_arb,
+		struct cam_hw_info *cdm_hw, struct cam_io_txn *txn,
+		uint32_t src, uint32_t len, uint32_t tag, bool set_arb,
 		uint32_t fifo_idx)
 {
 	struct cam_cdm *cdm_core = (struct cam_cdm *)cdm_hw->core_info;
@@ -765,13 +765,13 @@ bool cam_hw_cdm_bl_write(
 		cdm_hw->soc_info.label_name, cdm_hw->soc_info.index,
 		src, len, tag, set_arb, fifo_idx);
 
-	if (cam_cdm_write_hw_reg(cdm_hw,
+	if (cam_cdm_write_hw_reg_txn(cdm_hw, txn,
 		cdm_core->offsets->bl_fifo_reg[fifo_idx]->bl_fifo_base,
 		src)) {
 		CAM_ERR(CAM_CDM, "Failed to write CDM base to BL base");
 		return true;
 	}
-	if (cam_cdm_write_hw_reg(cdm_hw,
+	if (cam_cdm_write_hw_reg_txn(cdm_hw, txn,
 		cdm_core->offsets->bl_fifo_reg[fifo_idx]->bl_fifo_len,
 		((len & CAM_CDM_FIFO_LEN_REG_LEN_MASK) |
 			((tag & CAM_CDM_FIFO_LEN_REG_TAG_MASK) << CAM_CDM_FIFO_LEN_REG_TAG_SHIFT)) |
@@ -782,11 +782,12 @@ bool cam_hw_cdm_bl_write(
 	return false;
 }
 
-bool cam_hw_cdm_commit_bl_write(struct cam_hw_info *cdm_hw, uint32_t fifo_idx)
+bool cam_hw_cdm_commit_bl_write(struct cam_hw_info *cdm_hw,
+	struct cam_io_txn *txn, uint32_t fifo_idx)
 {
 	struct cam_cdm *cdm_core = (struct cam_cdm *)cdm_hw->core_info;
 
-	if (cam_cdm_write_hw_reg(cdm_hw,
+	if (cam_cdm_write_hw_reg_txn(cdm_hw, txn,
 		cdm_core->offsets->bl_fifo_reg[fifo_idx]->bl_fifo_store,
 		1)) {
 		CAM_ERR(CAM_CDM, "Failed to write CDM commit BL");
@@ -802,10 +803,12 @@ int cam_hw_cdm_submit_gen_irq(
 {
 	struct cam_cdm_bl_cb_request_entry *node;
 	struct cam_cdm *core = (struct cam_cdm *)cdm_hw->core_info;
+	struct cam_io_txn txn;
 	uint32_t len;
 	int rc;
 	bool bit_wr_enable = false;
 
+	cam_io_txn_begin(&txn);
 	if (core->bl_fifo[fifo_idx].bl_tag >
 		(core->bl_fifo[fifo_idx].bl_depth - 1)) {
 		CAM_ERR(CAM_CDM,
@@ -843,7 +846,7 @@ int cam_hw_cdm_submit_gen_irq(
 		((uint32_t *)core->gen_irq[fifo_idx].kmdvaddr + len),
 		core->bl_fifo[fifo_idx].bl_tag,
 		bit_wr_enable, fifo_idx);
-	rc = cam_hw_cdm_bl_write(cdm_hw,
+	rc = cam_hw_cdm_bl_write(cdm_hw, &txn,
 		(core->gen_irq[fifo_idx].vaddr + (4*len)),
 		((4 * core->ops->cdm_required_size_genirq()) - 1),
 		core->bl_fifo[fifo_idx].bl_tag,
@@ -873,7 +876,7 @@ int cam_hw_cdm_submit_gen_irq(
 		}
 	}
 
-	if (cam_hw_cdm_commit_bl_write(cdm_hw, fifo_idx)) {
+	if (cam_hw_cdm_commit_bl_write(cdm_hw, &txn, fifo_idx)) {
 		CAM_ERR(CAM_CDM,
 			"Cannot commit the genirq BL with tag tag=%d",
 			core->bl_fifo[fifo_idx].bl_tag);
@@ -886,6 +889,7 @@ int cam_hw_cdm_submit_gen_irq(
 	trace_cam_log_event("CDM_START", "CDM_START_IRQ", req->data->cookie, 0);
 
 end:
+	cam_io_txn_commit(&txn);
 	return rc;
 }
 
@@ -894,6 +898,7 @@ int cam_hw_cdm_submit_debug_gen_irq(
 	uint32_t            fifo_idx)
 {
 	struct cam_cdm *core = (struct cam_cdm *)cdm_hw->core_info;
+	struct cam_io_txn txn;
 	uint32_t len;
 	int rc;
 	bool bit_wr_enable = false;
@@ -910,7 +915,8 @@ int cam_hw_cdm_submit_debug_gen_irq(
 	core->ops->cdm_write_genirq(
 		((uint32_t *)core->gen_irq[fifo_idx].kmdvaddr + len),
 		CAM_CDM_DBG_GEN_IRQ_USR_DATA, bit_wr_enable, fifo_idx);
-	rc = cam_hw_cdm_bl_write(cdm_hw,
+	cam_io_txn_begin(&txn);
+	rc = cam_hw_cdm_bl_write(cdm_hw, &txn,
 		(core->gen_irq[fifo_idx].vaddr + (4*len)),
 		((4 * core->ops->cdm_required_size_genirq()) - 1),
 		core->bl_fifo[fifo_idx].bl_tag,
@@ -923,7 +929,7 @@ int cam_hw_cdm_submit_debug_gen_irq(
 		rc = -EIO;
 		goto end;
 	}
-	if (cam_hw_cdm_commit_bl_write(cdm_hw, fifo_idx)) {
+	if (cam_hw_cdm_commit_bl_write(cdm_hw, &txn, fifo_idx)) {
 		CAM_ERR(CAM_CDM,
 			"Cannot commit the dbggenirq BL with tag tag=0x%x",
 			core->bl_fifo[fifo_idx].bl_tag);
@@ -932,6 +938,7 @@ int cam_hw_cdm_submit_debug_gen_irq(
 	}
 
 end:
+	cam_io_txn_commit(&txn);
 	return rc;
 }
 
@@ -944,6 +951,7 @@ int cam_hw_cdm_submit_bl(struct cam_hw_info *cdm_hw,
 	struct cam_cdm_bl_request *cdm_cmd = req->data;
 	struct cam_cdm *core = (struct cam_cdm *)cdm_hw->core_info;
 	struct cam_cdm_bl_fifo *bl_fifo = NULL;
+	struct cam_io_txn txn;
 	uint32_t fifo_idx = 0;
 	int write_count = 0;
 
@@ -977,6 +985,11 @@ int cam_hw_cdm_submit_bl(struct cam_hw_info *cdm_hw,
 		return -EAGAIN;
 	}
 
+	/*
+	 * BL contents are all in memory by now, one barrier ahead of the
+	 * first BL write covers every BL of this request.
+	 */
+	cam_io_txn_begin(&txn);
 	for (i = 0; i < req->data->cmd_arrary_count ; i++) {
 		dma_addr_t hw_vaddr_ptr = 0;
 		size_t len = 0;
@@ -1052,7 +1065,7 @@ int cam_hw_cdm_submit_bl(struct cam_hw_info *cdm_hw,
 			CAM_DBG(CAM_CDM, "Got the hwva: %pK, type: %u",
 				hw_vaddr_ptr, req->data->type);
 
-			rc = cam_hw_cdm_bl_write(cdm_hw,
+			rc = cam_hw_cdm_bl_write(cdm_hw, &txn,
 				((uint32_t)hw_vaddr_ptr + cdm_cmd->cmd[i].offset),
 				(cdm_cmd->cmd[i].len - 1),
 				core->bl_fifo[fifo_idx].bl_tag,
@@ -1065,7 +1078,8 @@ int cam_hw_cdm_submit_bl(struct cam_hw_info *cdm_hw,
 				break;
 			}
 
-			if (cam_hw_cdm_commit_bl_write(cdm_hw, fifo_idx)) {
+			if (cam_hw_cdm_commit_bl_write(cdm_hw, &txn,
+				fifo_idx)) {
 				CAM_ERR(CAM_CDM, "Commit failed for BL: %d Tag: %u",
 					i, core->bl_fifo[fifo_idx].bl_tag);
 				rc = -EIO;
@@ -1144,6 +1158,7 @@ int cam_hw_cdm_submit_bl(struct cam_hw_info *cdm_hw,
 			break;
 		}
 	}
+	cam_io_txn_commit(&txn);
 	mutex_unlock(&client->lock);
 	mutex_unlock(&core->bl_fifo[fifo_idx].fifo_lock);
 
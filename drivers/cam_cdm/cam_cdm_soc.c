@@ -77,6 +77,29 @@ permission_error:
 
 }
 
+bool cam_cdm_write_hw_reg_txn(struct cam_hw_info *cdm_hw,
+	struct cam_io_txn *txn, uint32_t reg, uint32_t value)
+{
+	void __iomem *reg_addr;
+	void __iomem *base =
+		cdm_hw->soc_info.reg_map[CAM_HW_CDM_BASE_INDEX].mem_base;
+	resource_size_t mem_len =
+		cdm_hw->soc_info.reg_map[CAM_HW_CDM_BASE_INDEX].size;
+
+	CAM_DBG(CAM_CDM, "E: b=%pK off=%x val=%x", (void __iomem *)base,
+		reg, value);
+
+	reg_addr = (base + reg);
+	if (reg_addr > (base + mem_len)) {
+		CAM_ERR_RATE_LIMIT(CAM_CDM,
+			"Accessing invalid region:%d\n",
+			reg);
+		return true;
+	}
+	cam_io_txn_w(txn, value, reg_addr);
+	return false;
+}
+
 int cam_cdm_soc_load_dt_private(struct platform_device *pdev,
 	struct cam_cdm_private_dt_data *cdm_pvt_data)
 {
@@ -6,6 +6,8 @@
 #ifndef _CAM_CDM_SOC_H_
 #define _CAM_CDM_SOC_H_
 
+#include "cam_io_util.h"
+
 #define CAM_HW_CDM_CPAS_0_NAME   "qcom,cam170-cpas-cdm0"
 #define CAM_HW_CDM_CPAS_NAME_1_0 "qcom,cam-cpas-cdm1_0"
 #define CAM_HW_CDM_CPAS_NAME_1_1 "qcom,cam-cpas-cdm1_1"
@@ -23,6 +25,8 @@ bool cam_cdm_read_hw_reg(struct cam_hw_info *cdm_hw,
 	uint32_t reg, uint32_t *value);
 bool cam_cdm_write_hw_reg(struct cam_hw_info *cdm_hw,
 	uint32_t reg, uint32_t value);
+bool cam_cdm_write_hw_reg_txn(struct cam_hw_info *cdm_hw,
+	struct cam_io_txn *txn, uint32_t reg, uint32_t value);
 int cam_cdm_intf_mgr_soc_get_dt_properties(
 	struct platform_device *pdev,
 	struct cam_cdm_intf_mgr *mgr);
@@ -10,6 +10,7 @@
 #include <linux/bitops.h>
 #include <linux/delay.h>
 #include <linux/debugfs.h>
+#include <linux/vmalloc.h>
 #include <media/cam_defs.h>
 #include <media/cam_cre.h>
 #include <media/cam_cpas.h>
@@ -104,20 +105,113 @@ static int cam_cre_mgr_update_reg_set(struct cam_cre_hw_mgr *hw_mgr,
 	return 0;
 }
 
-static void cam_cre_free_io_config(struct cam_cre_request *req)
+static void cam_cre_free_req_pool(struct cam_cre_ctx *ctx)
+{
+	struct cam_cre_req_pool *pool = &ctx->req_pool;
+
+	vfree(pool->io_buf);
+	vfree(pool->req);
+	memset(pool, 0, sizeof(*pool));
+}
+
+static int cam_cre_alloc_req_pool(struct cam_cre_ctx *ctx)
+{
+	struct cam_cre_req_pool *pool = &ctx->req_pool;
+	uint32_t batch_size, io_per_batch;
+
+	batch_size = clamp_t(uint32_t, ctx->cre_acquire.batch_size,
+		1, CRE_MAX_BATCH_SIZE);
+	io_per_batch = clamp_t(uint32_t, ctx->cre_acquire.num_in_res +
+		ctx->cre_acquire.num_out_res, 1, CRE_MAX_IO_BUFS);
+	pool->num_io_buf = CAM_CTX_REQ_MAX * batch_size * io_per_batch;
+
+	pool->req = vzalloc(CAM_CTX_REQ_MAX * sizeof(struct cam_cre_request));
+	pool->io_buf = vzalloc(pool->num_io_buf * sizeof(struct cre_io_buf));
+	if (!pool->req || !pool->io_buf) {
+		CAM_ERR(CAM_CRE, "ctx: %d req pool alloc failed io_bufs: %u",
+			ctx->ctx_id, pool->num_io_buf);
+		cam_cre_free_req_pool(ctx);
+		return -ENOMEM;
+	}
+
+	pool->batch_size = batch_size;
+	pool->io_per_batch = io_per_batch;
+	CAM_DBG(CAM_CRE, "ctx: %d req pool batch: %u io_per_batch: %u",
+		ctx->ctx_id, batch_size, io_per_batch);
+
+	return 0;
+}
+
+static struct cre_io_buf *cam_cre_get_io_buf(struct cam_cre_ctx *ctx,
+	uint32_t req_idx, uint32_t batch_idx, uint32_t io_idx)
+{
+	struct cam_cre_req_pool *pool = &ctx->req_pool;
+	struct cre_io_buf *io_buf;
+
+	if (batch_idx < pool->batch_size && io_idx < pool->io_per_batch) {
+		io_buf = &pool->io_buf[((req_idx * pool->batch_size) +
+			batch_idx) * pool->io_per_batch + io_idx];
+		memset(io_buf, 0, sizeof(*io_buf));
+		return io_buf;
+	}
+
+	cre_hw_mgr->pool_io_buf_miss++;
+	CAM_DBG(CAM_CRE, "ctx: %d io buf %u:%u outside pool %u:%u",
+		ctx->ctx_id, batch_idx, io_idx, pool->batch_size,
+		pool->io_per_batch);
+
+	return kzalloc(sizeof(struct cre_io_buf), GFP_KERNEL);
+}
+
+static bool cam_cre_is_pool_io_buf(struct cam_cre_ctx *ctx,
+	struct cre_io_buf *io_buf)
+{
+	struct cam_cre_req_pool *pool = &ctx->req_pool;
+
+	return pool->io_buf && io_buf >= pool->io_buf &&
+		io_buf < pool->io_buf + pool->num_io_buf;
+}
+
+static void cam_cre_free_io_config(struct cam_cre_ctx *ctx,
+	struct cam_cre_request *req)
 {
 	int i, j;
 
 	for (i = 0; i < CRE_MAX_BATCH_SIZE; i++) {
 		for (j = 0; j < CRE_MAX_IO_BUFS; j++) {
-			if (req->io_buf[i][j]) {
+			if (!req->io_buf[i][j])
+				continue;
+
+			if (!cam_cre_is_pool_io_buf(ctx, req->io_buf[i][j]))
 				cam_free_clear(req->io_buf[i][j]);
-				req->io_buf[i][j] = NULL;
-			}
+			req->io_buf[i][j] = NULL;
 		}
 	}
 }
 
+static struct cam_cre_request *cam_cre_get_req(struct cam_cre_ctx *ctx,
+	uint32_t req_idx)
+{
+	struct cam_cre_request *req;
+
+	req = &ctx->req_pool.req[req_idx];
+	memset(req, 0, sizeof(*req));
+	ctx->req_list[req_idx] = req;
+
+	return req;
+}
+
+static void cam_cre_put_req(struct cam_cre_ctx *ctx, uint32_t req_idx)
+{
+	struct cam_cre_request *req = ctx->req_list[req_idx];
+
+	if (req) {
+		cam_cre_free_io_config(ctx, req);
+		ctx->req_list[req_idx] = NULL;
+	}
+	clear_bit(req_idx, ctx->bitmap);
+}
+
 static int cam_cre_mgr_process_cmd_io_buf_req(struct cam_cre_hw_mgr *hw_mgr,
 	struct cam_packet *packet, struct cam_cre_ctx *ctx_data,
 	uint32_t req_idx)
@@ -152,12 +246,12 @@ static int cam_cre_mgr_process_cmd_io_buf_req(struct cam_cre_hw_mgr *hw_mgr,
 				return -EINVAL;
 			}
 
-			cre_request->io_buf[i][j] =
-				kzalloc(sizeof(struct cre_io_buf), GFP_KERNEL);
+			cre_request->io_buf[i][j] = cam_cre_get_io_buf(
+				ctx_data, req_idx, i, j);
 			if (!cre_request->io_buf[i][j]) {
 				CAM_ERR(CAM_CRE,
 					"IO config allocation failure");
-				cam_cre_free_io_config(cre_request);
+				cam_cre_free_io_config(ctx_data, cre_request);
 				return -ENOMEM;
 			}
 
@@ -586,10 +680,7 @@ static int cam_cre_mgr_handle_config_err(
 
 	req_idx = cre_req->req_idx;
 	cre_req->request_id = 0;
-	cam_cre_free_io_config(ctx_data->req_list[req_idx]);
-	cam_free_clear(ctx_data->req_list[req_idx]);
-	ctx_data->req_list[req_idx] = NULL;
-	clear_bit(req_idx, ctx_data->bitmap);
+	cam_cre_put_req(ctx_data, req_idx);
 	return 0;
 }
 
@@ -903,11 +994,8 @@ static int32_t cam_cre_mgr_process_msg(void *priv, void *data)
 		buf_data.request_id = active_req->request_id;
 		ctx->ctxt_event_cb(ctx->context_priv, evt_id, &buf_data);
 		rc = cam_cre_mgr_reset_hw();
-		clear_bit(active_req_idx, ctx->bitmap);
-		cam_cre_free_io_config(active_req);
-		cam_free_clear((void *)active_req);
+		cam_cre_put_req(ctx, active_req_idx);
 		ctx->req_cnt--;
-		ctx->req_list[active_req_idx] = NULL;
 	} else if (irq_data.wr_buf_done) {
 		/* Signal Buf done */
 		active_req->frames_done++;
@@ -923,11 +1011,8 @@ static int32_t cam_cre_mgr_process_msg(void *priv, void *data)
 			buf_data.evt_param = CAM_SYNC_COMMON_EVENT_SUCCESS;
 			buf_data.request_id = active_req->request_id;
 			ctx->ctxt_event_cb(ctx->context_priv, evt_id, &buf_data);
-			clear_bit(active_req_idx, ctx->bitmap);
-			cam_cre_free_io_config(active_req);
-			cam_free_clear((void *)active_req);
+			cam_cre_put_req(ctx, active_req_idx);
 			ctx->req_cnt--;
-			ctx->req_list[active_req_idx] = NULL;
 		}
 	}
 	mutex_unlock(&ctx->ctx_mutex);
@@ -1757,6 +1842,10 @@ static int cam_cre_mgr_acquire_hw(void *hw_priv, void *hw_acquire_args)
 		goto end;
 	}
 
+	rc = cam_cre_alloc_req_pool(ctx);
+	if (rc)
+		goto end;
+
 	if (!hw_mgr->cre_ctx_cnt) {
 		for (i = 0; i < cre_hw_mgr->num_cre; i++) {
 			rc = hw_mgr->cre_dev_intf[i]->hw_ops.init(
@@ -1908,6 +1997,7 @@ cre_irq_set_failed:
 		}
 	}
 end:
+	cam_cre_free_req_pool(ctx);
 	args->ctxt_to_hw_map = NULL;
 	cam_cre_put_free_ctx(hw_mgr, ctx_id);
 	mutex_unlock(&ctx->ctx_mutex);
@@ -1948,11 +2038,9 @@ static int cam_cre_mgr_release_ctx(struct cam_cre_hw_mgr *hw_mgr, int ctx_id)
 	for (i = 0; i < CAM_CTX_REQ_MAX; i++) {
 		if (!hw_mgr->ctx[ctx_id].req_list[i])
 			continue;
-		cam_cre_free_io_config(hw_mgr->ctx[ctx_id].req_list[i]);
-		cam_free_clear(hw_mgr->ctx[ctx_id].req_list[i]);
-		hw_mgr->ctx[ctx_id].req_list[i] = NULL;
-		clear_bit(i, hw_mgr->ctx[ctx_id].bitmap);
+		cam_cre_put_req(&hw_mgr->ctx[ctx_id], i);
 	}
+	cam_cre_free_req_pool(&hw_mgr->ctx[ctx_id]);
 
 	hw_mgr->ctx[ctx_id].req_cnt = 0;
 	hw_mgr->ctx[ctx_id].last_flush_req = 0;
@@ -2223,6 +2311,7 @@ static int cam_cre_mgr_prepare_hw_update(void *hw_priv,
 	request_idx  = find_next_zero_bit(ctx_data->bitmap,
 			ctx_data->bits, ctx_data->last_req_idx);
 	if (request_idx >= CAM_CTX_REQ_MAX || request_idx < 0) {
+		hw_mgr->pool_req_exhausted++;
 		mutex_unlock(&ctx_data->ctx_mutex);
 		CAM_ERR(CAM_CRE, "Invalid ctx req slot = %d", request_idx);
 		return -EINVAL;
@@ -2231,18 +2320,7 @@ static int cam_cre_mgr_prepare_hw_update(void *hw_priv,
 		request_idx, ctx_data->last_req_idx, ctx_data->bits);
 	ctx_data->last_req_idx = request_idx;
 
-	ctx_data->req_list[request_idx] =
-		kzalloc(sizeof(struct cam_cre_request), GFP_KERNEL);
-	if (!ctx_data->req_list[request_idx]) {
-		CAM_ERR(CAM_CRE, "mem allocation failed ctx:%d req_idx:%d",
-			ctx_data->ctx_id, request_idx);
-		rc = -ENOMEM;
-		goto req_mem_alloc_failed;
-	}
-	memset(ctx_data->req_list[request_idx], 0,
-			sizeof(struct cam_cre_request));
-
-	cre_req = ctx_data->req_list[request_idx];
+	cre_req = cam_cre_get_req(ctx_data, request_idx);
 	cre_req->request_id = packet->header.request_id;
 	cre_req->frames_done = 0;
 	cre_req->req_idx = request_idx;
@@ -2292,10 +2370,7 @@ static int cam_cre_mgr_prepare_hw_update(void *hw_priv,
 	return rc;
 
 end:
-	cam_free_clear((void *)ctx_data->req_list[request_idx]);
-	ctx_data->req_list[request_idx] = NULL;
-req_mem_alloc_failed:
-	clear_bit(request_idx, ctx_data->bitmap);
+	cam_cre_put_req(ctx_data, request_idx);
 	mutex_unlock(&ctx_data->ctx_mutex);
 	return rc;
 }
@@ -2520,10 +2595,7 @@ static int cam_cre_mgr_flush_req(struct cam_cre_ctx *ctx_data,
 		buf_data.request_id = ctx_data->req_list[idx]->request_id;
 		ctx_data->ctxt_event_cb(ctx_data->context_priv, evt_id, &buf_data);
 		ctx_data->req_list[idx]->request_id = 0;
-		cam_cre_free_io_config(ctx_data->req_list[idx]);
-		cam_free_clear(ctx_data->req_list[idx]);
-		ctx_data->req_list[idx] = NULL;
-		clear_bit(idx, ctx_data->bitmap);
+		cam_cre_put_req(ctx_data, idx);
 	}
 
 	return 0;
@@ -2548,10 +2620,7 @@ static int cam_cre_mgr_flush_all(struct cam_cre_ctx *ctx_data,
 		buf_data.request_id = ctx_data->req_list[i]->request_id;
 		ctx_data->ctxt_event_cb(ctx_data->context_priv, evt_id, &buf_data);
 		ctx_data->req_list[i]->request_id = 0;
-		cam_cre_free_io_config(ctx_data->req_list[i]);
-		cam_free_clear(ctx_data->req_list[i]);
-		ctx_data->req_list[i] = NULL;
-		clear_bit(i, ctx_data->bitmap);
+		cam_cre_put_req(ctx_data, i);
 	}
 	mutex_unlock(&ctx_data->ctx_mutex);
 
@@ -2917,6 +2986,11 @@ static int cam_cre_create_debug_fs(void)
 		goto err;
 	}
 
+	debugfs_create_u64("pool_req_exhausted", 0444,
+		cre_hw_mgr->dentry, &cre_hw_mgr->pool_req_exhausted);
+	debugfs_create_u64("pool_io_buf_miss", 0444,
+		cre_hw_mgr->dentry, &cre_hw_mgr->pool_io_buf_miss);
+
 	dbgfileptr = debugfs_create_file("cre_debug_clk", 0644,
 		cre_hw_mgr->dentry, NULL, &cam_cre_debug_default_clk);
 
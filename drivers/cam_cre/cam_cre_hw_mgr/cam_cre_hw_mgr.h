@@ -292,6 +292,23 @@ struct cam_cre_request {
 	ktime_t   submit_timestamp;
 };
 
+/**
+ * struct cam_cre_req_pool
+ *
+ * @req:               Request slots, one per ctx request index
+ * @io_buf:            IO config buffers carved up per request slot
+ * @num_io_buf:        Total number of entries in @io_buf
+ * @batch_size:        Batches per request slot covered by @io_buf
+ * @io_per_batch:      IO buffers per batch covered by @io_buf
+ */
+struct cam_cre_req_pool {
+	struct cam_cre_request *req;
+	struct cre_io_buf      *io_buf;
+	uint32_t                num_io_buf;
+	uint32_t                batch_size;
+	uint32_t                io_per_batch;
+};
+
 /**
  * struct cam_cre_ctx
  *
@@ -314,6 +331,7 @@ struct cam_cre_request {
  * @packet:            Current packet to process
  * @cre_top:           Pointer to CRE top data structure
  * @req_list:          Request List
+ * @req_pool:          Request memory preallocated at acquire
  * @ctxt_event_cb:     Callback of a context
  */
 struct cam_cre_ctx {
@@ -337,6 +355,7 @@ struct cam_cre_ctx {
 	struct cre_top                  *cre_top;
 	struct cam_packet               *packet;
 	struct cam_cre_request          *req_list[CAM_CTX_REQ_MAX];
+	struct cam_cre_req_pool          req_pool;
 	cam_hw_event_cb_func ctxt_event_cb;
 };
 
@@ -366,6 +385,8 @@ struct cam_cre_ctx {
  * @clk_info:          CRE clock Info for HW manager
  * @dentry:            Pointer to CRE debugfs directory
  * @dump_req_data_enable: CRE hang dump enablement
+ * @pool_req_exhausted: Requests rejected for lack of a free ctx slot
+ * @pool_io_buf_miss:  IO buffers allocated outside the ctx request pool
  */
 struct cam_cre_hw_mgr {
 	uint32_t      cre_ctx_cnt;
@@ -394,6 +415,8 @@ struct cam_cre_hw_mgr {
 	struct cam_cre_clk_info clk_info;
 	struct dentry *dentry;
 	bool   dump_req_data_enable;
+	uint64_t pool_req_exhausted;
+	uint64_t pool_io_buf_miss;
 };
 
 /**
@@ -22,6 +22,7 @@
 #include "cam_fd_hw_mgr_intf.h"
 #include "cam_fd_hw_mgr.h"
 #include "cam_trace.h"
+#include "cam_req_mgr_debug.h"
 
 static struct cam_fd_hw_mgr g_fd_hw_mgr;
 
@@ -190,6 +191,40 @@ static int cam_fd_mgr_util_get_frame_req(
 	return rc;
 }
 
+static int cam_fd_mgr_util_get_processing_frame_req(
+	struct cam_fd_hw_mgr *hw_mgr, int32_t device_index,
+	struct cam_fd_mgr_frame_request **frame_req)
+{
+	struct cam_fd_mgr_frame_request *req_ptr, *req_temp;
+	struct cam_fd_device *hw_device;
+	int rc = -EPERM;
+
+	if ((device_index < 0) || (device_index >= hw_mgr->num_devices)) {
+		CAM_ERR(CAM_FD, "Invalid device index %d", device_index);
+		return -EINVAL;
+	}
+
+	hw_device = &hw_mgr->hw_device[device_index];
+	*frame_req = NULL;
+
+	mutex_lock(&hw_mgr->frame_req_mutex);
+	mutex_lock(&hw_device->lock);
+	list_for_each_entry_safe(req_ptr, req_temp,
+		&hw_mgr->frame_processing_list, list) {
+		if ((req_ptr->hw_ctx == hw_device->cur_hw_ctx) &&
+			(req_ptr->request_id == hw_device->req_id)) {
+			list_del_init(&req_ptr->list);
+			*frame_req = req_ptr;
+			rc = 0;
+			break;
+		}
+	}
+	mutex_unlock(&hw_device->lock);
+	mutex_unlock(&hw_mgr->frame_req_mutex);
+
+	return rc;
+}
+
 static int cam_fd_mgr_util_get_device(struct cam_fd_hw_mgr *hw_mgr,
 	struct cam_fd_hw_mgr_ctx *hw_ctx, struct cam_fd_device **hw_device)
 {
@@ -262,7 +297,7 @@ static int cam_fd_mgr_util_select_device(struct cam_fd_hw_mgr *hw_mgr,
 	struct cam_fd_hw_mgr_ctx *hw_ctx,
 	struct cam_fd_acquire_dev_info *fd_acquire_args)
 {
-	int i, rc;
+	int i, j, rc;
 	struct cam_fd_hw_reserve_args hw_reserve_args;
 	struct cam_fd_device *hw_device = NULL;
 
@@ -303,18 +338,25 @@ static int cam_fd_mgr_util_select_device(struct cam_fd_hw_mgr *hw_mgr,
 	 * there is a HW which meets acquire requirements
 	 */
 	if (i == hw_mgr->num_devices) {
-		for (i = 0; i < hw_mgr->num_devices; i++) {
-			hw_device = &hw_mgr->hw_device[i];
+		/* Share the least loaded capable device */
+		for (j = 0; j < hw_mgr->num_devices; j++) {
+			hw_device = &hw_mgr->hw_device[j];
 			if ((fd_acquire_args->mode &
 				hw_device->hw_caps.supported_modes) &&
 				(!fd_acquire_args->get_raw_results ||
-				hw_device->hw_caps.raw_results_available)) {
-				hw_device->num_ctxts++;
-				CAM_DBG(CAM_FD,
-					"Found sharing HW Index=%d, num_ctxts=%d",
-					i, hw_device->num_ctxts);
-				break;
-			}
+				hw_device->hw_caps.raw_results_available) &&
+				((i == hw_mgr->num_devices) ||
+				(hw_device->num_ctxts <
+				hw_mgr->hw_device[i].num_ctxts)))
+				i = j;
+		}
+
+		if (i < hw_mgr->num_devices) {
+			hw_device = &hw_mgr->hw_device[i];
+			hw_device->num_ctxts++;
+			CAM_DBG(CAM_FD,
+				"Found sharing HW Index=%d, num_ctxts=%d",
+				i, hw_device->num_ctxts);
 		}
 	}
 
@@ -849,14 +891,54 @@ static int cam_fd_mgr_util_prepare_hw_update_entries(
 	return rc;
 }
 
+static int cam_fd_mgr_util_start_frame(struct cam_fd_device *hw_device,
+	struct cam_fd_mgr_frame_request *frame_req)
+{
+	struct cam_fd_hw_mgr_ctx *hw_ctx = frame_req->hw_ctx;
+	struct cam_fd_hw_cmd_start_args start_args;
+	int rc;
+
+	if (!hw_device->hw_intf->hw_ops.start) {
+		CAM_ERR(CAM_FD, "Invalid hw_ops.start");
+		return -EPERM;
+	}
+
+	trace_cam_submit_to_hw("FD", frame_req->request_id);
+
+	start_args.hw_ctx = hw_ctx;
+	start_args.ctx_hw_private = hw_ctx->ctx_hw_private;
+	start_args.hw_req_private = &frame_req->hw_req_private;
+	start_args.hw_update_entries = frame_req->hw_update_entries;
+	start_args.num_hw_update_entries = frame_req->num_hw_update_entries;
+
+	frame_req->submit_timestamp = ktime_get();
+	rc = hw_device->hw_intf->hw_ops.start(hw_device->hw_intf->hw_priv,
+		&start_args, sizeof(start_args));
+	if (rc) {
+		CAM_ERR(CAM_FD, "Failed in HW Start %d", rc);
+		return rc;
+	}
+
+	hw_device->ready_to_process = false;
+	hw_device->cur_hw_ctx = hw_ctx;
+	hw_device->req_id = frame_req->request_id;
+
+	return 0;
+}
+
+/*
+ * Start pending frames, high priority list first and in submission order
+ * within a list, on every FD device that is idle. A frame whose device is
+ * busy does not hold back frames queued behind it for another device.
+ */
 static int cam_fd_mgr_util_submit_frame(void *priv, void *data)
 {
 	struct cam_fd_device *hw_device;
 	struct cam_fd_hw_mgr *hw_mgr;
-	struct cam_fd_mgr_frame_request *frame_req;
-	struct cam_fd_hw_mgr_ctx *hw_ctx;
-	struct cam_fd_hw_cmd_start_args start_args;
-	int rc;
+	struct cam_fd_mgr_frame_request *frame_req, *req_temp;
+	struct list_head *pending_list[2];
+	unsigned long busy_mask = 0;
+	int i, rc = 0;
 
 	if (!priv) {
 		CAM_ERR(CAM_FD, "Invalid data");
@@ -864,87 +946,65 @@ static int cam_fd_mgr_util_submit_frame(void *priv, void *data)
 	}
 
 	hw_mgr = (struct cam_fd_hw_mgr *)priv;
+	pending_list[0] = &hw_mgr->frame_pending_list_high;
+	pending_list[1] = &hw_mgr->frame_pending_list_normal;
+
 	mutex_lock(&hw_mgr->frame_req_mutex);
 
-	/* Check if we have any frames pending in high priority list */
-	if (!list_empty(&hw_mgr->frame_pending_list_high)) {
-		CAM_DBG(CAM_FD, "Pending frames in high priority list");
-		frame_req = list_first_entry(&hw_mgr->frame_pending_list_high,
-			struct cam_fd_mgr_frame_request, list);
-	} else if (!list_empty(&hw_mgr->frame_pending_list_normal)) {
-		CAM_DBG(CAM_FD, "Pending frames in normal priority list");
-		frame_req = list_first_entry(&hw_mgr->frame_pending_list_normal,
-			struct cam_fd_mgr_frame_request, list);
-	} else {
-		mutex_unlock(&hw_mgr->frame_req_mutex);
-		CAM_DBG(CAM_FD, "No pending frames");
-		return 0;
-	}
+	for (i = 0; i < ARRAY_SIZE(pending_list); i++) {
+		list_for_each_entry_safe(frame_req, req_temp,
+			pending_list[i], list) {
+			rc = cam_fd_mgr_util_get_device(hw_mgr,
+				frame_req->hw_ctx, &hw_device);
+			if (rc) {
+				CAM_ERR(CAM_FD, "Error in getting device %d",
+					rc);
+				goto end;
+			}
 
-	CAM_DBG(CAM_FD, "FrameSubmit : Frame[%lld]", frame_req->request_id);
-	hw_ctx = frame_req->hw_ctx;
-	rc = cam_fd_mgr_util_get_device(hw_mgr, hw_ctx, &hw_device);
-	if (rc) {
-		mutex_unlock(&hw_mgr->frame_req_mutex);
-		CAM_ERR(CAM_FD, "Error in getting device %d", rc);
-		return rc;
-	}
+			if (test_bit(frame_req->hw_ctx->device_index,
+				&busy_mask))
+				continue;
 
-	mutex_lock(&hw_device->lock);
-	if (hw_device->ready_to_process == false) {
-		if (hw_mgr->num_pending_frames > 6) {
-			CAM_WARN(CAM_FD,
-				"Device busy for longer time with cur_hw_ctx=%pK, ReqId=%lld",
-				hw_device->cur_hw_ctx, hw_device->req_id);
-		}
-		mutex_unlock(&hw_device->lock);
-		mutex_unlock(&hw_mgr->frame_req_mutex);
-		return -EBUSY;
-	}
+			mutex_lock(&hw_device->lock);
+			if (!hw_device->ready_to_process) {
+				if (hw_mgr->num_pending_frames > 6)
+					CAM_WARN(CAM_FD,
+						"Device busy for longer time with cur_hw_ctx=%pK, ReqId=%lld",
+						hw_device->cur_hw_ctx,
+						hw_device->req_id);
+				mutex_unlock(&hw_device->lock);
+				set_bit(frame_req->hw_ctx->device_index,
+					&busy_mask);
+				continue;
+			}
 
-	trace_cam_submit_to_hw("FD", frame_req->request_id);
+			CAM_DBG(CAM_FD, "FrameSubmit : Frame[%lld] device %d",
+				frame_req->request_id,
+				frame_req->hw_ctx->device_index);
 
-	list_del_init(&frame_req->list);
-	hw_mgr->num_pending_frames--;
-	list_add_tail(&frame_req->list, &hw_mgr->frame_processing_list);
-
-	if (hw_device->hw_intf->hw_ops.start) {
-		start_args.hw_ctx = hw_ctx;
-		start_args.ctx_hw_private = hw_ctx->ctx_hw_private;
-		start_args.hw_req_private = &frame_req->hw_req_private;
-		start_args.hw_update_entries = frame_req->hw_update_entries;
-		start_args.num_hw_update_entries =
-			frame_req->num_hw_update_entries;
-
-		rc = hw_device->hw_intf->hw_ops.start(
-			hw_device->hw_intf->hw_priv, &start_args,
-			sizeof(start_args));
-		if (rc) {
-			CAM_ERR(CAM_FD, "Failed in HW Start %d", rc);
 			list_del_init(&frame_req->list);
+			hw_mgr->num_pending_frames--;
+			list_add_tail(&frame_req->list,
+				&hw_mgr->frame_processing_list);
+
+			rc = cam_fd_mgr_util_start_frame(hw_device, frame_req);
 			mutex_unlock(&hw_device->lock);
-			mutex_unlock(&hw_mgr->frame_req_mutex);
-			goto put_req_into_free_list;
+			if (rc) {
+				list_del_init(&frame_req->list);
+				mutex_unlock(&hw_mgr->frame_req_mutex);
+				cam_fd_mgr_util_put_frame_req(
+					&hw_mgr->frame_free_list, &frame_req);
+				return rc;
+			}
+
+			set_bit(frame_req->hw_ctx->device_index, &busy_mask);
 		}
-	} else {
-		CAM_ERR(CAM_FD, "Invalid hw_ops.start");
-		list_del_init(&frame_req->list);
-		mutex_unlock(&hw_device->lock);
-		mutex_unlock(&hw_mgr->frame_req_mutex);
-		rc = -EPERM;
-		goto put_req_into_free_list;
 	}
 
-	hw_device->ready_to_process = false;
-	hw_device->cur_hw_ctx = hw_ctx;
-	hw_device->req_id = frame_req->request_id;
-	mutex_unlock(&hw_device->lock);
+end:
 	mutex_unlock(&hw_mgr->frame_req_mutex);
 
-	return rc;
-put_req_into_free_list:
-	cam_fd_mgr_util_put_frame_req(&hw_mgr->frame_free_list, &frame_req);
-
 	return rc;
 }
 
@@ -978,7 +1038,8 @@ static int32_t cam_fd_mgr_workq_irq_cb(void *priv, void *data)
 	struct cam_fd_mgr_frame_request *frame_req = NULL;
 	enum cam_fd_hw_irq_type irq_type;
 	uint32_t evt_id = CAM_CTX_EVT_ID_ERROR;
-	int rc;
+	bool next_submitted = false;
+	int rc, submit_rc = 0;
 
 	if (!data || !priv) {
 		CAM_ERR(CAM_FD, "Invalid data %pK %pK", data, priv);
@@ -997,9 +1058,9 @@ static int32_t cam_fd_mgr_workq_irq_cb(void *priv, void *data)
 		return 0;
 	}
 
-	/* Get the frame from processing list */
-	rc = cam_fd_mgr_util_get_frame_req(&hw_mgr->frame_processing_list,
-		&frame_req);
+	/* Get the frame this device was processing */
+	rc = cam_fd_mgr_util_get_processing_frame_req(hw_mgr,
+		work_data->device_index, &frame_req);
 	if (rc || !frame_req) {
 		/*
 		 * This can happen if reset is triggered while no frames
@@ -1053,6 +1114,32 @@ static int32_t cam_fd_mgr_workq_irq_cb(void *priv, void *data)
 	trace_cam_irq_handled("FD", irq_type);
 
 notify_context:
+	/*
+	 * Now we can set hw device is free to process further frames.
+	 * Note - Do not change state to IDLE until we read the frame results,
+	 * Otherwise, other thread may schedule frame processing before
+	 * reading current frame's results. Also, we need to set to IDLE state
+	 * in case some error happens after getting this irq callback
+	 */
+	mutex_lock(&hw_device->lock);
+	hw_device->ready_to_process = true;
+	hw_device->req_id = -1;
+	hw_device->cur_hw_ctx = NULL;
+	CAM_DBG(CAM_FD, "ready_to_process=%d", hw_device->ready_to_process);
+	mutex_unlock(&hw_device->lock);
+
+	/*
+	 * Results are read out already, so start the next frame before the
+	 * context signals this one to keep the core busy.
+	 */
+	submit_rc = cam_fd_mgr_util_submit_frame(hw_mgr, NULL);
+	next_submitted = true;
+
+	if (evt_id == CAM_CTX_EVT_ID_SUCCESS)
+		cam_req_mgr_debug_lat_record(CAM_REQ_MGR_LAT_FD_SUBMIT_TO_DONE,
+			frame_req->hw_ctx->ctx_index,
+			frame_req->submit_timestamp);
+
 	/* Do a callback to inform frame done or stop done */
 	if (frame_req->hw_ctx->event_cb) {
 		struct cam_hw_done_event_data buf_data;
@@ -1072,20 +1159,6 @@ notify_context:
 			CAM_ERR(CAM_FD, "Error in event cb handling %d", rc);
 	}
 
-	/*
-	 * Now we can set hw device is free to process further frames.
-	 * Note - Do not change state to IDLE until we read the frame results,
-	 * Otherwise, other thread may schedule frame processing before
-	 * reading current frame's results. Also, we need to set to IDLE state
-	 * in case some error happens after getting this irq callback
-	 */
-	mutex_lock(&hw_device->lock);
-	hw_device->ready_to_process = true;
-	hw_device->req_id = -1;
-	hw_device->cur_hw_ctx = NULL;
-	CAM_DBG(CAM_FD, "ready_to_process=%d", hw_device->ready_to_process);
-	mutex_unlock(&hw_device->lock);
-
 put_req_in_free_list:
 	rc = cam_fd_mgr_util_put_frame_req(&hw_mgr->frame_free_list,
 		&frame_req);
@@ -1096,13 +1169,14 @@ put_req_in_free_list:
 
 submit_next_frame:
 	/* Check if there are any frames pending for processing and submit */
-	rc = cam_fd_mgr_util_submit_frame(hw_mgr, NULL);
-	if (rc) {
-		CAM_ERR(CAM_FD, "Error while submit frame, rc=%d", rc);
-		return rc;
+	if (!next_submitted)
+		submit_rc = cam_fd_mgr_util_submit_frame(hw_mgr, NULL);
+	if (submit_rc) {
+		CAM_ERR(CAM_FD, "Error while submit frame, rc=%d", submit_rc);
+		return submit_rc;
 	}
 
-	return rc;
+	return 0;
 }
 
 static int cam_fd_mgr_irq_cb(void *data, enum cam_fd_hw_irq_type irq_type)
@@ -1124,6 +1198,8 @@ static int cam_fd_mgr_irq_cb(void *data, enum cam_fd_hw_irq_type irq_type)
 	work_data = (struct cam_fd_mgr_work_data *)task->payload;
 	work_data->type = CAM_FD_WORK_IRQ;
 	work_data->irq_type = irq_type;
+	work_data->device_index =
+		(struct cam_fd_device *)data - hw_mgr->hw_device;
 
 	task->process_cb = cam_fd_mgr_workq_irq_cb;
 	rc = cam_req_mgr_workq_enqueue_task(task, hw_mgr, CRM_TASK_PRIORITY_0);
@@ -18,7 +18,7 @@
 #include "cam_req_mgr_workq.h"
 #include "cam_fd_hw_intf.h"
 
-#define CAM_FD_HW_MAX            1
+#define CAM_FD_HW_MAX            2
 #define CAM_FD_WORKQ_NUM_TASK    10
 
 /*
@@ -121,12 +121,14 @@ struct cam_fd_mgr_frame_request {
 /**
  * struct cam_fd_mgr_work_data : HW Mgr work data information
  *
- * @type     : Type of work
- * @irq_type : IRQ type when this work is queued because of irq callback
+ * @type         : Type of work
+ * @irq_type     : IRQ type when this work is queued because of irq callback
+ * @device_index : Index of the FD device which raised the irq
  */
 struct cam_fd_mgr_work_data {
 	enum cam_fd_mgr_work_type      type;
 	enum cam_fd_hw_irq_type        irq_type;
+	int32_t                        device_index;
 };
 
 /**
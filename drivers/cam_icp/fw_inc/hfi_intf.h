@@ -12,6 +12,11 @@
 #define HFI_CMD_Q_MINI_DUMP_SIZE_IN_BYTES      4096
 #define HFI_MSG_Q_MINI_DUMP_SIZE_IN_BYTES      4096
 
+/* Number of independent HFI instances, one per ICP processor */
+#define HFI_NUM_MAX                            2
+#define HFI_HANDLE_INIT                        -1
+#define HFI_CLIENT_NAME_LEN                    32
+
 /**
  * struct hfi_mem
  * @len: length of memory
@@ -78,16 +83,35 @@ struct hfi_mini_dump_info {
 	bool           msg_q_state;
 	bool           cmd_q_state;
 };
+/**
+ * cam_hfi_register() - reserve an hfi instance for a client
+ * @client_handle: output, handle of the instance for all hfi calls
+ * @client_name: name of the client
+ *
+ * Returns success(zero)/failure(non zero)
+ */
+int cam_hfi_register(int *client_handle, const char *client_name);
+
+/**
+ * cam_hfi_unregister() - release an hfi instance
+ * @client_handle: handle of the instance, reset on return
+ *
+ * Returns success(zero)/failure(non zero)
+ */
+int cam_hfi_unregister(int *client_handle);
+
 /**
  * hfi_write_cmd() - function for hfi write
+ * @client_handle: hfi instance handle
  * @cmd_ptr: pointer to command data for hfi write
  *
  * Returns success(zero)/failure(non zero)
  */
-int hfi_write_cmd(void *cmd_ptr);
+int hfi_write_cmd(int client_handle, void *cmd_ptr);
 
 /**
  * hfi_read_message() - function for hfi read
+ * @client_handle: hfi instance handle
  * @pmsg: buffer to place read message for hfi queue
  * @q_id: queue id
  * @words_read: total number of words read from the queue
@@ -95,10 +119,41 @@ int hfi_write_cmd(void *cmd_ptr);
  *
  * Returns success(zero)/failure(non zero)
  */
-int hfi_read_message(uint32_t *pmsg, uint8_t q_id, uint32_t *words_read);
+int hfi_read_message(int client_handle, uint32_t *pmsg, uint8_t q_id,
+	uint32_t *words_read);
+
+/**
+ * hfi_msg_process_cb - callback processing a chunk read from a hfi queue
+ * @priv: private data passed to hfi_drain_message
+ * @pmsg: buffer holding the packets read
+ * @words_read: number of words read into the buffer
+ *
+ * Called with the message queue lock released, so it may read other
+ * queues, e.g. the debug queue on a fatal error.
+ */
+typedef int (*hfi_msg_process_cb)(void *priv, uint32_t *pmsg,
+	uint32_t words_read);
+
+/**
+ * hfi_drain_message() - read and process all pending packets of a queue
+ * @client_handle: hfi instance handle
+ * @pmsg: buffer to place read messages for hfi queue
+ * @q_id: queue id
+ * @process_cb: called for every chunk read from the queue
+ * @priv: private data for process_cb
+ *
+ * Keeps reading while firmware has packets pending, up to a bounded
+ * number of reads. The message queue lock is only held for each read
+ * and pending check, not across process_cb.
+ *
+ * Returns success(zero)/failure(non zero)
+ */
+int hfi_drain_message(int client_handle, uint32_t *pmsg, uint8_t q_id,
+	hfi_msg_process_cb process_cb, void *priv);
 
 /**
  * hfi_init() - function initialize hfi after firmware download
+ * @client_handle: hfi instance handle
  * @hfi_mem: hfi memory info
  * @hfi_ops: processor-specific hfi ops
  * @priv: device private data
@@ -106,8 +161,9 @@ int hfi_read_message(uint32_t *pmsg, uint8_t q_id, uint32_t *words_read);
  *
  * Returns success(zero)/failure(non zero)
  */
-int cam_hfi_init(struct hfi_mem_info *hfi_mem, const struct hfi_ops *hfi_ops,
-		void *priv, uint8_t event_driven_mode);
+int cam_hfi_init(int client_handle, struct hfi_mem_info *hfi_mem,
+		const struct hfi_ops *hfi_ops, void *priv,
+		uint8_t event_driven_mode);
 
 /**
  * hfi_get_hw_caps() - hardware capabilities from firmware
@@ -119,78 +175,91 @@ int hfi_get_hw_caps(void *query_caps);
 
 /**
  * hfi_send_system_cmd() - send hfi system command to firmware
+ * @client_handle: hfi instance handle
  * @type: type of system command
  * @data: command data
  * @size: size of command data
  */
-void hfi_send_system_cmd(uint32_t type, uint64_t data, uint32_t size);
+void hfi_send_system_cmd(int client_handle, uint32_t type, uint64_t data,
+	uint32_t size);
 
 /**
  * cam_hfi_deinit() - cleanup HFI
+ * @client_handle: hfi instance handle
  */
-void cam_hfi_deinit(void);
+void cam_hfi_deinit(int client_handle);
 /**
  * hfi_set_debug_level() - set debug level
+ * @client_handle: hfi instance handle
  * @icp_dbg_type: 1 for debug_q & 2 for qdss
  * @lvl: FW debug message level
  */
-int hfi_set_debug_level(u64 icp_dbg_type, uint32_t lvl);
+int hfi_set_debug_level(int client_handle, u64 icp_dbg_type, uint32_t lvl);
 
 /**
  * hfi_set_fw_dump_level() - set firmware dump level
+ * @client_handle: hfi instance handle
  * @lvl: level of firmware dump level
  */
-int hfi_set_fw_dump_level(uint32_t lvl);
+int hfi_set_fw_dump_level(int client_handle, uint32_t lvl);
 
 /**
  * hfi_send_freq_info() - set firmware dump level
+ * @client_handle: hfi instance handle
  * @freq: icp freq
  */
-int hfi_send_freq_info(int32_t freq);
+int hfi_send_freq_info(int client_handle, int32_t freq);
 
 /**
  * hfi_enable_ipe_bps_pc() - Enable interframe pc
  * Host sends a command to firmware to enable interframe
  * power collapse for IPE and BPS hardware.
  *
+ * @client_handle: hfi instance handle
  * @enable: flag to enable/disable
  * @core_info: Core information to firmware
  */
-int hfi_enable_ipe_bps_pc(bool enable, uint32_t core_info);
+int hfi_enable_ipe_bps_pc(int client_handle, bool enable, uint32_t core_info);
 
 /**
  * hfi_cmd_ubwc_config_ext() - UBWC configuration to firmware
+ * @client_handle: hfi instance handle
  * @ubwc_ipe_cfg: UBWC ipe fetch/write configuration params
  * @ubwc_bps_cfg: UBWC bps fetch/write configuration params
  */
-int hfi_cmd_ubwc_config_ext(uint32_t *ubwc_ipe_cfg,
+int hfi_cmd_ubwc_config_ext(int client_handle, uint32_t *ubwc_ipe_cfg,
 	uint32_t *ubwc_bps_cfg);
 
 /**
  * hfi_cmd_ubwc_config() - UBWC configuration to firmware
  *                         for older targets
+ * @client_handle: hfi instance handle
  * @ubwc_cfg: UBWC configuration parameters
  */
-int hfi_cmd_ubwc_config(uint32_t *ubwc_cfg);
+int hfi_cmd_ubwc_config(int client_handle, uint32_t *ubwc_cfg);
 
 /**
  * cam_hfi_resume() - function to resume
+ * @client_handle: hfi instance handle
  * @hfi_mem: hfi memory info
  *
  * Returns success(zero)/failure(non zero)
  */
-int cam_hfi_resume(struct hfi_mem_info *hfi_mem);
+int cam_hfi_resume(int client_handle, struct hfi_mem_info *hfi_mem);
 
 /**
  * cam_hfi_queue_dump() - utility function to dump hfi queues
+ * @client_handle: hfi instance handle
  * @dump_queue_data: if set dumps queue contents
  *
  */
-void cam_hfi_queue_dump(bool dump_queue_data);
+void cam_hfi_queue_dump(int client_handle, bool dump_queue_data);
 
 /**
  * cam_hfi_mini_dump() - utility function for mini dump
+ * @client_handle: hfi instance handle
+ * @dst: destination of the dump
  */
-void cam_hfi_mini_dump(struct hfi_mini_dump_info *dst);
+void cam_hfi_mini_dump(int client_handle, struct hfi_mini_dump_info *dst);
 
 #endif /* _HFI_INTF_H_ */
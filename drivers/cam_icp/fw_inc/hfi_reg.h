@@ -7,6 +7,9 @@
 #define _CAM_HFI_REG_H_
 
 #include <linux/types.h>
+#include <linux/mutex.h>
+#include <linux/rwsem.h>
+#include <linux/kref.h>
 #include "hfi_intf.h"
 
 /* general purpose registers */
@@ -273,12 +276,18 @@ struct hfi_qtbl {
  * @uncachedheap_size: uncached heap size
  * @msgpacket_buf: message buffer
  * @hfi_state: State machine for hfi
- * @cmd_q_lock: Lock for command queue
+ * @cmd_q_lock: Lock for command queue, writers share it against init/deinit
  * @cmd_q_state: State of command queue
  * @mutex msg_q_lock: Lock for message queue
  * @msg_q_state: State of message queue
  * @priv: device private data
  * @dbg_lvl: debug level set to FW
+ * @cmd_q_reserve_idx: Host write index up to which cmd queue space is
+ *                     reserved by writers
+ * @cmd_q_commit_idx: Host write index last published to firmware
+ * @cmd_q_writers: Writers between reservation and doorbell
+ * @client_name: Name of the client registered for this instance
+ * @ref: References held by the registration and by in-flight callers
  */
 struct hfi_info {
 	struct hfi_mem_info map;
@@ -287,12 +296,17 @@ struct hfi_info {
 	uint32_t uncachedheap_size;
 	uint32_t msgpacket_buf[ICP_HFI_MAX_MSG_SIZE_IN_WORDS];
 	uint8_t hfi_state;
-	struct mutex cmd_q_lock;
+	struct rw_semaphore cmd_q_lock;
 	bool cmd_q_state;
 	struct mutex msg_q_lock;
 	bool msg_q_state;
 	void *priv;
 	u64 dbg_lvl;
+	atomic_t cmd_q_reserve_idx;
+	uint32_t cmd_q_commit_idx;
+	atomic_t cmd_q_writers;
+	char client_name[HFI_CLIENT_NAME_LEN];
+	struct kref ref;
 };
 
 #endif /* _CAM_HFI_REG_H_ */
@@ -12,6 +12,8 @@
 #include <linux/timer.h>
 #include <media/cam_icp.h>
 #include <linux/iopoll.h>
+#include <linux/rwsem.h>
+#include <linux/kref.h>
 
 #include "cam_io_util.h"
 #include "hfi_reg.h"
@@ -37,11 +39,52 @@
 #define HFI_POLL_DELAY_US 10
 #define HFI_POLL_TIMEOUT_US 1500000
 
-static struct hfi_info *g_hfi;
+/* Bound on queue reads per drain, remaining packets raise a new irq */
+#define HFI_MSG_DRAIN_MAX_READS 8
+
+static struct hfi_info *g_hfi[HFI_NUM_MAX];
 unsigned int g_icp_mmu_hdl;
 
-static DEFINE_MUTEX(hfi_cmd_q_mutex);
-static DEFINE_MUTEX(hfi_msg_q_mutex);
+static DEFINE_MUTEX(hfi_register_mutex);
+/* Protects g_hfi lookups against unregister, taken from any context */
+static DEFINE_SPINLOCK(hfi_instance_lock);
+
+/*
+ * Returns the instance with a reference held, release it with
+ * hfi_put_instance() so a concurrent unregister does not free it in use.
+ */
+static struct hfi_info *hfi_get_instance(int client_handle)
+{
+	struct hfi_info *hfi = NULL;
+	unsigned long flags;
+
+	if ((client_handle >= 0) && (client_handle < HFI_NUM_MAX)) {
+		spin_lock_irqsave(&hfi_instance_lock, flags);
+		hfi = g_hfi[client_handle];
+		if (hfi)
+			kref_get(&hfi->ref);
+		spin_unlock_irqrestore(&hfi_instance_lock, flags);
+	}
+
+	if (!hfi)
+		CAM_ERR(CAM_HFI, "Invalid client handle: %d", client_handle);
+
+	return hfi;
+}
+
+static void hfi_release_instance(struct kref *ref)
+{
+	struct hfi_info *hfi = container_of(ref, struct hfi_info, ref);
+
+	CAM_DBG(CAM_HFI, "Releasing hfi instance %s", hfi->client_name);
+	mutex_destroy(&hfi->msg_q_lock);
+	cam_free_clear((void *)hfi);
+}
+
+static void hfi_put_instance(struct hfi_info *hfi)
+{
+	kref_put(&hfi->ref, hfi_release_instance);
+}
 
 static void hfi_irq_raise(struct hfi_info *hfi)
 {
@@ -89,16 +132,22 @@ static void hfi_queue_dump(uint32_t *dwords, int count)
 			rows * 4, dwords[0], dwords[1], dwords[2]);
 }
 
-void cam_hfi_mini_dump(struct hfi_mini_dump_info *dst)
+void cam_hfi_mini_dump(int client_handle, struct hfi_mini_dump_info *dst)
 {
-	struct hfi_mem_info *hfi_mem = &g_hfi->map;
+	struct hfi_info *hfi = hfi_get_instance(client_handle);
+	struct hfi_mem_info *hfi_mem;
 	struct hfi_qtbl *qtbl;
 	struct hfi_q_hdr *q_hdr;
 	uint32_t *dwords;
 	int num_dwords;
 
+	if (!hfi)
+		return;
+
+	hfi_mem = &hfi->map;
 	if (!hfi_mem) {
 		CAM_ERR(CAM_HFI, "hfi mem info NULL... unable to dump queues");
+		hfi_put_instance(hfi);
 		return;
 	}
 
@@ -111,20 +160,27 @@ void cam_hfi_mini_dump(struct hfi_mini_dump_info *dst)
 	q_hdr = &qtbl->q_hdr[Q_MSG];
 	dwords = (uint32_t *)hfi_mem->msg_q.kva;
 	memcpy(dst->msg_q, dwords, ICP_CMD_Q_SIZE_IN_BYTES);
-	dst->msg_q_state = g_hfi->msg_q_state;
-	dst->cmd_q_state = g_hfi->cmd_q_state;
+	dst->msg_q_state = hfi->msg_q_state;
+	dst->cmd_q_state = hfi->cmd_q_state;
+	hfi_put_instance(hfi);
 }
 
-void cam_hfi_queue_dump(bool dump_queue_data)
+void cam_hfi_queue_dump(int client_handle, bool dump_queue_data)
 {
-	struct hfi_mem_info *hfi_mem = &g_hfi->map;
+	struct hfi_info *hfi = hfi_get_instance(client_handle);
+	struct hfi_mem_info *hfi_mem;
 	struct hfi_qtbl *qtbl;
 	struct hfi_q_hdr *q_hdr;
 	uint32_t *dwords;
 	int num_dwords;
 
+	if (!hfi)
+		return;
+
+	hfi_mem = &hfi->map;
 	if (!hfi_mem) {
 		CAM_ERR(CAM_HFI, "hfi mem info NULL... unable to dump queues");
+		hfi_put_instance(hfi);
 		return;
 	}
 
@@ -163,12 +219,69 @@ void cam_hfi_queue_dump(bool dump_queue_data)
 
 	if (dump_queue_data)
 		hfi_queue_dump(dwords, num_dwords);
+
+	hfi_put_instance(hfi);
+}
+
+/*
+ * Reserves size_in_words in the command queue by advancing the host side
+ * reservation index. Returns the start index of the reservation.
+ */
+static int hfi_cmd_q_reserve(struct hfi_info *hfi, struct hfi_q_hdr *q,
+	uint32_t size_in_words, uint32_t *start_idx)
+{
+	uint32_t q_size = q->qhdr_q_size;
+	uint32_t read_idx, reserve_idx, empty_space, new_idx;
+
+	do {
+		reserve_idx = atomic_read(&hfi->cmd_q_reserve_idx);
+		read_idx = READ_ONCE(q->qhdr_read_idx);
+		empty_space = (reserve_idx >= read_idx) ?
+			(q_size - (reserve_idx - read_idx)) :
+			(read_idx - reserve_idx);
+		if (empty_space <= size_in_words) {
+			CAM_ERR(CAM_HFI,
+				"failed: empty space %u, size_in_words %u",
+				empty_space, size_in_words);
+			return -EIO;
+		}
+
+		new_idx = reserve_idx + size_in_words;
+		if (new_idx >= q_size)
+			new_idx -= q_size;
+	} while (atomic_cmpxchg(&hfi->cmd_q_reserve_idx, reserve_idx,
+		new_idx) != reserve_idx);
+
+	*start_idx = reserve_idx;
+	return 0;
 }
 
-int hfi_write_cmd(void *cmd_ptr)
+/*
+ * Publishes a filled reservation to firmware. Reservations are made
+ * visible in the order they were taken, so a writer waits for the ones
+ * ahead of it to be published first.
+ */
+static void hfi_cmd_q_commit(struct hfi_info *hfi, struct hfi_q_hdr *q,
+	uint32_t start_idx, uint32_t end_idx)
 {
-	uint32_t size_in_words, empty_space, new_write_idx, read_idx, temp;
+	while (READ_ONCE(hfi->cmd_q_commit_idx) != start_idx)
+		cpu_relax();
+
+	/*
+	 * To make sure command data in a command queue before
+	 * updating write index
+	 */
+	wmb();
+
+	q->qhdr_write_idx = end_idx;
+	smp_store_release(&hfi->cmd_q_commit_idx, end_idx);
+}
+
+int hfi_write_cmd(int client_handle, void *cmd_ptr)
+{
+	uint32_t size_in_words, start_idx, new_write_idx, temp;
 	uint32_t *write_q, *write_ptr;
+	struct hfi_info *hfi;
 	struct hfi_qtbl *q_tbl;
 	struct hfi_q_hdr *q;
 	int rc = 0;
@@ -178,25 +291,23 @@ int hfi_write_cmd(void *cmd_ptr)
 		return -EINVAL;
 	}
 
-	mutex_lock(&hfi_cmd_q_mutex);
-	if (!g_hfi) {
-		CAM_ERR(CAM_HFI, "HFI interface not setup");
-		rc = -ENODEV;
-		goto err;
-	}
+	hfi = hfi_get_instance(client_handle);
+	if (!hfi)
+		return -ENODEV;
 
-	if (g_hfi->hfi_state != HFI_READY ||
-		!g_hfi->cmd_q_state) {
+	down_read(&hfi->cmd_q_lock);
+	if (hfi->hfi_state != HFI_READY ||
+		!hfi->cmd_q_state) {
 		CAM_ERR(CAM_HFI, "HFI state: %u, cmd q state: %u",
-			g_hfi->hfi_state, g_hfi->cmd_q_state);
+			hfi->hfi_state, hfi->cmd_q_state);
 		rc = -ENODEV;
 		goto err;
 	}
 
-	q_tbl = (struct hfi_qtbl *)g_hfi->map.qtbl.kva;
+	q_tbl = (struct hfi_qtbl *)hfi->map.qtbl.kva;
 	q = &q_tbl->q_hdr[Q_CMD];
 
-	write_q = (uint32_t *)g_hfi->map.cmd_q.kva;
+	write_q = (uint32_t *)hfi->map.cmd_q.kva;
 
 	size_in_words = (*(uint32_t *)cmd_ptr) >> BYTE_WORD_SHIFT;
 	if (!size_in_words) {
@@ -205,19 +316,22 @@ int hfi_write_cmd(void *cmd_ptr)
 		goto err;
 	}
 
-	read_idx = q->qhdr_read_idx;
-	empty_space = (q->qhdr_write_idx >= read_idx) ?
-		(q->qhdr_q_size - (q->qhdr_write_idx - read_idx)) :
-		(read_idx - q->qhdr_write_idx);
-	if (empty_space <= size_in_words) {
-		CAM_ERR(CAM_HFI, "failed: empty space %u, size_in_words %u",
-			empty_space, size_in_words);
-		rc = -EIO;
+	/*
+	 * Writers spin on the ones ahead of them at commit, keep the
+	 * window from reservation to commit non preemptible.
+	 */
+	preempt_disable();
+	atomic_inc(&hfi->cmd_q_writers);
+
+	rc = hfi_cmd_q_reserve(hfi, q, size_in_words, &start_idx);
+	if (rc) {
+		atomic_dec(&hfi->cmd_q_writers);
+		preempt_enable();
 		goto err;
 	}
 
-	new_write_idx = q->qhdr_write_idx + size_in_words;
-	write_ptr = (uint32_t *)(write_q + q->qhdr_write_idx);
+	new_write_idx = start_idx + size_in_words;
+	write_ptr = (uint32_t *)(write_q + start_idx);
 
 	if (new_write_idx < q->qhdr_q_size) {
 		memcpy(write_ptr, (uint8_t *)cmd_ptr,
@@ -230,30 +344,29 @@ int hfi_write_cmd(void *cmd_ptr)
 			new_write_idx << BYTE_WORD_SHIFT);
 	}
 
-	/*
-	 * To make sure command data in a command queue before
-	 * updating write index
-	 */
-	wmb();
-
-	q->qhdr_write_idx = new_write_idx;
+	hfi_cmd_q_commit(hfi, q, start_idx, new_write_idx);
 
 	/*
-	 * Before raising interrupt make sure command data is ready for
-	 * firmware to process
+	 * Only the last writer of a burst rings the doorbell, commits are
+	 * ordered so its write index covers every command ahead of it.
+	 * The register write in irq_raise orders the queue update before
+	 * the interrupt.
 	 */
-	wmb();
-	hfi_irq_raise(g_hfi);
+	if (atomic_dec_and_test(&hfi->cmd_q_writers)) {
+		hfi_irq_raise(hfi);
 
-	/* Ensure HOST2ICP trigger is received by FW */
-	wmb();
+		/* Ensure HOST2ICP trigger is received by FW */
+		wmb();
+	}
+	preempt_enable();
 err:
-	mutex_unlock(&hfi_cmd_q_mutex);
+	up_read(&hfi->cmd_q_lock);
+	hfi_put_instance(hfi);
 	return rc;
 }
 
-int hfi_read_message(uint32_t *pmsg, uint8_t q_id,
-	uint32_t *words_read)
+static int hfi_read_message_locked(struct hfi_info *hfi, uint32_t *pmsg,
+	uint8_t q_id, uint32_t *words_read)
 {
 	struct hfi_qtbl *q_tbl_ptr;
 	struct hfi_q_hdr *q;
@@ -272,36 +385,29 @@ int hfi_read_message(uint32_t *pmsg, uint8_t q_id,
 		return -EINVAL;
 	}
 
-	mutex_lock(&hfi_msg_q_mutex);
-	if (!g_hfi) {
-		CAM_ERR(CAM_HFI, "hfi not set up yet");
-		rc = -ENODEV;
-		goto err;
-	}
-
-	if ((g_hfi->hfi_state != HFI_READY) ||
-		!g_hfi->msg_q_state) {
+	if ((hfi->hfi_state != HFI_READY) ||
+		!hfi->msg_q_state) {
 		CAM_ERR(CAM_HFI, "hfi state: %u, msg q state: %u",
-			g_hfi->hfi_state, g_hfi->msg_q_state);
+			hfi->hfi_state, hfi->msg_q_state);
 		rc = -ENODEV;
 		goto err;
 	}
 
-	q_tbl_ptr = (struct hfi_qtbl *)g_hfi->map.qtbl.kva;
+	q_tbl_ptr = (struct hfi_qtbl *)hfi->map.qtbl.kva;
 	q = &q_tbl_ptr->q_hdr[q_id];
 
 	if (q->qhdr_read_idx == q->qhdr_write_idx) {
 		CAM_DBG(CAM_HFI, "Q not ready, state:%u, r idx:%u, w idx:%u",
-			g_hfi->hfi_state, q->qhdr_read_idx, q->qhdr_write_idx);
+			hfi->hfi_state, q->qhdr_read_idx, q->qhdr_write_idx);
 		rc = -EIO;
 		goto err;
 	}
 
 	if (q_id == Q_MSG) {
-		read_q = (uint32_t *)g_hfi->map.msg_q.kva;
+		read_q = (uint32_t *)hfi->map.msg_q.kva;
 		size_upper_bound = ICP_HFI_MAX_PKT_SIZE_MSGQ_IN_WORDS;
 	} else {
-		read_q = (uint32_t *)g_hfi->map.dbg_q.kva;
+		read_q = (uint32_t *)hfi->map.dbg_q.kva;
 		size_upper_bound = ICP_HFI_MAX_PKT_SIZE_IN_WORDS;
 	}
 
@@ -348,11 +454,88 @@ int hfi_read_message(uint32_t *pmsg, uint8_t q_id,
 	 */
 	wmb();
 err:
-	mutex_unlock(&hfi_msg_q_mutex);
 	return rc;
 }
 
-int hfi_cmd_ubwc_config(uint32_t *ubwc_cfg)
+static bool hfi_msg_q_pending_locked(struct hfi_info *hfi, uint8_t q_id)
+{
+	struct hfi_qtbl *q_tbl_ptr;
+	struct hfi_q_hdr *q;
+
+	if ((hfi->hfi_state != HFI_READY) || !hfi->msg_q_state)
+		return false;
+
+	q_tbl_ptr = (struct hfi_qtbl *)hfi->map.qtbl.kva;
+	q = &q_tbl_ptr->q_hdr[q_id];
+
+	return q->qhdr_read_idx != READ_ONCE(q->qhdr_write_idx);
+}
+
+int hfi_read_message(int client_handle, uint32_t *pmsg, uint8_t q_id,
+	uint32_t *words_read)
+{
+	struct hfi_info *hfi;
+	int rc;
+
+	hfi = hfi_get_instance(client_handle);
+	if (!hfi)
+		return -ENODEV;
+
+	mutex_lock(&hfi->msg_q_lock);
+	rc = hfi_read_message_locked(hfi, pmsg, q_id, words_read);
+	mutex_unlock(&hfi->msg_q_lock);
+	hfi_put_instance(hfi);
+
+	return rc;
+}
+
+int hfi_drain_message(int client_handle, uint32_t *pmsg, uint8_t q_id,
+	hfi_msg_process_cb process_cb, void *priv)
+{
+	uint32_t words_read, num_reads = 0;
+	struct hfi_info *hfi;
+	bool pending;
+	int rc;
+
+	if (!process_cb) {
+		CAM_ERR(CAM_HFI, "Invalid process cb");
+		return -EINVAL;
+	}
+
+	hfi = hfi_get_instance(client_handle);
+	if (!hfi)
+		return -ENODEV;
+
+	do {
+		mutex_lock(&hfi->msg_q_lock);
+		rc = hfi_read_message_locked(hfi, pmsg, q_id, &words_read);
+		mutex_unlock(&hfi->msg_q_lock);
+		if (rc)
+			break;
+
+		num_reads++;
+		/* Unlocked, fatal error handling reads the debug queue */
+		rc = process_cb(priv, pmsg, words_read);
+		if (rc)
+			break;
+
+		if (num_reads >= HFI_MSG_DRAIN_MAX_READS)
+			break;
+
+		mutex_lock(&hfi->msg_q_lock);
+		pending = hfi_msg_q_pending_locked(hfi, q_id);
+		mutex_unlock(&hfi->msg_q_lock);
+	} while (pending);
+
+	CAM_DBG(CAM_HFI, "q_id: %u drained %u reads rc: %d",
+		q_id, num_reads, rc);
+	hfi_put_instance(hfi);
+
+	return rc;
+}
+
+
+int hfi_cmd_ubwc_config(int client_handle, uint32_t *ubwc_cfg)
 {
 	uint8_t *prop;
 	struct hfi_cmd_prop *dbg_prop;
@@ -377,13 +560,13 @@ int hfi_cmd_ubwc_config(uint32_t *ubwc_cfg)
 	dbg_prop->prop_data[1] = ubwc_cfg[0];
 	dbg_prop->prop_data[2] = ubwc_cfg[1];
 
-	hfi_write_cmd(prop);
+	hfi_write_cmd(client_handle, prop);
 	kfree(prop);
 
 	return 0;
 }
 
-int hfi_cmd_ubwc_config_ext(uint32_t *ubwc_ipe_cfg,
+int hfi_cmd_ubwc_config_ext(int client_handle, uint32_t *ubwc_ipe_cfg,
 	uint32_t *ubwc_bps_cfg)
 {
 	uint8_t *prop;
@@ -412,14 +595,14 @@ int hfi_cmd_ubwc_config_ext(uint32_t *ubwc_ipe_cfg,
 	dbg_prop->prop_data[3] = ubwc_ipe_cfg[0];
 	dbg_prop->prop_data[4] = ubwc_ipe_cfg[1];
 
-	hfi_write_cmd(prop);
+	hfi_write_cmd(client_handle, prop);
 	kfree(prop);
 
 	return 0;
 }
 
 
-int hfi_enable_ipe_bps_pc(bool enable, uint32_t core_info)
+int hfi_enable_ipe_bps_pc(int client_handle, bool enable, uint32_t core_info)
 {
 	uint8_t *prop;
 	struct hfi_cmd_prop *dbg_prop;
@@ -440,14 +623,15 @@ int hfi_enable_ipe_bps_pc(bool enable, uint32_t core_info)
 	dbg_prop->prop_data[1] = enable;
 	dbg_prop->prop_data[2] = core_info;
 
-	hfi_write_cmd(prop);
+	hfi_write_cmd(client_handle, prop);
 	kfree(prop);
 
 	return 0;
 }
 
-int hfi_set_debug_level(u64 icp_dbg_type, uint32_t lvl)
+int hfi_set_debug_level(int client_handle, u64 icp_dbg_type, uint32_t lvl)
 {
+	struct hfi_info *hfi;
 	uint8_t *prop;
 	struct hfi_cmd_prop *dbg_prop;
 	uint32_t size = 0, val;
@@ -464,8 +648,12 @@ int hfi_set_debug_level(u64 icp_dbg_type, uint32_t lvl)
 	if (lvl > val)
 		return -EINVAL;
 
-	if (g_hfi)
-		g_hfi->dbg_lvl = lvl;
+	hfi = hfi_get_instance(client_handle);
+	if (!hfi)
+		return -ENODEV;
+
+	hfi->dbg_lvl = lvl;
+	hfi_put_instance(hfi);
 
 	size = sizeof(struct hfi_cmd_prop) +
 		sizeof(struct hfi_debug);
@@ -481,14 +669,14 @@ int hfi_set_debug_level(u64 icp_dbg_type, uint32_t lvl)
 	dbg_prop->prop_data[0] = HFI_PROP_SYS_DEBUG_CFG;
 	dbg_prop->prop_data[1] = lvl;
 	dbg_prop->prop_data[2] = icp_dbg_type;
-	hfi_write_cmd(prop);
+	hfi_write_cmd(client_handle, prop);
 
 	kfree(prop);
 
 	return 0;
 }
 
-int hfi_set_fw_dump_level(uint32_t lvl)
+int hfi_set_fw_dump_level(int client_handle, uint32_t lvl)
 {
 	uint8_t *prop = NULL;
 	struct hfi_cmd_prop *fw_dump_level_switch_prop = NULL;
@@ -519,23 +707,26 @@ int hfi_set_fw_dump_level(uint32_t lvl)
 			 fw_dump_level_switch_prop->prop_data[0],
 			 fw_dump_level_switch_prop->prop_data[1]);
 
-	hfi_write_cmd(prop);
+	hfi_write_cmd(client_handle, prop);
 	kfree(prop);
 	return 0;
 }
 
-int hfi_send_freq_info(int32_t freq)
+int hfi_send_freq_info(int client_handle, int32_t freq)
 {
 	uint8_t *prop = NULL;
 	struct hfi_cmd_prop *dbg_prop = NULL;
+	struct hfi_info *hfi;
 	uint32_t size = 0;
+	u64 dbg_lvl;
 
-	if (!g_hfi) {
-		CAM_ERR(CAM_HFI, "HFI interface not setup");
+	hfi = hfi_get_instance(client_handle);
+	if (!hfi)
 		return -ENODEV;
-	}
 
-	if (!(g_hfi->dbg_lvl & HFI_DEBUG_MSG_PERF))
+	dbg_lvl = hfi->dbg_lvl;
+	hfi_put_instance(hfi);
+	if (!(dbg_lvl & HFI_DEBUG_MSG_PERF))
 		return -EINVAL;
 
 	size = sizeof(struct hfi_cmd_prop) + sizeof(freq);
@@ -561,14 +752,15 @@ int hfi_send_freq_info(int32_t freq)
 			 dbg_prop->num_prop,
 			 dbg_prop->prop_data[0],
 			 dbg_prop->prop_data[1],
-			 g_hfi->dbg_lvl);
+			 dbg_lvl);
 
-	hfi_write_cmd(prop);
+	hfi_write_cmd(client_handle, prop);
 	kfree(prop);
 	return 0;
 }
 
-void hfi_send_system_cmd(uint32_t type, uint64_t data, uint32_t size)
+void hfi_send_system_cmd(int client_handle, uint32_t type, uint64_t data,
+	uint32_t size)
 {
 	switch (type) {
 	case HFI_CMD_SYS_INIT: {
@@ -578,7 +770,7 @@ void hfi_send_system_cmd(uint32_t type, uint64_t data, uint32_t size)
 
 		init.size = sizeof(struct hfi_cmd_sys_init);
 		init.pkt_type = type;
-		hfi_write_cmd(&init);
+		hfi_write_cmd(client_handle, &init);
 	}
 		break;
 	case HFI_CMD_SYS_PC_PREP: {
@@ -586,7 +778,7 @@ void hfi_send_system_cmd(uint32_t type, uint64_t data, uint32_t size)
 
 		prep.size = sizeof(struct hfi_cmd_pc_prep);
 		prep.pkt_type = type;
-		hfi_write_cmd(&prep);
+		hfi_write_cmd(client_handle, &prep);
 	}
 		break;
 	case HFI_CMD_SYS_SET_PROPERTY: {
@@ -597,7 +789,7 @@ void hfi_send_system_cmd(uint32_t type, uint64_t data, uint32_t size)
 			prop.pkt_type = type;
 			prop.num_prop = 1;
 			prop.prop_data[0] = HFI_PROP_SYS_DEBUG_CFG;
-			hfi_write_cmd(&prop);
+			hfi_write_cmd(client_handle, &prop);
 		}
 	}
 		break;
@@ -609,7 +801,7 @@ void hfi_send_system_cmd(uint32_t type, uint64_t data, uint32_t size)
 		ping.size = sizeof(struct hfi_cmd_ping_pkt);
 		ping.pkt_type = type;
 		ping.user_data = (uint64_t)data;
-		hfi_write_cmd(&ping);
+		hfi_write_cmd(client_handle, &ping);
 	}
 		break;
 	case HFI_CMD_SYS_RESET: {
@@ -618,7 +810,7 @@ void hfi_send_system_cmd(uint32_t type, uint64_t data, uint32_t size)
 		reset.size = sizeof(struct hfi_cmd_sys_reset_pkt);
 		reset.pkt_type = type;
 		reset.user_data = (uint64_t)data;
-		hfi_write_cmd(&reset);
+		hfi_write_cmd(client_handle, &reset);
 	}
 		break;
 	case HFI_CMD_IPEBPS_CREATE_HANDLE: {
@@ -628,7 +820,7 @@ void hfi_send_system_cmd(uint32_t type, uint64_t data, uint32_t size)
 		handle.pkt_type = type;
 		handle.handle_type = (uint32_t)data;
 		handle.user_data1 = 0;
-		hfi_write_cmd(&handle);
+		hfi_write_cmd(client_handle, &handle);
 	}
 		break;
 	case HFI_CMD_IPEBPS_ASYNC_COMMAND_INDIRECT:
@@ -671,12 +863,14 @@ int hfi_get_hw_caps(void *query_buf)
 	return 0;
 }
 
-int cam_hfi_resume(struct hfi_mem_info *hfi_mem)
+static int __cam_hfi_resume(struct hfi_info *hfi,
+	struct hfi_mem_info *hfi_mem)
 {
 	int rc = 0;
 	uint32_t fw_version, status = 0;
-	void __iomem *icp_base = hfi_iface_addr(g_hfi);
+	void __iomem *icp_base;
 
+	icp_base = hfi_iface_addr(hfi);
 	if (!icp_base) {
 		CAM_ERR(CAM_HFI, "invalid HFI interface address");
 		return -EINVAL;
@@ -691,7 +885,7 @@ int cam_hfi_resume(struct hfi_mem_info *hfi_mem)
 	    return -ETIMEDOUT;
 	}
 
-	hfi_irq_enable(g_hfi);
+	hfi_irq_enable(hfi);
 
 	fw_version = cam_io_r(icp_base + HFI_REG_FW_VERSION);
 	CAM_DBG(CAM_HFI, "fw version : [%x]", fw_version);
@@ -745,10 +939,47 @@ int cam_hfi_resume(struct hfi_mem_info *hfi_mem)
 	return rc;
 }
 
-int cam_hfi_init(struct hfi_mem_info *hfi_mem, const struct hfi_ops *hfi_ops,
-		void *priv, uint8_t event_driven_mode)
+int cam_hfi_resume(int client_handle, struct hfi_mem_info *hfi_mem)
+{
+	struct hfi_info *hfi;
+	int rc;
+
+	hfi = hfi_get_instance(client_handle);
+	if (!hfi)
+		return -ENODEV;
+
+	rc = __cam_hfi_resume(hfi, hfi_mem);
+	hfi_put_instance(hfi);
+
+	return rc;
+}
+
+/*
+ * Instances outlive firmware reloads, so init starts from a clean state.
+ * The locks (held by the caller) and the registered name are kept.
+ */
+static void hfi_reset_instance(struct hfi_info *hfi)
+{
+	memset(&hfi->map, 0, sizeof(hfi->map));
+	memset(&hfi->ops, 0, sizeof(hfi->ops));
+	hfi->smem_size = 0;
+	hfi->uncachedheap_size = 0;
+	memset(hfi->msgpacket_buf, 0, sizeof(hfi->msgpacket_buf));
+	hfi->cmd_q_state = false;
+	hfi->msg_q_state = false;
+	hfi->priv = NULL;
+	hfi->dbg_lvl = 0;
+	atomic_set(&hfi->cmd_q_reserve_idx, 0);
+	hfi->cmd_q_commit_idx = 0;
+	atomic_set(&hfi->cmd_q_writers, 0);
+}
+
+int cam_hfi_init(int client_handle, struct hfi_mem_info *hfi_mem,
+		const struct hfi_ops *hfi_ops, void *priv,
+		uint8_t event_driven_mode)
 {
 	int rc = 0;
+	struct hfi_info *hfi;
 	uint32_t status = 0;
 	struct hfi_qtbl *qtbl;
 	struct hfi_qtbl_hdr *qtbl_hdr;
@@ -763,25 +994,22 @@ int cam_hfi_init(struct hfi_mem_info *hfi_mem, const struct hfi_ops *hfi_ops,
 		return -EINVAL;
 	}
 
-	mutex_lock(&hfi_cmd_q_mutex);
-	mutex_lock(&hfi_msg_q_mutex);
+	hfi = hfi_get_instance(client_handle);
+	if (!hfi)
+		return -ENODEV;
 
-	if (!g_hfi) {
-		g_hfi = kzalloc(sizeof(struct hfi_info), GFP_KERNEL);
-		if (!g_hfi) {
-			rc = -ENOMEM;
-			goto alloc_fail;
-		}
-	}
+	down_write(&hfi->cmd_q_lock);
+	mutex_lock(&hfi->msg_q_lock);
 
-	if (g_hfi->hfi_state != HFI_DEINIT) {
+	if (hfi->hfi_state != HFI_DEINIT) {
 		CAM_ERR(CAM_HFI, "hfi_init: invalid state");
 		rc = -EINVAL;
 		goto regions_fail;
 	}
 
-	memcpy(&g_hfi->map, hfi_mem, sizeof(g_hfi->map));
-	g_hfi->hfi_state = HFI_DEINIT;
+	hfi_reset_instance(hfi);
+	memcpy(&hfi->map, hfi_mem, sizeof(hfi->map));
+	hfi->hfi_state = HFI_DEINIT;
 
 	qtbl = (struct hfi_qtbl *)hfi_mem->qtbl.kva;
 	qtbl_hdr = &qtbl->q_tbl_hdr;
@@ -897,10 +1125,10 @@ int cam_hfi_init(struct hfi_mem_info *hfi_mem, const struct hfi_ops *hfi_ops,
 		break;
 	}
 
-	g_hfi->ops = *hfi_ops;
-	g_hfi->priv = priv;
+	hfi->ops = *hfi_ops;
+	hfi->priv = priv;
 
-	icp_base = hfi_iface_addr(g_hfi);
+	icp_base = hfi_iface_addr(hfi);
 	if (!icp_base) {
 		CAM_ERR(CAM_HFI, "invalid HFI interface address");
 		rc = -EINVAL;
@@ -967,42 +1195,115 @@ int cam_hfi_init(struct hfi_mem_info *hfi_mem, const struct hfi_ops *hfi_ops,
 	CAM_DBG(CAM_HFI, "ICP fw version: 0x%x",
 		cam_io_r(icp_base + HFI_REG_FW_VERSION));
 
-	g_hfi->hfi_state = HFI_READY;
-	g_hfi->cmd_q_state = true;
-	g_hfi->msg_q_state = true;
+	atomic_set(&hfi->cmd_q_reserve_idx, cmd_q_hdr->qhdr_write_idx);
+	hfi->cmd_q_commit_idx = cmd_q_hdr->qhdr_write_idx;
+	atomic_set(&hfi->cmd_q_writers, 0);
+	hfi->hfi_state = HFI_READY;
+	hfi->cmd_q_state = true;
+	hfi->msg_q_state = true;
 
-	hfi_irq_enable(g_hfi);
+	hfi_irq_enable(hfi);
 
-	mutex_unlock(&hfi_cmd_q_mutex);
-	mutex_unlock(&hfi_msg_q_mutex);
+	up_write(&hfi->cmd_q_lock);
+	mutex_unlock(&hfi->msg_q_lock);
+	hfi_put_instance(hfi);
 
 	return rc;
 regions_fail:
-	kfree(g_hfi);
-	g_hfi = NULL;
-alloc_fail:
-	mutex_unlock(&hfi_cmd_q_mutex);
-	mutex_unlock(&hfi_msg_q_mutex);
+	up_write(&hfi->cmd_q_lock);
+	mutex_unlock(&hfi->msg_q_lock);
+	hfi_put_instance(hfi);
 	return rc;
 }
 
-void cam_hfi_deinit(void)
+void cam_hfi_deinit(int client_handle)
 {
-	mutex_lock(&hfi_cmd_q_mutex);
-	mutex_lock(&hfi_msg_q_mutex);
+	struct hfi_info *hfi;
 
-	if (!g_hfi) {
-		CAM_ERR(CAM_HFI, "hfi path not established yet");
-		goto err;
+	hfi = hfi_get_instance(client_handle);
+	if (!hfi)
+		return;
+
+	down_write(&hfi->cmd_q_lock);
+	mutex_lock(&hfi->msg_q_lock);
+
+	hfi->cmd_q_state = false;
+	hfi->msg_q_state = false;
+	hfi->hfi_state = HFI_DEINIT;
+	memset(&hfi->map, 0, sizeof(hfi->map));
+
+	up_write(&hfi->cmd_q_lock);
+	mutex_unlock(&hfi->msg_q_lock);
+	hfi_put_instance(hfi);
+}
+
+int cam_hfi_register(int *client_handle, const char *client_name)
+{
+	int i, rc = 0;
+	struct hfi_info *hfi;
+
+	if (!client_handle || !client_name) {
+		CAM_ERR(CAM_HFI, "Invalid args");
+		return -EINVAL;
 	}
 
-	g_hfi->cmd_q_state = false;
-	g_hfi->msg_q_state = false;
+	mutex_lock(&hfi_register_mutex);
+	for (i = 0; i < HFI_NUM_MAX; i++) {
+		if (!g_hfi[i])
+			break;
+	}
 
-	cam_free_clear((void *)g_hfi);
-	g_hfi = NULL;
+	if (i == HFI_NUM_MAX) {
+		CAM_ERR(CAM_HFI, "No free hfi instance for %s", client_name);
+		rc = -ENOSPC;
+		goto end;
+	}
 
-err:
-	mutex_unlock(&hfi_cmd_q_mutex);
-	mutex_unlock(&hfi_msg_q_mutex);
+	hfi = kzalloc(sizeof(struct hfi_info), GFP_KERNEL);
+	if (!hfi) {
+		rc = -ENOMEM;
+		goto end;
+	}
+
+	init_rwsem(&hfi->cmd_q_lock);
+	mutex_init(&hfi->msg_q_lock);
+	kref_init(&hfi->ref);
+	hfi->hfi_state = HFI_DEINIT;
+	strscpy(hfi->client_name, client_name, sizeof(hfi->client_name));
+	spin_lock_irq(&hfi_instance_lock);
+	g_hfi[i] = hfi;
+	spin_unlock_irq(&hfi_instance_lock);
+	*client_handle = i;
+
+	CAM_DBG(CAM_HFI, "Registered %s as hfi instance %d", client_name, i);
+end:
+	mutex_unlock(&hfi_register_mutex);
+	return rc;
+}
+
+int cam_hfi_unregister(int *client_handle)
+{
+	struct hfi_info *hfi;
+
+	if (!client_handle)
+		return -EINVAL;
+
+	mutex_lock(&hfi_register_mutex);
+	hfi = hfi_get_instance(*client_handle);
+	if (!hfi) {
+		mutex_unlock(&hfi_register_mutex);
+		return -EINVAL;
+	}
+
+	spin_lock_irq(&hfi_instance_lock);
+	g_hfi[*client_handle] = NULL;
+	spin_unlock_irq(&hfi_instance_lock);
+	mutex_unlock(&hfi_register_mutex);
+
+	/* Drop the lookup and the registration references, last user frees */
+	hfi_put_instance(hfi);
+	hfi_put_instance(hfi);
+	*client_handle = HFI_HANDLE_INIT;
+
+	return 0;
 }
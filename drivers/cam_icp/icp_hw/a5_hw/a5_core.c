@@ -620,11 +620,24 @@ int cam_a5_process_cmd(void *device_priv, uint32_t cmd_type,
 		rc = cam_a5_power_resume(a5_dev, *((bool *)cmd_args));
 		break;
 	case CAM_ICP_SEND_INIT:
-		hfi_send_system_cmd(HFI_CMD_SYS_INIT, 0, 0);
+		a5_soc = soc_info->soc_private;
+		hfi_send_system_cmd(a5_soc->hfi_handle, HFI_CMD_SYS_INIT, 0, 0);
 		break;
 
 	case CAM_ICP_CMD_PC_PREP:
-		hfi_send_system_cmd(HFI_CMD_SYS_PC_PREP, 0, 0);
+		a5_soc = soc_info->soc_private;
+		hfi_send_system_cmd(a5_soc->hfi_handle,
+			HFI_CMD_SYS_PC_PREP, 0, 0);
+		break;
+
+	case CAM_ICP_CMD_SET_HFI_HANDLE:
+		if (!cmd_args || (arg_size != sizeof(int32_t))) {
+			CAM_ERR(CAM_ICP, "Invalid args");
+			return -EINVAL;
+		}
+
+		a5_soc = soc_info->soc_private;
+		a5_soc->hfi_handle = *((int32_t *)cmd_args);
 		break;
 
 	case CAM_ICP_CMD_VOTE_CPAS: {
@@ -702,10 +715,11 @@ int cam_a5_process_cmd(void *device_priv, uint32_t cmd_type,
 					"Force disable UBWC compression, ubwc_ipe_cfg: 0x%x, ubwc_bps_cfg: 0x%x",
 					ubwc_ipe_cfg[1], ubwc_bps_cfg[1]);
 			}
-			rc = hfi_cmd_ubwc_config_ext(&ubwc_ipe_cfg[0],
-					&ubwc_bps_cfg[0]);
+			rc = hfi_cmd_ubwc_config_ext(a5_soc->hfi_handle,
+				&ubwc_ipe_cfg[0], &ubwc_bps_cfg[0]);
 		} else {
-			rc = hfi_cmd_ubwc_config(a5_soc->uconfig.ubwc_cfg);
+			rc = hfi_cmd_ubwc_config(a5_soc->hfi_handle,
+				a5_soc->uconfig.ubwc_cfg);
 		}
 
 		break;
@@ -18,6 +18,7 @@
 #include "cam_cpas_api.h"
 #include "cam_debug_util.h"
 #include "camera_main.h"
+#include "hfi_intf.h"
 
 struct a5_soc_info cam_a5_soc_info;
 EXPORT_SYMBOL(cam_a5_soc_info);
@@ -159,6 +160,7 @@ static int cam_a5_component_bind(struct device *dev,
 	core_info->a5_hw_info = hw_info;
 
 	a5_dev->soc_info.soc_private = &cam_a5_soc_info;
+	cam_a5_soc_info.hfi_handle = HFI_HANDLE_INIT;
 
 	rc = cam_a5_init_soc_resources(&a5_dev->soc_info, cam_a5_irq,
 		a5_dev);
@@ -194,10 +194,11 @@ int cam_a5_enable_soc_resources(struct cam_hw_soc_info *soc_info)
 	if (rc)
 		CAM_ERR(CAM_ICP, "enable platform failed");
 	else {
+		struct a5_soc_info *a5_soc_info = soc_info->soc_private;
 		int32_t clk_rate = 0;
 
 		clk_rate = clk_get_rate(soc_info->clk[soc_info->src_clk_idx]);
-		hfi_send_freq_info(clk_rate);
+		hfi_send_freq_info(a5_soc_info->hfi_handle, clk_rate);
 	}
 
 	return rc;
@@ -205,13 +206,14 @@ int cam_a5_enable_soc_resources(struct cam_hw_soc_info *soc_info)
 
 int cam_a5_disable_soc_resources(struct cam_hw_soc_info *soc_info)
 {
+	struct a5_soc_info *a5_soc_info = soc_info->soc_private;
 	int rc = 0;
 
 	rc = cam_soc_util_disable_platform_resource(soc_info, true, true);
 	if (rc)
 		CAM_ERR(CAM_ICP, "disable platform failed");
 	else
-		hfi_send_freq_info(0);
+		hfi_send_freq_info(a5_soc_info->hfi_handle, 0);
 
 	return rc;
 }
@@ -219,6 +221,7 @@ int cam_a5_disable_soc_resources(struct cam_hw_soc_info *soc_info)
 int cam_a5_update_clk_rate(struct cam_hw_soc_info *soc_info,
 	int32_t clk_level)
 {
+	struct a5_soc_info *a5_soc_info;
 	int32_t src_clk_idx = 0;
 	int32_t clk_rate = 0;
 	int rc = 0;
@@ -262,6 +265,7 @@ int cam_a5_update_clk_rate(struct cam_hw_soc_info *soc_info,
 	if (rc)
 		return rc;
 
-	hfi_send_freq_info(clk_rate);
+	a5_soc_info = soc_info->soc_private;
+	hfi_send_freq_info(a5_soc_info->hfi_handle, clk_rate);
 	return 0;
 }
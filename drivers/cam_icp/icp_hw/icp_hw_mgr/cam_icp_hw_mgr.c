@@ -38,6 +38,7 @@
 #include "hfi_session_defs.h"
 #include "hfi_sys_defs.h"
 #include "cam_req_mgr_workq.h"
+#include "cam_req_mgr_debug.h"
 #include "cam_mem_mgr.h"
 #include "a5_core.h"
 #include "lx7_core.h"
@@ -135,7 +136,7 @@ static inline void cam_icp_dump_debug_info(bool skip_dump)
 		return;
 
 	cam_icp_mgr_process_dbg_buf(icp_hw_mgr.icp_dbg_lvl);
-	cam_hfi_queue_dump(false);
+	cam_hfi_queue_dump(icp_hw_mgr.hfi_handle, false);
 	icp_dev_intf->hw_ops.process_cmd(
 		icp_dev_intf->hw_priv, CAM_ICP_CMD_HW_REG_DUMP, NULL, 0x0);
 }
@@ -307,19 +308,27 @@ static int cam_icp_supported_clk_rates(struct cam_icp_hw_mgr *hw_mgr,
 	return 0;
 }
 
-static int cam_icp_clk_idx_from_req_id(struct cam_icp_hw_ctx_data *ctx_data,
-	uint64_t req_id)
+static inline uint64_t cam_icp_frame_user_data(uint64_t request_id,
+	int32_t idx)
 {
-	struct hfi_frame_process_info *frame_process;
-	int i;
+	return ((uint64_t)(idx + 1) << ICP_FRAME_SLOT_SHIFT) |
+		(request_id & ICP_FRAME_REQ_ID_MASK);
+}
 
-	frame_process = &ctx_data->hfi_frame_process;
+static int32_t cam_icp_frame_idx_from_user_data(
+	struct hfi_frame_process_info *frame_process, uint64_t user_data)
+{
+	int32_t idx = (int32_t)(user_data >> ICP_FRAME_SLOT_SHIFT) - 1;
 
-	for (i = 0; i < CAM_FRAME_CMD_MAX; i++)
-		if (frame_process->request_id[i] == req_id)
-			return i;
+	if ((idx < 0) || (idx >= CAM_FRAME_CMD_MAX))
+		return -EINVAL;
 
-	return 0;
+	if (!test_bit(idx, frame_process->bitmap) ||
+		((frame_process->request_id[idx] & ICP_FRAME_REQ_ID_MASK) !=
+		(user_data & ICP_FRAME_REQ_ID_MASK)))
+		return -EINVAL;
+
+	return idx;
 }
 
 static int cam_icp_ctx_clk_info_init(struct cam_icp_hw_ctx_data *ctx_data)
@@ -920,7 +929,8 @@ static bool cam_icp_busy_prev_reqs(struct hfi_frame_process_info *frm_process,
 	int i;
 	int cnt;
 
-	for (i = 0, cnt = 0; i < CAM_FRAME_CMD_MAX; i++) {
+	cnt = 0;
+	for_each_set_bit(i, frm_process->bitmap, CAM_FRAME_CMD_MAX) {
 		if (frm_process->request_id[i]) {
 			if (frm_process->fw_process_flag[i]) {
 				CAM_DBG(CAM_PERF, "r id = %lld busy = %d",
@@ -1747,9 +1757,11 @@ static int cam_icp_mgr_ipe_bps_resume(struct cam_icp_hw_mgr *hw_mgr,
 
 	CAM_DBG(CAM_PERF, "core_info %X", core_info_mask);
 	if (icp_hw_mgr.ipe_bps_pc_flag)
-		rc = hfi_enable_ipe_bps_pc(true, core_info_mask);
+		rc = hfi_enable_ipe_bps_pc(hw_mgr->hfi_handle, true,
+			core_info_mask);
 	else
-		rc = hfi_enable_ipe_bps_pc(false, core_info_mask);
+		rc = hfi_enable_ipe_bps_pc(hw_mgr->hfi_handle, false,
+			core_info_mask);
 end:
 	return rc;
 }
@@ -1996,7 +2008,7 @@ static int cam_icp_mgr_process_cmd(void *priv, void *data)
 	hw_mgr = priv;
 	task_data = (struct hfi_cmd_work_data *)data;
 
-	rc = hfi_write_cmd(task_data->data);
+	rc = hfi_write_cmd(icp_hw_mgr.hfi_handle, task_data->data);
 
 	return rc;
 }
@@ -2008,7 +2020,7 @@ static int cam_icp_mgr_cleanup_ctx(struct cam_icp_hw_ctx_data *ctx_data)
 	struct cam_hw_done_event_data buf_data;
 
 	hfi_frame_process = &ctx_data->hfi_frame_process;
-	for (i = 0; i < CAM_FRAME_CMD_MAX; i++) {
+	for_each_set_bit(i, hfi_frame_process->bitmap, CAM_FRAME_CMD_MAX) {
 		if (!hfi_frame_process->request_id[i])
 			continue;
 		buf_data.request_id = hfi_frame_process->request_id[i];
@@ -2137,8 +2149,8 @@ static int cam_icp_mgr_dump_clk(struct cam_icp_hw_ctx_data *ctx_data)
 
 static int cam_icp_mgr_handle_frame_process(uint32_t *msg_ptr, int flag)
 {
-	int i, rc;
-	uint32_t idx;
+	int rc;
+	int32_t idx;
 	uint64_t request_id;
 	struct cam_icp_hw_ctx_data *ctx_data = NULL;
 	struct hfi_msg_ipebps_async_ack *ioconfig_ack = NULL;
@@ -2148,7 +2160,7 @@ static int cam_icp_mgr_handle_frame_process(uint32_t *msg_ptr, int flag)
 	uint32_t event_id;
 
 	ioconfig_ack = (struct hfi_msg_ipebps_async_ack *)msg_ptr;
-	request_id = ioconfig_ack->user_data2;
+	request_id = ioconfig_ack->user_data2 & ICP_FRAME_REQ_ID_MASK;
 	ctx_data = (struct cam_icp_hw_ctx_data *)
 		U64_TO_PTR(ioconfig_ack->user_data1);
 	if (!ctx_data) {
@@ -2175,17 +2187,14 @@ static int cam_icp_mgr_handle_frame_process(uint32_t *msg_ptr, int flag)
 	cam_icp_device_timer_reset(&icp_hw_mgr, clk_type);
 
 	hfi_frame_process = &ctx_data->hfi_frame_process;
-	for (i = 0; i < CAM_FRAME_CMD_MAX; i++)
-		if (hfi_frame_process->request_id[i] == request_id)
-			break;
-
-	if (i >= CAM_FRAME_CMD_MAX) {
+	idx = cam_icp_frame_idx_from_user_data(hfi_frame_process,
+		ioconfig_ack->user_data2);
+	if (idx < 0) {
 		CAM_ERR(CAM_ICP, "pkt not found in ctx data for req_id =%lld",
 			request_id);
 		mutex_unlock(&ctx_data->ctx_mutex);
 		return -EINVAL;
 	}
-	idx = i;
 
 	if (flag == ICP_FRAME_PROCESS_FAILURE) {
 		buf_data.evt_param = CAM_SYNC_ICP_EVENT_FRAME_PROCESS_FAILURE;
@@ -2209,6 +2218,9 @@ static int cam_icp_mgr_handle_frame_process(uint32_t *msg_ptr, int flag)
 		}
 	} else {
 		event_id = CAM_CTX_EVT_ID_SUCCESS;
+		cam_req_mgr_debug_lat_record(CAM_REQ_MGR_LAT_SUBMIT_TO_DONE,
+			ctx_data->ctx_id,
+			hfi_frame_process->submit_timestamp[idx]);
 	}
 
 	buf_data.request_id = hfi_frame_process->request_id[idx];
@@ -2579,7 +2591,8 @@ static void cam_icp_mgr_process_dbg_buf(unsigned int debug_lvl)
 	char *dbg_buf;
 	int rc = 0;
 
-	rc = hfi_read_message(icp_hw_mgr.dbg_buf, Q_DBG, &read_len);
+	rc = hfi_read_message(icp_hw_mgr.hfi_handle,
+		icp_hw_mgr.dbg_buf, Q_DBG, &read_len);
 	if (rc)
 		return;
 
@@ -2676,10 +2689,37 @@ static int cam_icp_process_msg_pkt_type(
 	return rc;
 }
 
+static int cam_icp_mgr_process_msg_buf(void *priv, uint32_t *msg_ptr,
+	uint32_t read_len)
+{
+	uint32_t msg_processed_len;
+	struct cam_icp_hw_mgr *hw_mgr = priv;
+
+	read_len = read_len << BYTE_WORD_SHIFT;
+	while (true) {
+		cam_icp_process_msg_pkt_type(hw_mgr, msg_ptr,
+			&msg_processed_len);
+
+		if (!msg_processed_len) {
+			CAM_ERR(CAM_ICP, "Failed to read");
+			return -EINVAL;
+		}
+
+		read_len -= msg_processed_len;
+		if (read_len > 0) {
+			msg_ptr += (msg_processed_len >>
+			BYTE_WORD_SHIFT);
+			msg_processed_len = 0;
+		} else {
+			break;
+		}
+	}
+
+	return 0;
+}
+
 static int32_t cam_icp_mgr_process_msg(void *priv, void *data)
 {
-	uint32_t read_len, msg_processed_len;
-	uint32_t *msg_ptr = NULL;
 	struct hfi_msg_work_data *task_data;
 	struct cam_icp_hw_mgr *hw_mgr;
 	int rc = 0;
@@ -2692,32 +2732,10 @@ static int32_t cam_icp_mgr_process_msg(void *priv, void *data)
 	task_data = data;
 	hw_mgr = priv;
 
-	rc = hfi_read_message(icp_hw_mgr.msg_buf, Q_MSG, &read_len);
-	if (rc) {
+	rc = hfi_drain_message(hw_mgr->hfi_handle, icp_hw_mgr.msg_buf,
+		Q_MSG, cam_icp_mgr_process_msg_buf, hw_mgr);
+	if (rc)
 		CAM_DBG(CAM_ICP, "Unable to read msg q rc %d", rc);
-	} else {
-		read_len = read_len << BYTE_WORD_SHIFT;
-		msg_ptr = (uint32_t *)icp_hw_mgr.msg_buf;
-		while (true) {
-			cam_icp_process_msg_pkt_type(hw_mgr, msg_ptr,
-				&msg_processed_len);
-
-			if (!msg_processed_len) {
-				CAM_ERR(CAM_ICP, "Failed to read");
-				rc = -EINVAL;
-				break;
-			}
-
-			read_len -= msg_processed_len;
-			if (read_len > 0) {
-				msg_ptr += (msg_processed_len >>
-				BYTE_WORD_SHIFT);
-				msg_processed_len = 0;
-			} else {
-				break;
-			}
-		}
-	}
 
 	cam_icp_mgr_process_dbg_buf(icp_hw_mgr.icp_dbg_lvl);
 
@@ -3510,7 +3528,7 @@ static int cam_icp_mgr_hfi_resume(struct cam_icp_hw_mgr *hw_mgr)
 		hfi_mem.io_mem2.iova,
 		hfi_mem.io_mem2.len);
 
-	return cam_hfi_resume(&hfi_mem);
+	return cam_hfi_resume(hw_mgr->hfi_handle, &hfi_mem);
 }
 
 static int cam_icp_retry_wait_for_abort(
@@ -3595,7 +3613,7 @@ static int cam_icp_mgr_abort_handle_wq(
 	memcpy(abort_cmd->payload.direct, &abort_data,
 		sizeof(abort_data));
 
-	rc = hfi_write_cmd(abort_cmd);
+	rc = hfi_write_cmd(icp_hw_mgr.hfi_handle, abort_cmd);
 	if (rc) {
 		kfree(abort_cmd);
 		return rc;
@@ -3641,7 +3659,7 @@ static int cam_icp_mgr_abort_handle(
 	abort_cmd->user_data1 = PTR_TO_U64(ctx_data);
 	abort_cmd->user_data2 = (uint64_t)0x0;
 
-	rc = hfi_write_cmd(abort_cmd);
+	rc = hfi_write_cmd(icp_hw_mgr.hfi_handle, abort_cmd);
 	if (rc) {
 		kfree(abort_cmd);
 		return rc;
@@ -3700,7 +3718,7 @@ static int cam_icp_mgr_destroy_handle(
 	memcpy(destroy_cmd->payload.direct, &ctx_data->temp_payload,
 		sizeof(uint64_t));
 
-	rc = hfi_write_cmd(destroy_cmd);
+	rc = hfi_write_cmd(icp_hw_mgr.hfi_handle, destroy_cmd);
 	if (rc) {
 		kfree(destroy_cmd);
 		return rc;
@@ -3791,7 +3809,7 @@ static unsigned long cam_icp_hw_mgr_mini_dump_cb(void *dst, unsigned long len)
 	md = (struct cam_icp_hw_mini_dump_info *)dst;
 	md->num_context = 0;
 	hw_mgr = &icp_hw_mgr;
-	cam_hfi_mini_dump(&md->hfi_info);
+	cam_hfi_mini_dump(hw_mgr->hfi_handle, &md->hfi_info);
 	memcpy(&md->hfi_mem_info, &hw_mgr->hfi_mem,
 		sizeof(struct icp_hfi_mem_info));
 	md->recovery = atomic_read(&hw_mgr->recovery);
@@ -3941,7 +3959,7 @@ static int cam_icp_mgr_hw_close(void *hw_priv, void *hw_close_args)
 
 	cam_icp_mgr_proc_shutdown(hw_mgr);
 
-	cam_hfi_deinit();
+	cam_hfi_deinit(hw_mgr->hfi_handle);
 	cam_icp_free_hfi_mem();
 
 	hw_mgr->icp_booted = false;
@@ -4081,7 +4099,8 @@ static int cam_icp_mgr_hfi_init(struct cam_icp_hw_mgr *hw_mgr)
 	else
 		hfi_ops = &hfi_a5_ops;
 
-	return cam_hfi_init(&hfi_mem, hfi_ops, icp_dev, 0);
+	return cam_hfi_init(hw_mgr->hfi_handle, &hfi_mem, hfi_ops,
+		icp_dev, 0);
 }
 
 static int cam_icp_mgr_send_fw_init(struct cam_icp_hw_mgr *hw_mgr)
@@ -4252,7 +4271,7 @@ static int cam_icp_mgr_hw_open(void *hw_mgr_priv, void *download_fw_args)
 	return rc;
 
 fw_init_failed:
-	cam_hfi_deinit();
+	cam_hfi_deinit(hw_mgr->hfi_handle);
 hfi_init_failed:
 	cam_icp_mgr_proc_shutdown(hw_mgr);
 boot_failed:
@@ -4445,7 +4464,7 @@ static int cam_icp_mgr_config_hw(void *hw_mgr_priv, void *config_hw_args)
 
 	frame_info = (struct icp_frame_info *)config_args->priv;
 	req_id = frame_info->request_id;
-	idx = cam_icp_clk_idx_from_req_id(ctx_data, req_id);
+	idx = frame_info->frame_idx;
 
 	if (cam_presil_mode_enabled()) {
 		CAM_INFO(CAM_ICP, "Sending relevant buffers for request: %llu to presil",
@@ -4498,6 +4517,7 @@ static int cam_icp_mgr_prepare_frame_process_cmd(
 	struct cam_icp_hw_ctx_data *ctx_data,
 	struct hfi_cmd_ipebps_async *hfi_cmd,
 	uint64_t request_id,
+	int32_t idx,
 	uint32_t fw_cmd_buf_iova_addr)
 {
 	hfi_cmd->size = sizeof(struct hfi_cmd_ipebps_async);
@@ -4510,10 +4530,10 @@ static int cam_icp_mgr_prepare_frame_process_cmd(
 	hfi_cmd->fw_handles[0] = ctx_data->fw_handle;
 	hfi_cmd->payload.indirect = fw_cmd_buf_iova_addr;
 	hfi_cmd->user_data1 = PTR_TO_U64(ctx_data);
-	hfi_cmd->user_data2 = request_id;
+	hfi_cmd->user_data2 = cam_icp_frame_user_data(request_id, idx);
 
-	CAM_DBG(CAM_ICP, "ctx_data : %pK, request_id :%lld cmd_buf %x",
-		(void *)ctx_data->context_priv, request_id,
+	CAM_DBG(CAM_ICP, "ctx_data : %pK, request_id :%lld idx %d cmd_buf %x",
+		(void *)ctx_data->context_priv, request_id, idx,
 		fw_cmd_buf_iova_addr);
 
 	return 0;
@@ -4834,7 +4854,7 @@ static int cam_icp_process_stream_settings(
 		map_cmd_size);
 
 	reinit_completion(&ctx_data->wait_complete);
-	rc = hfi_write_cmd(async_direct);
+	rc = hfi_write_cmd(icp_hw_mgr.hfi_handle, async_direct);
 	if (rc) {
 		CAM_ERR(CAM_ICP, "hfi write failed  rc %d", rc);
 		goto end;
@@ -5137,7 +5157,8 @@ static int cam_icp_mgr_update_hfi_frame_process(
 	ctx_data->hfi_frame_process.frame_info[index].request_id =
 		packet->header.request_id;
 	ctx_data->hfi_frame_process.frame_info[index].io_config = 0;
-        ctx_data->hfi_frame_process.frame_info[index].pkt = packet;
+	ctx_data->hfi_frame_process.frame_info[index].pkt = packet;
+	ctx_data->hfi_frame_process.frame_info[index].frame_idx = index;
 	rc = cam_icp_process_generic_cmd_buffer(packet, ctx_data, index,
 		&ctx_data->hfi_frame_process.frame_info[index].io_config);
 	if (rc) {
@@ -5354,7 +5375,7 @@ static int cam_icp_mgr_prepare_hw_update(void *hw_mgr_priv,
 	hfi_cmd = (struct hfi_cmd_ipebps_async *)
 			&ctx_data->hfi_frame_process.hfi_frame_cmd[idx];
 	cam_icp_mgr_prepare_frame_process_cmd(
-		ctx_data, hfi_cmd, packet->header.request_id,
+		ctx_data, hfi_cmd, packet->header.request_id, idx,
 		fw_cmd_buf_iova_addr);
 
 	prepare_args->num_hw_update_entries = 1;
@@ -5374,7 +5395,7 @@ static int cam_icp_mgr_send_abort_status(struct cam_icp_hw_ctx_data *ctx_data)
 
 	mutex_lock(&ctx_data->ctx_mutex);
 	hfi_frame_process = &ctx_data->hfi_frame_process;
-	for (idx = 0; idx < CAM_FRAME_CMD_MAX; idx++) {
+	for_each_set_bit(idx, hfi_frame_process->bitmap, CAM_FRAME_CMD_MAX) {
 		if (!hfi_frame_process->request_id[idx])
 			continue;
 
@@ -5461,7 +5482,7 @@ static int cam_icp_mgr_flush_all(struct cam_icp_hw_ctx_data *ctx_data,
 	bool clear_in_resource = false;
 
 	hfi_frame_process = &ctx_data->hfi_frame_process;
-	for (idx = 0; idx < CAM_FRAME_CMD_MAX; idx++) {
+	for_each_set_bit(idx, hfi_frame_process->bitmap, CAM_FRAME_CMD_MAX) {
 		if (!hfi_frame_process->request_id[idx])
 			continue;
 
@@ -5492,7 +5513,7 @@ static int cam_icp_mgr_flush_req(struct cam_icp_hw_ctx_data *ctx_data,
 
 	hfi_frame_process = &ctx_data->hfi_frame_process;
 	request_id = *(int64_t *)flush_args->flush_req_pending[0];
-	for (idx = 0; idx < CAM_FRAME_CMD_MAX; idx++) {
+	for_each_set_bit(idx, hfi_frame_process->bitmap, CAM_FRAME_CMD_MAX) {
 		if (!hfi_frame_process->request_id[idx])
 			continue;
 
@@ -6079,10 +6100,12 @@ static int cam_icp_mgr_acquire_hw(void *hw_mgr_priv, void *acquire_hw_args)
 			goto get_io_buf_failed;
 
 		if (icp_hw_mgr.icp_debug_type)
-			hfi_set_debug_level(icp_hw_mgr.icp_debug_type,
+			hfi_set_debug_level(icp_hw_mgr.hfi_handle,
+				icp_hw_mgr.icp_debug_type,
 				icp_hw_mgr.icp_dbg_lvl);
 
-		hfi_set_fw_dump_level(icp_hw_mgr.icp_fw_dump_lvl);
+		hfi_set_fw_dump_level(icp_hw_mgr.hfi_handle,
+			icp_hw_mgr.icp_fw_dump_lvl);
 
 		rc = cam_icp_send_ubwc_cfg(hw_mgr);
 		if (rc)
@@ -6438,6 +6461,30 @@ free_devices:
 	return rc;
 }
 
+static int cam_icp_mgr_register_hfi(void)
+{
+	struct cam_hw_intf *icp_dev_intf = icp_hw_mgr.icp_dev_intf;
+	int rc;
+
+	icp_hw_mgr.hfi_handle = HFI_HANDLE_INIT;
+	rc = cam_hfi_register(&icp_hw_mgr.hfi_handle, "icp");
+	if (rc) {
+		CAM_ERR(CAM_ICP, "Failed to register hfi instance rc=%d", rc);
+		return rc;
+	}
+
+	rc = icp_dev_intf->hw_ops.process_cmd(icp_dev_intf->hw_priv,
+		CAM_ICP_CMD_SET_HFI_HANDLE, &icp_hw_mgr.hfi_handle,
+		sizeof(icp_hw_mgr.hfi_handle));
+	if (rc) {
+		CAM_ERR(CAM_ICP, "Failed to set hfi handle %d rc=%d",
+			icp_hw_mgr.hfi_handle, rc);
+		cam_hfi_unregister(&icp_hw_mgr.hfi_handle);
+	}
+
+	return rc;
+}
+
 static void cam_req_mgr_process_workq_icp_command_queue(struct work_struct *w)
 {
 	cam_req_mgr_process_workq(w);
@@ -6669,6 +6716,10 @@ int cam_icp_hw_mgr_init(struct device_node *of_node, uint64_t *hw_mgr_hdl,
 		goto icp_wq_create_failed;
 	}
 
+	rc = cam_icp_mgr_register_hfi();
+	if (rc)
+		goto hfi_register_failed;
+
 	if (iommu_hdl)
 		*iommu_hdl = icp_hw_mgr.iommu_hdl;
 
@@ -6677,6 +6728,8 @@ int cam_icp_hw_mgr_init(struct device_node *of_node, uint64_t *hw_mgr_hdl,
 		cam_icp_hw_mgr_mini_dump_cb, "cam_icp");
 	return rc;
 
+hfi_register_failed:
+	cam_icp_mgr_destroy_wq();
 icp_wq_create_failed:
 	cam_smmu_destroy_handle(icp_hw_mgr.iommu_sec_hdl);
 	icp_hw_mgr.iommu_sec_hdl = -1;
@@ -6700,6 +6753,7 @@ void cam_icp_hw_mgr_deinit(void)
 	debugfs_remove_recursive(icp_hw_mgr.dentry);
 	icp_hw_mgr.dentry = NULL;
 	cam_icp_mgr_destroy_wq();
+	cam_hfi_unregister(&icp_hw_mgr.hfi_handle);
 	cam_icp_mgr_free_devs();
 	mutex_destroy(&icp_hw_mgr.hw_mgr_mutex);
 	for (i = 0; i < CAM_ICP_CTX_MAX; i++)
@@ -27,6 +27,13 @@
 
 #define CAM_FRAME_CMD_MAX       40
 
+/*
+ * Frame process commands carry (frame slot + 1) in the upper byte of the
+ * firmware opaque user_data2, the request id lives in the lower bits
+ */
+#define ICP_FRAME_SLOT_SHIFT    56
+#define ICP_FRAME_REQ_ID_MASK   ((1ULL << ICP_FRAME_SLOT_SHIFT) - 1)
+
 #define CAM_MAX_OUT_RES         14
 #define CAM_MAX_IN_RES          16
 
@@ -147,12 +154,14 @@ struct clk_work_data {
  * @io_config: the address of io config
  * @hfi_cfg_io_cmd: command struct to be sent to hfi
  * @pkt: pointer to the packet header of current request
+ * @frame_idx: frame process slot owned by this request
  */
 struct icp_frame_info {
 	uint64_t request_id;
 	dma_addr_t io_config;
 	struct hfi_cmd_ipebps_async hfi_cfg_io_cmd;
 	struct cam_packet *pkt;
+	int32_t frame_idx;
 };
 
 /**
@@ -375,6 +384,7 @@ struct cam_icp_clk_info {
  * @recovery: Flag to validate if in previous session FW
  *            reported a fatal error or wdt. If set FW is
  *            re-downloaded for new camera session.
+ * @hfi_handle: Handle of the HFI instance driven by this hw manager
  */
 struct cam_icp_hw_mgr {
 	struct mutex hw_mgr_mutex;
@@ -425,6 +435,7 @@ struct cam_icp_hw_mgr {
 	bool bps_clk_state;
 	bool disable_ubwc_comp;
 	atomic_t recovery;
+	int32_t hfi_handle;
 };
 
 /**
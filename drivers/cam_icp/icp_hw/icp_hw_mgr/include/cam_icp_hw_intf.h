@@ -45,6 +45,7 @@ enum cam_icp_cmd_type {
 	CAM_ICP_CMD_HW_DUMP,
 	CAM_ICP_CMD_HW_MINI_DUMP,
 	CAM_ICP_CMD_HW_REG_DUMP,
+	CAM_ICP_CMD_SET_HFI_HANDLE,
 	CAM_ICP_CMD_MAX,
 };
 
@@ -55,7 +55,8 @@ static int cam_lx7_ubwc_configure(struct cam_hw_soc_info *soc_info)
 	bps_ubwc_cfg[0] = soc_priv->ubwc_cfg.bps_fetch[i];
 	bps_ubwc_cfg[1] = soc_priv->ubwc_cfg.bps_write[i];
 
-	rc = hfi_cmd_ubwc_config_ext(ipe_ubwc_cfg, bps_ubwc_cfg);
+	rc = hfi_cmd_ubwc_config_ext(soc_priv->hfi_handle, ipe_ubwc_cfg,
+		bps_ubwc_cfg);
 	if (rc)	{
 		CAM_ERR(CAM_ICP, "failed to write UBWC config rc=%d", rc);
 		return rc;
@@ -824,6 +825,7 @@ int cam_lx7_process_cmd(void *priv, uint32_t cmd_type,
 			void *args, uint32_t arg_size)
 {
 	struct cam_hw_info *lx7_info = priv;
+	struct lx7_soc_info *soc_priv;
 	int rc = -EINVAL;
 
 	if (!lx7_info) {
@@ -831,6 +833,8 @@ int cam_lx7_process_cmd(void *priv, uint32_t cmd_type,
 		return -EINVAL;
 	}
 
+	soc_priv = lx7_info->soc_info.soc_private;
+
 	switch (cmd_type) {
 	case CAM_ICP_CMD_PROC_SHUTDOWN:
 		rc = cam_lx7_shutdown(lx7_info);
@@ -857,11 +861,22 @@ int cam_lx7_process_cmd(void *priv, uint32_t cmd_type,
 		rc = cam_lx7_ubwc_configure(&lx7_info->soc_info);
 		break;
 	case CAM_ICP_SEND_INIT:
-		hfi_send_system_cmd(HFI_CMD_SYS_INIT, 0, 0);
+		hfi_send_system_cmd(soc_priv->hfi_handle,
+			HFI_CMD_SYS_INIT, 0, 0);
 		rc = 0;
 		break;
 	case CAM_ICP_CMD_PC_PREP:
-		hfi_send_system_cmd(HFI_CMD_SYS_PC_PREP, 0, 0);
+		hfi_send_system_cmd(soc_priv->hfi_handle,
+			HFI_CMD_SYS_PC_PREP, 0, 0);
+		rc = 0;
+		break;
+	case CAM_ICP_CMD_SET_HFI_HANDLE:
+		if (!args || (arg_size != sizeof(int32_t))) {
+			CAM_ERR(CAM_ICP, "Invalid args");
+			break;
+		}
+
+		soc_priv->hfi_handle = *((int32_t *)args);
 		rc = 0;
 		break;
 	case CAM_ICP_CMD_CLK_UPDATE: {
@@ -12,6 +12,7 @@
 #include "cam_hw.h"
 #include "cam_hw_intf.h"
 #include "cam_icp_hw_intf.h"
+#include "hfi_intf.h"
 #include "lx7_core.h"
 #include "lx7_soc.h"
 
@@ -52,6 +53,7 @@ static int cam_lx7_component_bind(struct device *dev,
 	lx7_info->soc_info.dev = &pdev->dev;
 	lx7_info->soc_info.dev_name = pdev->name;
 	lx7_info->soc_info.soc_private = lx7_soc_info;
+	lx7_soc_info->hfi_handle = HFI_HANDLE_INIT;
 
 	mutex_init(&lx7_info->hw_mutex);
 	spin_lock_init(&lx7_info->hw_lock);
@@ -143,10 +143,11 @@ int cam_lx7_soc_resources_enable(struct cam_hw_soc_info *soc_info)
 	if (rc)
 		CAM_ERR(CAM_ICP, "failed to enable soc resources rc=%d", rc);
 	else {
+		struct lx7_soc_info *lx7_soc_info = soc_info->soc_private;
 		int32_t clk_rate = 0;
 
 		clk_rate = clk_get_rate(soc_info->clk[soc_info->src_clk_idx]);
-		hfi_send_freq_info(clk_rate);
+		hfi_send_freq_info(lx7_soc_info->hfi_handle, clk_rate);
 	}
 
 	return rc;
@@ -154,13 +155,14 @@ int cam_lx7_soc_resources_enable(struct cam_hw_soc_info *soc_info)
 
 int cam_lx7_soc_resources_disable(struct cam_hw_soc_info *soc_info)
 {
+	struct lx7_soc_info *lx7_soc_info = soc_info->soc_private;
 	int rc = 0;
 
 	rc = cam_soc_util_disable_platform_resource(soc_info, true, true);
 	if (rc)
 		CAM_ERR(CAM_ICP, "failed to disable soc resources rc=%d", rc);
 	else
-		hfi_send_freq_info(0);
+		hfi_send_freq_info(lx7_soc_info->hfi_handle, 0);
 
 	return rc;
 }
@@ -168,6 +170,7 @@ int cam_lx7_soc_resources_disable(struct cam_hw_soc_info *soc_info)
 int cam_lx7_update_clk_rate(struct cam_hw_soc_info *soc_info,
 	int32_t clk_level)
 {
+	struct lx7_soc_info *lx7_soc_info;
 	int32_t src_clk_idx = 0;
 	int32_t clk_rate = 0;
 	int rc = 0;
@@ -211,6 +214,7 @@ int cam_lx7_update_clk_rate(struct cam_hw_soc_info *soc_info,
 	if (rc)
 		return rc;
 
-	hfi_send_freq_info(clk_rate);
+	lx7_soc_info = soc_info->soc_private;
+	hfi_send_freq_info(lx7_soc_info->hfi_handle, clk_rate);
 	return 0;
 }
@@ -14,6 +14,7 @@
 
 struct lx7_soc_info {
 	uint32_t icp_qos_val;
+	int32_t hfi_handle;
 	struct {
 		uint32_t ipe_fetch[UBWC_CONFIG_MAX];
 		uint32_t ipe_write[UBWC_CONFIG_MAX];
@@ -57,6 +57,9 @@ static int __cam_isp_ctx_check_deferred_buf_done(
 	struct cam_isp_hw_done_event_data *done,
 	uint32_t bubble_state);
 
+static int __cam_isp_ctx_schedule_apply_req_offline(
+	struct cam_isp_context *ctx_isp);
+
 static const char *__cam_isp_evt_val_to_type(
 	uint32_t evt_id)
 {
@@ -112,6 +115,12 @@ static void __cam_isp_ctx_update_event_record(
 		req_isp = (struct cam_isp_ctx_req *) req->req_priv;
 		ctx_isp->event_record[event][iterator].req_id =
 			req->request_id;
+		if (event == CAM_ISP_CTX_EVENT_RUP && req_isp->lat_apply_ts) {
+			cam_req_mgr_debug_lat_record(
+				CAM_REQ_MGR_LAT_APPLY_TO_RUP,
+				ctx_isp->base->ctx_id, req_isp->lat_apply_ts);
+			req_isp->lat_apply_ts = 0;
+		}
 		req_isp->event_timestamp[event] = cur_time;
 	} else {
 		ctx_isp->event_record[event][iterator].req_id = 0;
@@ -824,6 +833,27 @@ end:
 	return rc;
 }
 
+/*
+ * The first SOF handled after a request was applied starts the frame the
+ * request is captured in, stamp it for the SOF to buf done histogram.
+ */
+static void __cam_isp_ctx_stamp_req_sof(struct cam_isp_context *ctx_isp,
+	struct list_head *req_list)
+{
+	struct cam_ctx_request *req;
+	struct cam_isp_ctx_req *req_isp;
+	ktime_t now = 0;
+
+	list_for_each_entry(req, req_list, list) {
+		req_isp = (struct cam_isp_ctx_req *) req->req_priv;
+		if (req_isp->lat_sof_ts)
+			continue;
+		if (!now)
+			now = ktime_get();
+		req_isp->lat_sof_ts = now;
+	}
+}
+
 static inline void __cam_isp_ctx_update_sof_ts_util(
 	struct cam_isp_hw_sof_event_data *sof_event_data,
 	struct cam_isp_context *ctx_isp)
@@ -835,6 +865,8 @@ static inline void __cam_isp_ctx_update_sof_ts_util(
 	ctx_isp->frame_id++;
 	ctx_isp->sof_timestamp_val = sof_event_data->timestamp;
 	ctx_isp->boot_timestamp = sof_event_data->boot_time;
+	__cam_isp_ctx_stamp_req_sof(ctx_isp, &ctx_isp->base->wait_req_list);
+	__cam_isp_ctx_stamp_req_sof(ctx_isp, &ctx_isp->base->active_req_list);
 }
 
 static int cam_isp_ctx_dump_req(
@@ -1582,6 +1614,9 @@ static int __cam_isp_ctx_handle_buf_done_for_req_list(
 		}
 		list_del_init(&req->list);
 		list_add_tail(&req->list, &ctx->free_req_list);
+		cam_req_mgr_debug_lat_record(CAM_REQ_MGR_LAT_SOF_TO_BUF_DONE,
+			ctx->ctx_id, req_isp->lat_sof_ts);
+		req_isp->lat_sof_ts = 0;
 		req_isp->reapply_type = CAM_CONFIG_REAPPLY_NONE;
 		req_isp->cdm_reset_before_apply = false;
 		req_isp->num_acked = 0;
@@ -1602,6 +1637,16 @@ static int __cam_isp_ctx_handle_buf_done_for_req_list(
 			buf_done_req_id, ctx_isp->active_req_cnt, ctx->ctx_id);
 		ctx_isp->req_info.last_bufdone_req_id = req->request_id;
 		ctx_isp->last_bufdone_err_apply_req_id = 0;
+
+		/*
+		 * An offline apply skipped at epoch for lack of in-flight
+		 * slots would otherwise wait for the next submit, kick it
+		 * now that this request retired.
+		 */
+		if (ctx_isp->offline_context &&
+			atomic_read(&ctx_isp->rxd_epoch) &&
+			!list_empty(&ctx->pending_req_list))
+			__cam_isp_ctx_schedule_apply_req_offline(ctx_isp);
 	}
 
 	if (atomic_read(&ctx_isp->internal_recovery_set) && !ctx_isp->active_req_cnt)
@@ -2459,6 +2504,7 @@ static int __cam_isp_ctx_apply_req_offline(
 {
 	int rc = 0;
 	int64_t prev_applied_req;
+	uint32_t inflight_max;
 	struct cam_context *ctx = NULL;
 	struct cam_isp_context *ctx_isp = priv;
 	struct cam_ctx_request *req;
@@ -2483,8 +2529,14 @@ static int __cam_isp_ctx_apply_req_offline(
 		(ctx_isp->substate_activated == CAM_ISP_CTX_ACTIVATED_APPLIED))
 		goto end;
 
-	if (ctx_isp->active_req_cnt >= 2)
+	inflight_max = isp_ctx_debug.offline_inflight_max ?
+		min_t(uint32_t, isp_ctx_debug.offline_inflight_max,
+		CAM_ISP_CTX_REQ_MAX) : CAM_ISP_CTX_OFFLINE_INFLIGHT_DEF;
+	if (ctx_isp->active_req_cnt >= inflight_max) {
+		CAM_DBG(CAM_ISP, "ctx %u %d requests in flight, max %u",
+			ctx->ctx_id, ctx_isp->active_req_cnt, inflight_max);
 		goto end;
+	}
 
 	spin_lock_bh(&ctx->lock);
 	req = list_first_entry(&ctx->pending_req_list, struct cam_ctx_request,
@@ -4139,6 +4191,37 @@ static struct cam_isp_ctx_irq_ops
 	},
 };
 
+/*
+ * Expose the BW/clock needs of the requests queued behind @req so the hw
+ * mgr can vote for them ahead of time. The pointers are only valid for the
+ * duration of the hw_config call, which runs under ctx_mutex.
+ */
+static void __cam_isp_ctx_fill_bw_clk_lookahead(
+	struct cam_context *ctx, struct cam_ctx_request *req)
+{
+	struct cam_ctx_request                *next_req = req;
+	struct cam_isp_ctx_req                *req_isp;
+	struct cam_isp_ctx_req                *next_req_isp;
+	struct cam_isp_prepare_hw_update_data *hw_update_data;
+
+	req_isp = (struct cam_isp_ctx_req *) req->req_priv;
+	hw_update_data = &req_isp->hw_update_data;
+	hw_update_data->num_upcoming_bw_clk = 0;
+
+	spin_lock_bh(&ctx->lock);
+	list_for_each_entry_continue(next_req, &ctx->pending_req_list, list) {
+		if (hw_update_data->num_upcoming_bw_clk >=
+			CAM_ISP_BW_CLK_LOOKAHEAD_MAX)
+			break;
+
+		next_req_isp = (struct cam_isp_ctx_req *) next_req->req_priv;
+		hw_update_data->upcoming_bw_clk[
+			hw_update_data->num_upcoming_bw_clk++] =
+			&next_req_isp->hw_update_data.bw_clk_config;
+	}
+	spin_unlock_bh(&ctx->lock);
+}
+
 static int __cam_isp_ctx_apply_req_in_activated_state(
 	struct cam_context *ctx, struct cam_req_mgr_apply_request *apply,
 	enum cam_isp_ctx_activated_substate next_state)
@@ -4249,6 +4332,8 @@ static int __cam_isp_ctx_apply_req_in_activated_state(
 	cfg.reapply_type = req_isp->reapply_type;
 	cfg.cdm_reset_before_apply = req_isp->cdm_reset_before_apply;
 
+	__cam_isp_ctx_fill_bw_clk_lookahead(ctx, req);
+
 	atomic_set(&ctx_isp->apply_in_progress, 1);
 
 	rc = ctx->hw_mgr_intf->hw_config(ctx->hw_mgr_intf->hw_mgr_priv, &cfg);
@@ -4256,6 +4341,8 @@ static int __cam_isp_ctx_apply_req_in_activated_state(
 		spin_lock_bh(&ctx->lock);
 		ctx_isp->substate_activated = next_state;
 		ctx_isp->last_applied_req_id = apply->request_id;
+		req_isp->lat_apply_ts = ktime_get();
+		req_isp->lat_sof_ts = 0;
 		list_del_init(&req->list);
 		list_add_tail(&req->list, &ctx->wait_req_list);
 		CAM_DBG(CAM_ISP, "new substate Substate[%s], applied req %lld",
@@ -5902,6 +5989,8 @@ static int __cam_isp_ctx_config_dev_in_top_state(
 	req_isp->num_deferred_acks = 0;
 	req_isp->bubble_detected = false;
 	req_isp->cdm_reset_before_apply = false;
+	req_isp->lat_apply_ts = 0;
+	req_isp->lat_sof_ts = 0;
 	req_isp->hw_update_data.packet = packet;
 
 	for (i = 0; i < req_isp->num_fence_map_out; i++) {
@@ -7814,6 +7903,8 @@ static int cam_isp_context_debug_register(void)
 		isp_ctx_debug.dentry, &isp_ctx_debug.enable_cdm_cmd_buff_dump);
 	debugfs_create_bool("disable_internal_recovery", 0644,
 		isp_ctx_debug.dentry, &isp_ctx_debug.disable_internal_recovery);
+	debugfs_create_u32("offline_inflight_max", 0644,
+		isp_ctx_debug.dentry, &isp_ctx_debug.offline_inflight_max);
 
 	if (IS_ERR(dbgfileptr)) {
 		if (PTR_ERR(dbgfileptr) == -ENODEV)
@@ -30,6 +30,9 @@
 /* max requests per ctx for isp */
 #define CAM_ISP_CTX_REQ_MAX                     8
 
+/* Default max requests fetched or awaiting buf done on an offline ctx */
+#define CAM_ISP_CTX_OFFLINE_INFLIGHT_DEF        2
+
 /*
  * Maximum entries in state monitoring array for error logging
  */
@@ -123,6 +126,8 @@ enum cam_isp_state_change_trigger {
  * @enable_state_monitor_dump:  Enable isp state monitor dump
  * @enable_cdm_cmd_buff_dump:   Enable CDM Command buffer dump
  * @disable_internal_recovery:  Disable internal kernel recovery
+ * @offline_inflight_max:       Max requests in flight on an offline ctx,
+ *                              0 selects CAM_ISP_CTX_OFFLINE_INFLIGHT_DEF
  *
  */
 struct cam_isp_ctx_debug {
@@ -130,6 +135,7 @@ struct cam_isp_ctx_debug {
 	uint32_t        enable_state_monitor_dump;
 	uint8_t         enable_cdm_cmd_buff_dump;
 	bool            disable_internal_recovery;
+	uint32_t        offline_inflight_max;
 };
 
 /**
@@ -169,6 +175,10 @@ struct cam_isp_ctx_irq_ops {
  * @event_timestamp:           Timestamp for different stage of request
  * @cdm_reset_before_apply:    For bubble re-apply when buf done not coming set
  *                             to True
+ * @lat_apply_ts:              Apply time not yet accounted to the apply to
+ *                             reg update latency histogram, 0 once used
+ * @lat_sof_ts:                Time of the first SOF after this request was
+ *                             applied, 0 until that SOF is handled
  *
  */
 struct cam_isp_ctx_req {
@@ -189,6 +199,8 @@ struct cam_isp_ctx_req {
 		[CAM_ISP_CTX_EVENT_MAX];
 	bool                                  bubble_detected;
 	bool                                  cdm_reset_before_apply;
+	ktime_t                               lat_apply_ts;
+	ktime_t                               lat_sof_ts;
 };
 
 /**
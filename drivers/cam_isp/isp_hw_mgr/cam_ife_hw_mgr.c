@@ -29,6 +29,8 @@
 #include "cam_mem_mgr_api.h"
 #include "cam_common_util.h"
 #include "cam_presil_hw_access.h"
+#include "cam_io_util.h"
+#include "cam_trace.h"
 
 #define CAM_IFE_SAFE_DISABLE 0
 #define CAM_IFE_SAFE_ENABLE 1
@@ -741,7 +743,8 @@ err:
 }
 
 static int cam_ife_hw_mgr_init_hw_res(
-	struct cam_isp_hw_mgr_res   *isp_hw_res)
+	struct cam_isp_hw_mgr_res   *isp_hw_res,
+	struct cam_hw_intf          *only_hw_intf)
 {
 	int i;
 	int rc = -1;
@@ -751,6 +754,8 @@ static int cam_ife_hw_mgr_init_hw_res(
 		if (!isp_hw_res->hw_res[i])
 			continue;
 		hw_intf = isp_hw_res->hw_res[i]->hw_intf;
+		if (only_hw_intf && (hw_intf != only_hw_intf))
+			continue;
 		CAM_DBG(CAM_ISP, "enabled vfe hardware %d",
 			hw_intf->hw_idx);
 		if (hw_intf->hw_ops.init) {
@@ -968,22 +973,40 @@ static void cam_ife_hw_mgr_deinit_hw(
 	ctx->flags.init_done = false;
 }
 
-static int cam_ife_hw_mgr_init_hw(
-	struct cam_ife_hw_mgr_ctx *ctx)
+/**
+ * struct cam_ife_hw_mgr_init_job - Per device hw init job
+ *
+ * @work:      Work item, only used for jobs run off the caller thread
+ * @ctx:       Context whose resources are initialized
+ * @hw_intf:   Device whose resources this job initializes
+ * @init_func: Stage init function, called with @hw_intf as filter
+ * @rc:        Result of the stage init on this device
+ */
+struct cam_ife_hw_mgr_init_job {
+	struct work_struct          work;
+	struct cam_ife_hw_mgr_ctx  *ctx;
+	struct cam_hw_intf         *hw_intf;
+	int (*init_func)(struct cam_ife_hw_mgr_ctx *ctx,
+		struct cam_hw_intf *hw_intf);
+	int                         rc;
+};
+
+static int cam_ife_hw_mgr_init_ife_sfe_res(
+	struct cam_ife_hw_mgr_ctx *ctx,
+	struct cam_hw_intf        *hw_intf)
 {
 	struct cam_isp_hw_mgr_res *hw_mgr_res;
-	struct cam_ife_hw_mgr          *hw_mgr;
 	int rc = 0, i;
 
 	/* INIT IFE SRC */
 	CAM_DBG(CAM_ISP, "INIT IFE SRC in ctx id:%d",
 		ctx->ctx_index);
 	list_for_each_entry(hw_mgr_res, &ctx->res_list_ife_src, list) {
-		rc = cam_ife_hw_mgr_init_hw_res(hw_mgr_res);
+		rc = cam_ife_hw_mgr_init_hw_res(hw_mgr_res, hw_intf);
 		if (rc) {
 			CAM_ERR(CAM_ISP, "Can not INIT IFE SRC (%d)",
 				 hw_mgr_res->res_id);
-			goto deinit;
+			return rc;
 		}
 	}
 
@@ -992,12 +1015,12 @@ static int cam_ife_hw_mgr_init_hw(
 		CAM_DBG(CAM_ISP, "INIT SFE Resource in ctx id:%d",
 			ctx->ctx_index);
 		list_for_each_entry(hw_mgr_res, &ctx->res_list_sfe_src, list) {
-			rc = cam_ife_hw_mgr_init_hw_res(hw_mgr_res);
+			rc = cam_ife_hw_mgr_init_hw_res(hw_mgr_res, hw_intf);
 			if (rc) {
 				CAM_ERR(CAM_ISP,
 					"Can not INIT SFE SRC res (%d)",
 					hw_mgr_res->res_id);
-				goto deinit;
+				return rc;
 			}
 		}
 
@@ -1005,23 +1028,20 @@ static int cam_ife_hw_mgr_init_hw(
 			ctx->ctx_index);
 		for (i = 0; i < CAM_SFE_HW_OUT_RES_MAX; i++) {
 			rc = cam_ife_hw_mgr_init_hw_res(
-				&ctx->res_list_sfe_out[i]);
+				&ctx->res_list_sfe_out[i], hw_intf);
 			if (rc) {
 				CAM_ERR(CAM_ISP, "Can not INIT SFE OUT (%d)",
 					ctx->res_list_sfe_out[i].res_id);
-				goto deinit;
+				return rc;
 			}
 		}
 	}
 
-	CAM_DBG(CAM_ISP, "INIT IFE csid ... in ctx id:%d",
-	ctx->ctx_index);
-
 	/* INIT IFE BUS RD */
 	CAM_DBG(CAM_ISP, "INIT IFE BUS RD in ctx id:%d",
 		ctx->ctx_index);
 	list_for_each_entry(hw_mgr_res, &ctx->res_list_ife_in_rd, list) {
-		rc = cam_ife_hw_mgr_init_hw_res(hw_mgr_res);
+		rc = cam_ife_hw_mgr_init_hw_res(hw_mgr_res, hw_intf);
 		if (rc) {
 			CAM_ERR(CAM_ISP, "Can not IFE BUS RD (%d)",
 				 hw_mgr_res->res_id);
@@ -1034,24 +1054,204 @@ static int cam_ife_hw_mgr_init_hw(
 		ctx->ctx_index);
 
 	for (i = 0; i < max_ife_out_res; i++) {
-		rc = cam_ife_hw_mgr_init_hw_res(&ctx->res_list_ife_out[i]);
+		rc = cam_ife_hw_mgr_init_hw_res(&ctx->res_list_ife_out[i],
+			hw_intf);
 		if (rc) {
 			CAM_ERR(CAM_ISP, "Can not INIT IFE OUT (%d)",
 				 ctx->res_list_ife_out[i].res_id);
-			goto deinit;
+			return rc;
 		}
 	}
 
+	return 0;
+}
+
+static int cam_ife_hw_mgr_init_csid_res(
+	struct cam_ife_hw_mgr_ctx *ctx,
+	struct cam_hw_intf        *hw_intf)
+{
+	struct cam_isp_hw_mgr_res *hw_mgr_res;
+	int rc = 0;
+
 	/* INIT IFE csid */
+	CAM_DBG(CAM_ISP, "INIT IFE csid ... in ctx id:%d",
+		ctx->ctx_index);
 	list_for_each_entry(hw_mgr_res, &ctx->res_list_ife_csid, list) {
-		rc = cam_ife_hw_mgr_init_hw_res(hw_mgr_res);
+		rc = cam_ife_hw_mgr_init_hw_res(hw_mgr_res, hw_intf);
 		if (rc) {
 			CAM_ERR(CAM_ISP, "Can not INIT IFE CSID(id :%d)",
 				 hw_mgr_res->res_id);
-			goto deinit;
+			return rc;
 		}
 	}
 
+	return 0;
+}
+
+static int cam_ife_hw_mgr_add_init_job(
+	struct cam_ife_hw_mgr_init_job *jobs,
+	int                             num_jobs,
+	struct cam_isp_hw_mgr_res      *hw_mgr_res)
+{
+	struct cam_hw_intf *hw_intf;
+	int i, j;
+
+	for (i = 0; i < CAM_ISP_HW_SPLIT_MAX; i++) {
+		if (!hw_mgr_res->hw_res[i])
+			continue;
+
+		hw_intf = hw_mgr_res->hw_res[i]->hw_intf;
+		for (j = 0; j < num_jobs; j++)
+			if (jobs[j].hw_intf == hw_intf)
+				break;
+
+		if (j < num_jobs)
+			continue;
+
+		if (num_jobs >= CAM_IFE_HW_INIT_JOBS_MAX) {
+			CAM_ERR(CAM_ISP, "Too many devices for parallel init");
+			return -EINVAL;
+		}
+
+		jobs[num_jobs++].hw_intf = hw_intf;
+	}
+
+	return num_jobs;
+}
+
+static void cam_ife_hw_mgr_init_job_work(struct work_struct *work)
+{
+	struct cam_ife_hw_mgr_init_job *job =
+		container_of(work, struct cam_ife_hw_mgr_init_job, work);
+
+	job->rc = job->init_func(job->ctx, job->hw_intf);
+}
+
+/*
+ * Run one init stage on every device of the context at once. Resources
+ * of one device are still initialized in list order by a single job, so
+ * per device hw init and refcounting stays serialized; only the power
+ * up (regulator settle, clock rate set, reset) of distinct devices
+ * overlaps. The first job runs on the caller thread.
+ */
+static int cam_ife_hw_mgr_init_stage_parallel(
+	struct cam_ife_hw_mgr_ctx *ctx,
+	int (*init_func)(struct cam_ife_hw_mgr_ctx *ctx,
+		struct cam_hw_intf *hw_intf),
+	bool csid_stage)
+{
+	struct cam_ife_hw_mgr_init_job  jobs[CAM_IFE_HW_INIT_JOBS_MAX];
+	struct cam_isp_hw_mgr_res      *hw_mgr_res;
+	int num_jobs = 0, rc = 0, i;
+
+	memset(jobs, 0, sizeof(jobs));
+
+	if (csid_stage) {
+		list_for_each_entry(hw_mgr_res, &ctx->res_list_ife_csid, list) {
+			num_jobs = cam_ife_hw_mgr_add_init_job(jobs, num_jobs,
+				hw_mgr_res);
+			if (num_jobs < 0)
+				return num_jobs;
+		}
+	} else {
+		list_for_each_entry(hw_mgr_res, &ctx->res_list_ife_src, list) {
+			num_jobs = cam_ife_hw_mgr_add_init_job(jobs, num_jobs,
+				hw_mgr_res);
+			if (num_jobs < 0)
+				return num_jobs;
+		}
+
+		list_for_each_entry(hw_mgr_res, &ctx->res_list_sfe_src, list) {
+			num_jobs = cam_ife_hw_mgr_add_init_job(jobs, num_jobs,
+				hw_mgr_res);
+			if (num_jobs < 0)
+				return num_jobs;
+		}
+
+		list_for_each_entry(hw_mgr_res, &ctx->res_list_ife_in_rd,
+			list) {
+			num_jobs = cam_ife_hw_mgr_add_init_job(jobs, num_jobs,
+				hw_mgr_res);
+			if (num_jobs < 0)
+				return num_jobs;
+		}
+
+		for (i = 0; i < CAM_SFE_HW_OUT_RES_MAX; i++) {
+			num_jobs = cam_ife_hw_mgr_add_init_job(jobs, num_jobs,
+				&ctx->res_list_sfe_out[i]);
+			if (num_jobs < 0)
+				return num_jobs;
+		}
+
+		for (i = 0; i < max_ife_out_res; i++) {
+			num_jobs = cam_ife_hw_mgr_add_init_job(jobs, num_jobs,
+				&ctx->res_list_ife_out[i]);
+			if (num_jobs < 0)
+				return num_jobs;
+		}
+	}
+
+	if (num_jobs <= 1)
+		return init_func(ctx, NULL);
+
+	for (i = 0; i < num_jobs; i++) {
+		jobs[i].ctx = ctx;
+		jobs[i].init_func = init_func;
+		if (!i)
+			continue;
+
+		INIT_WORK_ONSTACK(&jobs[i].work, cam_ife_hw_mgr_init_job_work);
+		queue_work(system_highpri_wq, &jobs[i].work);
+	}
+
+	jobs[0].rc = init_func(ctx, jobs[0].hw_intf);
+
+	for (i = 1; i < num_jobs; i++) {
+		flush_work(&jobs[i].work);
+		destroy_work_on_stack(&jobs[i].work);
+	}
+
+	for (i = 0; i < num_jobs; i++) {
+		if (jobs[i].rc) {
+			CAM_ERR(CAM_ISP, "ctx:%d hw idx:%u init failed rc:%d",
+				ctx->ctx_index, jobs[i].hw_intf->hw_idx,
+				jobs[i].rc);
+			if (!rc)
+				rc = jobs[i].rc;
+		}
+	}
+
+	return rc;
+}
+
+static int cam_ife_hw_mgr_init_hw(
+	struct cam_ife_hw_mgr_ctx *ctx)
+{
+	struct cam_ife_hw_mgr          *hw_mgr;
+	ktime_t start;
+	bool parallel;
+	int rc = 0, i;
+
+	start = ktime_get();
+	parallel = g_ife_hw_mgr.debug_cfg.enable_parallel_init;
+
+	if (parallel)
+		rc = cam_ife_hw_mgr_init_stage_parallel(ctx,
+			cam_ife_hw_mgr_init_ife_sfe_res, false);
+	else
+		rc = cam_ife_hw_mgr_init_ife_sfe_res(ctx, NULL);
+	if (rc)
+		goto deinit;
+
+	/* CSID comes up only once all of its consumers are powered */
+	if (parallel)
+		rc = cam_ife_hw_mgr_init_stage_parallel(ctx,
+			cam_ife_hw_mgr_init_csid_res, true);
+	else
+		rc = cam_ife_hw_mgr_init_csid_res(ctx, NULL);
+	if (rc)
+		goto deinit;
+
 	hw_mgr = ctx->hw_mgr;
 
 	if (hw_mgr->csid_global_reset_en) {
@@ -1075,6 +1275,9 @@ static int cam_ife_hw_mgr_init_hw(
 		}
 	}
 
+	CAM_DBG(CAM_PERF, "ctx:%d hw init took %lld us parallel:%d",
+		ctx->ctx_index, ktime_us_delta(ktime_get(), start), parallel);
+
 	return rc;
 deinit:
 	ctx->flags.init_done = true;
@@ -5846,6 +6049,214 @@ static int cam_isp_blob_bw_update(
 	return rc;
 }
 
+static uint64_t cam_ife_mgr_get_total_camnoc_bw(
+	struct cam_isp_bw_clk_config_info *bw_clk_config)
+{
+	uint64_t total_bw = 0;
+	uint32_t i;
+
+	if (!bw_clk_config->bw_config_valid)
+		return 0;
+
+	for (i = 0; i < bw_clk_config->bw_config_v2.num_paths; i++)
+		total_bw += bw_clk_config->bw_config_v2.axi_path[i].camnoc_bw;
+
+	return total_bw;
+}
+
+static uint64_t cam_ife_mgr_get_max_pix_clk(
+	struct cam_isp_bw_clk_config_info *bw_clk_config)
+{
+	struct cam_isp_clock_config_internal *clk_cfg;
+	uint64_t max_clk = 0;
+
+	if (bw_clk_config->ife_clock_config_valid) {
+		clk_cfg = &bw_clk_config->ife_clock_config;
+		max_clk = max(clk_cfg->left_pix_hz, clk_cfg->right_pix_hz);
+	}
+
+	if (bw_clk_config->sfe_clock_config_valid) {
+		clk_cfg = &bw_clk_config->sfe_clock_config;
+		max_clk = max3(max_clk, clk_cfg->left_pix_hz,
+			clk_cfg->right_pix_hz);
+	}
+
+	return max_clk;
+}
+
+static void cam_ife_mgr_merge_bw_config(
+	struct cam_isp_bw_config_internal_v2 *dst,
+	struct cam_isp_bw_config_internal_v2 *src)
+{
+	struct cam_axi_per_path_bw_vote *dst_path;
+	struct cam_axi_per_path_bw_vote *src_path;
+	uint32_t i, j;
+
+	for (i = 0; i < src->num_paths; i++) {
+		src_path = &src->axi_path[i];
+
+		for (j = 0; j < dst->num_paths; j++) {
+			dst_path = &dst->axi_path[j];
+			if ((dst_path->usage_data == src_path->usage_data) &&
+				(dst_path->transac_type ==
+				src_path->transac_type) &&
+				(dst_path->path_data_type ==
+				src_path->path_data_type))
+				break;
+		}
+
+		if (j == dst->num_paths) {
+			if (dst->num_paths < CAM_ISP_MAX_PER_PATH_VOTES)
+				dst->axi_path[dst->num_paths++] = *src_path;
+			continue;
+		}
+
+		dst_path->camnoc_bw = max(dst_path->camnoc_bw,
+			src_path->camnoc_bw);
+		dst_path->mnoc_ab_bw = max(dst_path->mnoc_ab_bw,
+			src_path->mnoc_ab_bw);
+		dst_path->mnoc_ib_bw = max(dst_path->mnoc_ib_bw,
+			src_path->mnoc_ib_bw);
+		dst_path->ddr_ab_bw = max(dst_path->ddr_ab_bw,
+			src_path->ddr_ab_bw);
+		dst_path->ddr_ib_bw = max(dst_path->ddr_ib_bw,
+			src_path->ddr_ib_bw);
+	}
+}
+
+static void cam_ife_mgr_merge_clock_config(
+	struct cam_isp_clock_config_internal *dst,
+	struct cam_isp_clock_config_internal *src)
+{
+	uint32_t i;
+
+	dst->num_rdi = max(dst->num_rdi, src->num_rdi);
+	dst->left_pix_hz = max(dst->left_pix_hz, src->left_pix_hz);
+	dst->right_pix_hz = max(dst->right_pix_hz, src->right_pix_hz);
+	for (i = 0; i < CAM_IFE_RDI_NUM_MAX; i++)
+		dst->rdi_hz[i] = max(dst->rdi_hz[i], src->rdi_hz[i]);
+}
+
+static void cam_ife_mgr_merge_bw_clk_config(
+	struct cam_isp_bw_clk_config_info *dst,
+	struct cam_isp_bw_clk_config_info *src,
+	bool                               overwrite)
+{
+	if (src->bw_config_valid) {
+		if (dst->bw_config_valid && !overwrite)
+			cam_ife_mgr_merge_bw_config(&dst->bw_config_v2,
+				&src->bw_config_v2);
+		else
+			memcpy(&dst->bw_config_v2, &src->bw_config_v2,
+				sizeof(dst->bw_config_v2));
+		dst->bw_config_valid = true;
+	}
+
+	if (src->ife_clock_config_valid) {
+		if (dst->ife_clock_config_valid && !overwrite)
+			cam_ife_mgr_merge_clock_config(&dst->ife_clock_config,
+				&src->ife_clock_config);
+		else
+			dst->ife_clock_config = src->ife_clock_config;
+		dst->ife_clock_config_valid = true;
+	}
+
+	if (src->sfe_clock_config_valid) {
+		if (dst->sfe_clock_config_valid && !overwrite)
+			cam_ife_mgr_merge_clock_config(&dst->sfe_clock_config,
+				&src->sfe_clock_config);
+		else
+			dst->sfe_clock_config = src->sfe_clock_config;
+		dst->sfe_clock_config_valid = true;
+	}
+}
+
+/*
+ * The top layers only hold the max of the last few applied votes, so a
+ * request needing more BW/clock gets it at its own apply. Fold in the
+ * needs of the requests queued behind it so the vote is raised ahead of
+ * the frame that needs it, and drops only once no queued request does.
+ */
+static struct cam_isp_bw_clk_config_info *cam_ife_mgr_plan_bw_clk(
+	struct cam_ife_hw_mgr_ctx             *ctx,
+	struct cam_hw_config_args             *cfg,
+	struct cam_isp_prepare_hw_update_data *hw_update_data)
+{
+	struct cam_ife_hw_mgr_bw_clk_plan *plan = &ctx->bw_clk_plan;
+	struct cam_isp_bw_clk_config_info *bw_clk_config;
+	uint64_t                           need_bw, need_clk;
+	uint64_t                           voted_bw, voted_clk;
+	uint32_t                           num_upcoming, i;
+
+	bw_clk_config = &hw_update_data->bw_clk_config;
+	num_upcoming = min(hw_update_data->num_upcoming_bw_clk,
+		g_ife_hw_mgr.debug_cfg.bw_clk_lookahead);
+	num_upcoming = min_t(uint32_t, num_upcoming,
+		CAM_ISP_BW_CLK_LOOKAHEAD_MAX);
+	hw_update_data->num_upcoming_bw_clk = 0;
+
+	if (ctx->bw_config_version != CAM_ISP_BW_CONFIG_V2)
+		return bw_clk_config;
+
+	/* A request without blobs keeps the needs of the last one with them */
+	cam_ife_mgr_merge_bw_clk_config(&plan->need, bw_clk_config, true);
+	need_bw = cam_ife_mgr_get_total_camnoc_bw(&plan->need);
+	need_clk = cam_ife_mgr_get_max_pix_clk(&plan->need);
+	voted_bw = need_bw;
+	voted_clk = need_clk;
+
+	if (num_upcoming && !cfg->init_packet) {
+		memcpy(&plan->planned, &plan->need, sizeof(plan->planned));
+		for (i = 0; i < num_upcoming; i++)
+			cam_ife_mgr_merge_bw_clk_config(&plan->planned,
+				hw_update_data->upcoming_bw_clk[i], false);
+
+		bw_clk_config = &plan->planned;
+		voted_bw = cam_ife_mgr_get_total_camnoc_bw(bw_clk_config);
+		voted_clk = cam_ife_mgr_get_max_pix_clk(bw_clk_config);
+	}
+
+	if (!cfg->init_packet) {
+		plan->num_req++;
+		if (need_bw > plan->voted_bw)
+			plan->late_bw_raise++;
+		if (need_clk > plan->voted_clk)
+			plan->late_clk_raise++;
+		plan->voted_bw_sum += voted_bw;
+		plan->voted_clk_sum += voted_clk;
+
+		trace_cam_log_event("ISPBwPlan", "need vs voted camnoc bw",
+			need_bw, voted_bw);
+		trace_cam_log_event("ISPClkPlan", "need vs voted pix clk",
+			need_clk, voted_clk);
+	}
+
+	CAM_DBG(CAM_PERF,
+		"ctx:%u req:%llu lookahead:%u bw need:%llu voted:%llu clk need:%llu voted:%llu",
+		ctx->ctx_index, cfg->request_id, num_upcoming,
+		need_bw, voted_bw, need_clk, voted_clk);
+
+	plan->voted_bw = voted_bw;
+	plan->voted_clk = voted_clk;
+
+	return bw_clk_config;
+}
+
+static void cam_ife_mgr_reset_bw_clk_plan(struct cam_ife_hw_mgr_ctx *ctx)
+{
+	struct cam_ife_hw_mgr_bw_clk_plan *plan = &ctx->bw_clk_plan;
+
+	if (plan->num_req)
+		CAM_DBG(CAM_PERF,
+			"ctx:%u reqs:%llu late raises bw:%llu clk:%llu avg vote bw:%llu clk:%llu",
+			ctx->ctx_index, plan->num_req,
+			plan->late_bw_raise, plan->late_clk_raise,
+			div64_u64(plan->voted_bw_sum, plan->num_req),
+			div64_u64(plan->voted_clk_sum, plan->num_req));
+
+	memset(plan, 0, sizeof(*plan));
+}
+
 /* entry function: config_hw */
 static int cam_ife_mgr_config_hw(void *hw_mgr_priv,
 					void *config_hw_args)
@@ -5856,6 +6267,7 @@ static int cam_ife_mgr_config_hw(void *hw_mgr_priv,
 	struct cam_cdm_bl_request *cdm_cmd;
 	struct cam_ife_hw_mgr_ctx *ctx;
 	struct cam_isp_prepare_hw_update_data *hw_update_data;
+	struct cam_isp_bw_clk_config_info *bw_clk_config;
 	unsigned long rem_jiffies = 0;
 	bool cdm_hang_detect = false;
 
@@ -5927,41 +6339,43 @@ static int cam_ife_mgr_config_hw(void *hw_mgr_priv,
 		hw_update_data->bw_clk_config.ife_clock_config_valid,
 		hw_update_data->bw_clk_config.sfe_clock_config_valid);
 
+	bw_clk_config = cam_ife_mgr_plan_bw_clk(ctx, cfg, hw_update_data);
+
 	/*
 	 * Update clock and bw values to top layer, the actual application of these
 	 * votes to hw will happen for all relevant hw indices at once, in a separate
 	 * finish update call
 	 */
-	if (hw_update_data->bw_clk_config.ife_clock_config_valid) {
+	if (bw_clk_config->ife_clock_config_valid) {
 		rc = cam_isp_blob_ife_clock_update((struct cam_isp_clock_config *)
-			&hw_update_data->bw_clk_config.ife_clock_config, ctx);
+			&bw_clk_config->ife_clock_config, ctx);
 		if (rc) {
 			CAM_ERR(CAM_PERF, "Clock Update Failed, rc=%d", rc);
 			return rc;
 		}
 	}
 
-	if (hw_update_data->bw_clk_config.sfe_clock_config_valid) {
+	if (bw_clk_config->sfe_clock_config_valid) {
 		rc = cam_isp_blob_sfe_clock_update((struct cam_isp_clock_config *)
-			&hw_update_data->bw_clk_config.sfe_clock_config, ctx);
+			&bw_clk_config->sfe_clock_config, ctx);
 		if (rc) {
 			CAM_ERR(CAM_PERF, "Clock Update Failed, rc=%d", rc);
 			return rc;
 		}
 	}
 
-	if (hw_update_data->bw_clk_config.bw_config_valid) {
+	if (bw_clk_config->bw_config_valid) {
 		if (ctx->bw_config_version == CAM_ISP_BW_CONFIG_V1) {
 			rc = cam_isp_blob_bw_update(
 				(struct cam_isp_bw_config *)
-				&hw_update_data->bw_clk_config.bw_config, ctx);
+				&bw_clk_config->bw_config, ctx);
 			if (rc) {
 				CAM_ERR(CAM_PERF, "Bandwidth Update Failed rc: %d", rc);
 				return rc;
 			}
 		} else if (ctx->bw_config_version == CAM_ISP_BW_CONFIG_V2) {
 			rc = cam_isp_blob_bw_update_v2((struct cam_isp_bw_config_v2 *)
-				&hw_update_data->bw_clk_config.bw_config_v2, ctx);
+				&bw_clk_config->bw_config_v2, ctx);
 			if (rc) {
 				CAM_ERR(CAM_PERF, "Bandwidth Update Failed rc: %d", rc);
 				return rc;
@@ -6309,6 +6723,8 @@ static int cam_ife_mgr_stop_hw(void *hw_mgr_priv, void *stop_hw_args)
 	 */
 	if (stop_isp->is_internal_stop)
 		cam_ife_mgr_finish_clk_bw_update(ctx, 0, true);
+	else
+		cam_ife_mgr_reset_bw_clk_plan(ctx);
 
 	/* check to avoid iterating loop */
 	if (ctx->ctx_type == CAM_IFE_CTX_TYPE_SFE) {
@@ -12923,6 +13339,7 @@ static int cam_ife_hw_mgr_handle_hw_sof(
 	switch (event_info->res_id) {
 	case CAM_ISP_HW_VFE_IN_CAMIF:
 	case CAM_ISP_HW_VFE_IN_RD:
+		cam_io_account_frame();
 		/* if frame header is enabled reset qtimer ts */
 		if (ife_hw_mgr_ctx->ctx_config &
 			CAM_IFE_CTX_CFG_FRAME_HEADER_TS) {
@@ -13541,13 +13958,20 @@ static int cam_ife_hw_mgr_debug_register(void)
 		g_ife_hw_mgr.debug_cfg.dentry, NULL, &cam_ife_sfe_debug);
 	debugfs_create_file("sfe_sensor_diag_sel", 0644,
 		g_ife_hw_mgr.debug_cfg.dentry, NULL, &cam_ife_sfe_sensor_diag_debug);
+	debugfs_create_bool("enable_parallel_init", 0644,
+		g_ife_hw_mgr.debug_cfg.dentry,
+		&g_ife_hw_mgr.debug_cfg.enable_parallel_init);
 	debugfs_create_bool("disable_ife_mmu_prefetch", 0644,
 		g_ife_hw_mgr.debug_cfg.dentry,
 		&g_ife_hw_mgr.debug_cfg.disable_ife_mmu_prefetch);
 	debugfs_create_file("sfe_cache_debug", 0644,
 		g_ife_hw_mgr.debug_cfg.dentry, NULL, &cam_ife_sfe_cache_debug);
+	debugfs_create_u32("bw_clk_lookahead", 0644,
+		g_ife_hw_mgr.debug_cfg.dentry,
+		&g_ife_hw_mgr.debug_cfg.bw_clk_lookahead);
 end:
 	g_ife_hw_mgr.debug_cfg.enable_csid_recovery = 1;
+	g_ife_hw_mgr.debug_cfg.bw_clk_lookahead = CAM_ISP_BW_CLK_LOOKAHEAD_MAX;
 	return rc;
 }
 
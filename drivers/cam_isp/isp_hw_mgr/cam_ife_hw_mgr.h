@@ -38,6 +38,9 @@ enum cam_ife_ctx_master_type {
 #define CAM_IFE_CTX_CFG_SW_SYNC_ON        BIT(1)
 #define CAM_IFE_CTX_CFG_DYNAMIC_SWITCH_ON BIT(2)
 
+/* Max distinct devices powered up in one parallel init stage */
+#define CAM_IFE_HW_INIT_JOBS_MAX (CAM_IFE_HW_NUM_MAX + CAM_SFE_HW_NUM_MAX)
+
 /**
  * struct cam_ife_hw_mgr_debug - contain the debug information
  *
@@ -53,6 +56,8 @@ enum cam_ife_ctx_master_type {
  * @per_req_reg_dump:          Enable per request reg dump
  * @disable_ubwc_comp:         Disable UBWC compression
  * @disable_ife_mmu_prefetch:  Disable MMU prefetch for IFE bus WR
+ * @enable_parallel_init:      Power up the devices of a context in parallel
+ * @bw_clk_lookahead:          Queued requests folded into each BW/clock vote
  *
  */
 struct cam_ife_hw_mgr_debug {
@@ -68,6 +73,8 @@ struct cam_ife_hw_mgr_debug {
 	bool           per_req_reg_dump;
 	bool           disable_ubwc_comp;
 	bool           disable_ife_mmu_prefetch;
+	bool           enable_parallel_init;
+	uint32_t       bw_clk_lookahead;
 };
 
 /**
@@ -216,6 +223,31 @@ struct cam_ife_cdm_user_data {
 	uint64_t                                  request_id;
 };
 
+/**
+ * struct cam_ife_hw_mgr_bw_clk_plan - Look-ahead BW/clock planner state
+ *
+ * @need:            BW/clock needs of the last applied request
+ * @planned:         Envelope of need and the needs of upcoming requests
+ * @num_req:         Requests applied since stream on
+ * @late_bw_raise:   Requests whose BW need exceeded the previous vote
+ * @late_clk_raise:  Requests whose clock need exceeded the previous vote
+ * @voted_bw_sum:    Sum of the camnoc BW voted per request
+ * @voted_clk_sum:   Sum of the pixel clock voted per request
+ * @voted_bw:        camnoc BW voted for the last request
+ * @voted_clk:       Pixel clock voted for the last request
+ */
+struct cam_ife_hw_mgr_bw_clk_plan {
+	struct cam_isp_bw_clk_config_info  need;
+	struct cam_isp_bw_clk_config_info  planned;
+	uint64_t                           num_req;
+	uint64_t                           late_bw_raise;
+	uint64_t                           late_clk_raise;
+	uint64_t                           voted_bw_sum;
+	uint64_t                           voted_clk_sum;
+	uint64_t                           voted_bw;
+	uint64_t                           voted_clk;
+};
+
 /**
  * struct cam_ife_hw_mgr_ctx - IFE HW manager Context object
  *
@@ -269,6 +301,7 @@ struct cam_ife_cdm_user_data {
  * @current_mup:            Current MUP val, scratch will then apply the same as previously
  *                          applied request
  * @curr_num_exp:           Current num of exposures
+ * @bw_clk_plan:            Look-ahead BW/clock planner state
  *
  */
 struct cam_ife_hw_mgr_ctx {
@@ -328,6 +361,7 @@ struct cam_ife_hw_mgr_ctx {
 	uint32_t                                   curr_num_exp;
 	struct cam_isp_hw_comp_record             *vfe_bus_comp_grp;
 	struct cam_isp_hw_comp_record             *sfe_bus_comp_grp;
+	struct cam_ife_hw_mgr_bw_clk_plan          bw_clk_plan;
 };
 
 /**
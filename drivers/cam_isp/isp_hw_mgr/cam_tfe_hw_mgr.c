@@ -27,6 +27,7 @@
 #include "cam_compat.h"
 #include "cam_req_mgr_debug.h"
 #include "cam_trace.h"
+#include "cam_io_util.h"
 #include "cam_compat.h"
 
 #define CAM_TFE_HW_CONFIG_TIMEOUT 60
@@ -5903,6 +5904,7 @@ static int cam_tfe_hw_mgr_handle_hw_sof(
 
 	switch (event_info->res_id) {
 	case CAM_ISP_HW_TFE_IN_CAMIF:
+		cam_io_account_frame();
 		cam_tfe_mgr_cmd_get_sof_timestamp(tfe_hw_mgr_ctx,
 			&sof_done_event_data.timestamp,
 			&sof_done_event_data.boot_time, NULL);
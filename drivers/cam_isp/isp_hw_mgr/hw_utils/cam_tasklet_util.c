@@ -4,14 +4,18 @@
  */
 
 #include <linux/slab.h>
-#include <linux/spinlock_types.h>
 #include <linux/interrupt.h>
-#include <linux/list.h>
+#include <linux/kthread.h>
+#include <linux/module.h>
+#include <linux/bitmap.h>
+#include <linux/atomic.h>
 #include <linux/ratelimit.h>
+#include <linux/sched.h>
 #include "cam_tasklet_util.h"
 #include "cam_irq_controller.h"
 #include "cam_debug_util.h"
 #include "cam_common_util.h"
+#include "cam_compat.h"
 
 
 /* Threshold for scheduling delay in ms */
@@ -20,8 +24,16 @@
 /* Threshold for execution delay in ms */
 #define CAM_TASKLET_EXE_TIME_THRESHOLD          10
 
+/* Must be a power of 2, used as ring size */
 #define CAM_TASKLETQ_SIZE                          256
 
+/* Bottom half execution modes, selected at cam_tasklet_init */
+#define CAM_TASKLET_BH_MODE_TASKLET                0
+#define CAM_TASKLET_BH_MODE_RT_THREAD              1
+
+static uint cam_tasklet_bh_mode = CAM_TASKLET_BH_MODE_TASKLET;
+module_param(cam_tasklet_bh_mode, uint, 0644);
+
 static void cam_tasklet_action(unsigned long data);
 
 /**
@@ -29,7 +41,6 @@ static void cam_tasklet_action(unsigned long data);
  * @Brief:                  Structure associated with each slot in the
  *                          tasklet queue
  *
- * @list:                   list_head member for each entry in queue
  * @payload:                Payload structure for the event. This will be
  *                          passed to the handler function
  * @handler_priv:           Private data passed at event subscribe
@@ -39,39 +50,74 @@ static void cam_tasklet_action(unsigned long data);
  *
  */
 struct cam_tasklet_queue_cmd {
-	struct list_head                   list;
 	void                              *payload;
 	void                              *handler_priv;
 	CAM_IRQ_HANDLER_BOTTOM_HALF        bottom_half_handler;
 	ktime_t                            tasklet_enqueue_ts;
 };
 
+/**
+ * struct cam_tasklet_ring_cell:
+ * @Brief:                  Cell of the pending command ring
+ *
+ * @seq:                    Sequence number telling producers and consumer
+ *                          whether the cell is free or holds a command
+ * @cmd_idx:                Index of the queued command in cmd_queue
+ *
+ */
+struct cam_tasklet_ring_cell {
+	atomic_t                           seq;
+	uint32_t                           cmd_idx;
+};
+
 /**
  * struct cam_tasklet_info:
  * @Brief:                  Tasklet private structure
  *
  * @list:                   list_head member for each tasklet
  * @index:                  Instance id for the tasklet
- * @tasklet_lock:           Spin lock
  * @tasklet_active:         Atomic variable to control tasklet state
+ * @num_enqueuing:          Number of top halves between the tasklet_active
+ *                          check and the bottom half kick in enqueue
  * @tasklet:                Tasklet structure used to schedule bottom half
- * @free_cmd_list:          List of free tasklet queue cmd for use
- * @used_cmd_list:          List of used tasklet queue cmd
+ * @bh_mode:                Bottom half mode, tasklet or RT kthread
+ * @worker:                 Kthread worker running the bottom half in
+ *                          RT thread mode
+ * @work:                   Work item queued on worker
+ * @cmd_map:                Bitmap of cmd_queue entries handed out to top halves
+ * @ring:                   Lock free ring of commands pending bottom half
+ *                          processing, multiple IRQ producers and the bottom
+ *                          half as single consumer
+ * @ring_tail:              Producer position in ring
+ * @ring_head:              Consumer position in ring
  * @cmd_queue:              Array of tasklet cmd for storage
+ * @num_in_use:             Number of commands currently handed out
+ * @high_water_mark:        Max of num_in_use since start
+ * @num_dropped:            Number of events dropped since start for lack of
+ *                          a free command or an inactive tasklet
  * @ctx_priv:               Private data passed to the handling function
  *
  */
 struct cam_tasklet_info {
 	struct list_head                   list;
 	uint32_t                           index;
-	spinlock_t                         tasklet_lock;
 	atomic_t                           tasklet_active;
+	atomic_t                           num_enqueuing;
 	struct tasklet_struct              tasklet;
-
-	struct list_head                   free_cmd_list;
-	struct list_head                   used_cmd_list;
+	uint32_t                           bh_mode;
+	struct kthread_worker             *worker;
+	struct kthread_work                work;
+
+	DECLARE_BITMAP(cmd_map, CAM_TASKLETQ_SIZE);
+	struct cam_tasklet_ring_cell       ring[CAM_TASKLETQ_SIZE];
+	atomic_t                           ring_tail;
+	uint32_t                           ring_head;
 	struct cam_tasklet_queue_cmd       cmd_queue[CAM_TASKLETQ_SIZE];
 
+	atomic_t                           num_in_use;
+	atomic_t                           high_water_mark;
+	atomic_t                           num_dropped;
+
 	void                              *ctx_priv;
 };
 
@@ -81,14 +127,26 @@ struct cam_irq_bh_api tasklet_bh_api = {
 	.put_bh_payload_func = cam_tasklet_put_cmd,
 };
 
+static void cam_tasklet_update_high_water_mark(
+	struct cam_tasklet_info *tasklet, int in_use)
+{
+	int hwm = atomic_read(&tasklet->high_water_mark);
+	int prev;
+
+	while (in_use > hwm) {
+		prev = atomic_cmpxchg(&tasklet->high_water_mark, hwm, in_use);
+		if (prev == hwm)
+			break;
+		hwm = prev;
+	}
+}
+
 int cam_tasklet_get_cmd(
 	void                         *bottom_half,
 	void                        **bh_cmd)
 {
-	int           rc = 0;
-	unsigned long flags;
+	int           i, idx;
 	struct cam_tasklet_info        *tasklet = bottom_half;
-	struct cam_tasklet_queue_cmd   *tasklet_cmd = NULL;
 
 	*bh_cmd = NULL;
 
@@ -100,33 +158,36 @@ int cam_tasklet_get_cmd(
 	if (!atomic_read(&tasklet->tasklet_active)) {
 		CAM_ERR_RATE_LIMIT(CAM_ISP, "Tasklet idx:%d is not active",
 			tasklet->index);
-		rc = -EPIPE;
-		return rc;
+		atomic_inc(&tasklet->num_dropped);
+		return -EPIPE;
 	}
 
-	spin_lock_irqsave(&tasklet->tasklet_lock, flags);
-	if (list_empty(&tasklet->free_cmd_list)) {
-		CAM_ERR_RATE_LIMIT(CAM_ISP, "No more free tasklet cmd idx:%d",
-			tasklet->index);
-		rc = -ENODEV;
-		goto spin_unlock;
-	} else {
-		tasklet_cmd = list_first_entry(&tasklet->free_cmd_list,
-			struct cam_tasklet_queue_cmd, list);
-		list_del_init(&(tasklet_cmd)->list);
-		*bh_cmd = tasklet_cmd;
+	for (i = 0; i < CAM_TASKLETQ_SIZE; i++) {
+		idx = find_first_zero_bit(tasklet->cmd_map, CAM_TASKLETQ_SIZE);
+		if (idx >= CAM_TASKLETQ_SIZE)
+			break;
+
+		/* Lost the race to another top half, look again */
+		if (test_and_set_bit(idx, tasklet->cmd_map))
+			continue;
+
+		cam_tasklet_update_high_water_mark(tasklet,
+			atomic_inc_return(&tasklet->num_in_use));
+		*bh_cmd = &tasklet->cmd_queue[idx];
+		return 0;
 	}
 
-spin_unlock:
-	spin_unlock_irqrestore(&tasklet->tasklet_lock, flags);
-	return rc;
+	atomic_inc(&tasklet->num_dropped);
+	CAM_ERR_RATE_LIMIT(CAM_ISP, "No more free tasklet cmd idx:%d dropped:%d",
+		tasklet->index, atomic_read(&tasklet->num_dropped));
+
+	return -ENODEV;
 }
 
 void cam_tasklet_put_cmd(
 	void                         *bottom_half,
 	void                        **bh_cmd)
 {
-	unsigned long flags;
 	struct cam_tasklet_info        *tasklet = bottom_half;
 	struct cam_tasklet_queue_cmd   *tasklet_cmd = *bh_cmd;
 
@@ -140,23 +201,19 @@ void cam_tasklet_put_cmd(
 		return;
 	}
 
-	spin_lock_irqsave(&tasklet->tasklet_lock, flags);
-	list_del_init(&tasklet_cmd->list);
-	list_add_tail(&tasklet_cmd->list, &tasklet->free_cmd_list);
 	*bh_cmd = NULL;
-	spin_unlock_irqrestore(&tasklet->tasklet_lock, flags);
+	atomic_dec(&tasklet->num_in_use);
+	clear_bit_unlock(tasklet_cmd - tasklet->cmd_queue, tasklet->cmd_map);
 }
 
 /**
  * cam_tasklet_dequeue_cmd()
  *
- * @brief:              Initialize the tasklet info structure
+ * @brief:              Pop the oldest pending command, only called from the
+ *                      single bottom half consumer
  *
- * @hw_mgr_ctx:         Private Ctx data that will be passed to the handler
- *                      function
- * @idx:                Index of tasklet used as identity
- * @tasklet_action:     Tasklet callback function that will be called
- *                      when tasklet runs on CPU
+ * @tasklet:            Tasklet info to dequeue from
+ * @tasklet_cmd:        Dequeued command if successful
  *
  * @return:             0: Success
  *                      Negative: Failure
@@ -165,27 +222,62 @@ static int cam_tasklet_dequeue_cmd(
 	struct cam_tasklet_info        *tasklet,
 	struct cam_tasklet_queue_cmd  **tasklet_cmd)
 {
-	int rc = 0;
-	unsigned long flags;
+	struct cam_tasklet_ring_cell *cell;
+	uint32_t pos = tasklet->ring_head;
+	uint32_t seq;
 
 	*tasklet_cmd = NULL;
 
-	CAM_DBG(CAM_ISP, "Dequeue before lock tasklet idx:%d", tasklet->index);
-	spin_lock_irqsave(&tasklet->tasklet_lock, flags);
-	if (list_empty(&tasklet->used_cmd_list)) {
+	cell = &tasklet->ring[pos & (CAM_TASKLETQ_SIZE - 1)];
+	seq = (uint32_t)atomic_read_acquire(&cell->seq);
+	if ((int32_t)(seq - (pos + 1)) < 0) {
 		CAM_DBG(CAM_ISP, "End of list reached. Exit");
-		rc = -ENODEV;
-		goto spin_unlock;
-	} else {
-		*tasklet_cmd = list_first_entry(&tasklet->used_cmd_list,
-			struct cam_tasklet_queue_cmd, list);
-		list_del_init(&(*tasklet_cmd)->list);
-		CAM_DBG(CAM_ISP, "Dequeue Successful");
+		return -ENODEV;
 	}
 
-spin_unlock:
-	spin_unlock_irqrestore(&tasklet->tasklet_lock, flags);
-	return rc;
+	*tasklet_cmd = &tasklet->cmd_queue[cell->cmd_idx];
+	atomic_set_release(&cell->seq, pos + CAM_TASKLETQ_SIZE);
+	tasklet->ring_head = pos + 1;
+	CAM_DBG(CAM_ISP, "Dequeue Successful");
+
+	return 0;
+}
+
+static int cam_tasklet_ring_push(
+	struct cam_tasklet_info        *tasklet,
+	uint32_t                        cmd_idx)
+{
+	struct cam_tasklet_ring_cell *cell;
+	uint32_t pos, seq;
+	int32_t dif;
+
+	pos = (uint32_t)atomic_read(&tasklet->ring_tail);
+	for (;;) {
+		cell = &tasklet->ring[pos & (CAM_TASKLETQ_SIZE - 1)];
+		seq = (uint32_t)atomic_read_acquire(&cell->seq);
+		dif = (int32_t)(seq - pos);
+		if (dif == 0) {
+			if (atomic_cmpxchg(&tasklet->ring_tail, pos, pos + 1) == pos)
+				break;
+		} else if (dif < 0) {
+			/* Can not happen as ring size matches cmd_queue size */
+			return -ENOSPC;
+		}
+		pos = (uint32_t)atomic_read(&tasklet->ring_tail);
+	}
+
+	cell->cmd_idx = cmd_idx;
+	atomic_set_release(&cell->seq, pos + 1);
+
+	return 0;
+}
+
+static void cam_tasklet_work_fn(struct kthread_work *work)
+{
+	struct cam_tasklet_info *tasklet =
+		container_of(work, struct cam_tasklet_info, work);
+
+	cam_tasklet_action((unsigned long)tasklet);
 }
 
 void cam_tasklet_enqueue_cmd(
@@ -195,7 +287,6 @@ void cam_tasklet_enqueue_cmd(
 	void                              *evt_payload_priv,
 	CAM_IRQ_HANDLER_BOTTOM_HALF        bottom_half_handler)
 {
-	unsigned long                  flags;
 	struct cam_tasklet_queue_cmd  *tasklet_cmd = bh_cmd;
 	struct cam_tasklet_info       *tasklet = bottom_half;
 
@@ -209,10 +300,18 @@ void cam_tasklet_enqueue_cmd(
 		return;
 	}
 
+	/*
+	 * Pairs with cam_tasklet_stop(): either stop sees this enqueue in
+	 * flight and waits for it, or this enqueue sees the tasklet inactive.
+	 */
+	atomic_inc(&tasklet->num_enqueuing);
+	smp_mb__after_atomic();
 	if (!atomic_read(&tasklet->tasklet_active)) {
 		CAM_ERR_RATE_LIMIT(CAM_ISP, "Tasklet is not active idx:%d",
 			tasklet->index);
-		return;
+		atomic_inc(&tasklet->num_dropped);
+		cam_tasklet_put_cmd(tasklet, &bh_cmd);
+		goto end;
 	}
 
 	CAM_DBG(CAM_ISP, "Enqueue tasklet cmd idx:%d", tasklet->index);
@@ -220,11 +319,52 @@ void cam_tasklet_enqueue_cmd(
 	tasklet_cmd->payload = evt_payload_priv;
 	tasklet_cmd->handler_priv = handler_priv;
 	tasklet_cmd->tasklet_enqueue_ts = ktime_get();
-	spin_lock_irqsave(&tasklet->tasklet_lock, flags);
-	list_add_tail(&tasklet_cmd->list,
-		&tasklet->used_cmd_list);
-	spin_unlock_irqrestore(&tasklet->tasklet_lock, flags);
-	tasklet_hi_schedule(&tasklet->tasklet);
+	if (cam_tasklet_ring_push(tasklet, tasklet_cmd - tasklet->cmd_queue)) {
+		CAM_ERR_RATE_LIMIT(CAM_ISP, "Tasklet ring full idx:%d",
+			tasklet->index);
+		atomic_inc(&tasklet->num_dropped);
+		cam_tasklet_put_cmd(tasklet, &bh_cmd);
+		goto end;
+	}
+
+	if (tasklet->bh_mode == CAM_TASKLET_BH_MODE_RT_THREAD)
+		kthread_queue_work(tasklet->worker, &tasklet->work);
+	else
+		tasklet_hi_schedule(&tasklet->tasklet);
+
+end:
+	atomic_dec_return_release(&tasklet->num_enqueuing);
+}
+
+static void cam_tasklet_reset_queue(struct cam_tasklet_info *tasklet)
+{
+	int i;
+
+	bitmap_zero(tasklet->cmd_map, CAM_TASKLETQ_SIZE);
+	for (i = 0; i < CAM_TASKLETQ_SIZE; i++)
+		atomic_set(&tasklet->ring[i].seq, i);
+	atomic_set(&tasklet->ring_tail, 0);
+	tasklet->ring_head = 0;
+	atomic_set(&tasklet->num_in_use, 0);
+	atomic_set(&tasklet->high_water_mark, 0);
+	atomic_set(&tasklet->num_dropped, 0);
+}
+
+/**
+ * cam_tasklet_deactivate()
+ *
+ * @brief:              Mark the tasklet inactive and wait for top halves
+ *                      already past the active check in enqueue, so nothing
+ *                      is queued after the bottom half is synced
+ *
+ * @tasklet:            Tasklet info to deactivate
+ */
+static void cam_tasklet_deactivate(struct cam_tasklet_info *tasklet)
+{
+	atomic_set(&tasklet->tasklet_active, 0);
+	smp_mb__after_atomic();
+	while (atomic_read_acquire(&tasklet->num_enqueuing))
+		cpu_relax();
 }
 
 int cam_tasklet_init(
@@ -232,7 +372,6 @@ int cam_tasklet_init(
 	void                     *hw_mgr_ctx,
 	uint32_t                  idx)
 {
-	int i;
 	struct cam_tasklet_info  *tasklet = NULL;
 
 	tasklet = kzalloc(sizeof(struct cam_tasklet_info), GFP_KERNEL);
@@ -245,15 +384,24 @@ int cam_tasklet_init(
 
 	tasklet->ctx_priv = hw_mgr_ctx;
 	tasklet->index = idx;
-	spin_lock_init(&tasklet->tasklet_lock);
+	tasklet->bh_mode = cam_tasklet_bh_mode;
 	memset(tasklet->cmd_queue, 0, sizeof(tasklet->cmd_queue));
-	INIT_LIST_HEAD(&tasklet->free_cmd_list);
-	INIT_LIST_HEAD(&tasklet->used_cmd_list);
-	for (i = 0; i < CAM_TASKLETQ_SIZE; i++) {
-		INIT_LIST_HEAD(&tasklet->cmd_queue[i].list);
-		list_add_tail(&tasklet->cmd_queue[i].list,
-			&tasklet->free_cmd_list);
+	cam_tasklet_reset_queue(tasklet);
+
+	if (tasklet->bh_mode == CAM_TASKLET_BH_MODE_RT_THREAD) {
+		tasklet->worker = kthread_create_worker(0, "cam_isp_bh_%u", idx);
+		if (IS_ERR(tasklet->worker)) {
+			CAM_WARN(CAM_ISP,
+				"Failed to create bh worker idx:%d rc:%ld, using tasklet",
+				idx, PTR_ERR(tasklet->worker));
+			tasklet->worker = NULL;
+			tasklet->bh_mode = CAM_TASKLET_BH_MODE_TASKLET;
+		} else {
+			cam_compat_sched_set_fifo(tasklet->worker->task);
+			kthread_init_work(&tasklet->work, cam_tasklet_work_fn);
+		}
 	}
+
 	tasklet_init(&tasklet->tasklet, cam_tasklet_action,
 		(unsigned long)tasklet);
 	tasklet_disable(&tasklet->tasklet);
@@ -263,15 +411,26 @@ int cam_tasklet_init(
 	return 0;
 }
 
+static void cam_tasklet_sync_bh(struct cam_tasklet_info *tasklet)
+{
+	if (tasklet->bh_mode == CAM_TASKLET_BH_MODE_RT_THREAD) {
+		kthread_flush_work(&tasklet->work);
+	} else {
+		tasklet_kill(&tasklet->tasklet);
+		tasklet_disable(&tasklet->tasklet);
+	}
+}
+
 void cam_tasklet_deinit(void    **tasklet_info)
 {
 	struct cam_tasklet_info *tasklet = *tasklet_info;
 
 	if (atomic_read(&tasklet->tasklet_active)) {
-		atomic_set(&tasklet->tasklet_active, 0);
-		tasklet_kill(&tasklet->tasklet);
-		tasklet_disable(&tasklet->tasklet);
+		cam_tasklet_deactivate(tasklet);
+		cam_tasklet_sync_bh(tasklet);
 	}
+	if (tasklet->worker)
+		kthread_destroy_worker(tasklet->worker);
 	kfree(tasklet);
 	*tasklet_info = NULL;
 }
@@ -284,7 +443,6 @@ static inline void cam_tasklet_flush(struct cam_tasklet_info *tasklet_info)
 int cam_tasklet_start(void  *tasklet_info)
 {
 	struct cam_tasklet_info       *tasklet = tasklet_info;
-	int i = 0;
 
 	if (atomic_read(&tasklet->tasklet_active)) {
 		CAM_ERR(CAM_ISP, "Tasklet already active idx:%d",
@@ -293,15 +451,12 @@ int cam_tasklet_start(void  *tasklet_info)
 	}
 
 	/* clean up the command queue first */
-	for (i = 0; i < CAM_TASKLETQ_SIZE; i++) {
-		list_del_init(&tasklet->cmd_queue[i].list);
-		list_add_tail(&tasklet->cmd_queue[i].list,
-			&tasklet->free_cmd_list);
-	}
+	cam_tasklet_reset_queue(tasklet);
 
 	atomic_set(&tasklet->tasklet_active, 1);
 
-	tasklet_enable(&tasklet->tasklet);
+	if (tasklet->bh_mode == CAM_TASKLET_BH_MODE_TASKLET)
+		tasklet_enable(&tasklet->tasklet);
 
 	return 0;
 }
@@ -313,10 +468,17 @@ void cam_tasklet_stop(void  *tasklet_info)
 	if (!atomic_read(&tasklet->tasklet_active))
 		return;
 
-	atomic_set(&tasklet->tasklet_active, 0);
-	tasklet_kill(&tasklet->tasklet);
-	tasklet_disable(&tasklet->tasklet);
+	cam_tasklet_deactivate(tasklet);
+	cam_tasklet_sync_bh(tasklet);
 	cam_tasklet_flush(tasklet);
+
+	if (atomic_read(&tasklet->num_dropped))
+		CAM_WARN(CAM_ISP, "Tasklet idx:%d high water mark:%d dropped:%d",
+			tasklet->index, atomic_read(&tasklet->high_water_mark),
+			atomic_read(&tasklet->num_dropped));
+	else
+		CAM_DBG(CAM_ISP, "Tasklet idx:%d high water mark:%d",
+			tasklet->index, atomic_read(&tasklet->high_water_mark));
 }
 
 /*
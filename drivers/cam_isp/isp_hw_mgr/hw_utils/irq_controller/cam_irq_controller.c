@@ -7,11 +7,13 @@
 #include <linux/spinlock_types.h>
 #include <linux/list.h>
 #include <linux/ratelimit.h>
+#include <linux/sched.h>
 
 #include "cam_io_util.h"
 #include "cam_irq_controller.h"
 #include "cam_debug_util.h"
 #include "cam_common_util.h"
+#include "cam_req_mgr_debug.h"
 
 /**
  * struct cam_irq_evt_handler:
@@ -32,6 +34,8 @@
  * @th_list_node:           list_head struct used for top half handler List
  * @index:                  Unique id of the event
  * @group:                  Group to which the event belongs
+ * @th_slot:                Dispatch slot in the controller top half index,
+ *                          -1 if not indexed
  */
 struct cam_irq_evt_handler {
 	enum cam_irq_priority_level        priority;
@@ -45,6 +49,7 @@ struct cam_irq_evt_handler {
 	struct list_head                   th_list_node;
 	int                                index;
 	int                                group;
+	int                                th_slot;
 };
 
 /**
@@ -100,6 +105,22 @@ struct cam_irq_register_obj {
  * @dependent_controller:   Array of controllers that depend on this controller
  * @delayed_global_clear:   Flag to indicate if this controller issues global clear after dependent
  *                          controllers are handled
+ * @th_slot:                Handlers in top half dispatch order, sorted by priority
+ *                          and then by subscription order
+ * @th_bit_index:           Per register, per status bit mask of th_slot entries
+ *                          subscribed to that bit. Length = num_registers * 32
+ * @th_prio_slots:          Mask of th_slot entries at each priority level
+ * @th_num_slots:           Number of th_slot entries in use
+ * @th_indexed:             Flag to indicate top half dispatch uses th_bit_index,
+ *                          falls back to list scan when there are too many handlers
+ * @th_task:                IRQ thread running top halves with the lock held when the
+ *                          IRQ is threaded, NULL otherwise
+ * @status_latched:         Flag to indicate irq_status_arr was read and cleared by
+ *                          the hard IRQ and is waiting for the IRQ thread
+ * @threaded:               Flag to indicate top halves run in an IRQ thread, the hard
+ *                          IRQ then only takes latch_lock and never lock
+ * @latch_lock:             Lock taken by the hard IRQ of a threaded controller to
+ *                          latch the status, and by the IRQ thread to consume it
  * @lock:                   Lock to be used by controller, Use mutex lock in presil mode,
  *                          and spinlock in regular case
  */
@@ -119,6 +140,15 @@ struct cam_irq_controller {
 	bool                            is_dependent;
 	struct cam_irq_controller      *dependent_controller[CAM_IRQ_MAX_DEPENDENTS];
 	bool                            delayed_global_clear;
+	struct cam_irq_evt_handler     *th_slot[CAM_IRQ_MAX_INDEXED_HANDLERS];
+	uint64_t                       *th_bit_index;
+	uint64_t                        th_prio_slots[CAM_IRQ_PRIORITY_MAX];
+	uint32_t                        th_num_slots;
+	bool                            th_indexed;
+	struct task_struct             *th_task;
+	bool                            status_latched;
+	bool                            threaded;
+	spinlock_t                      latch_lock;
 
 #ifdef CONFIG_CAM_PRESIL
 	struct mutex                    lock;
@@ -127,6 +157,12 @@ struct cam_irq_controller {
 #endif
 };
 
+/* True if called from top half processing, hard IRQ or IRQ thread */
+static inline bool cam_irq_controller_in_th(struct cam_irq_controller *controller)
+{
+	return in_irq() || (READ_ONCE(controller->th_task) == current);
+}
+
 #ifdef CONFIG_CAM_PRESIL
 static inline void cam_irq_controller_lock_init(struct cam_irq_controller *controller)
 {
@@ -156,7 +192,42 @@ static inline void cam_irq_controller_unlock(struct cam_irq_controller *controll
 {
 	mutex_unlock(&controller->lock);
 }
+
+static inline unsigned long cam_irq_controller_lock_thread(
+	struct cam_irq_controller *controller)
+{
+	mutex_lock(&controller->lock);
+
+	return 0;
+}
+
+static inline void cam_irq_controller_unlock_thread(
+	struct cam_irq_controller *controller, unsigned long flags)
+{
+	mutex_unlock(&controller->lock);
+}
+
+static inline unsigned long cam_irq_controller_lock_dep(
+	struct cam_irq_controller *controller)
+{
+	mutex_lock(&controller->lock);
+
+	return 0;
+}
+
+static inline void cam_irq_controller_unlock_dep(
+	struct cam_irq_controller *controller, unsigned long flags)
+{
+	mutex_unlock(&controller->lock);
+}
+
+static inline void cam_irq_controller_set_lock_class(
+	struct cam_irq_controller *controller)
+{
+}
 #else
+static struct lock_class_key cam_irq_controller_thread_lock_key;
+
 static inline void cam_irq_controller_lock_init(struct cam_irq_controller *controller)
 {
 	spin_lock_init(&controller->lock);
@@ -167,7 +238,7 @@ static inline unsigned long cam_irq_controller_lock_irqsave(
 {
 	unsigned long flags = 0;
 
-	if (!in_irq())
+	if (!cam_irq_controller_in_th(controller))
 		spin_lock_irqsave(&controller->lock, flags);
 
 	return flags;
@@ -176,7 +247,7 @@ static inline unsigned long cam_irq_controller_lock_irqsave(
 static inline void cam_irq_controller_unlock_irqrestore(
 	struct cam_irq_controller *controller, unsigned long flags)
 {
-	if (!in_irq())
+	if (!cam_irq_controller_in_th(controller))
 		spin_unlock_irqrestore(&controller->lock, flags);
 }
 
@@ -189,9 +260,181 @@ static inline void cam_irq_controller_unlock(struct cam_irq_controller *controll
 {
 	spin_unlock(&controller->lock);
 }
+
+/*
+ * Lock for top half processing outside hard IRQ. The hard IRQ of a threaded
+ * controller never takes this lock, so the IRQ thread keeps interrupts
+ * enabled and only holds off bottom halves that may update the handlers.
+ */
+static inline unsigned long cam_irq_controller_lock_thread(
+	struct cam_irq_controller *controller)
+{
+	unsigned long flags = 0;
+
+	if (controller->threaded)
+		spin_lock_bh(&controller->lock);
+	else
+		spin_lock_irqsave(&controller->lock, flags);
+
+	return flags;
+}
+
+static inline void cam_irq_controller_unlock_thread(
+	struct cam_irq_controller *controller, unsigned long flags)
+{
+	if (controller->threaded)
+		spin_unlock_bh(&controller->lock);
+	else
+		spin_unlock_irqrestore(&controller->lock, flags);
+}
+
+/* Lock a dependent controller for its status read by the primary */
+static inline unsigned long cam_irq_controller_lock_dep(
+	struct cam_irq_controller *controller)
+{
+	unsigned long flags = 0;
+
+	if (controller->threaded)
+		spin_lock_irqsave_nested(&controller->latch_lock, flags,
+			SINGLE_DEPTH_NESTING);
+	else
+		spin_lock_irqsave(&controller->lock, flags);
+
+	return flags;
+}
+
+static inline void cam_irq_controller_unlock_dep(
+	struct cam_irq_controller *controller, unsigned long flags)
+{
+	if (controller->threaded)
+		spin_unlock_irqrestore(&controller->latch_lock, flags);
+	else
+		spin_unlock_irqrestore(&controller->lock, flags);
+}
+
+/*
+ * Threaded controllers take lock with interrupts enabled, keep them in their
+ * own class so lockdep does not mix them up with hard IRQ controllers.
+ */
+static inline void cam_irq_controller_set_lock_class(
+	struct cam_irq_controller *controller)
+{
+	lockdep_set_class(&controller->lock,
+		&cam_irq_controller_thread_lock_key);
+}
 #endif
 
+static inline uint64_t *cam_irq_controller_bit_index(
+	struct cam_irq_controller *controller, int reg, int bit)
+{
+	return &controller->th_bit_index[(reg * CAM_IRQ_BITS_PER_REGISTER) + bit];
+}
 
+/**
+ * cam_irq_controller_index_handler()
+ *
+ * @Brief:                Add or remove the status bits of an indexed handler
+ *                        to/from the per bit dispatch index
+ *
+ * @controller:           IRQ Controller structure
+ * @evt_handler:          Event handler structure
+ * @add:                  True to add the handler bits, false to remove them
+ */
+static void cam_irq_controller_index_handler(
+	struct cam_irq_controller   *controller,
+	struct cam_irq_evt_handler  *evt_handler,
+	bool                         add)
+{
+	uint64_t slot_mask;
+	unsigned long bits;
+	int i, bit;
+
+	if (!controller->th_indexed || evt_handler->th_slot < 0)
+		return;
+
+	slot_mask = BIT_ULL(evt_handler->th_slot);
+	for (i = 0; i < controller->num_registers; i++) {
+		bits = evt_handler->evt_bit_mask_arr[i];
+		for_each_set_bit(bit, &bits, CAM_IRQ_BITS_PER_REGISTER) {
+			if (add)
+				*cam_irq_controller_bit_index(controller, i, bit) |= slot_mask;
+			else
+				*cam_irq_controller_bit_index(controller, i, bit) &= ~slot_mask;
+		}
+	}
+}
+
+/**
+ * cam_irq_controller_rebuild_th_index()
+ *
+ * @Brief:                Reassign dispatch slots to all subscribed handlers in
+ *                        priority then subscription order and rebuild the per
+ *                        bit index. Called with the controller lock held.
+ *
+ * @controller:           IRQ Controller structure
+ */
+static void cam_irq_controller_rebuild_th_index(
+	struct cam_irq_controller *controller)
+{
+	struct cam_irq_evt_handler *evt_handler;
+	uint32_t num_slots = 0;
+	int i;
+
+	memset(controller->th_bit_index, 0, controller->num_registers *
+		CAM_IRQ_BITS_PER_REGISTER * sizeof(uint64_t));
+	memset(controller->th_prio_slots, 0, sizeof(controller->th_prio_slots));
+	memset(controller->th_slot, 0, sizeof(controller->th_slot));
+	controller->th_indexed = true;
+
+	for (i = 0; i < CAM_IRQ_PRIORITY_MAX; i++) {
+		list_for_each_entry(evt_handler, &controller->th_list_head[i], th_list_node) {
+			if (num_slots >= CAM_IRQ_MAX_INDEXED_HANDLERS) {
+				controller->th_indexed = false;
+				break;
+			}
+
+			evt_handler->th_slot = num_slots;
+			controller->th_slot[num_slots] = evt_handler;
+			controller->th_prio_slots[i] |= BIT_ULL(num_slots);
+			cam_irq_controller_index_handler(controller, evt_handler, true);
+			num_slots++;
+		}
+	}
+
+	controller->th_num_slots = num_slots;
+	if (!controller->th_indexed) {
+		CAM_WARN(CAM_IRQ_CTRL, "%s: more than %d handlers, using list dispatch",
+			controller->name, CAM_IRQ_MAX_INDEXED_HANDLERS);
+		list_for_each_entry(evt_handler, &controller->evt_handler_list_head, list_node)
+			evt_handler->th_slot = -1;
+	}
+}
+
+/**
+ * cam_irq_controller_unindex_handler()
+ *
+ * @Brief:                Drop a handler from the dispatch index in place. Slots
+ *                        of other handlers are left untouched so that a top
+ *                        half dispatch in progress is not affected.
+ *
+ * @controller:           IRQ Controller structure
+ * @evt_handler:          Event handler structure
+ */
+static void cam_irq_controller_unindex_handler(
+	struct cam_irq_controller   *controller,
+	struct cam_irq_evt_handler  *evt_handler)
+{
+	int i, slot = evt_handler->th_slot;
+
+	if (!controller->th_indexed || slot < 0)
+		return;
+
+	cam_irq_controller_index_handler(controller, evt_handler, false);
+	for (i = 0; i < CAM_IRQ_PRIORITY_MAX; i++)
+		controller->th_prio_slots[i] &= ~BIT_ULL(slot);
+	controller->th_slot[slot] = NULL;
+	evt_handler->th_slot = -1;
+}
 
 int cam_irq_controller_unregister_dependent(void *primary_controller, void *secondary_controller)
 {
@@ -261,6 +504,10 @@ int cam_irq_controller_register_dependent(void *primary_controller, void *second
 		ctrl_primary->irq_register_arr[i].dependent_read_mask[dep_idx] = mask[i];
 	ctrl_secondary->is_dependent = true;
 
+	/* Dependents are handled from the top halves of the primary */
+	if (ctrl_primary->threaded)
+		cam_irq_controller_set_threaded(ctrl_secondary, true);
+
 	/**
 	 * NOTE: For dependent controllers that should not issue global clear command,
 	 * set their global_clear_offset to 0
@@ -278,25 +525,28 @@ static inline void cam_irq_controller_clear_irq(
 	struct cam_irq_evt_handler *evt_handler)
 {
 	struct cam_irq_register_obj *irq_register;
+	struct cam_io_txn txn;
 	int i;
 
 	/* Don't clear in IRQ context since global clear will be issued after
 	 * top half processing
 	 */
-	if (in_irq())
+	if (cam_irq_controller_in_th(controller))
 		return;
 
+	cam_io_txn_begin(&txn);
 	for (i = 0; i < controller->num_registers; i++) {
 		irq_register = &controller->irq_register_arr[i];
-		cam_io_w_mb(evt_handler->evt_bit_mask_arr[i],
+		cam_io_txn_w(&txn, evt_handler->evt_bit_mask_arr[i],
 				controller->mem_base +
 				irq_register->clear_reg_offset);
 	}
 
 	if (controller->global_clear_offset)
-		cam_io_w_mb(controller->global_clear_bitmask,
+		cam_io_txn_w(&txn, controller->global_clear_bitmask,
 				controller->mem_base +
 				controller->global_clear_offset);
+	cam_io_txn_commit(&txn);
 }
 
 int cam_irq_controller_deinit(void **irq_controller)
@@ -318,6 +568,7 @@ int cam_irq_controller_deinit(void **irq_controller)
 		kfree(evt_handler);
 	}
 
+	kfree(controller->th_bit_index);
 	kfree(controller->th_payload.evt_status_arr);
 	kfree(controller->irq_status_arr);
 	kfree(controller->irq_register_arr);
@@ -375,6 +626,15 @@ int cam_irq_controller_init(const char       *name,
 		goto evt_mask_alloc_error;
 	}
 
+	controller->th_bit_index = kcalloc(register_info->num_registers *
+		CAM_IRQ_BITS_PER_REGISTER, sizeof(uint64_t), GFP_KERNEL);
+	if (!controller->th_bit_index) {
+		CAM_DBG(CAM_IRQ_CTRL, "Failed to allocate TH bit index");
+		rc = -ENOMEM;
+		goto bit_index_alloc_error;
+	}
+	controller->th_indexed = true;
+
 	controller->name = name;
 
 	CAM_DBG(CAM_IRQ_CTRL, "num_registers: %d",
@@ -413,12 +673,15 @@ int cam_irq_controller_init(const char       *name,
 		INIT_LIST_HEAD(&controller->th_list_head[i]);
 
 	cam_irq_controller_lock_init(controller);
+	spin_lock_init(&controller->latch_lock);
 
 	controller->hdl_idx = 1;
 	*irq_controller = controller;
 
 	return rc;
 
+bit_index_alloc_error:
+	kfree(controller->th_payload.evt_status_arr);
 evt_mask_alloc_error:
 	kfree(controller->irq_status_arr);
 status_alloc_error:
@@ -434,19 +697,22 @@ static inline void __cam_irq_controller_disable_irq(
 	struct cam_irq_evt_handler *evt_handler)
 {
 	struct cam_irq_register_obj *irq_register;
+	struct cam_io_txn txn;
 	uint32_t *update_mask;
 	int i, priority;
 
 	update_mask = evt_handler->evt_bit_mask_arr;
 	priority    = evt_handler->priority;
 
+	cam_io_txn_begin(&txn);
 	for (i = 0; i < controller->num_registers; i++) {
 		irq_register = &controller->irq_register_arr[i];
 		irq_register->top_half_enable_mask[priority] &= ~update_mask[i];
 		irq_register->aggr_mask &= ~update_mask[i];
-		cam_io_w_mb(irq_register->aggr_mask, controller->mem_base +
-			irq_register->mask_reg_offset);
+		cam_io_txn_w(&txn, irq_register->aggr_mask,
+			controller->mem_base + irq_register->mask_reg_offset);
 	}
+	cam_io_txn_commit(&txn);
 }
 
 static inline void __cam_irq_controller_enable_irq(
@@ -454,19 +720,22 @@ static inline void __cam_irq_controller_enable_irq(
 	struct cam_irq_evt_handler *evt_handler)
 {
 	struct cam_irq_register_obj *irq_register;
+	struct cam_io_txn txn;
 	uint32_t *update_mask;
 	int i, priority;
 
 	update_mask = evt_handler->evt_bit_mask_arr;
 	priority    = evt_handler->priority;
 
+	cam_io_txn_begin(&txn);
 	for (i = 0; i < controller->num_registers; i++) {
 		irq_register = &controller->irq_register_arr[i];
 		irq_register->top_half_enable_mask[priority] |= update_mask[i];
 		irq_register->aggr_mask |= update_mask[i];
-		cam_io_w_mb(irq_register->aggr_mask, controller->mem_base +
-			irq_register->mask_reg_offset);
+		cam_io_txn_w(&txn, irq_register->aggr_mask,
+			controller->mem_base + irq_register->mask_reg_offset);
 	}
+	cam_io_txn_commit(&txn);
 }
 
 int cam_irq_controller_subscribe_irq(void *irq_controller,
@@ -552,6 +821,7 @@ int cam_irq_controller_subscribe_irq(void *irq_controller,
 	evt_handler->bottom_half              = bottom_half;
 	evt_handler->index                    = controller->hdl_idx++;
 	evt_handler->group                    = evt_grp;
+	evt_handler->th_slot                  = -1;
 
 	if (irq_bh_api)
 		evt_handler->irq_bh_api       = *irq_bh_api;
@@ -568,6 +838,7 @@ int cam_irq_controller_subscribe_irq(void *irq_controller,
 		&controller->evt_handler_list_head);
 	list_add_tail(&evt_handler->th_list_node,
 		&controller->th_list_head[priority]);
+	cam_irq_controller_rebuild_th_index(controller);
 
 	cam_irq_controller_unlock_irqrestore(controller, flags);
 
@@ -669,6 +940,7 @@ int cam_irq_controller_unsubscribe_irq(void *irq_controller,
 
 	list_del_init(&evt_handler->list_node);
 	list_del_init(&evt_handler->th_list_node);
+	cam_irq_controller_unindex_handler(controller, evt_handler);
 
 	__cam_irq_controller_disable_irq(controller, evt_handler);
 	cam_irq_controller_clear_irq(controller, evt_handler);
@@ -714,6 +986,99 @@ static bool cam_irq_controller_match_bit_mask(
 	return false;
 }
 
+/**
+ * cam_irq_controller_handler_enabled()
+ *
+ * @Brief:                Check that a handler still has top half enabled for
+ *                        at least one of the status bits that are set. An
+ *                        earlier top half of the same dispatch may have
+ *                        disabled or updated it after the slots were picked.
+ *
+ * @controller:           IRQ Controller structure
+ * @evt_handler:          Event handler structure
+ *
+ * @Return:               True: If an enabled, interested IRQ Bit is Set
+ *                        False: Otherwise
+ */
+static bool cam_irq_controller_handler_enabled(
+	struct cam_irq_controller   *controller,
+	struct cam_irq_evt_handler  *evt_handler)
+{
+	struct cam_irq_register_obj *irq_register;
+	int i, priority = evt_handler->priority;
+
+	for (i = 0; i < controller->num_registers; i++) {
+		irq_register = &controller->irq_register_arr[i];
+		if (evt_handler->evt_bit_mask_arr[i] &
+			controller->irq_status_arr[i] &
+			irq_register->top_half_enable_mask[priority])
+			return true;
+	}
+
+	return false;
+}
+
+static void __cam_irq_controller_th_dispatch(
+	struct cam_irq_controller      *controller,
+	struct cam_irq_evt_handler     *evt_handler)
+{
+	struct cam_irq_th_payload      *th_payload = &controller->th_payload;
+	int                             rc = -EINVAL;
+	int                             i;
+	void                           *bh_cmd = NULL;
+	struct cam_irq_bh_api          *irq_bh_api = NULL;
+
+	CAM_DBG(CAM_IRQ_CTRL, "match found");
+
+	cam_irq_th_payload_init(th_payload);
+	th_payload->handler_priv  = evt_handler->handler_priv;
+	th_payload->num_registers = controller->num_registers;
+	for (i = 0; i < controller->num_registers; i++) {
+		th_payload->evt_status_arr[i] =
+			controller->irq_status_arr[i] &
+			evt_handler->evt_bit_mask_arr[i];
+	}
+
+	irq_bh_api = &evt_handler->irq_bh_api;
+
+	if (evt_handler->bottom_half_handler) {
+		rc = irq_bh_api->get_bh_payload_func(
+			evt_handler->bottom_half, &bh_cmd);
+		if (rc || !bh_cmd) {
+			CAM_ERR_RATE_LIMIT(CAM_ISP,
+				"No payload, IRQ handling frozen for %s",
+				controller->name);
+			return;
+		}
+	}
+
+	/*
+	 * irq_status_arr[0] is dummy argument passed. the entire
+	 * status array is passed in th_payload.
+	 */
+	if (evt_handler->top_half_handler)
+		rc = evt_handler->top_half_handler(
+			controller->irq_status_arr[0],
+			(void *)th_payload);
+
+	if (rc && bh_cmd) {
+		irq_bh_api->put_bh_payload_func(
+			evt_handler->bottom_half, &bh_cmd);
+		return;
+	}
+
+	if (evt_handler->bottom_half_handler) {
+		CAM_DBG(CAM_IRQ_CTRL, "Enqueuing bottom half for %s",
+			controller->name);
+		irq_bh_api->bottom_half_enqueue_func(
+			evt_handler->bottom_half,
+			bh_cmd,
+			evt_handler->handler_priv,
+			th_payload->evt_payload_priv,
+			evt_handler->bottom_half_handler);
+	}
+}
+
 static void __cam_irq_controller_th_processing(
 	struct cam_irq_controller      *controller,
 	struct list_head               *th_list_head,
@@ -721,12 +1086,7 @@ static void __cam_irq_controller_th_processing(
 {
 	struct cam_irq_evt_handler     *evt_handler = NULL;
 	struct cam_irq_evt_handler     *evt_handler_tmp = NULL;
-	struct cam_irq_th_payload      *th_payload = &controller->th_payload;
 	bool                            is_irq_match;
-	int                             rc = -EINVAL;
-	int                             i;
-	void                           *bh_cmd = NULL;
-	struct cam_irq_bh_api          *irq_bh_api = NULL;
 
 	CAM_DBG(CAM_IRQ_CTRL, "Enter");
 
@@ -736,59 +1096,66 @@ static void __cam_irq_controller_th_processing(
 	list_for_each_entry_safe(evt_handler, evt_handler_tmp, th_list_head, th_list_node) {
 		is_irq_match = cam_irq_controller_match_bit_mask(controller, evt_handler, evt_grp);
 
-		if (!is_irq_match)
+		if (!is_irq_match ||
+			!cam_irq_controller_handler_enabled(controller, evt_handler))
 			continue;
 
-		CAM_DBG(CAM_IRQ_CTRL, "match found");
+		__cam_irq_controller_th_dispatch(controller, evt_handler);
+	}
 
-		cam_irq_th_payload_init(th_payload);
-		th_payload->handler_priv  = evt_handler->handler_priv;
-		th_payload->num_registers = controller->num_registers;
-		for (i = 0; i < controller->num_registers; i++) {
-			th_payload->evt_status_arr[i] =
-				controller->irq_status_arr[i] &
-				evt_handler->evt_bit_mask_arr[i];
-		}
+	CAM_DBG(CAM_IRQ_CTRL, "Exit");
+}
 
-		irq_bh_api = &evt_handler->irq_bh_api;
-		bh_cmd = NULL;
-
-		if (evt_handler->bottom_half_handler) {
-			rc = irq_bh_api->get_bh_payload_func(
-				evt_handler->bottom_half, &bh_cmd);
-			if (rc || !bh_cmd) {
-				CAM_ERR_RATE_LIMIT(CAM_ISP,
-					"No payload, IRQ handling frozen for %s",
-					controller->name);
-				continue;
-			}
-		}
+/**
+ * cam_irq_controller_get_pending_slots()
+ *
+ * @Brief:                Collect dispatch slots of handlers subscribed to any
+ *                        of the status bits that are set, touching only the
+ *                        bits that fired
+ *
+ * @controller:           IRQ Controller structure
+ *
+ * @Return:               Mask of th_slot entries to be dispatched
+ */
+static uint64_t cam_irq_controller_get_pending_slots(
+	struct cam_irq_controller *controller)
+{
+	uint64_t pending = 0;
+	unsigned long status;
+	int i, bit;
+
+	for (i = 0; i < controller->num_registers; i++) {
+		status = controller->irq_status_arr[i];
+		for_each_set_bit(bit, &status, CAM_IRQ_BITS_PER_REGISTER)
+			pending |= *cam_irq_controller_bit_index(controller, i, bit);
+	}
+
+	return pending;
+}
+
+static void __cam_irq_controller_th_processing_indexed(
+	struct cam_irq_controller      *controller,
+	uint64_t                        pending,
+	int                             evt_grp)
+{
+	struct cam_irq_evt_handler     *evt_handler = NULL;
+	int                             slot;
 
-		/*
-		 * irq_status_arr[0] is dummy argument passed. the entire
-		 * status array is passed in th_payload.
-		 */
-		if (evt_handler->top_half_handler)
-			rc = evt_handler->top_half_handler(
-				controller->irq_status_arr[0],
-				(void *)th_payload);
-
-		if (rc && bh_cmd) {
-			irq_bh_api->put_bh_payload_func(
-				evt_handler->bottom_half, &bh_cmd);
+	CAM_DBG(CAM_IRQ_CTRL, "Enter pending: 0x%llx", pending);
+
+	while (pending) {
+		slot = __ffs64(pending);
+		pending &= ~BIT_ULL(slot);
+
+		evt_handler = controller->th_slot[slot];
+		if (!evt_handler ||
+			!cam_irq_controller_match_bit_mask(controller,
+				evt_handler, evt_grp) ||
+			!cam_irq_controller_handler_enabled(controller,
+				evt_handler))
 			continue;
-		}
 
-		if (evt_handler->bottom_half_handler) {
-			CAM_DBG(CAM_IRQ_CTRL, "Enqueuing bottom half for %s",
-				controller->name);
-			irq_bh_api->bottom_half_enqueue_func(
-				evt_handler->bottom_half,
-				bh_cmd,
-				evt_handler->handler_priv,
-				th_payload->evt_payload_priv,
-				evt_handler->bottom_half_handler);
-		}
+		__cam_irq_controller_th_dispatch(controller, evt_handler);
 	}
 
 	CAM_DBG(CAM_IRQ_CTRL, "Exit");
@@ -798,27 +1165,31 @@ void cam_irq_controller_disable_all(void *priv)
 {
 	struct cam_irq_controller  *controller  = priv;
 	struct cam_irq_register_obj *irq_register;
+	struct cam_io_txn txn;
 
 	uint32_t i = 0;
 
 	if (!controller)
 		return;
 
+	cam_io_txn_begin(&txn);
 	for (i = 0; i < controller->num_registers; i++) {
 		irq_register = &controller->irq_register_arr[i];
 		memset(irq_register->top_half_enable_mask, 0, CAM_IRQ_PRIORITY_MAX);
 		irq_register->aggr_mask = 0;
-		cam_io_w_mb(0x0, controller->mem_base + irq_register->mask_reg_offset);
-		cam_io_w_mb(controller->clear_all_bitmask, controller->mem_base +
-			irq_register->clear_reg_offset);
+		cam_io_txn_w(&txn, 0x0,
+			controller->mem_base + irq_register->mask_reg_offset);
+		cam_io_txn_w(&txn, controller->clear_all_bitmask,
+			controller->mem_base + irq_register->clear_reg_offset);
 	}
 
 	if (controller->global_clear_offset && !controller->delayed_global_clear) {
-		cam_io_w_mb(controller->global_clear_bitmask,
+		cam_io_txn_w(&txn, controller->global_clear_bitmask,
 			controller->mem_base + controller->global_clear_offset);
 		CAM_DBG(CAM_IRQ_CTRL, "Global Clear done from %s",
 			controller->name);
 	}
+	cam_io_txn_commit(&txn);
 }
 
 static void __cam_irq_controller_read_registers(struct cam_irq_controller *controller)
@@ -830,7 +1201,7 @@ static void __cam_irq_controller_read_registers(struct cam_irq_controller *contr
 		irq_register = &controller->irq_register_arr[i];
 
 		/* Skip register read if we are not going to process it */
-		if (!irq_register->aggr_mask) {
+		if (!READ_ONCE(irq_register->aggr_mask)) {
 			controller->irq_status_arr[i] = 0;
 			continue;
 		}
@@ -859,6 +1230,7 @@ static void cam_irq_controller_read_registers(struct cam_irq_controller *control
 	struct cam_irq_register_obj *irq_register;
 	struct cam_irq_controller *dep_controller;
 	bool need_reg_read[CAM_IRQ_MAX_DEPENDENTS] = {false};
+	unsigned long flags;
 	int i, j;
 
 	__cam_irq_controller_read_registers(controller);
@@ -878,9 +1250,9 @@ static void cam_irq_controller_read_registers(struct cam_irq_controller *control
 			dep_controller = controller->dependent_controller[j];
 			CAM_DBG(CAM_IRQ_CTRL, "Reading dependent registers for %s",
 				dep_controller->name);
-			cam_irq_controller_lock(dep_controller);
+			flags = cam_irq_controller_lock_dep(dep_controller);
 			__cam_irq_controller_read_registers(dep_controller);
-			cam_irq_controller_unlock(dep_controller);
+			cam_irq_controller_unlock_dep(dep_controller, flags);
 		}
 	}
 
@@ -892,13 +1264,30 @@ static void cam_irq_controller_read_registers(struct cam_irq_controller *control
 	}
 }
 
+static bool cam_irq_controller_consume_latch(
+	struct cam_irq_controller *controller)
+{
+	unsigned long flags;
+	bool latched;
+
+	if (!controller->threaded)
+		return false;
+
+	spin_lock_irqsave(&controller->latch_lock, flags);
+	latched = controller->status_latched;
+	controller->status_latched = false;
+	spin_unlock_irqrestore(&controller->latch_lock, flags);
+
+	return latched;
+}
+
 static void cam_irq_controller_process_th(struct cam_irq_controller *controller, int evt_grp)
 {
 	struct cam_irq_register_obj *irq_register;
 	bool need_th_processing[CAM_IRQ_PRIORITY_MAX] = {false};
+	uint64_t pending = 0;
 	int i, j;
 
-
 	for (i = 0; i < controller->num_registers; i++) {
 		irq_register = &controller->irq_register_arr[i];
 		for (j = 0; j < CAM_IRQ_PRIORITY_MAX; j++) {
@@ -909,41 +1298,103 @@ static void cam_irq_controller_process_th(struct cam_irq_controller *controller,
 		}
 	}
 
+	if (controller->th_indexed)
+		pending = cam_irq_controller_get_pending_slots(controller);
+
 	for (i = 0; i < CAM_IRQ_PRIORITY_MAX; i++) {
-		if (need_th_processing[i]) {
-			CAM_DBG(CAM_IRQ_CTRL, "(%s) Invoke TH processing priority:%d",
-				controller->name, i);
-			__cam_irq_controller_th_processing(controller, &controller->th_list_head[i],
-				evt_grp);
-		}
+		if (!need_th_processing[i])
+			continue;
+
+		CAM_DBG(CAM_IRQ_CTRL, "(%s) Invoke TH processing priority:%d",
+			controller->name, i);
+		if (controller->th_indexed)
+			__cam_irq_controller_th_processing_indexed(controller,
+				pending & controller->th_prio_slots[i], evt_grp);
+		else
+			__cam_irq_controller_th_processing(controller,
+				&controller->th_list_head[i], evt_grp);
 	}
 }
 
 irqreturn_t cam_irq_controller_handle_irq(int irq_num, void *priv, int evt_grp)
 {
 	struct cam_irq_controller *controller  = priv;
+	unsigned long              flags = 0;
+	bool                       is_hardirq = in_irq();
+	bool                       latched;
+	ktime_t                    start;
 
 	if (unlikely(!controller))
 		return IRQ_NONE;
 
+	start = cam_req_mgr_debug_lat_start(CAM_REQ_MGR_LAT_IRQ_TH);
+
 	CAM_DBG(CAM_IRQ_CTRL,
 		"Locking: %s IRQ Controller: [%pK], lock handle: %pK",
 		controller->name, controller, &controller->lock);
-	cam_irq_controller_lock(controller);
 
-	if (!controller->is_dependent)
+	if (is_hardirq) {
+		cam_irq_controller_lock(controller);
+	} else {
+		flags = cam_irq_controller_lock_thread(controller);
+		WRITE_ONCE(controller->th_task, current);
+	}
+
+	/*
+	 * Threaded IRQ status is read and cleared by the hard IRQ, the line
+	 * stays masked (IRQF_ONESHOT) until the thread is done with it.
+	 */
+	latched = cam_irq_controller_consume_latch(controller);
+	if (!controller->is_dependent && !latched)
 		cam_irq_controller_read_registers(controller);
 
 	cam_irq_controller_process_th(controller, evt_grp);
 
-	cam_irq_controller_unlock(controller);
+	if (is_hardirq) {
+		cam_irq_controller_unlock(controller);
+	} else {
+		WRITE_ONCE(controller->th_task, NULL);
+		cam_irq_controller_unlock_thread(controller, flags);
+	}
 	CAM_DBG(CAM_IRQ_CTRL,
 		"Unlocked: %s IRQ Controller: %pK, lock handle: %pK",
 		controller->name, controller, &controller->lock);
 
+	cam_req_mgr_debug_lat_record(CAM_REQ_MGR_LAT_IRQ_TH,
+		CAM_REQ_MGR_LAT_INST_MAX, start);
+
 	return IRQ_HANDLED;
 }
 
+irqreturn_t cam_irq_controller_latch_irq(void *priv)
+{
+	struct cam_irq_controller *controller  = priv;
+
+	if (unlikely(!controller))
+		return IRQ_NONE;
+
+	spin_lock(&controller->latch_lock);
+	cam_irq_controller_read_registers(controller);
+	controller->status_latched = true;
+	spin_unlock(&controller->latch_lock);
+
+	return IRQ_WAKE_THREAD;
+}
+
+void cam_irq_controller_set_threaded(void *irq_controller, bool threaded)
+{
+	struct cam_irq_controller *controller = irq_controller;
+
+	if (!controller)
+		return;
+
+	if (threaded && !controller->threaded)
+		cam_irq_controller_set_lock_class(controller);
+	controller->threaded = threaded;
+
+	CAM_DBG(CAM_IRQ_CTRL, "%s threaded %d", controller->name, threaded);
+}
+
 int cam_irq_controller_update_irq(void *irq_controller, uint32_t handle,
 	bool enable, uint32_t *irq_mask)
 {
@@ -964,6 +1415,7 @@ int cam_irq_controller_update_irq(void *irq_controller, uint32_t handle,
 		goto end;
 
 	__cam_irq_controller_disable_irq(controller, evt_handler);
+	cam_irq_controller_index_handler(controller, evt_handler, false);
 	for (i = 0; i < controller->num_registers; i++) {
 		if (enable) {
 			evt_handler->evt_bit_mask_arr[i] |= irq_mask[i];
@@ -971,6 +1423,7 @@ int cam_irq_controller_update_irq(void *irq_controller, uint32_t handle,
 			evt_handler->evt_bit_mask_arr[i] &= ~irq_mask[i];
 		}
 	}
+	cam_irq_controller_index_handler(controller, evt_handler, true);
 	__cam_irq_controller_enable_irq(controller, evt_handler);
 	cam_irq_controller_clear_irq(controller, evt_handler);
 
@@ -979,3 +1432,7 @@ end:
 
 	return rc;
 }
+
+#ifdef CONFIG_SPECTRA_KUNIT_TEST
+#include "cam_irq_controller_test.c"
+#endif
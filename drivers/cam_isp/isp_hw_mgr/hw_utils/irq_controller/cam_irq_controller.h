@@ -10,6 +10,9 @@
 
 #define CAM_IRQ_BITS_PER_REGISTER      32
 
+/* Max handlers per controller dispatched through the per bit index */
+#define CAM_IRQ_MAX_INDEXED_HANDLERS   64
+
 /*
  * enum cam_irq_priority_level:
  * @Brief:                  Priority levels for IRQ events.
@@ -236,6 +239,39 @@ int cam_irq_controller_deinit(void **irq_controller);
  */
 irqreturn_t cam_irq_controller_handle_irq(int irq_num, void *priv, int evt_grp);
 
+/*
+ * cam_irq_controller_latch_irq()
+ *
+ * @brief:              Hard IRQ half of a threaded IRQ. Reads and clears the
+ *                      status registers of the controller and its dependent
+ *                      controllers, and leaves the top halves to
+ *                      cam_irq_controller_handle_irq() in the IRQ thread.
+ *                      The IRQ must be requested with IRQF_ONESHOT so the
+ *                      latched status is not overwritten before the thread
+ *                      has run.
+ *
+ * @priv:               Pointer to the primary IRQ Controller
+ *
+ * @return:             IRQ_WAKE_THREAD/IRQ_NONE
+ */
+irqreturn_t cam_irq_controller_latch_irq(void *priv);
+
+/*
+ * cam_irq_controller_set_threaded()
+ *
+ * @brief:              Mark a controller as handled from an IRQ thread, with
+ *                      cam_irq_controller_latch_irq() as its hard IRQ. Top
+ *                      halves then run with interrupts enabled. Dependents
+ *                      registered later inherit the mode. Must be called
+ *                      before the IRQ is enabled.
+ *
+ * @irq_controller:     Pointer to IRQ Controller
+ * @threaded:           True if the IRQ line is requested as threaded
+ *
+ * @return:             None
+ */
+void cam_irq_controller_set_threaded(void *irq_controller, bool threaded);
+
 /*
  * cam_irq_controller_disable_irq()
  *
@@ -0,0 +1,304 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ */
+
+/*
+ * KUnit tests for the IRQ controller, built into cam_irq_controller.c so the
+ * controller internals are visible. Registers are backed by memory, status
+ * is raised by writing the status register before calling the handler.
+ */
+
+#include "cam_kunit.h"
+
+#define CAM_IRQ_TEST_NUM_REGS          2
+#define CAM_IRQ_TEST_MASK_OFFSET       0x00
+#define CAM_IRQ_TEST_CLEAR_OFFSET      0x10
+#define CAM_IRQ_TEST_STATUS_OFFSET     0x20
+#define CAM_IRQ_TEST_GLOBAL_CLEAR      0x30
+#define CAM_IRQ_TEST_REG_SIZE          0x40
+#define CAM_IRQ_TEST_BENCH_ITER        10000
+
+struct cam_irq_test_handler {
+	void       *controller;
+	int         calls;
+	uint32_t    status[CAM_IRQ_TEST_NUM_REGS];
+	int         disable_hdl;
+};
+
+struct cam_irq_test_ctx {
+	void __iomem                       *regs;
+	void                               *controller;
+	struct cam_irq_register_set         reg_set[CAM_IRQ_TEST_NUM_REGS];
+	struct cam_irq_controller_reg_info  reg_info;
+};
+
+static int cam_irq_test_top_half(uint32_t evt_id,
+	struct cam_irq_th_payload *th_payload)
+{
+	struct cam_irq_test_handler *handler = th_payload->handler_priv;
+	int i;
+
+	handler->calls++;
+	for (i = 0; i < CAM_IRQ_TEST_NUM_REGS; i++)
+		handler->status[i] = th_payload->evt_status_arr[i];
+
+	if (handler->disable_hdl)
+		cam_irq_controller_disable_irq(handler->controller,
+			handler->disable_hdl);
+
+	return 0;
+}
+
+static int cam_irq_test_subscribe(struct cam_irq_test_ctx *ctx,
+	struct cam_irq_test_handler *handler, enum cam_irq_priority_level prio,
+	uint32_t mask0, uint32_t mask1, enum cam_irq_event_group evt_grp)
+{
+	uint32_t mask[CAM_IRQ_TEST_NUM_REGS] = {mask0, mask1};
+
+	handler->controller = ctx->controller;
+
+	return cam_irq_controller_subscribe_irq(ctx->controller, prio, mask,
+		handler, cam_irq_test_top_half, NULL, NULL, NULL, evt_grp);
+}
+
+static void cam_irq_test_raise(struct cam_irq_test_ctx *ctx,
+	uint32_t status0, uint32_t status1)
+{
+	cam_kunit_reg_w(ctx->regs, CAM_IRQ_TEST_STATUS_OFFSET, status0);
+	cam_kunit_reg_w(ctx->regs, CAM_IRQ_TEST_STATUS_OFFSET + 4, status1);
+	cam_irq_controller_handle_irq(0, ctx->controller, CAM_IRQ_EVT_GROUP_0);
+}
+
+static int cam_irq_test_init(struct kunit *test)
+{
+	struct cam_irq_test_ctx *ctx;
+	int i, rc;
+
+	ctx = kunit_kzalloc(test, sizeof(*ctx), GFP_KERNEL);
+	if (!ctx)
+		return -ENOMEM;
+
+	ctx->regs = cam_kunit_alloc_regs(test, CAM_IRQ_TEST_REG_SIZE);
+	if (!ctx->regs)
+		return -ENOMEM;
+
+	for (i = 0; i < CAM_IRQ_TEST_NUM_REGS; i++) {
+		ctx->reg_set[i].mask_reg_offset =
+			CAM_IRQ_TEST_MASK_OFFSET + (i * 4);
+		ctx->reg_set[i].clear_reg_offset =
+			CAM_IRQ_TEST_CLEAR_OFFSET + (i * 4);
+		ctx->reg_set[i].status_reg_offset =
+			CAM_IRQ_TEST_STATUS_OFFSET + (i * 4);
+	}
+	ctx->reg_info.num_registers = CAM_IRQ_TEST_NUM_REGS;
+	ctx->reg_info.irq_reg_set = ctx->reg_set;
+	ctx->reg_info.global_clear_offset = CAM_IRQ_TEST_GLOBAL_CLEAR;
+	ctx->reg_info.global_clear_bitmask = 0x1;
+	ctx->reg_info.clear_all_bitmask = 0xFFFFFFFF;
+
+	rc = cam_irq_controller_init("kunit", ctx->regs, &ctx->reg_info,
+		&ctx->controller);
+	if (rc)
+		return rc;
+
+	test->priv = ctx;
+
+	return 0;
+}
+
+static void cam_irq_test_exit(struct kunit *test)
+{
+	struct cam_irq_test_ctx *ctx = test->priv;
+
+	if (ctx && ctx->controller)
+		cam_irq_controller_deinit(&ctx->controller);
+}
+
+static void cam_irq_test_dispatch(struct kunit *test)
+{
+	struct cam_irq_test_ctx *ctx = test->priv;
+	struct cam_irq_test_handler sof = {0}, done = {0}, other_grp = {0};
+
+	KUNIT_ASSERT_GT(test, cam_irq_test_subscribe(ctx, &sof,
+		CAM_IRQ_PRIORITY_0, BIT(3), 0, CAM_IRQ_EVT_GROUP_0), 0);
+	KUNIT_ASSERT_GT(test, cam_irq_test_subscribe(ctx, &done,
+		CAM_IRQ_PRIORITY_1, 0, BIT(5), CAM_IRQ_EVT_GROUP_0), 0);
+	KUNIT_ASSERT_GT(test, cam_irq_test_subscribe(ctx, &other_grp,
+		CAM_IRQ_PRIORITY_1, BIT(3), 0, CAM_IRQ_EVT_GROUP_1), 0);
+
+	KUNIT_EXPECT_EQ(test, cam_kunit_reg_r(ctx->regs,
+		CAM_IRQ_TEST_MASK_OFFSET), (uint32_t)BIT(3));
+	KUNIT_EXPECT_EQ(test, cam_kunit_reg_r(ctx->regs,
+		CAM_IRQ_TEST_MASK_OFFSET + 4), (uint32_t)BIT(5));
+
+	cam_irq_test_raise(ctx, BIT(3) | BIT(7), BIT(5));
+
+	KUNIT_EXPECT_EQ(test, sof.calls, 1);
+	KUNIT_EXPECT_EQ(test, sof.status[0], (uint32_t)BIT(3));
+	KUNIT_EXPECT_EQ(test, sof.status[1], 0U);
+	KUNIT_EXPECT_EQ(test, done.calls, 1);
+	KUNIT_EXPECT_EQ(test, done.status[0], 0U);
+	KUNIT_EXPECT_EQ(test, done.status[1], (uint32_t)BIT(5));
+	KUNIT_EXPECT_EQ(test, other_grp.calls, 0);
+
+	/* Status read is written back to clear, followed by a global clear */
+	KUNIT_EXPECT_EQ(test, cam_kunit_reg_r(ctx->regs,
+		CAM_IRQ_TEST_CLEAR_OFFSET), (uint32_t)(BIT(3) | BIT(7)));
+	KUNIT_EXPECT_EQ(test, cam_kunit_reg_r(ctx->regs,
+		CAM_IRQ_TEST_CLEAR_OFFSET + 4), (uint32_t)BIT(5));
+	KUNIT_EXPECT_EQ(test, cam_kunit_reg_r(ctx->regs,
+		CAM_IRQ_TEST_GLOBAL_CLEAR), 1U);
+
+	cam_irq_test_raise(ctx, BIT(7), 0);
+	KUNIT_EXPECT_EQ(test, sof.calls, 1);
+	KUNIT_EXPECT_EQ(test, done.calls, 1);
+}
+
+static void cam_irq_test_disable_in_top_half(struct kunit *test)
+{
+	struct cam_irq_test_ctx *ctx = test->priv;
+	struct cam_irq_test_handler first = {0}, second = {0};
+	int second_hdl;
+
+	KUNIT_ASSERT_GT(test, cam_irq_test_subscribe(ctx, &first,
+		CAM_IRQ_PRIORITY_0, BIT(0), 0, CAM_IRQ_EVT_GROUP_0), 0);
+	second_hdl = cam_irq_test_subscribe(ctx, &second,
+		CAM_IRQ_PRIORITY_0, BIT(0), 0, CAM_IRQ_EVT_GROUP_0);
+	KUNIT_ASSERT_GT(test, second_hdl, 0);
+
+	/* A top half disabling a later handler of the same status skips it */
+	first.disable_hdl = second_hdl;
+	cam_irq_test_raise(ctx, BIT(0), 0);
+
+	KUNIT_EXPECT_EQ(test, first.calls, 1);
+	KUNIT_EXPECT_EQ(test, second.calls, 0);
+
+	first.disable_hdl = 0;
+	KUNIT_EXPECT_EQ(test, cam_irq_controller_enable_irq(ctx->controller,
+		second_hdl), 0);
+	cam_irq_test_raise(ctx, BIT(0), 0);
+	KUNIT_EXPECT_EQ(test, first.calls, 2);
+	KUNIT_EXPECT_EQ(test, second.calls, 1);
+}
+
+static void cam_irq_test_list_fallback(struct kunit *test)
+{
+	struct cam_irq_test_ctx *ctx = test->priv;
+	struct cam_irq_controller *controller = ctx->controller;
+	struct cam_irq_test_handler *fillers, first = {0}, second = {0};
+	int i, second_hdl;
+
+	fillers = kunit_kcalloc(test, CAM_IRQ_MAX_INDEXED_HANDLERS,
+		sizeof(*fillers), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, fillers);
+
+	/* Enough handlers to overflow the dispatch index */
+	for (i = 0; i < CAM_IRQ_MAX_INDEXED_HANDLERS; i++)
+		KUNIT_ASSERT_GT(test, cam_irq_test_subscribe(ctx, &fillers[i],
+			CAM_IRQ_PRIORITY_1, 0, BIT(i % 32),
+			CAM_IRQ_EVT_GROUP_0), 0);
+	KUNIT_ASSERT_GT(test, cam_irq_test_subscribe(ctx, &first,
+		CAM_IRQ_PRIORITY_0, BIT(0), 0, CAM_IRQ_EVT_GROUP_0), 0);
+	second_hdl = cam_irq_test_subscribe(ctx, &second,
+		CAM_IRQ_PRIORITY_0, BIT(0), 0, CAM_IRQ_EVT_GROUP_0);
+	KUNIT_ASSERT_GT(test, second_hdl, 0);
+	KUNIT_ASSERT_FALSE(test, controller->th_indexed);
+
+	/* As with the index, a handler disabled mid dispatch is skipped */
+	first.disable_hdl = second_hdl;
+	cam_irq_test_raise(ctx, BIT(0), BIT(2));
+
+	KUNIT_EXPECT_EQ(test, first.calls, 1);
+	KUNIT_EXPECT_EQ(test, second.calls, 0);
+	KUNIT_EXPECT_EQ(test, fillers[2].calls, 1);
+	KUNIT_EXPECT_EQ(test, fillers[34].calls, 1);
+	KUNIT_EXPECT_EQ(test, fillers[3].calls, 0);
+
+	first.disable_hdl = 0;
+	KUNIT_EXPECT_EQ(test, cam_irq_controller_enable_irq(ctx->controller,
+		second_hdl), 0);
+	cam_irq_test_raise(ctx, BIT(0), 0);
+	KUNIT_EXPECT_EQ(test, first.calls, 2);
+	KUNIT_EXPECT_EQ(test, second.calls, 1);
+}
+
+static void cam_irq_test_threaded(struct kunit *test)
+{
+	struct cam_irq_test_ctx *ctx = test->priv;
+	struct cam_irq_test_handler sof = {0};
+	unsigned long flags;
+
+	cam_irq_controller_set_threaded(ctx->controller, true);
+	KUNIT_ASSERT_GT(test, cam_irq_test_subscribe(ctx, &sof,
+		CAM_IRQ_PRIORITY_0, BIT(3), 0, CAM_IRQ_EVT_GROUP_0), 0);
+
+	/* Hard IRQ half reads and clears the status, top halves wait */
+	cam_kunit_reg_w(ctx->regs, CAM_IRQ_TEST_STATUS_OFFSET, BIT(3));
+	local_irq_save(flags);
+	KUNIT_EXPECT_EQ(test, cam_irq_controller_latch_irq(ctx->controller),
+		IRQ_WAKE_THREAD);
+	local_irq_restore(flags);
+	KUNIT_EXPECT_EQ(test, sof.calls, 0);
+	KUNIT_EXPECT_EQ(test, cam_kunit_reg_r(ctx->regs,
+		CAM_IRQ_TEST_CLEAR_OFFSET), (uint32_t)BIT(3));
+
+	/* Thread half dispatches the latched status without a new read */
+	cam_kunit_reg_w(ctx->regs, CAM_IRQ_TEST_STATUS_OFFSET, 0);
+	cam_irq_controller_handle_irq(0, ctx->controller, CAM_IRQ_EVT_GROUP_0);
+	KUNIT_EXPECT_EQ(test, sof.calls, 1);
+	KUNIT_EXPECT_EQ(test, sof.status[0], (uint32_t)BIT(3));
+}
+
+static void cam_irq_test_bench_storm(struct kunit *test)
+{
+	struct cam_irq_test_ctx *ctx = test->priv;
+	struct cam_irq_test_handler *handlers;
+	struct cam_kunit_bench bench;
+	uint32_t status;
+	int i, total = 0;
+	ktime_t start;
+
+	handlers = kunit_kcalloc(test, CAM_IRQ_BITS_PER_REGISTER,
+		sizeof(*handlers), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, handlers);
+	KUNIT_ASSERT_EQ(test, cam_kunit_bench_init(test, &bench,
+		"irq_th_dispatch", CAM_IRQ_TEST_BENCH_ITER), 0);
+
+	/* One handler per bit of the first register, as on a VFE top */
+	for (i = 0; i < CAM_IRQ_BITS_PER_REGISTER; i++)
+		KUNIT_ASSERT_GT(test, cam_irq_test_subscribe(ctx, &handlers[i],
+			i % CAM_IRQ_PRIORITY_MAX, BIT(i), 0,
+			CAM_IRQ_EVT_GROUP_0), 0);
+
+	for (i = 0; i < CAM_IRQ_TEST_BENCH_ITER; i++) {
+		/* A few bits per IRQ, spread over the register */
+		status = BIT(i % 32) | BIT((i * 7) % 32) | BIT((i * 13) % 32);
+		start = ktime_get();
+		cam_irq_test_raise(ctx, status, 0);
+		cam_kunit_bench_add(&bench, start);
+	}
+
+	for (i = 0; i < CAM_IRQ_BITS_PER_REGISTER; i++)
+		total += handlers[i].calls;
+
+	KUNIT_EXPECT_GE(test, total, CAM_IRQ_TEST_BENCH_ITER);
+	KUNIT_EXPECT_EQ(test, bench.num, (uint32_t)CAM_IRQ_TEST_BENCH_ITER);
+	cam_kunit_bench_report(test, &bench);
+}
+
+static struct kunit_case cam_irq_controller_test_cases[] = {
+	KUNIT_CASE(cam_irq_test_dispatch),
+	KUNIT_CASE(cam_irq_test_disable_in_top_half),
+	KUNIT_CASE(cam_irq_test_list_fallback),
+	KUNIT_CASE(cam_irq_test_threaded),
+	KUNIT_CASE(cam_irq_test_bench_storm),
+	{}
+};
+
+struct kunit_suite cam_irq_controller_test_suite = {
+	.name = "cam_irq_controller",
+	.init = cam_irq_test_init,
+	.exit = cam_irq_test_exit,
+	.test_cases = cam_irq_controller_test_cases,
+};
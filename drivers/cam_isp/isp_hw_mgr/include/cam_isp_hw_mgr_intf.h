@@ -37,6 +37,9 @@
 /* Appliacble vote paths for dual ife, based on no. of UAPI definitions */
 #define CAM_ISP_MAX_PER_PATH_VOTES 40
 
+/* Queued requests visible to BW/clock planning, covers CAM_PIPELINE_DELAY_2 */
+#define CAM_ISP_BW_CLK_LOOKAHEAD_MAX 2
+
 /* Output params for acquire from hw_mgr to ctx */
 #define CAM_IFE_CTX_CUSTOM_EN          BIT(0)
 #define CAM_IFE_CTX_FRAME_HEADER_EN    BIT(1)
@@ -245,6 +248,9 @@ struct cam_isp_bw_clk_config_info {
  * @mup_val:               MUP value if configured
  * @num_exp:               Num of exposures
  * @mup_en:                Flag if dynamic sensor switch is enabled
+ * @upcoming_bw_clk:       BW and clock config of the requests queued behind
+ *                         this one, filled by the context at apply
+ * @num_upcoming_bw_clk:   Count of entries in upcoming_bw_clk
  *
  */
 struct cam_isp_prepare_hw_update_data {
@@ -261,6 +267,9 @@ struct cam_isp_prepare_hw_update_data {
 	uint32_t                              mup_val;
 	uint32_t                              num_exp;
 	bool                                  mup_en;
+	struct cam_isp_bw_clk_config_info    *upcoming_bw_clk[
+						CAM_ISP_BW_CLK_LOOKAHEAD_MAX];
+	uint32_t                              num_upcoming_bw_clk;
 };
 
 /**
@@ -57,6 +57,7 @@
 #define CAM_IFE_CSID_DEBUG_ENABLE_HBI_VBI_INFO            BIT(7)
 #define CAM_IFE_CSID_DEBUG_DISABLE_EARLY_EOF              BIT(8)
 #define CAM_IFE_DEBUG_ENABLE_UNMAPPED_VC_DT_IRQ           BIT(9)
+#define CAM_IFE_CSID_DEBUG_CONSOLIDATE_PATH_IRQ           BIT(10)
 
 /* Binning supported masks. Binning support changes for specific paths
  * and also for targets. With the mask, we handle the supported features
@@ -269,11 +270,15 @@ struct cam_ife_csid_core_info {
  * @csi2_reserve_cnt:       Reserve count for csi2
  * @irq_debug_cnt:          irq debug counter
  * @error_irq_count:        error irq counter
+ * @path_irq_cnt:           path irqs serviced since stream on
+ * @frame_cnt:              frames (master path SOFs) since stream on
  */
 struct cam_ife_csid_hw_counters {
 	uint32_t                          csi2_reserve_cnt;
 	uint32_t                          irq_debug_cnt;
 	uint32_t                          error_irq_count;
+	uint32_t                          path_irq_cnt;
+	uint32_t                          frame_cnt;
 };
 
 /*
@@ -302,6 +307,8 @@ struct cam_ife_csid_debug_info {
  * @offline_mode:           flag to indicate if csid in offline mode
  * @rdi_lcr_en:             flag to indicate if RDI to lcr is enabled
  * @sfe_en:                 flag to indicate if SFE is enabled
+ * @path_irq_consolidated:  flag to indicate if slave path per-frame irqs
+ *                          are masked and sampled from the master path
  */
 struct cam_ife_csid_hw_flags {
 	bool                  device_enabled;
@@ -316,6 +323,7 @@ struct cam_ife_csid_hw_flags {
 	bool                  offline_mode;
 	bool                  rdi_lcr_en;
 	bool                  sfe_en;
+	bool                  path_irq_consolidated;
 };
 
 /*
@@ -49,10 +49,16 @@
 /* Max number of sof irq's triggered in case of SOF freeze */
 #define CAM_CSID_IRQ_SOF_DEBUG_CNT_MAX 12
 
+/* Master SOFs without a new slave SOF before slave path irqs are restored */
+#define CAM_IFE_CSID_SLAVE_SOF_STALL_MAX 4
+
 static void cam_ife_csid_ver2_print_debug_reg_status(
 	struct cam_ife_csid_ver2_hw *csid_hw,
 	struct cam_isp_resource_node    *res);
 
+static uint64_t __cam_ife_csid_ver2_get_time_stamp(void __iomem *mem_base,
+	uint32_t timestamp0_addr, uint32_t timestamp1_addr);
+
 static bool cam_ife_csid_ver2_disable_sof_retime(
 	struct cam_ife_csid_ver2_hw     *csid_hw,
 	struct cam_isp_resource_node    *res)
@@ -212,6 +218,127 @@ static int cam_ife_csid_ver2_sof_irq_debug(
 	return 0;
 }
 
+static bool cam_ife_csid_ver2_is_irq_slave_path(
+	struct cam_ife_csid_ver2_hw     *csid_hw,
+	struct cam_isp_resource_node    *res)
+{
+	struct cam_isp_resource_node      *ipp_res;
+	struct cam_ife_csid_ver2_path_cfg *ipp_cfg;
+
+	if (!(csid_hw->debug_info.debug_val &
+		CAM_IFE_CSID_DEBUG_CONSOLIDATE_PATH_IRQ))
+		return false;
+
+	if (csid_hw->flags.offline_mode || res->rdi_only_ctx ||
+		(res->res_id == CAM_IFE_PIX_PATH_RES_IPP))
+		return false;
+
+	ipp_res = &csid_hw->path_res[CAM_IFE_PIX_PATH_RES_IPP];
+	ipp_cfg = (struct cam_ife_csid_ver2_path_cfg *)ipp_res->res_priv;
+
+	if (!ipp_cfg ||
+		(ipp_res->res_state < CAM_ISP_RESOURCE_STATE_RESERVED))
+		return false;
+
+	return ipp_cfg->handle_camif_irq &&
+		((ipp_cfg->sync_mode == CAM_ISP_HW_SYNC_NONE) ||
+		(ipp_cfg->sync_mode == CAM_ISP_HW_SYNC_MASTER));
+}
+
+static void cam_ife_csid_ver2_restore_path_irq(
+	struct cam_ife_csid_ver2_hw     *csid_hw,
+	struct cam_isp_resource_node    *res)
+{
+	struct cam_ife_csid_ver2_path_cfg *path_cfg;
+	uint32_t irq_mask[CAM_IFE_CSID_IRQ_REG_MAX] = {0};
+
+	path_cfg = (struct cam_ife_csid_ver2_path_cfg *)res->res_priv;
+
+	if (!path_cfg || !path_cfg->irq_handle ||
+		!path_cfg->consolidated_irq_mask)
+		return;
+
+	irq_mask[path_cfg->irq_reg_idx] = path_cfg->consolidated_irq_mask;
+	cam_irq_controller_update_irq(
+		csid_hw->csid_irq_controller,
+		path_cfg->irq_handle,
+		true, irq_mask);
+
+	CAM_DBG(CAM_ISP, "CSID:%u %s restored irq mask 0x%x",
+		csid_hw->hw_intf->hw_idx, res->res_name,
+		path_cfg->consolidated_irq_mask);
+
+	path_cfg->consolidated_irq_mask = 0;
+}
+
+static void cam_ife_csid_ver2_restore_path_irqs(
+	struct cam_ife_csid_ver2_hw     *csid_hw)
+{
+	int i;
+
+	if (!csid_hw->flags.path_irq_consolidated)
+		return;
+
+	for (i = CAM_IFE_PIX_PATH_RES_RDI_0; i < CAM_IFE_PIX_PATH_RES_MAX; i++)
+		cam_ife_csid_ver2_restore_path_irq(csid_hw,
+			&csid_hw->path_res[i]);
+
+	csid_hw->flags.path_irq_consolidated = false;
+}
+
+static void cam_ife_csid_ver2_sample_slave_paths(
+	struct cam_ife_csid_ver2_hw     *csid_hw)
+{
+	const struct cam_ife_csid_ver2_path_reg_info *path_reg;
+	struct cam_ife_csid_ver2_reg_info            *csid_reg;
+	struct cam_ife_csid_ver2_path_cfg            *path_cfg;
+	struct cam_isp_resource_node                 *res;
+	void __iomem                                 *mem_base;
+	uint64_t                                      sof_ts;
+	int                                           i;
+
+	csid_reg = (struct cam_ife_csid_ver2_reg_info *)
+			csid_hw->core_info->csid_reg;
+	mem_base = csid_hw->hw_info->soc_info.reg_map[0].mem_base;
+
+	for (i = CAM_IFE_PIX_PATH_RES_RDI_0; i < CAM_IFE_PIX_PATH_RES_MAX;
+		i++) {
+		res = &csid_hw->path_res[i];
+		path_cfg = (struct cam_ife_csid_ver2_path_cfg *)res->res_priv;
+		path_reg = csid_reg->path_reg[i];
+
+		if (!path_cfg || !path_cfg->consolidated_irq_mask ||
+			(res->res_state != CAM_ISP_RESOURCE_STATE_STREAMING))
+			continue;
+
+		if (!path_reg || !path_reg->timestamp_curr0_sof_addr)
+			continue;
+
+		sof_ts = __cam_ife_csid_ver2_get_time_stamp(mem_base,
+			path_reg->timestamp_curr0_sof_addr,
+			path_reg->timestamp_curr1_sof_addr);
+
+		CAM_DBG(CAM_ISP, "CSID:%u frame %u %s sof_ts %llu",
+			csid_hw->hw_intf->hw_idx, csid_hw->counters.frame_cnt,
+			res->res_name, sof_ts);
+
+		if (sof_ts != path_cfg->sampled_sof_ts) {
+			path_cfg->sampled_sof_ts = sof_ts;
+			path_cfg->stall_cnt = 0;
+			continue;
+		}
+
+		if (++path_cfg->stall_cnt < CAM_IFE_CSID_SLAVE_SOF_STALL_MAX)
+			continue;
+
+		CAM_WARN_RATE_LIMIT(CAM_ISP,
+			"CSID:%u %s no SOF for %u frames, restoring path irqs",
+			csid_hw->hw_intf->hw_idx, res->res_name,
+			path_cfg->stall_cnt);
+		cam_ife_csid_ver2_restore_path_irq(csid_hw, res);
+	}
+}
+
 static int cam_ife_csid_ver2_get_evt_payload(
 	struct cam_ife_csid_ver2_hw *csid_hw,
 	struct cam_ife_csid_ver2_evt_payload **evt_payload,
@@ -391,6 +518,7 @@ static int cam_ife_csid_ver2_path_top_half(
 	csid_reg = (struct cam_ife_csid_ver2_reg_info *)
 			csid_hw->core_info->csid_reg;
 	path_cfg = (struct cam_ife_csid_ver2_path_cfg *)res->res_priv;
+	csid_hw->counters.path_irq_cnt++;
 
 	rc  = cam_ife_csid_ver2_get_evt_payload(csid_hw, &evt_payload,
 			&csid_hw->path_free_payload_list,
@@ -932,6 +1060,7 @@ static int cam_ife_csid_ver2_handle_event_err(
 	evt.event_data = (void *)&err_evt_info;
 
 	if (!is_secondary) {
+		cam_ife_csid_ver2_restore_path_irqs(csid_hw);
 		if (res) {
 			cam_ife_csid_ver2_print_debug_reg_status(csid_hw, res);
 			path_cfg = (struct cam_ife_csid_ver2_path_cfg *)res->res_priv;
@@ -1568,9 +1697,16 @@ static int cam_ife_csid_ver2_ipp_bottom_half(
 	if (irq_status_ipp & path_reg->eof_irq_mask)
 		csid_hw->event_cb(csid_hw->token, CAM_ISP_HW_EVENT_EOF, (void *)&evt_info);
 
-	if (irq_status_ipp & path_reg->sof_irq_mask)
+	if (irq_status_ipp & path_reg->sof_irq_mask) {
 		csid_hw->event_cb(csid_hw->token, CAM_ISP_HW_EVENT_SOF, (void *)&evt_info);
 
+		if (path_cfg->handle_camif_irq) {
+			csid_hw->counters.frame_cnt++;
+			if (csid_hw->flags.path_irq_consolidated)
+				cam_ife_csid_ver2_sample_slave_paths(csid_hw);
+		}
+	}
+
 	if (irq_status_ipp & path_reg->rup_irq_mask)
 		csid_hw->event_cb(csid_hw->token, CAM_ISP_HW_EVENT_REG_UPDATE, (void *)&evt_info);
 
@@ -1792,6 +1928,9 @@ static int cam_ife_csid_ver2_rdi_bottom_half(
 		csid_hw->event_cb(csid_hw->token, CAM_ISP_HW_EVENT_EOF, (void *)&evt_info);
 
 	if ((irq_status_rdi & rdi_reg->sof_irq_mask)) {
+		if (res->rdi_only_ctx)
+			csid_hw->counters.frame_cnt++;
+
 		if (path_cfg->sec_evt_config.en_secondary_evt &&
 			(path_cfg->sec_evt_config.evt_type & CAM_IFE_CSID_EVT_SOF)) {
 			evt_info.is_secondary_evt = true;
@@ -2071,6 +2210,9 @@ static int cam_ife_csid_ver2_disable_path(
 	path_cfg->skip_discard_frame_cfg = false;
 	path_cfg->num_frames_discard = 0;
 	path_cfg->sof_cnt = 0;
+	path_cfg->consolidated_irq_mask = 0;
+	path_cfg->sampled_sof_ts = 0;
+	path_cfg->stall_cnt = 0;
 	return rc;
 }
 
@@ -3308,6 +3450,17 @@ static int cam_ife_csid_ver2_program_rdi_path(
 		path_cfg->handle_camif_irq = true;
 	}
 
+	/*
+	 * The master IPP delivers RUP and SOF for the frame, so the debug and
+	 * RUP irqs of this path are withheld and its SOF is sampled instead.
+	 */
+	if (cam_ife_csid_ver2_is_irq_slave_path(csid_hw, res)) {
+		path_cfg->consolidated_irq_mask = val;
+		if (val)
+			csid_hw->flags.path_irq_consolidated = true;
+		val = 0;
+	}
+
 	/* Enable secondary events dictated by HW mgr for RDI paths */
 	if (path_cfg->sec_evt_config.en_secondary_evt) {
 		if (path_cfg->sec_evt_config.evt_type & CAM_IFE_CSID_EVT_SOF)
@@ -3670,13 +3823,20 @@ static int cam_ife_csid_ver2_program_ppp_path(
 
 	val = csid_hw->debug_info.path_mask;
 
+	if (cam_ife_csid_ver2_is_irq_slave_path(csid_hw, res)) {
+		path_cfg->consolidated_irq_mask = val;
+		if (val)
+			csid_hw->flags.path_irq_consolidated = true;
+		val = 0;
+	}
+
 	irq_mask[path_cfg->irq_reg_idx] = val;
 	irq_mask[CAM_IFE_CSID_IRQ_REG_TOP] = path_reg->top_irq_mask;
 	path_cfg->irq_handle = cam_irq_controller_subscribe_irq(
 				csid_hw->csid_irq_controller,
 				CAM_IRQ_PRIORITY_1,
 				irq_mask,
-				csid_hw,
+				res,
 				cam_ife_csid_ver2_path_top_half,
 				cam_ife_csid_ver2_ppp_bottom_half,
 				csid_hw->tasklet,
@@ -4386,7 +4546,10 @@ int cam_ife_csid_ver2_start(void *hw_priv, void *args,
 
 	mutex_lock(&csid_hw->hw_info->hw_mutex);
 	csid_hw->flags.sof_irq_triggered = false;
+	csid_hw->flags.path_irq_consolidated = false;
 	csid_hw->counters.irq_debug_cnt = 0;
+	csid_hw->counters.path_irq_cnt = 0;
+	csid_hw->counters.frame_cnt = 0;
 
 	rc = cam_ife_csid_ver2_enable_hw(csid_hw);
 
@@ -4505,6 +4668,18 @@ int cam_ife_csid_ver2_stop(void *hw_priv,
 	csid_hw->flags.device_enabled = false;
 	csid_hw->flags.rdi_lcr_en = false;
 
+	if (csid_hw->counters.frame_cnt)
+		CAM_DBG(CAM_ISP,
+			"CSID:%u path irqs: %u frames: %u irqs/frame x100: %u consolidated: %s",
+			csid_hw->hw_intf->hw_idx,
+			csid_hw->counters.path_irq_cnt,
+			csid_hw->counters.frame_cnt,
+			csid_hw->counters.path_irq_cnt * 100 /
+			csid_hw->counters.frame_cnt,
+			CAM_BOOL_TO_YESNO(
+			csid_hw->flags.path_irq_consolidated));
+	csid_hw->flags.path_irq_consolidated = false;
+
 	reset.reset_type = (csid_hw->flags.fatal_err_detected) ? CAM_IFE_CSID_RESET_GLOBAL :
 		CAM_IFE_CSID_RESET_PATH;
 	cam_ife_csid_ver2_reset(hw_priv, &reset,
@@ -5436,6 +5611,16 @@ static irqreturn_t cam_ife_csid_irq(int irq_num, void *data)
 		csid_hw->csid_irq_controller, CAM_IRQ_EVT_GROUP_0);
 }
 
+static irqreturn_t cam_ife_csid_irq_latch(int irq_num, void *data)
+{
+	struct cam_ife_csid_ver2_hw *csid_hw = data;
+
+	if (!csid_hw)
+		return IRQ_NONE;
+
+	return cam_irq_controller_latch_irq(csid_hw->csid_irq_controller);
+}
+
 static void cam_ife_csid_ver2_free_res(struct cam_ife_csid_ver2_hw *csid_hw)
 {
 
@@ -5614,6 +5799,11 @@ static int cam_ife_csid_hw_init_irq(
 		return rc;
 	}
 
+	cam_irq_controller_set_threaded(csid_hw->csid_irq_controller,
+		soc_info->irq_threaded);
+	cam_irq_controller_set_threaded(csid_hw->buf_done_irq_controller,
+		soc_info->irq_threaded);
+
 	spin_lock_init(&csid_hw->path_payload_lock);
 	INIT_LIST_HEAD(&csid_hw->path_free_payload_list);
 	for (i = 0; i < CAM_IFE_CSID_VER2_PAYLOAD_MAX; i++) {
@@ -5672,6 +5862,7 @@ int cam_ife_csid_hw_ver2_init(struct cam_hw_intf *hw_intf,
 	init_completion(&csid_hw->hw_info->hw_complete);
 	atomic_set(&csid_hw->discard_frame_per_path, 0);
 
+	csid_hw->hw_info->soc_info.irq_latch_handler = cam_ife_csid_irq_latch;
 	rc = cam_ife_csid_init_soc_resources(&csid_hw->hw_info->soc_info,
 			cam_ife_csid_irq, csid_hw, is_custom);
 	if (rc < 0) {
@@ -160,6 +160,10 @@ struct cam_ife_csid_ver2_evt_payload {
  *                          the corresponding paths
  * @sfe_shdr:               flag to indicate if sfe is inline shdr
  * @lcr_en:                 Flag to indicate if path is part can be input to LCR
+ * @consolidated_irq_mask:  Per-frame irq bits withheld from this slave path
+ *                          while the master path services the frame
+ * @sampled_sof_ts:         Last SOF timestamp sampled at master path SOF
+ * @stall_cnt:              Consecutive master SOFs without a new slave SOF
  *
  */
 struct cam_ife_csid_ver2_path_cfg {
@@ -189,6 +193,9 @@ struct cam_ife_csid_ver2_path_cfg {
 	uint32_t                             sof_cnt;
 	uint32_t                             num_frames_discard;
 	uint32_t                             epoch_cfg;
+	uint32_t                             consolidated_irq_mask;
+	uint64_t                             sampled_sof_ts;
+	uint32_t                             stall_cnt;
 	enum cam_isp_hw_sync_mode            sync_mode;
 	bool                                 vfr_en;
 	bool                                 frame_id_dec_en;
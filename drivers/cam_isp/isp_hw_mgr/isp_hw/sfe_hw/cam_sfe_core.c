@@ -400,6 +400,20 @@ irqreturn_t cam_sfe_irq(int irq_num, void *data)
 		core_info->sfe_irq_controller, CAM_IRQ_EVT_GROUP_0);
 }
 
+irqreturn_t cam_sfe_irq_latch(int irq_num, void *data)
+{
+	struct cam_hw_info            *sfe_hw;
+	struct cam_sfe_hw_core_info   *core_info;
+
+	if (!data)
+		return IRQ_NONE;
+
+	sfe_hw = (struct cam_hw_info *)data;
+	core_info = (struct cam_sfe_hw_core_info *)sfe_hw->core_info;
+
+	return cam_irq_controller_latch_irq(core_info->sfe_irq_controller);
+}
+
 int cam_sfe_core_init(
 	struct cam_sfe_hw_core_info  *core_info,
 	struct cam_hw_soc_info       *soc_info,
@@ -415,6 +429,8 @@ int cam_sfe_core_init(
 		CAM_ERR(CAM_SFE, "SFE irq controller init failed");
 		return rc;
 	}
+	cam_irq_controller_set_threaded(core_info->sfe_irq_controller,
+		soc_info->irq_threaded);
 
 	rc = cam_sfe_top_init(sfe_hw_info->top_version, soc_info, hw_intf,
 		sfe_hw_info->top_hw_info, core_info->sfe_irq_controller,
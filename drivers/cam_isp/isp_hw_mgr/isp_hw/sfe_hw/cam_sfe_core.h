@@ -78,6 +78,7 @@ int cam_sfe_process_cmd(void *device_priv, uint32_t cmd_type,
 	void *cmd_args, uint32_t arg_size);
 
 irqreturn_t cam_sfe_irq(int irq_num, void *data);
+irqreturn_t cam_sfe_irq_latch(int irq_num, void *data);
 
 int cam_sfe_core_init(struct cam_sfe_hw_core_info *core_info,
 	struct cam_hw_soc_info             *soc_info,
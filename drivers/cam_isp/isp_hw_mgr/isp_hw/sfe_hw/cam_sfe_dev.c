@@ -101,6 +101,7 @@ static int cam_sfe_component_bind(struct device *dev,
 	hw_info = (struct cam_sfe_hw_info *)match_dev->data;
 	core_info->sfe_hw_info = hw_info;
 
+	sfe_info->soc_info.irq_latch_handler = cam_sfe_irq_latch;
 	rc = cam_sfe_init_soc_resources(&sfe_info->soc_info, cam_sfe_irq,
 		sfe_info);
 	if (rc < 0) {
@@ -580,6 +580,20 @@ irqreturn_t cam_vfe_irq(int irq_num, void *data)
 		core_info->vfe_irq_controller, CAM_IRQ_EVT_GROUP_0);
 }
 
+irqreturn_t cam_vfe_irq_latch(int irq_num, void *data)
+{
+	struct cam_hw_info            *vfe_hw;
+	struct cam_vfe_hw_core_info   *core_info;
+
+	if (!data)
+		return IRQ_NONE;
+
+	vfe_hw = (struct cam_hw_info *)data;
+	core_info = (struct cam_vfe_hw_core_info *)vfe_hw->core_info;
+
+	return cam_irq_controller_latch_irq(core_info->vfe_irq_controller);
+}
+
 int cam_vfe_core_init(struct cam_vfe_hw_core_info  *core_info,
 	struct cam_hw_soc_info                     *soc_info,
 	struct cam_hw_intf                         *hw_intf,
@@ -605,6 +619,8 @@ int cam_vfe_core_init(struct cam_vfe_hw_core_info  *core_info,
 			"Error, cam_irq_controller_init failed rc = %d", rc);
 		return rc;
 	}
+	cam_irq_controller_set_threaded(core_info->vfe_irq_controller,
+		soc_info->irq_threaded);
 
 	rc = cam_vfe_top_init(vfe_hw_info->top_version, soc_info, hw_intf,
 		vfe_hw_info->top_hw_info, core_info->vfe_irq_controller,
@@ -86,6 +86,7 @@ int cam_vfe_process_cmd(void *device_priv, uint32_t cmd_type,
 	void *cmd_args, uint32_t arg_size);
 
 irqreturn_t cam_vfe_irq(int irq_num, void *data);
+irqreturn_t cam_vfe_irq_latch(int irq_num, void *data);
 
 int cam_vfe_core_init(struct cam_vfe_hw_core_info *core_info,
 	struct cam_hw_soc_info             *soc_info,
@@ -99,6 +99,7 @@ static int cam_vfe_component_bind(struct device *dev,
 	hw_info = (struct cam_vfe_hw_info *)match_dev->data;
 	core_info->vfe_hw_info = hw_info;
 
+	vfe_hw->soc_info.irq_latch_handler = cam_vfe_irq_latch;
 	rc = cam_vfe_init_soc_resources(&vfe_hw->soc_info, cam_vfe_irq,
 		vfe_hw);
 	if (rc < 0) {
@@ -6,6 +6,8 @@
 
 #include <linux/module.h>
 #include <linux/kernel.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
 #include <media/cam_cpas.h>
 #include <media/cam_req_mgr.h>
 #include <media/cam_sync.h>
@@ -78,6 +80,96 @@ static int cam_lrme_mgr_util_get_device(struct cam_lrme_hw_mgr *hw_mgr,
 	return 0;
 }
 
+static bool cam_lrme_mgr_util_ctx_uses_device(struct cam_lrme_hw_mgr *hw_mgr,
+	uint32_t home_index, uint32_t device_index, bool all_devices)
+{
+	struct cam_lrme_device *hw_device = &hw_mgr->hw_device[device_index];
+
+	if (device_index == home_index)
+		return true;
+
+	if (!all_devices || !hw_device->valid)
+		return false;
+
+	/*
+	 * Command buffers are built by the home device. Only the changebase
+	 * is rewritten at submit, so the register layout must match.
+	 */
+	return !memcmp(&hw_device->hw_caps,
+		&hw_mgr->hw_device[home_index].hw_caps,
+		sizeof(hw_device->hw_caps));
+}
+
+static struct cam_lrme_device *cam_lrme_mgr_util_dispatch_frame(
+	struct cam_lrme_hw_mgr *hw_mgr,
+	struct cam_lrme_frame_request *frame_req)
+{
+	struct cam_lrme_ctx_dispatch *ctx_dispatch;
+	struct cam_lrme_device *hw_device;
+	uint64_t ctx_index;
+	uint32_t home_index, index, i;
+
+	ctx_index = CAM_LRME_DECODE_CTX_INDEX(frame_req->ctxt_to_hw_map);
+	home_index = CAM_LRME_DECODE_DEVICE_INDEX(frame_req->ctxt_to_hw_map);
+	if (ctx_index >= CAM_CTX_MAX || home_index >= CAM_LRME_HW_MAX) {
+		CAM_ERR(CAM_LRME, "Invalid ctx index %llu device index %u",
+			ctx_index, home_index);
+		return NULL;
+	}
+
+	spin_lock(&hw_mgr->dispatch_lock);
+	ctx_dispatch = &hw_mgr->ctx_dispatch[ctx_index];
+	index = home_index;
+	if (ctx_dispatch->num_inflight) {
+		/* Frames of a context must complete in order */
+		index = ctx_dispatch->device_index;
+	} else if (ctx_dispatch->all_devices &&
+		!hw_mgr->debugfs_entry.disable_frame_dispatch) {
+		for (i = 0; i < CAM_LRME_HW_MAX; i++) {
+			if (!cam_lrme_mgr_util_ctx_uses_device(hw_mgr,
+				home_index, i, true))
+				continue;
+			if (hw_mgr->hw_device[i].queue_depth <
+				hw_mgr->hw_device[index].queue_depth)
+				index = i;
+		}
+	}
+
+	hw_device = &hw_mgr->hw_device[index];
+	ctx_dispatch->device_index = index;
+	ctx_dispatch->num_inflight++;
+	if (!hw_device->queue_depth++)
+		hw_device->busy_start = ktime_get();
+	hw_device->num_frames++;
+	spin_unlock(&hw_mgr->dispatch_lock);
+
+	CAM_DBG(CAM_LRME, "req %llu ctx %llu dispatched to device %u depth %u",
+		frame_req->req_id, ctx_index, index, hw_device->queue_depth);
+
+	return hw_device;
+}
+
+static void cam_lrme_mgr_util_retire_frame(struct cam_lrme_hw_mgr *hw_mgr,
+	struct cam_lrme_frame_request *frame_req)
+{
+	struct cam_lrme_device *hw_device = frame_req->hw_device;
+	struct cam_lrme_ctx_dispatch *ctx_dispatch;
+	uint64_t ctx_index;
+
+	ctx_index = CAM_LRME_DECODE_CTX_INDEX(frame_req->ctxt_to_hw_map);
+	if (!hw_device || ctx_index >= CAM_CTX_MAX)
+		return;
+
+	spin_lock(&hw_mgr->dispatch_lock);
+	ctx_dispatch = &hw_mgr->ctx_dispatch[ctx_index];
+	if (ctx_dispatch->num_inflight)
+		ctx_dispatch->num_inflight--;
+	if (hw_device->queue_depth && !--hw_device->queue_depth)
+		hw_device->busy_time = ktime_add(hw_device->busy_time,
+			ktime_sub(ktime_get(), hw_device->busy_start));
+	spin_unlock(&hw_mgr->dispatch_lock);
+}
+
 static int cam_lrme_mgr_util_packet_validate(struct cam_packet *packet,
 	size_t remain_len)
 {
@@ -518,6 +610,7 @@ static int cam_lrme_mgr_cb(void *data,
 	frame_req = cb_args->frame_req;
 
 	if (cb_args->cb_type & CAM_LRME_CB_PUT_FRAME) {
+		cam_lrme_mgr_util_retire_frame(hw_mgr, frame_req);
 		memset(frame_req, 0x0, sizeof(*frame_req));
 		INIT_LIST_HEAD(&frame_req->frame_list);
 		cam_lrme_mgr_util_put_frame_req(&hw_mgr->frame_free_list,
@@ -547,6 +640,8 @@ static int cam_lrme_mgr_cb(void *data,
 		return -EINVAL;
 	}
 
+	cam_lrme_mgr_util_retire_frame(hw_mgr, frame_req);
+
 	if (hw_mgr->event_cb) {
 		struct cam_hw_done_event_data buf_data;
 
@@ -638,7 +733,7 @@ static int cam_lrme_mgr_hw_release(void *hw_mgr_priv, void *hw_release_args)
 	struct cam_lrme_hw_mgr *hw_mgr = hw_mgr_priv;
 	struct cam_hw_release_args *args =
 		(struct cam_hw_release_args *)hw_release_args;
-	uint64_t device_index;
+	uint64_t device_index, ctx_index;
 
 	if (!hw_mgr_priv || !hw_release_args) {
 		CAM_ERR(CAM_LRME, "Invalid arguments %pK, %pK",
@@ -652,6 +747,14 @@ static int cam_lrme_mgr_hw_release(void *hw_mgr_priv, void *hw_release_args)
 		return -EPERM;
 	}
 
+	ctx_index = CAM_LRME_DECODE_CTX_INDEX(args->ctxt_to_hw_map);
+	if (ctx_index < CAM_CTX_MAX) {
+		spin_lock(&hw_mgr->dispatch_lock);
+		memset(&hw_mgr->ctx_dispatch[ctx_index], 0,
+			sizeof(hw_mgr->ctx_dispatch[ctx_index]));
+		spin_unlock(&hw_mgr->dispatch_lock);
+	}
+
 	rc = cam_lrme_mgr_util_release(hw_mgr, device_index);
 	if (rc)
 		CAM_ERR(CAM_LRME, "Failed in release device, rc=%d", rc);
@@ -667,6 +770,7 @@ static int cam_lrme_mgr_hw_dump(void *hw_mgr_priv, void *hw_dump_args)
 	int rc = 0;
 	uint32_t device_index;
 	struct cam_lrme_hw_dump_args lrme_dump_args;
+	uint64_t ctx_index;
 
 	device_index = CAM_LRME_DECODE_DEVICE_INDEX(dump_args->ctxt_to_hw_map);
 	if (device_index >= hw_mgr->device_count) {
@@ -674,6 +778,16 @@ static int cam_lrme_mgr_hw_dump(void *hw_mgr_priv, void *hw_dump_args)
 		return -EPERM;
 	}
 
+	/* The request may have been dispatched away from the home device */
+	ctx_index = CAM_LRME_DECODE_CTX_INDEX(dump_args->ctxt_to_hw_map);
+	if (ctx_index < CAM_CTX_MAX) {
+		spin_lock(&hw_mgr->dispatch_lock);
+		if (hw_mgr->ctx_dispatch[ctx_index].all_devices)
+			device_index =
+				hw_mgr->ctx_dispatch[ctx_index].device_index;
+		spin_unlock(&hw_mgr->dispatch_lock);
+	}
+
 	CAM_DBG(CAM_LRME, "Start device index %d", device_index);
 
 	rc = cam_lrme_mgr_util_get_device(hw_mgr, device_index, &hw_device);
@@ -709,6 +823,7 @@ static int cam_lrme_mgr_hw_flush(void *hw_mgr_priv, void *hw_flush_args)
 	struct cam_lrme_hw_mgr *hw_mgr = hw_mgr_priv;
 	struct cam_hw_flush_args *args;
 	struct cam_lrme_device *hw_device;
+	struct cam_lrme_device *frame_device;
 	struct cam_lrme_frame_request *frame_req = NULL, *req_to_flush = NULL;
 	struct cam_lrme_frame_request **req_list = NULL;
 	uint32_t device_index;
@@ -745,12 +860,15 @@ static int cam_lrme_mgr_hw_flush(void *hw_mgr_priv, void *hw_flush_args)
 	req_list = (struct cam_lrme_frame_request **)args->flush_req_active;
 	for (i = 0; i < args->num_req_active; i++) {
 		frame_req = req_list[i];
+		frame_device = frame_req->hw_device ?
+			frame_req->hw_device : hw_device;
 		priority = CAM_LRME_DECODE_PRIORITY(args->ctxt_to_hw_map);
 		spin_lock((priority == CAM_LRME_PRIORITY_HIGH) ?
-			&hw_device->high_req_lock :
-			&hw_device->normal_req_lock);
+			&frame_device->high_req_lock :
+			&frame_device->normal_req_lock);
 		if (!list_empty(&frame_req->frame_list)) {
 			list_del_init(&frame_req->frame_list);
+			cam_lrme_mgr_util_retire_frame(hw_mgr, frame_req);
 			cam_lrme_mgr_util_put_frame_req(
 				&hw_mgr->frame_free_list,
 				&frame_req->frame_list,
@@ -758,11 +876,15 @@ static int cam_lrme_mgr_hw_flush(void *hw_mgr_priv, void *hw_flush_args)
 		} else
 			req_to_flush = frame_req;
 		spin_unlock((priority == CAM_LRME_PRIORITY_HIGH) ?
-			&hw_device->high_req_lock :
-			&hw_device->normal_req_lock);
+			&frame_device->high_req_lock :
+			&frame_device->normal_req_lock);
 	}
 	if (!req_to_flush)
 		goto end;
+
+	/* In-flight frames of a context are all on one device */
+	if (req_to_flush->hw_device)
+		hw_device = req_to_flush->hw_device;
 	if (hw_device->hw_intf.hw_ops.flush) {
 		lrme_flush_args.ctxt_to_hw_map = req_to_flush->ctxt_to_hw_map;
 		lrme_flush_args.flush_type = args->flush_type;
@@ -784,14 +906,79 @@ end:
 }
 
 
+static int cam_lrme_mgr_util_start_device(struct cam_lrme_hw_mgr *hw_mgr,
+	uint32_t device_index)
+{
+	int rc;
+	struct cam_lrme_device *hw_device;
+
+	rc = cam_lrme_mgr_util_get_device(hw_mgr, device_index, &hw_device);
+	if (rc) {
+		CAM_ERR(CAM_LRME, "Failed to get hw device");
+		return rc;
+	}
+
+	if (!hw_device->hw_intf.hw_ops.start) {
+		CAM_ERR(CAM_LRME, "Invalid start function");
+		return -EINVAL;
+	}
+
+	rc = hw_device->hw_intf.hw_ops.start(hw_device->hw_intf.hw_priv,
+		NULL, 0);
+	if (rc) {
+		CAM_ERR(CAM_LRME, "Failed in HW start %d, device %u",
+			rc, device_index);
+		return rc;
+	}
+
+	rc = hw_device->hw_intf.hw_ops.process_cmd(
+			hw_device->hw_intf.hw_priv,
+			CAM_LRME_HW_CMD_DUMP_REGISTER,
+			&g_lrme_hw_mgr.debugfs_entry.dump_register,
+			sizeof(bool));
+	if (rc) {
+		CAM_ERR(CAM_LRME, "Failed to set dump register %d", rc);
+		if (hw_device->hw_intf.hw_ops.stop)
+			hw_device->hw_intf.hw_ops.stop(
+				hw_device->hw_intf.hw_priv, NULL, 0);
+	}
+
+	return rc;
+}
+
+static int cam_lrme_mgr_util_stop_device(struct cam_lrme_hw_mgr *hw_mgr,
+	uint32_t device_index)
+{
+	int rc;
+	struct cam_lrme_device *hw_device;
+
+	rc = cam_lrme_mgr_util_get_device(hw_mgr, device_index, &hw_device);
+	if (rc) {
+		CAM_ERR(CAM_LRME, "Failed to get hw device");
+		return rc;
+	}
+
+	if (hw_device->hw_intf.hw_ops.stop) {
+		rc = hw_device->hw_intf.hw_ops.stop(
+			hw_device->hw_intf.hw_priv, NULL, 0);
+		if (rc)
+			CAM_ERR(CAM_LRME, "Failed in HW stop %d, device %u",
+				rc, device_index);
+	}
+
+	return rc;
+}
+
 static int cam_lrme_mgr_hw_start(void *hw_mgr_priv, void *hw_start_args)
 {
-	int rc = 0;
+	int rc = 0, i;
 	struct cam_lrme_hw_mgr *hw_mgr = hw_mgr_priv;
 	struct cam_hw_start_args *args =
 		(struct cam_hw_start_args *)hw_start_args;
-	struct cam_lrme_device *hw_device;
+	struct cam_lrme_ctx_dispatch *ctx_dispatch;
 	uint32_t device_index;
+	uint64_t ctx_index;
+	bool all_devices;
 
 	if (!hw_mgr || !args) {
 		CAM_ERR(CAM_LRME, "Invalid input params");
@@ -804,39 +991,57 @@ static int cam_lrme_mgr_hw_start(void *hw_mgr_priv, void *hw_start_args)
 		return -EPERM;
 	}
 
+	ctx_index = CAM_LRME_DECODE_CTX_INDEX(args->ctxt_to_hw_map);
+	if (ctx_index >= CAM_CTX_MAX) {
+		CAM_ERR(CAM_LRME, "Invalid ctx index %llu", ctx_index);
+		return -EINVAL;
+	}
+
 	CAM_DBG(CAM_LRME, "Start device index %d", device_index);
 
-	rc = cam_lrme_mgr_util_get_device(hw_mgr, device_index, &hw_device);
-	if (rc) {
-		CAM_ERR(CAM_LRME, "Failed to get hw device");
-		return rc;
-	}
+	/*
+	 * Frames are dispatched per request to the least loaded device,
+	 * so every device the context may land on has to be powered.
+	 */
+	all_devices = !hw_mgr->debugfs_entry.disable_frame_dispatch;
+	for (i = 0; i < CAM_LRME_HW_MAX; i++) {
+		if (!cam_lrme_mgr_util_ctx_uses_device(hw_mgr, device_index,
+			i, all_devices))
+			continue;
 
-	if (hw_device->hw_intf.hw_ops.start) {
-		rc = hw_device->hw_intf.hw_ops.start(
-			hw_device->hw_intf.hw_priv, NULL, 0);
-	} else {
-		CAM_ERR(CAM_LRME, "Invalid start function");
-		return -EINVAL;
+		rc = cam_lrme_mgr_util_start_device(hw_mgr, i);
+		if (rc)
+			goto stop_devices;
 	}
 
-	rc = hw_device->hw_intf.hw_ops.process_cmd(
-			hw_device->hw_intf.hw_priv,
-			CAM_LRME_HW_CMD_DUMP_REGISTER,
-			&g_lrme_hw_mgr.debugfs_entry.dump_register,
-			sizeof(bool));
+	ctx_dispatch = &hw_mgr->ctx_dispatch[ctx_index];
+	spin_lock(&hw_mgr->dispatch_lock);
+	ctx_dispatch->device_index = device_index;
+	ctx_dispatch->all_devices = all_devices;
+	spin_unlock(&hw_mgr->dispatch_lock);
+
+	return 0;
+
+stop_devices:
+	while (--i >= 0) {
+		if (cam_lrme_mgr_util_ctx_uses_device(hw_mgr, device_index,
+			i, all_devices))
+			cam_lrme_mgr_util_stop_device(hw_mgr, i);
+	}
 
 	return rc;
 }
 
 static int cam_lrme_mgr_hw_stop(void *hw_mgr_priv, void *stop_args)
 {
-	int rc = 0;
+	int rc = 0, i, stop_rc;
 	struct cam_lrme_hw_mgr *hw_mgr = hw_mgr_priv;
 	struct cam_hw_stop_args *args =
 		(struct cam_hw_stop_args *)stop_args;
-	struct cam_lrme_device *hw_device;
+	struct cam_lrme_ctx_dispatch *ctx_dispatch;
 	uint32_t device_index;
+	uint64_t ctx_index;
+	bool all_devices;
 
 	if (!hw_mgr_priv || !stop_args) {
 		CAM_ERR(CAM_LRME, "Invalid arguments");
@@ -849,24 +1054,30 @@ static int cam_lrme_mgr_hw_stop(void *hw_mgr_priv, void *stop_args)
 		return -EPERM;
 	}
 
+	ctx_index = CAM_LRME_DECODE_CTX_INDEX(args->ctxt_to_hw_map);
+	if (ctx_index >= CAM_CTX_MAX) {
+		CAM_ERR(CAM_LRME, "Invalid ctx index %llu", ctx_index);
+		return -EINVAL;
+	}
+
 	CAM_DBG(CAM_LRME, "Stop device index %d", device_index);
 
-	rc = cam_lrme_mgr_util_get_device(hw_mgr, device_index, &hw_device);
-	if (rc) {
-		CAM_ERR(CAM_LRME, "Failed to get hw device");
-		return rc;
-	}
+	ctx_dispatch = &hw_mgr->ctx_dispatch[ctx_index];
+	spin_lock(&hw_mgr->dispatch_lock);
+	all_devices = ctx_dispatch->all_devices;
+	ctx_dispatch->all_devices = false;
+	spin_unlock(&hw_mgr->dispatch_lock);
 
-	if (hw_device->hw_intf.hw_ops.stop) {
-		rc = hw_device->hw_intf.hw_ops.stop(
-			hw_device->hw_intf.hw_priv, NULL, 0);
-		if (rc) {
-			CAM_ERR(CAM_LRME, "Failed in HW stop %d", rc);
-			goto end;
-		}
+	for (i = 0; i < CAM_LRME_HW_MAX; i++) {
+		if (!cam_lrme_mgr_util_ctx_uses_device(hw_mgr, device_index,
+			i, all_devices))
+			continue;
+
+		stop_rc = cam_lrme_mgr_util_stop_device(hw_mgr, i);
+		if (stop_rc && !rc)
+			rc = stop_rc;
 	}
 
-end:
 	return rc;
 }
 
@@ -962,6 +1173,7 @@ static int cam_lrme_mgr_hw_prepare_update(void *hw_mgr_priv,
 	frame_req->req_id = args->packet->header.request_id;
 	frame_req->hw_device = hw_device;
 	frame_req->num_hw_update_entries = args->num_hw_update_entries;
+	frame_req->changebase_addr = config_args.changebase_addr;
 	for (i = 0; i < args->num_hw_update_entries; i++)
 		frame_req->hw_update_entries[i] = args->hw_update_entries[i];
 
@@ -1003,9 +1215,10 @@ static int cam_lrme_mgr_hw_config(void *hw_mgr_priv,
 		return -EINVAL;
 	}
 
-	hw_device = frame_req->hw_device;
+	hw_device = cam_lrme_mgr_util_dispatch_frame(hw_mgr, frame_req);
 	if (!hw_device)
 		return -EINVAL;
+	frame_req->hw_device = hw_device;
 
 	priority = CAM_LRME_DECODE_PRIORITY(args->ctxt_to_hw_map);
 	if (priority == CAM_LRME_PRIORITY_HIGH) {
@@ -1024,6 +1237,76 @@ static int cam_lrme_mgr_hw_config(void *hw_mgr_priv,
 	return rc;
 }
 
+static int cam_lrme_mgr_dispatch_stats_show(struct seq_file *m, void *unused)
+{
+	struct cam_lrme_hw_mgr *hw_mgr = m->private;
+	struct cam_lrme_device *hw_device;
+	ktime_t busy_time;
+	uint32_t queue_depth, num_context;
+	uint64_t num_frames;
+	int i;
+
+	seq_puts(m, "device num_ctx depth frames busy_ms\n");
+	for (i = 0; i < CAM_LRME_HW_MAX; i++) {
+		hw_device = &hw_mgr->hw_device[i];
+		if (!hw_device->valid)
+			continue;
+
+		spin_lock(&hw_mgr->dispatch_lock);
+		queue_depth = hw_device->queue_depth;
+		num_context = hw_device->num_context;
+		num_frames = hw_device->num_frames;
+		busy_time = hw_device->busy_time;
+		if (queue_depth)
+			busy_time = ktime_add(busy_time,
+				ktime_sub(ktime_get(), hw_device->busy_start));
+		spin_unlock(&hw_mgr->dispatch_lock);
+
+		seq_printf(m, "%6d %7u %5u %6llu %7lld\n", i, num_context,
+			queue_depth, num_frames, ktime_to_ms(busy_time));
+	}
+
+	return 0;
+}
+
+static int cam_lrme_mgr_dispatch_stats_open(struct inode *inode,
+	struct file *file)
+{
+	return single_open(file, cam_lrme_mgr_dispatch_stats_show,
+		inode->i_private);
+}
+
+static ssize_t cam_lrme_mgr_dispatch_stats_write(struct file *file,
+	const char __user *ubuf, size_t size, loff_t *ppos)
+{
+	struct cam_lrme_hw_mgr *hw_mgr =
+		((struct seq_file *)file->private_data)->private;
+	struct cam_lrme_device *hw_device;
+	int i;
+
+	/* Any write restarts the utilisation window */
+	spin_lock(&hw_mgr->dispatch_lock);
+	for (i = 0; i < CAM_LRME_HW_MAX; i++) {
+		hw_device = &hw_mgr->hw_device[i];
+		hw_device->num_frames = 0;
+		hw_device->busy_time = 0;
+		if (hw_device->queue_depth)
+			hw_device->busy_start = ktime_get();
+	}
+	spin_unlock(&hw_mgr->dispatch_lock);
+
+	return size;
+}
+
+static const struct file_operations cam_lrme_mgr_dispatch_stats_fops = {
+	.owner   = THIS_MODULE,
+	.open    = cam_lrme_mgr_dispatch_stats_open,
+	.read    = seq_read,
+	.write   = cam_lrme_mgr_dispatch_stats_write,
+	.llseek  = seq_lseek,
+	.release = single_release,
+};
+
 static int cam_lrme_mgr_create_debugfs_entry(void)
 {
 	int rc = 0;
@@ -1048,6 +1331,13 @@ static int cam_lrme_mgr_create_debugfs_entry(void)
 			rc = PTR_ERR(dbgfileptr);
 	}
 
+	debugfs_create_bool("disable_frame_dispatch", 0644,
+		g_lrme_hw_mgr.debugfs_entry.dentry,
+		&g_lrme_hw_mgr.debugfs_entry.disable_frame_dispatch);
+	debugfs_create_file("dispatch_stats", 0644,
+		g_lrme_hw_mgr.debugfs_entry.dentry, &g_lrme_hw_mgr,
+		&cam_lrme_mgr_dispatch_stats_fops);
+
 err:
 	return rc;
 }
@@ -1067,6 +1357,12 @@ int cam_lrme_mgr_register_device(
 	char buf[128];
 	int i, rc;
 
+	if (lrme_hw_intf->hw_idx >= CAM_LRME_HW_MAX) {
+		CAM_ERR(CAM_LRME, "Invalid hw index %u",
+			lrme_hw_intf->hw_idx);
+		return -EINVAL;
+	}
+
 	hw_device = &g_lrme_hw_mgr.hw_device[lrme_hw_intf->hw_idx];
 
 	g_lrme_hw_mgr.device_iommu = *device_iommu;
@@ -1181,6 +1477,7 @@ int cam_lrme_hw_mgr_init(struct cam_hw_mgr_intf *hw_mgr_intf,
 
 	mutex_init(&g_lrme_hw_mgr.hw_mgr_mutex);
 	spin_lock_init(&g_lrme_hw_mgr.free_req_lock);
+	spin_lock_init(&g_lrme_hw_mgr.dispatch_lock);
 	INIT_LIST_HEAD(&g_lrme_hw_mgr.frame_free_list);
 
 	/* Init hw mgr frame requests and add to free list */
@@ -19,7 +19,7 @@
 #include "cam_lrme_hw_intf.h"
 #include "cam_context.h"
 
-#define CAM_LRME_HW_MAX 1
+#define CAM_LRME_HW_MAX 2
 #define CAM_LRME_WORKQ_NUM_TASK 10
 
 #define CAM_LRME_DECODE_DEVICE_INDEX(ctxt_to_hw_map) \
@@ -56,10 +56,27 @@ struct cam_lrme_mgr_work_data {
  *
  * @dentry                       : entry of debugfs
  * @dump_register                : flag to dump registers
+ * @disable_frame_dispatch       : flag to keep every frame of a context on
+ *                                 the device reserved at acquire
  */
 struct cam_lrme_debugfs_entry {
 	struct dentry   *dentry;
 	bool             dump_register;
+	bool             disable_frame_dispatch;
+};
+
+/**
+ * struct cam_lrme_ctx_dispatch : Per context frame dispatch state
+ *
+ * @device_index : Device the context's in-flight frames are queued on
+ * @num_inflight : Number of frames dispatched and not yet returned
+ * @all_devices  : Whether all compatible devices were started for the
+ *                 context, which allows dispatching to any of them
+ */
+struct cam_lrme_ctx_dispatch {
+	uint32_t device_index;
+	uint32_t num_inflight;
+	bool     all_devices;
 };
 
 /**
@@ -75,6 +92,11 @@ struct cam_lrme_debugfs_entry {
  * @frame_pending_list_normal : Normal priority request queue
  * @high_req_lock             : Spinlock of high priority queue
  * @normal_req_lock           : Spinlock of normal priority queue
+ * @queue_depth               : Frames dispatched to this device, queued or
+ *                              in hw, and not yet returned
+ * @num_frames                : Total number of frames dispatched
+ * @busy_start                : Time queue_depth last became non-zero
+ * @busy_time                 : Accumulated time with queue_depth non-zero
  */
 struct cam_lrme_device {
 	struct cam_lrme_dev_cap        hw_caps;
@@ -87,6 +109,10 @@ struct cam_lrme_device {
 	struct list_head               frame_pending_list_normal;
 	spinlock_t                     high_req_lock;
 	spinlock_t                     normal_req_lock;
+	uint32_t                       queue_depth;
+	uint64_t                       num_frames;
+	ktime_t                        busy_start;
+	ktime_t                        busy_time;
 };
 
 /**
@@ -96,6 +122,8 @@ struct cam_lrme_device {
  * @frame_free_list : List of free frame request
  * @hw_mgr_mutex    : Mutex to protect HW manager data
  * @free_req_lock   :Spinlock to protect frame_free_list
+ * @dispatch_lock   : Spinlock to protect device queue depth and
+ *                    ctx_dispatch
  * @hw_device       : List of HW devices
  * @device_iommu    : Device iommu
  * @cdm_iommu       : cdm iommu
@@ -103,12 +131,14 @@ struct cam_lrme_device {
  * @lrme_caps       : LRME capabilities
  * @event_cb        : IRQ callback function
  * @debugfs_entry   : debugfs entry to set debug prop
+ * @ctx_dispatch    : Per context frame dispatch state
  */
 struct cam_lrme_hw_mgr {
 	uint32_t                      device_count;
 	struct list_head              frame_free_list;
 	struct mutex                  hw_mgr_mutex;
 	spinlock_t                    free_req_lock;
+	spinlock_t                    dispatch_lock;
 	struct cam_lrme_device        hw_device[CAM_LRME_HW_MAX];
 	struct cam_iommu_handle       device_iommu;
 	struct cam_iommu_handle       cdm_iommu;
@@ -116,6 +146,7 @@ struct cam_lrme_hw_mgr {
 	struct cam_lrme_query_cap_cmd lrme_caps;
 	cam_hw_event_cb_func          event_cb;
 	struct cam_lrme_debugfs_entry debugfs_entry;
+	struct cam_lrme_ctx_dispatch  ctx_dispatch[CAM_CTX_MAX];
 };
 
 int cam_lrme_mgr_register_device(struct cam_hw_intf *lrme_hw_intf,
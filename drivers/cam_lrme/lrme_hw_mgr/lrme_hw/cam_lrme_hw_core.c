@@ -407,6 +407,7 @@ static int cam_lrme_hw_util_process_config_hw(struct cam_hw_info *lrme_hw,
 	mem_base = CAM_SOC_GET_REG_MAP_CAM_BASE(soc_info, CAM_LRME_BASE_IDX);
 
 	hw_cdm_info->cdm_ops->cdm_write_changebase(cmd_buf_addr, mem_base);
+	config_args->changebase_addr = cmd_buf_addr;
 	cmd_buf_addr += size;
 	available_size -= (size * 4);
 
@@ -562,15 +563,26 @@ int cam_lrme_hw_util_get_caps(struct cam_hw_info *lrme_hw,
 	return 0;
 }
 
-static int cam_lrme_hw_util_submit_req(struct cam_lrme_core *lrme_core,
+static int cam_lrme_hw_util_submit_req(struct cam_hw_info *lrme_hw,
 	struct cam_lrme_frame_request *frame_req)
 {
+	struct cam_lrme_core *lrme_core = lrme_hw->core_info;
 	struct cam_lrme_cdm_info *hw_cdm_info =
 		lrme_core->hw_cdm_info;
 	struct cam_cdm_bl_request *cdm_cmd = hw_cdm_info->cdm_cmd;
 	struct cam_hw_update_entry *cmd;
 	int i, rc = 0;
 
+	/*
+	 * The frame may have been prepared on another LRME device, point
+	 * the changebase at the registers of this one.
+	 */
+	if (frame_req->changebase_addr)
+		hw_cdm_info->cdm_ops->cdm_write_changebase(
+			frame_req->changebase_addr,
+			CAM_SOC_GET_REG_MAP_CAM_BASE(&lrme_hw->soc_info,
+			CAM_LRME_BASE_IDX));
+
 	if (frame_req->num_hw_update_entries > 0) {
 		cdm_cmd->cmd_arrary_count = frame_req->num_hw_update_entries;
 		cdm_cmd->type = CAM_CDM_BL_CMD_TYPE_MEM_HANDLE;
@@ -632,7 +644,7 @@ static int cam_lrme_hw_util_flush_ctx(struct cam_hw_info *lrme_hw,
 		submit_args.hw_update_entries = req_submit->hw_update_entries;
 		submit_args.num_hw_update_entries =
 			req_submit->num_hw_update_entries;
-		rc = cam_lrme_hw_util_submit_req(lrme_core, req_submit);
+		rc = cam_lrme_hw_util_submit_req(lrme_hw, req_submit);
 		if (rc)
 			CAM_ERR(CAM_LRME, "Submit failed");
 		lrme_core->req_submit = req_submit;
@@ -651,7 +663,7 @@ static int cam_lrme_hw_util_flush_ctx(struct cam_hw_info *lrme_hw,
 		submit_args.hw_update_entries = req_proc->hw_update_entries;
 		submit_args.num_hw_update_entries =
 			req_proc->num_hw_update_entries;
-		rc = cam_lrme_hw_util_submit_req(lrme_core, req_proc);
+		rc = cam_lrme_hw_util_submit_req(lrme_hw, req_proc);
 		if (rc)
 			CAM_ERR(CAM_LRME, "Submit failed");
 		lrme_core->req_submit = req_proc;
@@ -694,7 +706,7 @@ static int cam_lrme_hw_util_flush_req(struct cam_hw_info *lrme_hw,
 		submit_args.hw_update_entries = req_submit->hw_update_entries;
 		submit_args.num_hw_update_entries =
 			req_submit->num_hw_update_entries;
-		rc = cam_lrme_hw_util_submit_req(lrme_core, req_submit);
+		rc = cam_lrme_hw_util_submit_req(lrme_hw, req_submit);
 		if (rc)
 			CAM_ERR(CAM_LRME, "Submit failed");
 		lrme_core->req_submit = req_submit;
@@ -713,7 +725,7 @@ static int cam_lrme_hw_util_flush_req(struct cam_hw_info *lrme_hw,
 		submit_args.hw_update_entries = req_proc->hw_update_entries;
 		submit_args.num_hw_update_entries =
 			req_proc->num_hw_update_entries;
-		rc = cam_lrme_hw_util_submit_req(lrme_core, req_proc);
+		rc = cam_lrme_hw_util_submit_req(lrme_hw, req_proc);
 		if (rc)
 			CAM_ERR(CAM_LRME, "Submit failed");
 		lrme_core->req_submit = req_proc;
@@ -1114,7 +1126,7 @@ int cam_lrme_hw_submit_req(void *hw_priv, void *hw_submit_args,
 		return -EBUSY;
 	}
 
-	rc = cam_lrme_hw_util_submit_req(lrme_core, frame_req);
+	rc = cam_lrme_hw_util_submit_req(lrme_hw, frame_req);
 	if (rc) {
 		CAM_ERR(CAM_LRME, "Submit req failed");
 		goto error;
@@ -89,6 +89,8 @@ enum cam_lrme_hw_reset_type {
  * @hw_device             : Pointer to HW device
  * @hw_update_entries     : List of hw_update_entries
  * @num_hw_update_entries : number of hw_update_entries
+ * @changebase_addr       : Changebase command in the KMD buffer, rewritten
+ *                          with the base of the device the frame runs on
  * @submit_timestamp      : timestamp of submitting request with hw
  */
 struct cam_lrme_frame_request {
@@ -98,6 +100,7 @@ struct cam_lrme_frame_request {
 	struct cam_lrme_device    *hw_device;
 	struct cam_hw_update_entry hw_update_entries[CAM_LRME_MAX_HW_ENTRIES];
 	uint32_t                   num_hw_update_entries;
+	uint32_t                  *changebase_addr;
 	ktime_t                    submit_timestamp;
 };
 
@@ -127,6 +130,7 @@ struct cam_lrme_hw_io_buffer {
  * @cmd_buf_addr    : Pointer to available KMD buffer
  * @size            : Available KMD buffer size
  * @config_buf_size : Size used to prepare update
+ * @changebase_addr : Changebase command written by prepare
  */
 struct cam_lrme_hw_cmd_config_args {
 	struct cam_lrme_device *hw_device;
@@ -135,6 +139,7 @@ struct cam_lrme_hw_cmd_config_args {
 	uint32_t *cmd_buf_addr;
 	uint32_t size;
 	uint32_t config_buf_size;
+	uint32_t *changebase_addr;
 };
 
 /**
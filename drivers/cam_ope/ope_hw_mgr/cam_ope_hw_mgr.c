@@ -17,6 +17,7 @@
 #include <linux/bitops.h>
 #include <linux/delay.h>
 #include <linux/debugfs.h>
+#include <linux/vmalloc.h>
 #include <media/cam_defs.h>
 #include <media/cam_ope.h>
 #include <media/cam_cpas.h>
@@ -179,20 +180,124 @@ static int cam_ope_mgr_reset_hw(void)
 	return rc;
 }
 
-static void cam_ope_free_io_config(struct cam_ope_request *req)
+static void cam_ope_free_req_pool(struct cam_ope_ctx *ctx)
+{
+	struct cam_ope_req_pool *pool = &ctx->req_pool;
+
+	vfree(pool->io_buf);
+	vfree(pool->cdm_cmd);
+	vfree(pool->req);
+	memset(pool, 0, sizeof(*pool));
+}
+
+static int cam_ope_alloc_req_pool(struct cam_ope_ctx *ctx)
+{
+	struct cam_ope_req_pool *pool = &ctx->req_pool;
+	uint32_t batch_size, io_per_batch;
+
+	batch_size = clamp_t(uint32_t, ctx->ope_acquire.batch_size,
+		1, OPE_MAX_BATCH_SIZE);
+	io_per_batch = clamp_t(uint32_t, ctx->ope_acquire.num_in_res +
+		ctx->ope_acquire.num_out_res, 1, OPE_MAX_IO_BUFS);
+
+	pool->cdm_cmd_size = ALIGN(sizeof(struct cam_cdm_bl_request) +
+		((OPE_MAX_CDM_BLS - 1) * sizeof(struct cam_cdm_bl_cmd)),
+		sizeof(uint64_t));
+	pool->num_io_buf = CAM_CTX_REQ_MAX * batch_size * io_per_batch;
+
+	pool->req = vzalloc(CAM_CTX_REQ_MAX * sizeof(struct cam_ope_request));
+	pool->cdm_cmd = vzalloc(CAM_CTX_REQ_MAX * pool->cdm_cmd_size);
+	pool->io_buf = vzalloc(pool->num_io_buf * sizeof(struct ope_io_buf));
+	if (!pool->req || !pool->cdm_cmd || !pool->io_buf) {
+		CAM_ERR(CAM_OPE, "ctx: %d req pool alloc failed io_bufs: %u",
+			ctx->ctx_id, pool->num_io_buf);
+		cam_ope_free_req_pool(ctx);
+		return -ENOMEM;
+	}
+
+	pool->batch_size = batch_size;
+	pool->io_per_batch = io_per_batch;
+	CAM_DBG(CAM_OPE, "ctx: %d req pool batch: %u io_per_batch: %u",
+		ctx->ctx_id, batch_size, io_per_batch);
+
+	return 0;
+}
+
+static struct ope_io_buf *cam_ope_get_io_buf(struct cam_ope_ctx *ctx,
+	uint32_t req_idx, uint32_t batch_idx, uint32_t io_idx)
+{
+	struct cam_ope_req_pool *pool = &ctx->req_pool;
+	struct ope_io_buf *io_buf;
+
+	if (batch_idx < pool->batch_size && io_idx < pool->io_per_batch) {
+		io_buf = &pool->io_buf[((req_idx * pool->batch_size) +
+			batch_idx) * pool->io_per_batch + io_idx];
+		memset(io_buf, 0, sizeof(*io_buf));
+		return io_buf;
+	}
+
+	ope_hw_mgr->pool_io_buf_miss++;
+	CAM_DBG(CAM_OPE, "ctx: %d io buf %u:%u outside pool %u:%u",
+		ctx->ctx_id, batch_idx, io_idx, pool->batch_size,
+		pool->io_per_batch);
+
+	return kzalloc(sizeof(struct ope_io_buf), GFP_KERNEL);
+}
+
+static bool cam_ope_is_pool_io_buf(struct cam_ope_ctx *ctx,
+	struct ope_io_buf *io_buf)
+{
+	struct cam_ope_req_pool *pool = &ctx->req_pool;
+
+	return pool->io_buf && io_buf >= pool->io_buf &&
+		io_buf < pool->io_buf + pool->num_io_buf;
+}
+
+static void cam_ope_free_io_config(struct cam_ope_ctx *ctx,
+	struct cam_ope_request *req)
 {
 	int i, j;
 
 	for (i = 0; i < OPE_MAX_BATCH_SIZE; i++) {
 		for (j = 0; j < OPE_MAX_IO_BUFS; j++) {
-			if (req->io_buf[i][j]) {
+			if (!req->io_buf[i][j])
+				continue;
+
+			if (!cam_ope_is_pool_io_buf(ctx, req->io_buf[i][j]))
 				cam_free_clear((void *)req->io_buf[i][j]);
-				req->io_buf[i][j] = NULL;
-			}
+			req->io_buf[i][j] = NULL;
 		}
 	}
 }
 
+static struct cam_ope_request *cam_ope_get_req(struct cam_ope_ctx *ctx,
+	uint32_t req_idx)
+{
+	struct cam_ope_req_pool *pool = &ctx->req_pool;
+	struct cam_ope_request *req;
+
+	req = &pool->req[req_idx];
+	memset(req, 0, sizeof(*req));
+	req->cdm_cmd = (struct cam_cdm_bl_request *)
+		((uint8_t *)pool->cdm_cmd + (req_idx * pool->cdm_cmd_size));
+	memset(req->cdm_cmd, 0, pool->cdm_cmd_size);
+	ctx->req_list[req_idx] = req;
+
+	return req;
+}
+
+static void cam_ope_put_req(struct cam_ope_ctx *ctx, uint32_t req_idx)
+{
+	struct cam_ope_request *req = ctx->req_list[req_idx];
+
+	if (req) {
+		cam_ope_free_io_config(ctx, req);
+		req->cdm_cmd = NULL;
+		ctx->req_list[req_idx] = NULL;
+	}
+	clear_bit(req_idx, ctx->bitmap);
+}
+
 static void cam_ope_device_timer_stop(struct cam_ope_hw_mgr *hw_mgr)
 {
 	if (hw_mgr->clk_info.watch_dog) {
@@ -1721,12 +1826,7 @@ static void cam_ope_ctx_cdm_callback(uint32_t handle, void *userdata,
 
 	buf_data.request_id = ope_req->request_id;
 	ope_req->request_id = 0;
-	cam_free_clear((void *)ctx->req_list[cookie]->cdm_cmd);
-	ctx->req_list[cookie]->cdm_cmd = NULL;
-	cam_ope_free_io_config(ctx->req_list[cookie]);
-	cam_free_clear((void *)ctx->req_list[cookie]);
-	ctx->req_list[cookie] = NULL;
-	clear_bit(cookie, ctx->bitmap);
+	cam_ope_put_req(ctx, cookie);
 	ctx->ctxt_event_cb(ctx->context_priv, evt_id, &buf_data);
 
 end:
@@ -1977,12 +2077,12 @@ static int cam_ope_mgr_process_cmd_io_buf_req(struct cam_ope_hw_mgr *hw_mgr,
 
 		for (j = 0; j < in_frame_set->num_io_bufs; j++) {
 			in_io_buf = &in_frame_set->io_buf[j];
-			ope_request->io_buf[i][j] =
-				kzalloc(sizeof(struct ope_io_buf), GFP_KERNEL);
+			ope_request->io_buf[i][j] = cam_ope_get_io_buf(
+				ctx_data, req_idx, i, j);
 			if (!ope_request->io_buf[i][j]) {
 				CAM_ERR(CAM_OPE,
 					"IO config allocation failure");
-				cam_ope_free_io_config(ope_request);
+				cam_ope_free_io_config(ctx_data, ope_request);
 				return -ENOMEM;
 			}
 			io_buf = ope_request->io_buf[i][j];
@@ -2648,10 +2748,15 @@ static int cam_ope_mgr_acquire_hw(void *hw_priv, void *hw_acquire_args)
 		goto end;
 	}
 
+	rc = cam_ope_alloc_req_pool(ctx);
+	if (rc)
+		goto end;
+
 	cdm_acquire = kzalloc(sizeof(struct cam_cdm_acquire_data), GFP_KERNEL);
 	if (!cdm_acquire) {
 		CAM_ERR(CAM_ISP, "Out of memory");
-		goto end;
+		rc = -ENOMEM;
+		goto free_req_pool;
 	}
 	strlcpy(cdm_acquire->identifier, "ope", sizeof("ope"));
 	if (ctx->ope_acquire.dev_type == OPE_DEV_TYPE_OPE_RT) {
@@ -2857,6 +2962,8 @@ cdm_acquire_failed:
 free_cdm_acquire:
 	cam_free_clear((void *)cdm_acquire);
 	cdm_acquire = NULL;
+free_req_pool:
+	cam_ope_free_req_pool(ctx);
 end:
 	args->ctxt_to_hw_map = NULL;
 	cam_ope_put_free_ctx(hw_mgr, ctx_id);
@@ -2966,15 +3073,9 @@ static int cam_ope_mgr_release_ctx(struct cam_ope_hw_mgr *hw_mgr, int ctx_id)
 		if (!hw_mgr->ctx[ctx_id].req_list[i])
 			continue;
 
-		if (hw_mgr->ctx[ctx_id].req_list[i]->cdm_cmd) {
-			cam_free_clear((void *)hw_mgr->ctx[ctx_id].req_list[i]->cdm_cmd);
-			hw_mgr->ctx[ctx_id].req_list[i]->cdm_cmd = NULL;
-		}
-		cam_ope_free_io_config(hw_mgr->ctx[ctx_id].req_list[i]);
-		cam_free_clear((void *)hw_mgr->ctx[ctx_id].req_list[i]);
-		hw_mgr->ctx[ctx_id].req_list[i] = NULL;
-		clear_bit(i, hw_mgr->ctx[ctx_id].bitmap);
+		cam_ope_put_req(&hw_mgr->ctx[ctx_id], i);
 	}
+	cam_ope_free_req_pool(&hw_mgr->ctx[ctx_id]);
 
 	cam_ope_req_timer_stop(&hw_mgr->ctx[ctx_id]);
 	hw_mgr->ctx[ctx_id].ope_cdm.cdm_handle = 0;
@@ -3257,32 +3358,13 @@ static int cam_ope_mgr_prepare_hw_update(void *hw_priv,
 
 	request_idx  = find_first_zero_bit(ctx_data->bitmap, ctx_data->bits);
 	if (request_idx >= CAM_CTX_REQ_MAX || request_idx < 0) {
+		hw_mgr->pool_req_exhausted++;
 		mutex_unlock(&ctx_data->ctx_mutex);
 		CAM_ERR(CAM_OPE, "Invalid ctx req slot = %d", request_idx);
 		return -EINVAL;
 	}
 
-	ctx_data->req_list[request_idx] =
-		kzalloc(sizeof(struct cam_ope_request), GFP_KERNEL);
-	if (!ctx_data->req_list[request_idx]) {
-		CAM_ERR(CAM_OPE, "mem allocation failed ctx:%d req_idx:%d",
-			ctx_data->ctx_id, request_idx);
-		rc = -ENOMEM;
-		goto req_mem_alloc_failed;
-	}
-
-	ope_req = ctx_data->req_list[request_idx];
-	ope_req->cdm_cmd =
-		kzalloc(((sizeof(struct cam_cdm_bl_request)) +
-			((OPE_MAX_CDM_BLS - 1) *
-			sizeof(struct cam_cdm_bl_cmd))),
-			GFP_KERNEL);
-	if (!ope_req->cdm_cmd) {
-		CAM_ERR(CAM_OPE, "Cdm mem alloc failed ctx:%d req_idx:%d",
-			ctx_data->ctx_id, request_idx);
-		rc = -ENOMEM;
-		goto req_cdm_mem_alloc_failed;
-	}
+	ope_req = cam_ope_get_req(ctx_data, request_idx);
 
 	rc = cam_ope_mgr_process_cmd_desc(hw_mgr, packet,
 		ctx_data, &ope_cmd_buf_addr, request_idx);
@@ -3343,13 +3425,7 @@ static int cam_ope_mgr_prepare_hw_update(void *hw_priv,
 
 end:
 	cam_ope_mgr_put_cmd_buf(packet);
-	cam_free_clear((void *)ctx_data->req_list[request_idx]->cdm_cmd);
-	ctx_data->req_list[request_idx]->cdm_cmd = NULL;
-req_cdm_mem_alloc_failed:
-	cam_free_clear((void *)ctx_data->req_list[request_idx]);
-	ctx_data->req_list[request_idx] = NULL;
-req_mem_alloc_failed:
-	clear_bit(request_idx, ctx_data->bitmap);
+	cam_ope_put_req(ctx_data, request_idx);
 	mutex_unlock(&ctx_data->ctx_mutex);
 	return rc;
 }
@@ -3371,12 +3447,7 @@ static int cam_ope_mgr_handle_config_err(
 
 	req_idx = ope_req->req_idx;
 	ope_req->request_id = 0;
-	cam_free_clear((void *)ctx_data->req_list[req_idx]->cdm_cmd);
-	ctx_data->req_list[req_idx]->cdm_cmd = NULL;
-	cam_ope_free_io_config(ctx_data->req_list[req_idx]);
-	cam_free_clear((void *)ctx_data->req_list[req_idx]);
-	ctx_data->req_list[req_idx] = NULL;
-	clear_bit(req_idx, ctx_data->bitmap);
+	cam_ope_put_req(ctx_data, req_idx);
 
 	return 0;
 }
@@ -3559,12 +3630,7 @@ static int cam_ope_mgr_flush_req(struct cam_ope_ctx *ctx_data,
 			continue;
 
 		ctx_data->req_list[idx]->request_id = 0;
-		cam_free_clear((void *)ctx_data->req_list[idx]->cdm_cmd);
-		ctx_data->req_list[idx]->cdm_cmd = NULL;
-		cam_ope_free_io_config(ctx_data->req_list[idx]);
-		cam_free_clear((void *)ctx_data->req_list[idx]);
-		ctx_data->req_list[idx] = NULL;
-		clear_bit(idx, ctx_data->bitmap);
+		cam_ope_put_req(ctx_data, idx);
 	}
 
 	return 0;
@@ -3592,12 +3658,7 @@ static int cam_ope_mgr_flush_all(struct cam_ope_ctx *ctx_data,
 			continue;
 
 		ctx_data->req_list[i]->request_id = 0;
-		cam_free_clear((void *)ctx_data->req_list[i]->cdm_cmd);
-		ctx_data->req_list[i]->cdm_cmd = NULL;
-		cam_ope_free_io_config(ctx_data->req_list[i]);
-		cam_free_clear((void *)ctx_data->req_list[i]);
-		ctx_data->req_list[i] = NULL;
-		clear_bit(i, ctx_data->bitmap);
+		cam_ope_put_req(ctx_data, i);
 	}
 	mutex_unlock(&ctx_data->ctx_mutex);
 
@@ -3961,6 +4022,11 @@ static int cam_ope_create_debug_fs(void)
 		goto err;
 	}
 
+	debugfs_create_u64("pool_req_exhausted", 0444,
+		ope_hw_mgr->dentry, &ope_hw_mgr->pool_req_exhausted);
+	debugfs_create_u64("pool_io_buf_miss", 0444,
+		ope_hw_mgr->dentry, &ope_hw_mgr->pool_io_buf_miss);
+
 	return 0;
 err:
 	debugfs_remove_recursive(ope_hw_mgr->dentry);
@@ -425,6 +425,27 @@ struct cam_ope_cdm {
 	struct cam_cdm_utils_ops *cdm_ops;
 };
 
+/**
+ * struct cam_ope_req_pool
+ *
+ * @req:             Request slots, one per ctx request index
+ * @cdm_cmd:         CDM BL requests, one per request slot
+ * @cdm_cmd_size:    Size of one CDM BL request in @cdm_cmd
+ * @io_buf:          IO config buffers carved up per request slot
+ * @num_io_buf:      Total number of entries in @io_buf
+ * @batch_size:      Batches per request slot covered by @io_buf
+ * @io_per_batch:    IO buffers per batch covered by @io_buf
+ */
+struct cam_ope_req_pool {
+	struct cam_ope_request *req;
+	void *cdm_cmd;
+	size_t cdm_cmd_size;
+	struct ope_io_buf *io_buf;
+	uint32_t num_io_buf;
+	uint32_t batch_size;
+	uint32_t io_per_batch;
+};
+
 /**
  * struct cam_ope_ctx
  *
@@ -440,6 +461,7 @@ struct cam_ope_cdm {
  * @ope_acquire:     OPE acquire command
  * @ctxt_event_cb:   Callback of a context
  * @req_list:        Request List
+ * @req_pool:        Request memory preallocated at acquire
  * @ope_cdm:         OPE CDM info
  * @last_req_time:   Timestamp of last request
  * @req_watch_dog:   Watchdog for requests
@@ -463,6 +485,7 @@ struct cam_ope_ctx {
 	struct ope_acquire_dev_info ope_acquire;
 	cam_hw_event_cb_func ctxt_event_cb;
 	struct cam_ope_request *req_list[CAM_CTX_REQ_MAX];
+	struct cam_ope_req_pool req_pool;
 	struct cam_ope_cdm ope_cdm;
 	uint64_t last_req_time;
 	struct cam_req_mgr_timer *req_watch_dog;
@@ -525,6 +548,8 @@ struct cam_ope_hw_intf_data {
  * @dentry:               Pointer to OPE debugfs directory
  * @frame_dump_enable:    OPE frame setting dump enablement
  * @dump_req_data_enable: OPE hang dump enablement
+ * @pool_req_exhausted:   Requests rejected for lack of a free ctx slot
+ * @pool_io_buf_miss:     IO buffers allocated outside the ctx request pool
  */
 struct cam_ope_hw_mgr {
 	int32_t             open_cnt;
@@ -559,6 +584,8 @@ struct cam_ope_hw_mgr {
 	struct dentry *dentry;
 	bool   frame_dump_enable;
 	bool   dump_req_data_enable;
+	uint64_t pool_req_exhausted;
+	uint64_t pool_io_buf_miss;
 };
 
 /**
@@ -495,6 +495,41 @@ static int dump_stripe_cmd(struct ope_frame_process *frm_proc,
 	return 0;
 }
 
+static bool ope_cmd_buf_needs_cpu_map(bool frame_dump,
+	struct ope_cmd_buf_info *cmd_buf)
+{
+	/* Direct buffers are only read back by the KMD for frame dumps */
+	return cmd_buf->type != OPE_CMD_BUF_TYPE_DIRECT || frame_dump;
+}
+
+static void ope_map_stripe_cmd_bufs(struct ope_frame_process *frm_proc,
+	int batch_idx, struct ope_stripe_cmd_map *map)
+{
+	int8_t last[OPE_MAX_STRIPES];
+	struct ope_cmd_buf_info *cmd_buf;
+	uint32_t stripe_idx;
+	int k;
+
+	memset(map, -1, sizeof(*map));
+	for (k = 0; k < frm_proc->num_cmd_bufs[batch_idx] &&
+		k < OPE_MAX_CMD_BUFS; k++) {
+		cmd_buf = &frm_proc->cmd_buf[batch_idx][k];
+		if (cmd_buf->cmd_buf_scope != OPE_CMD_BUF_SCOPE_STRIPE ||
+			!cmd_buf->mem_handle)
+			continue;
+
+		stripe_idx = cmd_buf->stripe_idx;
+		if (stripe_idx >= OPE_MAX_STRIPES)
+			continue;
+
+		if (map->first[stripe_idx] < 0)
+			map->first[stripe_idx] = k;
+		else
+			map->next[last[stripe_idx]] = k;
+		last[stripe_idx] = k;
+	}
+}
+
 static uint32_t *ope_create_frame_cmd_batch(struct cam_ope_hw_mgr *hw_mgr,
 	struct cam_ope_ctx *ctx_data, uint32_t req_idx,
 	uint32_t *kmd_buf, uint32_t buffered, int batch_idx,
@@ -513,9 +548,11 @@ static uint32_t *ope_create_frame_cmd_batch(struct cam_ope_hw_mgr *hw_mgr,
 	uint32_t print_idx;
 	uint32_t *print_ptr;
 	int num_dmi = 0;
+	bool cpu_mapped, frame_dump;
 	struct cam_cdm_utils_ops *cdm_ops;
 
 	frm_proc = ope_dev_prepare_req->frame_process;
+	frame_dump = ope_dev_prepare_req->frame_dump;
 	ope_request = ctx_data->req_list[req_idx];
 	cdm_ops = ctx_data->ope_cdm.cdm_ops;
 	wr_cdm_info =
@@ -557,10 +594,15 @@ static uint32_t *ope_create_frame_cmd_batch(struct cam_ope_hw_mgr *hw_mgr,
 		}
 		iova_addr = iova_addr + frm_proc->cmd_buf[i][j].offset;
 
-		rc = cam_mem_get_cpu_buf(
-			frm_proc->cmd_buf[i][j].mem_handle,
-			&cpu_addr, &buf_len);
-		if (rc || !cpu_addr) {
+		cpu_mapped = ope_cmd_buf_needs_cpu_map(frame_dump,
+			&frm_proc->cmd_buf[i][j]);
+		if (cpu_mapped)
+			rc = cam_mem_get_cpu_buf(
+				frm_proc->cmd_buf[i][j].mem_handle,
+				&cpu_addr, &buf_len);
+		else
+			cpu_addr = 0;
+		if (cpu_mapped && (rc || !cpu_addr)) {
 			CAM_ERR(CAM_OPE, "get cmd buf failed %x",
 				hw_mgr->iommu_hdl);
 			return NULL;
@@ -573,8 +615,9 @@ static uint32_t *ope_create_frame_cmd_batch(struct cam_ope_hw_mgr *hw_mgr,
 				iova_addr,
 				frm_proc->cmd_buf[i][j].length);
 			print_ptr = (uint32_t *)cpu_addr;
-			dump_direct_cmd(print_idx, print_ptr,
-				frm_proc, i, j);
+			if (frame_dump)
+				dump_direct_cmd(print_idx, print_ptr,
+					frm_proc, i, j);
 		} else {
 			num_dmi = frm_proc->cmd_buf[i][j].length /
 				sizeof(struct cdm_dmi_cmd);
@@ -596,7 +639,7 @@ static uint32_t *ope_create_frame_cmd_batch(struct cam_ope_hw_mgr *hw_mgr,
 					0, dmi_cmd->DMIAddr,
 					dmi_cmd->DMISel, dmi_cmd->addr,
 					dmi_cmd->length);
-				if (hw_mgr->frame_dump_enable)
+				if (frame_dump)
 					dump_dmi_cmd(print_idx,
 						print_ptr, dmi_cmd, temp);
 				print_ptr +=
@@ -605,11 +648,13 @@ static uint32_t *ope_create_frame_cmd_batch(struct cam_ope_hw_mgr *hw_mgr,
 			}
 			CAM_DBG(CAM_OPE, "Frame DB : In direct: X");
 		}
-		if (hw_mgr->frame_dump_enable)
+		if (frame_dump)
 			dump_frame_cmd(frm_proc, i, j,
 				iova_addr, kmd_buf, buf_len);
 
-		cam_mem_put_cpu_buf(frm_proc->cmd_buf[i][j].mem_handle);
+		if (cpu_mapped)
+			cam_mem_put_cpu_buf(
+				frm_proc->cmd_buf[i][j].mem_handle);
 	}
 	return kmd_buf;
 
@@ -678,9 +723,11 @@ static uint32_t *ope_create_frame_cmd(struct cam_ope_hw_mgr *hw_mgr,
 	uint32_t print_idx;
 	uint32_t *print_ptr;
 	int num_dmi = 0;
+	bool cpu_mapped, frame_dump;
 	struct cam_cdm_utils_ops *cdm_ops;
 
 	frm_proc = ope_dev_prepare_req->frame_process;
+	frame_dump = ope_dev_prepare_req->frame_dump;
 	ope_request = ctx_data->req_list[req_idx];
 	cdm_ops = ctx_data->ope_cdm.cdm_ops;
 	wr_cdm_info =
@@ -717,10 +764,15 @@ static uint32_t *ope_create_frame_cmd(struct cam_ope_hw_mgr *hw_mgr,
 			}
 			iova_addr = iova_addr + frm_proc->cmd_buf[i][j].offset;
 
-			rc = cam_mem_get_cpu_buf(
-				frm_proc->cmd_buf[i][j].mem_handle,
-				&cpu_addr, &buf_len);
-			if (rc || !cpu_addr) {
+			cpu_mapped = ope_cmd_buf_needs_cpu_map(frame_dump,
+				&frm_proc->cmd_buf[i][j]);
+			if (cpu_mapped)
+				rc = cam_mem_get_cpu_buf(
+					frm_proc->cmd_buf[i][j].mem_handle,
+					&cpu_addr, &buf_len);
+			else
+				cpu_addr = 0;
+			if (cpu_mapped && (rc || !cpu_addr)) {
 				CAM_ERR(CAM_OPE, "get cmd buf failed %x",
 					hw_mgr->iommu_hdl);
 				return NULL;
@@ -733,7 +785,7 @@ static uint32_t *ope_create_frame_cmd(struct cam_ope_hw_mgr *hw_mgr,
 					iova_addr,
 					frm_proc->cmd_buf[i][j].length);
 				print_ptr = (uint32_t *)cpu_addr;
-				if (hw_mgr->frame_dump_enable)
+				if (frame_dump)
 					dump_direct_cmd(print_idx, print_ptr,
 						frm_proc, i, j);
 			} else {
@@ -759,7 +811,7 @@ static uint32_t *ope_create_frame_cmd(struct cam_ope_hw_mgr *hw_mgr,
 						0, dmi_cmd->DMIAddr,
 						dmi_cmd->DMISel, dmi_cmd->addr,
 						dmi_cmd->length);
-					if (hw_mgr->frame_dump_enable)
+					if (frame_dump)
 						dump_dmi_cmd(print_idx,
 							print_ptr, dmi_cmd,
 							temp);
@@ -769,11 +821,13 @@ static uint32_t *ope_create_frame_cmd(struct cam_ope_hw_mgr *hw_mgr,
 				}
 				CAM_DBG(CAM_OPE, "Frame DB : In direct: X");
 			}
-			if (hw_mgr->frame_dump_enable)
+			if (frame_dump)
 				dump_frame_cmd(frm_proc, i, j,
 					iova_addr, kmd_buf, buf_len);
 
-			cam_mem_put_cpu_buf(frm_proc->cmd_buf[i][j].mem_handle);
+			if (cpu_mapped)
+				cam_mem_put_cpu_buf(
+					frm_proc->cmd_buf[i][j].mem_handle);
 		}
 	}
 	return kmd_buf;
@@ -785,7 +839,9 @@ static uint32_t *ope_create_stripe_cmd(struct cam_ope_hw_mgr *hw_mgr,
 	int batch_idx,
 	int s_idx,
 	uint32_t stripe_idx,
-	struct ope_frame_process *frm_proc)
+	struct ope_frame_process *frm_proc,
+	struct ope_stripe_cmd_map *map,
+	bool frame_dump)
 {
 	int rc = 0, i, j, k;
 	uint32_t temp[3];
@@ -796,6 +852,7 @@ static uint32_t *ope_create_stripe_cmd(struct cam_ope_hw_mgr *hw_mgr,
 	uint32_t print_idx;
 	uint32_t *print_ptr;
 	int num_dmi = 0;
+	bool cpu_mapped;
 	struct cam_cdm_utils_ops *cdm_ops;
 	uint32_t reg_val_pair[2];
 	struct cam_hw_info *ope_dev;
@@ -814,18 +871,8 @@ static uint32_t *ope_create_stripe_cmd(struct cam_ope_hw_mgr *hw_mgr,
 	j = s_idx;
 	cdm_ops = ctx_data->ope_cdm.cdm_ops;
 	/* cmd buffer stripes */
-	for (k = 0; k < frm_proc->num_cmd_bufs[i]; k++) {
-		if (frm_proc->cmd_buf[i][k].cmd_buf_scope !=
-			OPE_CMD_BUF_SCOPE_STRIPE)
-			continue;
-
-		if (frm_proc->cmd_buf[i][k].stripe_idx !=
-			stripe_idx)
-			continue;
-
-		if (!frm_proc->cmd_buf[i][k].mem_handle)
-			continue;
-
+	k = stripe_idx < OPE_MAX_STRIPES ? map->first[stripe_idx] : -1;
+	for (; k >= 0; k = map->next[k]) {
 		CAM_DBG(CAM_OPE, "process stripe %d", stripe_idx);
 		rc = cam_mem_get_io_buf(frm_proc->cmd_buf[i][k].mem_handle,
 			hw_mgr->iommu_cdm_hdl, &iova_addr, &buf_len, NULL);
@@ -835,9 +882,15 @@ static uint32_t *ope_create_stripe_cmd(struct cam_ope_hw_mgr *hw_mgr,
 			return NULL;
 		}
 		iova_addr = iova_addr + frm_proc->cmd_buf[i][k].offset;
-		rc = cam_mem_get_cpu_buf(frm_proc->cmd_buf[i][k].mem_handle,
-			&cpu_addr, &buf_len);
-		if (rc || !cpu_addr) {
+		cpu_mapped = ope_cmd_buf_needs_cpu_map(frame_dump,
+			&frm_proc->cmd_buf[i][k]);
+		if (cpu_mapped)
+			rc = cam_mem_get_cpu_buf(
+				frm_proc->cmd_buf[i][k].mem_handle,
+				&cpu_addr, &buf_len);
+		else
+			cpu_addr = 0;
+		if (cpu_mapped && (rc || !cpu_addr)) {
 			CAM_DBG(CAM_OPE, "get cmd buf fail %x",
 				hw_mgr->iommu_hdl);
 			return NULL;
@@ -852,7 +905,7 @@ static uint32_t *ope_create_stripe_cmd(struct cam_ope_hw_mgr *hw_mgr,
 			print_ptr = (uint32_t *)cpu_addr;
 			CAM_DBG(CAM_OPE, "Stripe:%d direct:E",
 				stripe_idx);
-			if (hw_mgr->frame_dump_enable)
+			if (frame_dump)
 				dump_direct_cmd(print_idx, print_ptr,
 					frm_proc, i, k);
 			CAM_DBG(CAM_OPE, "Stripe:%d direct:X", stripe_idx);
@@ -875,7 +928,7 @@ static uint32_t *ope_create_stripe_cmd(struct cam_ope_hw_mgr *hw_mgr,
 				kmd_buf = cdm_ops->cdm_write_dmi(kmd_buf,
 					0, dmi_cmd->DMIAddr, dmi_cmd->DMISel,
 					dmi_cmd->addr, dmi_cmd->length);
-				if (hw_mgr->frame_dump_enable)
+				if (frame_dump)
 					dump_dmi_cmd(print_idx,
 						print_ptr, dmi_cmd, temp);
 				print_ptr += sizeof(struct cdm_dmi_cmd) /
@@ -884,11 +937,13 @@ static uint32_t *ope_create_stripe_cmd(struct cam_ope_hw_mgr *hw_mgr,
 			CAM_DBG(CAM_OPE, "Stripe:%d Indirect:X", stripe_idx);
 		}
 
-		if (hw_mgr->frame_dump_enable)
+		if (frame_dump)
 			dump_stripe_cmd(frm_proc, stripe_idx, i, k,
 				iova_addr, kmd_buf, buf_len);
 
-		cam_mem_put_cpu_buf(frm_proc->cmd_buf[i][k].mem_handle);
+		if (cpu_mapped)
+			cam_mem_put_cpu_buf(
+				frm_proc->cmd_buf[i][k].mem_handle);
 	}
 
 	ope_dev = hw_mgr->ope_dev_intf[0]->hw_priv;
@@ -973,6 +1028,7 @@ static uint32_t *ope_create_stripes_batch(struct cam_ope_hw_mgr *hw_mgr,
 	struct ope_frame_process *frm_proc;
 	uint32_t stripe_idx = 0;
 	struct cam_cdm_utils_ops *cdm_ops;
+	struct ope_stripe_cmd_map map;
 
 	frm_proc = ope_dev_prepare_req->frame_process;
 	ope_request = ctx_data->req_list[req_idx];
@@ -984,6 +1040,7 @@ static uint32_t *ope_create_stripes_batch(struct cam_ope_hw_mgr *hw_mgr,
 	}
 	i = batch_idx;
 	/* Stripes */
+	ope_map_stripe_cmd_bufs(frm_proc, i, &map);
 
 	wr_cdm_info =
 		&ope_dev_prepare_req->wr_cdm_batch->io_port_cdm[i];
@@ -992,7 +1049,8 @@ static uint32_t *ope_create_stripes_batch(struct cam_ope_hw_mgr *hw_mgr,
 	for (j = 0; j < ope_request->num_stripes[i]; j++) {
 		/* cmd buffer stripes */
 		kmd_buf = ope_create_stripe_cmd(hw_mgr, ctx_data,
-			kmd_buf, i, j, stripe_idx, frm_proc);
+			kmd_buf, i, j, stripe_idx, frm_proc, &map,
+			ope_dev_prepare_req->frame_dump);
 		if (!kmd_buf)
 			goto end;
 
@@ -1044,6 +1102,7 @@ static uint32_t *ope_create_stripes(struct cam_ope_hw_mgr *hw_mgr,
 	struct ope_frame_process *frm_proc;
 	uint32_t stripe_idx = 0;
 	struct cam_cdm_utils_ops *cdm_ops;
+	struct ope_stripe_cmd_map map;
 
 	frm_proc = ope_dev_prepare_req->frame_process;
 	ope_request = ctx_data->req_list[req_idx];
@@ -1051,6 +1110,7 @@ static uint32_t *ope_create_stripes(struct cam_ope_hw_mgr *hw_mgr,
 
 	/* Stripes */
 	for (i = 0; i < frm_proc->batch_size; i++) {
+		ope_map_stripe_cmd_bufs(frm_proc, i, &map);
 		wr_cdm_info =
 		&ope_dev_prepare_req->wr_cdm_batch->io_port_cdm[i];
 		rd_cdm_info =
@@ -1058,7 +1118,8 @@ static uint32_t *ope_create_stripes(struct cam_ope_hw_mgr *hw_mgr,
 		for (j = 0; j < ope_request->num_stripes[i]; j++) {
 			/* cmd buffer stripes */
 			kmd_buf = ope_create_stripe_cmd(hw_mgr, ctx_data,
-				kmd_buf, i, j, stripe_idx, frm_proc);
+				kmd_buf, i, j, stripe_idx, frm_proc, &map,
+				ope_dev_prepare_req->frame_dump);
 			if (!kmd_buf)
 				goto end;
 
@@ -1111,6 +1172,7 @@ static uint32_t *ope_create_stripes_nrt(struct cam_ope_hw_mgr *hw_mgr,
 	struct ope_frame_process *frm_proc;
 	uint32_t stripe_idx = 0;
 	struct cam_cdm_utils_ops *cdm_ops;
+	struct ope_stripe_cmd_map map;
 	uint32_t len;
 	int num_nrt_stripes, num_arb;
 
@@ -1127,6 +1189,7 @@ static uint32_t *ope_create_stripes_nrt(struct cam_ope_hw_mgr *hw_mgr,
 
 	/* Stripes */
 	for (i = 0; i < frm_proc->batch_size; i++) {
+		ope_map_stripe_cmd_bufs(frm_proc, i, &map);
 		wr_cdm_info =
 		&ope_dev_prepare_req->wr_cdm_batch->io_port_cdm[i];
 		rd_cdm_info =
@@ -1152,7 +1215,8 @@ static uint32_t *ope_create_stripes_nrt(struct cam_ope_hw_mgr *hw_mgr,
 			}
 			/* cmd buffer stripes */
 			kmd_buf = ope_create_stripe_cmd(hw_mgr, ctx_data,
-				kmd_buf, i, j, stripe_idx, frm_proc);
+				kmd_buf, i, j, stripe_idx, frm_proc, &map,
+				ope_dev_prepare_req->frame_dump);
 			if (!kmd_buf)
 				goto end;
 
@@ -1543,6 +1607,8 @@ static int cam_ope_dev_process_prepare(struct ope_hw *ope_hw, void *cmd_args)
 	struct cam_ope_dev_prepare_req *ope_dev_prepare_req;
 
 	ope_dev_prepare_req = cmd_args;
+	ope_dev_prepare_req->frame_dump =
+		READ_ONCE(ope_dev_prepare_req->hw_mgr->frame_dump_enable);
 
 	rc = cam_ope_top_process(ope_hw, ope_dev_prepare_req->ctx_data->ctx_id,
 		OPE_HW_PREPARE, ope_dev_prepare_req);
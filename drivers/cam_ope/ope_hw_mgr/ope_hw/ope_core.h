@@ -33,6 +33,17 @@ struct cam_ope_cpas_vote {
 	uint32_t axi_vote_valid;
 };
 
+/**
+ * struct ope_stripe_cmd_map
+ *
+ * @first: First stripe scoped command buffer of each stripe, -1 if none
+ * @next:  Next command buffer of the same stripe, -1 at the end
+ */
+struct ope_stripe_cmd_map {
+	int8_t first[OPE_MAX_STRIPES];
+	int8_t next[OPE_MAX_CMD_BUFS];
+};
+
 /**
  * struct cam_ope_device_hw_info
  *
@@ -154,6 +154,7 @@ struct cam_ope_irq_data {
  * @frame_process:  Frame process command
  * @req_idx:        Request Index
  * @kmd_buf_offset: KMD buffer offset
+ * @frame_dump:     frame_dump_enable latched once for the whole request
  */
 struct cam_ope_dev_prepare_req {
 	struct cam_ope_hw_mgr *hw_mgr;
@@ -165,6 +166,7 @@ struct cam_ope_dev_prepare_req {
 	struct ope_frame_process *frame_process;
 	uint32_t req_idx;
 	uint32_t kmd_buf_offset;
+	bool frame_dump;
 };
 
 int cam_ope_top_process(struct ope_hw *ope_hw_info,
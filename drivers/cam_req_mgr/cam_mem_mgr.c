@@ -11,6 +11,8 @@
 #include <linux/dma-buf.h>
 #include <linux/version.h>
 #include <linux/debugfs.h>
+#include <linux/file.h>
+#include <linux/log2.h>
 #if IS_REACHABLE(CONFIG_DMABUF_HEAPS)
 #include <linux/mem-buf.h>
 #include <soc/qcom/secure_buffer.h>
@@ -28,7 +30,9 @@
 
 #define CAM_MEM_SHARED_BUFFER_PAD_4K (4 * 1024)
 
-static struct cam_mem_table tbl;
+static struct cam_mem_table tbl = {
+	.pool.zero_on_reuse = true,
+};
 static atomic_t cam_mem_mgr_state = ATOMIC_INIT(CAM_MEM_MGR_UNINITIALIZED);
 
 #if IS_REACHABLE(CONFIG_DMABUF_HEAPS)
@@ -166,6 +170,360 @@ static int cam_mem_util_unmap_cpu_va(struct dma_buf *dmabuf,
 	return rc;
 }
 
+static int cam_mem_pool_get_class(size_t len)
+{
+	int class;
+
+	if (!len)
+		return -EINVAL;
+
+	class = order_base_2(PAGE_ALIGN(len) >> PAGE_SHIFT);
+	if (class >= CAM_MEM_POOL_NUM_CLASSES)
+		return -EINVAL;
+
+	return class;
+}
+
+static bool cam_mem_pool_is_eligible(uint32_t flags)
+{
+	/* Secure buffers are never recycled across allocations */
+	return !(flags & CAM_MEM_FLAG_PROTECTED_MODE);
+}
+
+static enum cam_smmu_region_id cam_mem_pool_get_region(uint32_t flags)
+{
+	/* Mirrors the region selection on regular unmap */
+	if (flags & CAM_MEM_FLAG_HW_SHARED_ACCESS)
+		return CAM_SMMU_REGION_SHARED;
+	else if (flags & CAM_MEM_FLAG_HW_READ_WRITE)
+		return CAM_SMMU_REGION_IO;
+
+	return CAM_SMMU_REGION_SHARED;
+}
+
+static bool cam_mem_pool_is_hw_mapped(uint32_t flags)
+{
+	return (flags & (CAM_MEM_FLAG_HW_READ_WRITE |
+		CAM_MEM_FLAG_HW_SHARED_ACCESS));
+}
+
+static void cam_mem_pool_unmap_entry(struct cam_mem_pool_entry *entry)
+{
+	int i, rc;
+	enum cam_smmu_region_id region;
+
+	if (!cam_mem_pool_is_hw_mapped(entry->flags))
+		return;
+
+	region = cam_mem_pool_get_region(entry->flags);
+	for (i = 0; i < entry->num_hdl; i++) {
+		rc = cam_smmu_unmap_user_iova(entry->hdls[i], entry->fd,
+			entry->dma_buf, region);
+		if (rc)
+			CAM_ERR(CAM_MEM,
+				"Failed to unmap pooled buf fd=%d i_ino=%lu mmu_hdl=%d rc=%d",
+				entry->fd, entry->i_ino, entry->hdls[i], rc);
+	}
+}
+
+static void cam_mem_pool_free_entry(struct cam_mem_pool_entry *entry)
+{
+	cam_mem_pool_unmap_entry(entry);
+	dma_buf_put(entry->dma_buf);
+	kfree(entry);
+}
+
+static void cam_mem_pool_free_list(struct list_head *free_list)
+{
+	struct cam_mem_pool_entry *entry, *next;
+
+	list_for_each_entry_safe(entry, next, free_list, list) {
+		list_del_init(&entry->list);
+		cam_mem_pool_free_entry(entry);
+	}
+}
+
+static void cam_mem_pool_reclaim_work(struct work_struct *work)
+{
+	LIST_HEAD(free_list);
+
+	mutex_lock(&tbl.pool.lock);
+	list_splice_init(&tbl.pool.reclaim_list, &free_list);
+	mutex_unlock(&tbl.pool.lock);
+
+	cam_mem_pool_free_list(&free_list);
+}
+
+static unsigned long cam_mem_pool_shrink_count(struct shrinker *shrinker,
+	struct shrink_control *sc)
+{
+	return READ_ONCE(tbl.pool.cur_size) >> PAGE_SHIFT;
+}
+
+static unsigned long cam_mem_pool_shrink_scan(struct shrinker *shrinker,
+	struct shrink_control *sc)
+{
+	int i;
+	unsigned long freed = 0;
+	struct cam_mem_pool_entry *entry;
+
+	/*
+	 * SMMU unmap may allocate and sleep on locks held around
+	 * allocations, so only detach entries here and tear them down
+	 * from the reclaim work.
+	 */
+	if (!mutex_trylock(&tbl.pool.lock))
+		return SHRINK_STOP;
+
+	for (i = CAM_MEM_POOL_NUM_CLASSES - 1;
+		(i >= 0) && (freed < sc->nr_to_scan); i--) {
+		while (!list_empty(&tbl.pool.bucket[i]) &&
+			(freed < sc->nr_to_scan)) {
+			/* Oldest entries sit at the tail */
+			entry = list_last_entry(&tbl.pool.bucket[i],
+				struct cam_mem_pool_entry, list);
+			list_move_tail(&entry->list, &tbl.pool.reclaim_list);
+			tbl.pool.cur_size -= entry->dma_buf->size;
+			tbl.pool.num_entries--;
+			tbl.pool.evicted++;
+			freed += entry->dma_buf->size >> PAGE_SHIFT;
+		}
+	}
+	mutex_unlock(&tbl.pool.lock);
+
+	if (freed)
+		schedule_work(&tbl.pool.reclaim_work);
+
+	return freed ? freed : SHRINK_STOP;
+}
+
+void cam_mem_mgr_pool_init(void)
+{
+	int i, rc;
+
+	mutex_init(&tbl.pool.lock);
+	for (i = 0; i < CAM_MEM_POOL_NUM_CLASSES; i++)
+		INIT_LIST_HEAD(&tbl.pool.bucket[i]);
+	INIT_LIST_HEAD(&tbl.pool.reclaim_list);
+	INIT_WORK(&tbl.pool.reclaim_work, cam_mem_pool_reclaim_work);
+	if (!tbl.pool.max_size)
+		tbl.pool.max_size = CAM_MEM_POOL_DEFAULT_MAX_SIZE;
+	tbl.pool.cur_size = 0;
+	tbl.pool.num_entries = 0;
+	tbl.pool.hits = 0;
+	tbl.pool.misses = 0;
+	tbl.pool.recycled = 0;
+	tbl.pool.evicted = 0;
+
+	tbl.pool.shrinker.count_objects = cam_mem_pool_shrink_count;
+	tbl.pool.shrinker.scan_objects = cam_mem_pool_shrink_scan;
+	tbl.pool.shrinker.seeks = DEFAULT_SEEKS;
+	rc = cam_compat_register_shrinker(&tbl.pool.shrinker, "cam_mem_pool");
+	if (rc)
+		CAM_WARN(CAM_MEM, "Failed to register pool shrinker rc=%d", rc);
+	tbl.pool.shrinker_registered = !rc;
+}
+
+void cam_mem_mgr_pool_deinit(void)
+{
+	int i;
+	LIST_HEAD(free_list);
+
+	if (tbl.pool.shrinker_registered) {
+		unregister_shrinker(&tbl.pool.shrinker);
+		tbl.pool.shrinker_registered = false;
+	}
+	flush_work(&tbl.pool.reclaim_work);
+
+	mutex_lock(&tbl.pool.lock);
+	for (i = 0; i < CAM_MEM_POOL_NUM_CLASSES; i++)
+		list_splice_init(&tbl.pool.bucket[i], &free_list);
+	list_splice_init(&tbl.pool.reclaim_list, &free_list);
+	tbl.pool.evicted += tbl.pool.num_entries;
+	tbl.pool.cur_size = 0;
+	tbl.pool.num_entries = 0;
+	CAM_DBG(CAM_MEM,
+		"Pool stats hits:%llu misses:%llu recycled:%llu evicted:%llu",
+		tbl.pool.hits, tbl.pool.misses, tbl.pool.recycled,
+		tbl.pool.evicted);
+	mutex_unlock(&tbl.pool.lock);
+
+	cam_mem_pool_free_list(&free_list);
+	mutex_destroy(&tbl.pool.lock);
+}
+
+/*
+ * Takes the buffer of a slot being released into the pool, keeping it
+ * allocated and mapped on its SMMU handles. @vaddr is the device address
+ * of the slot, which unmap has already cleared from the table. Returns
+ * true if the pool now owns the table reference and the SMMU mappings of
+ * the buffer.
+ */
+static bool cam_mem_pool_put(int32_t idx, dma_addr_t vaddr)
+{
+	int class;
+	struct cam_mem_pool_entry *entry;
+	struct cam_mem_buf_queue *buf = &tbl.bufq[idx];
+
+	if (!atomic_read(&cam_mem_mgr_state) || !READ_ONCE(tbl.pool.enable))
+		return false;
+
+	if (!buf->dma_buf || buf->is_imported || !buf->is_internal ||
+		(buf->smmu_mapping_client != CAM_SMMU_MAPPING_USER) ||
+		!cam_mem_pool_is_eligible(buf->flags))
+		return false;
+
+	/* Only recycle once userspace and other importers let go of it */
+	if (file_count(buf->dma_buf->file) != 1)
+		return false;
+
+	class = cam_mem_pool_get_class(buf->dma_buf->size);
+	if (class < 0)
+		return false;
+
+	entry = kzalloc(sizeof(*entry), GFP_KERNEL);
+	if (!entry)
+		return false;
+
+	entry->dma_buf = buf->dma_buf;
+	entry->fd = buf->fd;
+	entry->i_ino = buf->i_ino;
+	entry->len = buf->len;
+	entry->flags = buf->flags;
+	entry->num_hdl = buf->num_hdl;
+	memcpy(entry->hdls, buf->hdls, sizeof(int32_t) * buf->num_hdl);
+	entry->vaddr = vaddr;
+
+	mutex_lock(&tbl.pool.lock);
+	if (!tbl.pool.enable ||
+		(tbl.pool.cur_size + entry->dma_buf->size > tbl.pool.max_size)) {
+		mutex_unlock(&tbl.pool.lock);
+		kfree(entry);
+		return false;
+	}
+
+	list_add(&entry->list, &tbl.pool.bucket[class]);
+	tbl.pool.cur_size += entry->dma_buf->size;
+	tbl.pool.num_entries++;
+	tbl.pool.recycled++;
+	mutex_unlock(&tbl.pool.lock);
+
+	CAM_DBG(CAM_MEM, "Pooled fd=%d i_ino=%lu size=%zu class=%d",
+		entry->fd, entry->i_ino, entry->dma_buf->size, class);
+
+	return true;
+}
+
+static struct cam_mem_pool_entry *cam_mem_pool_find(
+	struct cam_mem_mgr_alloc_cmd *cmd, size_t len)
+{
+	int class;
+	struct cam_mem_pool_entry *entry;
+
+	class = cam_mem_pool_get_class(len);
+	if (class < 0)
+		return NULL;
+
+	mutex_lock(&tbl.pool.lock);
+	list_for_each_entry(entry, &tbl.pool.bucket[class], list) {
+		if ((entry->dma_buf->size != PAGE_ALIGN(len)) ||
+			(entry->flags != cmd->flags) ||
+			(entry->num_hdl != cmd->num_hdl) ||
+			memcmp(entry->hdls, cmd->mmu_hdls,
+			sizeof(int32_t) * cmd->num_hdl))
+			continue;
+
+		list_del_init(&entry->list);
+		tbl.pool.cur_size -= entry->dma_buf->size;
+		tbl.pool.num_entries--;
+		tbl.pool.hits++;
+		mutex_unlock(&tbl.pool.lock);
+		return entry;
+	}
+	tbl.pool.misses++;
+	mutex_unlock(&tbl.pool.lock);
+
+	return NULL;
+}
+
+static int cam_mem_pool_zero_buf(struct dma_buf *dmabuf)
+{
+	int rc;
+	uintptr_t kvaddr = 0;
+	size_t klen = 0;
+
+	rc = cam_mem_util_map_cpu_va(dmabuf, &kvaddr, &klen);
+	if (rc)
+		return rc;
+
+	memset((void *)kvaddr, 0, klen);
+
+	return cam_mem_util_unmap_cpu_va(dmabuf, kvaddr);
+}
+
+/*
+ * Hands out a pooled buffer matching the allocation request with a new
+ * fd installed, its SMMU mappings now tracked with that fd.
+ */
+static struct cam_mem_pool_entry *cam_mem_pool_get(
+	struct cam_mem_mgr_alloc_cmd *cmd, size_t len)
+{
+	int i, rc, fd;
+	struct cam_mem_pool_entry *entry;
+
+	if (!READ_ONCE(tbl.pool.enable) || !cam_mem_pool_is_eligible(cmd->flags))
+		return NULL;
+
+	entry = cam_mem_pool_find(cmd, len);
+	if (!entry)
+		return NULL;
+
+	if (tbl.pool.zero_on_reuse) {
+		rc = cam_mem_pool_zero_buf(entry->dma_buf);
+		if (rc) {
+			CAM_ERR(CAM_MEM, "Failed to clear pooled buf rc=%d", rc);
+			goto free_entry;
+		}
+	}
+
+	fd = get_unused_fd_flags(O_CLOEXEC);
+	if (fd < 0) {
+		CAM_ERR(CAM_MEM, "get fd fail, fd=%d", fd);
+		goto free_entry;
+	}
+
+	if (cam_mem_pool_is_hw_mapped(entry->flags)) {
+		for (i = 0; i < entry->num_hdl; i++) {
+			rc = cam_smmu_update_user_iova_fd(entry->hdls[i],
+				entry->fd, fd, entry->dma_buf);
+			if (rc) {
+				CAM_ERR(CAM_MEM,
+					"Pooled buf fd=%d no longer mapped on mmu_hdl=%d rc=%d",
+					entry->fd, entry->hdls[i], rc);
+				goto restore_fd;
+			}
+		}
+	}
+
+	get_dma_buf(entry->dma_buf);
+	fd_install(fd, entry->dma_buf->file);
+	entry->fd = fd;
+
+	CAM_DBG(CAM_MEM, "Reusing pooled buf fd=%d i_ino=%lu len=%zu",
+		entry->fd, entry->i_ino, entry->len);
+
+	return entry;
+
+restore_fd:
+	for (--i; i >= 0; i--)
+		cam_smmu_update_user_iova_fd(entry->hdls[i], fd, entry->fd,
+			entry->dma_buf);
+	put_unused_fd(fd);
+free_entry:
+	cam_mem_pool_free_entry(entry);
+	return NULL;
+}
+
 static int cam_mem_mgr_create_debug_fs(void)
 {
 	int rc = 0;
@@ -182,6 +540,22 @@ static int cam_mem_mgr_create_debug_fs(void)
 
 	debugfs_create_bool("alloc_profile_enable", 0644,
 		tbl.dentry, &tbl.alloc_profile_enable);
+	debugfs_create_bool("pool_enable", 0644,
+		tbl.dentry, &tbl.pool.enable);
+	debugfs_create_bool("pool_zero_on_reuse", 0644,
+		tbl.dentry, &tbl.pool.zero_on_reuse);
+	debugfs_create_size_t("pool_max_size", 0644,
+		tbl.dentry, &tbl.pool.max_size);
+	debugfs_create_size_t("pool_cur_size", 0444,
+		tbl.dentry, &tbl.pool.cur_size);
+	debugfs_create_u64("pool_hits", 0444,
+		tbl.dentry, &tbl.pool.hits);
+	debugfs_create_u64("pool_misses", 0444,
+		tbl.dentry, &tbl.pool.misses);
+	debugfs_create_u64("pool_recycled", 0444,
+		tbl.dentry, &tbl.pool.recycled);
+	debugfs_create_u64("pool_evicted", 0444,
+		tbl.dentry, &tbl.pool.evicted);
 end:
 	return rc;
 }
@@ -375,21 +749,14 @@ int cam_mem_get_cpu_buf(int32_t buf_handle, uintptr_t *vaddr_ptr, size_t *len)
 }
 EXPORT_SYMBOL(cam_mem_get_cpu_buf);
 
-int cam_mem_mgr_cache_ops(struct cam_mem_cache_ops_cmd *cmd)
+static int cam_mem_mgr_cache_ops_range(int32_t buf_handle,
+	uint32_t mem_cache_ops, uint64_t offset, uint64_t length)
 {
 	int rc = 0, idx;
 	uint32_t cache_dir;
 	unsigned long dmabuf_flag = 0;
 
-	if (!atomic_read(&cam_mem_mgr_state)) {
-		CAM_ERR(CAM_MEM, "failed. mem_mgr not initialized");
-		return -EINVAL;
-	}
-
-	if (!cmd)
-		return -EINVAL;
-
-	idx = CAM_MEM_MGR_GET_HDL_IDX(cmd->buf_handle);
+	idx = CAM_MEM_MGR_GET_HDL_IDX(buf_handle);
 	if (idx >= CAM_MEM_BUFQ_MAX || idx <= 0)
 		return -EINVAL;
 
@@ -405,11 +772,23 @@ int cam_mem_mgr_cache_ops(struct cam_mem_cache_ops_cmd *cmd)
 	mutex_lock(&tbl.bufq[idx].q_lock);
 	mutex_unlock(&tbl.m_lock);
 
-	if (cmd->buf_handle != tbl.bufq[idx].buf_handle) {
+	if (buf_handle != tbl.bufq[idx].buf_handle) {
 		rc = -EINVAL;
 		goto end;
 	}
 
+	if ((offset >= tbl.bufq[idx].len) ||
+		(length > (tbl.bufq[idx].len - offset))) {
+		CAM_ERR(CAM_MEM,
+			"Invalid range offset:%llu length:%llu buf_len:%zu buf_hdl:0x%x",
+			offset, length, tbl.bufq[idx].len, buf_handle);
+		rc = -EINVAL;
+		goto end;
+	}
+
+	if (!length)
+		length = tbl.bufq[idx].len - offset;
+
 	rc = dma_buf_get_flags(tbl.bufq[idx].dma_buf, &dmabuf_flag);
 	if (rc) {
 		CAM_ERR(CAM_MEM, "cache get flags failed %d", rc);
@@ -421,7 +800,7 @@ int cam_mem_mgr_cache_ops(struct cam_mem_cache_ops_cmd *cmd)
 	cache_dir = DMA_BIDIRECTIONAL;
 #else
 	if (dmabuf_flag & ION_FLAG_CACHED) {
-		switch (cmd->mem_cache_ops) {
+		switch (mem_cache_ops) {
 		case CAM_MEM_CLEAN_CACHE:
 			cache_dir = DMA_TO_DEVICE;
 			break;
@@ -433,7 +812,7 @@ int cam_mem_mgr_cache_ops(struct cam_mem_cache_ops_cmd *cmd)
 			break;
 		default:
 			CAM_ERR(CAM_MEM,
-				"invalid cache ops :%d", cmd->mem_cache_ops);
+				"invalid cache ops :%d", mem_cache_ops);
 			rc = -EINVAL;
 			goto end;
 		}
@@ -442,27 +821,101 @@ int cam_mem_mgr_cache_ops(struct cam_mem_cache_ops_cmd *cmd)
 		goto end;
 	}
 #endif
-	rc = dma_buf_begin_cpu_access(tbl.bufq[idx].dma_buf,
-		(cmd->mem_cache_ops == CAM_MEM_CLEAN_INV_CACHE) ?
-		DMA_BIDIRECTIONAL : DMA_TO_DEVICE);
-	if (rc) {
-		CAM_ERR(CAM_MEM, "dma begin access failed rc=%d", rc);
-		goto end;
-	}
+	if ((offset == 0) && (length == tbl.bufq[idx].len)) {
+		rc = dma_buf_begin_cpu_access(tbl.bufq[idx].dma_buf,
+			(mem_cache_ops == CAM_MEM_CLEAN_INV_CACHE) ?
+			DMA_BIDIRECTIONAL : DMA_TO_DEVICE);
+		if (rc) {
+			CAM_ERR(CAM_MEM, "dma begin access failed rc=%d", rc);
+			goto end;
+		}
 
-	rc = dma_buf_end_cpu_access(tbl.bufq[idx].dma_buf,
-		cache_dir);
-	if (rc) {
-		CAM_ERR(CAM_MEM, "dma end access failed rc=%d", rc);
-		goto end;
+		rc = dma_buf_end_cpu_access(tbl.bufq[idx].dma_buf,
+			cache_dir);
+		if (rc) {
+			CAM_ERR(CAM_MEM, "dma end access failed rc=%d", rc);
+			goto end;
+		}
+	} else {
+		rc = cam_compat_util_dmabuf_sync_partial(tbl.bufq[idx].dma_buf,
+			(mem_cache_ops == CAM_MEM_CLEAN_INV_CACHE) ?
+			DMA_BIDIRECTIONAL : DMA_TO_DEVICE, cache_dir,
+			(unsigned int)offset, (unsigned int)length);
+		if (rc) {
+			CAM_ERR(CAM_MEM,
+				"dma partial access failed rc=%d offset:%llu length:%llu",
+				rc, offset, length);
+			goto end;
+		}
 	}
 
 end:
 	mutex_unlock(&tbl.bufq[idx].q_lock);
 	return rc;
 }
+
+int cam_mem_mgr_cache_ops(struct cam_mem_cache_ops_cmd *cmd)
+{
+	if (!atomic_read(&cam_mem_mgr_state)) {
+		CAM_ERR(CAM_MEM, "failed. mem_mgr not initialized");
+		return -EINVAL;
+	}
+
+	if (!cmd)
+		return -EINVAL;
+
+	return cam_mem_mgr_cache_ops_range(cmd->buf_handle,
+		cmd->mem_cache_ops, 0, 0);
+}
 EXPORT_SYMBOL(cam_mem_mgr_cache_ops);
 
+int cam_mem_mgr_cache_ops_v2(struct cam_mem_cache_ops_v2_cmd *cmd)
+{
+	int rc = 0;
+	uint32_t i;
+	struct cam_mem_cache_ops_range *range;
+
+	if (!atomic_read(&cam_mem_mgr_state)) {
+		CAM_ERR(CAM_MEM, "failed. mem_mgr not initialized");
+		return -EINVAL;
+	}
+
+	if (!cmd)
+		return -EINVAL;
+
+	cmd->num_done = 0;
+	if (!cmd->num_ranges ||
+		(cmd->num_ranges > CAM_MEM_CACHE_OPS_MAX_RANGES)) {
+		CAM_ERR(CAM_MEM, "Invalid num ranges %u", cmd->num_ranges);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < cmd->num_ranges; i++) {
+		range = &cmd->ranges[i];
+
+		/* Partial cpu access takes 32 bit offset and length */
+		if ((range->offset > UINT_MAX) || (range->length > UINT_MAX)) {
+			CAM_ERR(CAM_MEM,
+				"Range %u out of bounds offset:%llu length:%llu",
+				i, range->offset, range->length);
+			return -EINVAL;
+		}
+
+		rc = cam_mem_mgr_cache_ops_range(range->buf_handle,
+			range->mem_cache_ops, range->offset, range->length);
+		if (rc) {
+			CAM_ERR(CAM_MEM,
+				"Cache ops failed for range %u buf_hdl:0x%x rc:%d",
+				i, range->buf_handle, rc);
+			return rc;
+		}
+
+		cmd->num_done++;
+	}
+
+	return rc;
+}
+
 #if IS_REACHABLE(CONFIG_DMABUF_HEAPS)
 
 #define CAM_MAX_VMIDS 4
@@ -912,6 +1365,7 @@ int cam_mem_mgr_alloc_and_map(struct cam_mem_mgr_alloc_cmd *cmd)
 	uintptr_t kvaddr = 0;
 	size_t klen;
 	unsigned long i_ino = 0;
+	struct cam_mem_pool_entry *pool_entry = NULL;
 
 	if (!atomic_read(&cam_mem_mgr_state)) {
 		CAM_ERR(CAM_MEM, "failed. mem_mgr not initialized");
@@ -939,6 +1393,16 @@ int cam_mem_mgr_alloc_and_map(struct cam_mem_mgr_alloc_cmd *cmd)
 		return rc;
 	}
 
+	pool_entry = cam_mem_pool_get(cmd, len);
+	if (pool_entry) {
+		dmabuf = pool_entry->dma_buf;
+		fd = pool_entry->fd;
+		i_ino = pool_entry->i_ino;
+		hw_vaddr = pool_entry->vaddr;
+		len = pool_entry->len;
+		goto get_slot;
+	}
+
 	rc = cam_mem_util_buffer_alloc(len, cmd->flags, &dmabuf, &fd, &i_ino);
 	if (rc) {
 		CAM_ERR(CAM_MEM,
@@ -954,6 +1418,7 @@ int cam_mem_mgr_alloc_and_map(struct cam_mem_mgr_alloc_cmd *cmd)
 		return rc;
 	}
 
+get_slot:
 	idx = cam_mem_get_slot();
 	if (idx < 0) {
 		CAM_ERR(CAM_MEM, "Failed in getting mem slot, idx=%d", idx);
@@ -961,9 +1426,10 @@ int cam_mem_mgr_alloc_and_map(struct cam_mem_mgr_alloc_cmd *cmd)
 		goto slot_fail;
 	}
 
-	if ((cmd->flags & CAM_MEM_FLAG_HW_READ_WRITE) ||
+	/* Pooled buffers are still mapped on the requested handles */
+	if (!pool_entry && ((cmd->flags & CAM_MEM_FLAG_HW_READ_WRITE) ||
 		(cmd->flags & CAM_MEM_FLAG_HW_SHARED_ACCESS) ||
-		(cmd->flags & CAM_MEM_FLAG_PROTECTED_MODE)) {
+		(cmd->flags & CAM_MEM_FLAG_PROTECTED_MODE))) {
 
 		enum cam_smmu_region_id region;
 
@@ -1041,10 +1507,11 @@ int cam_mem_mgr_alloc_and_map(struct cam_mem_mgr_alloc_cmd *cmd)
 	cmd->out.vaddr = 0;
 
 	CAM_DBG(CAM_MEM,
-		"fd=%d, flags=0x%x, num_hdl=%d, idx=%d, buf handle=%x, len=%zu, i_ino=%lu",
+		"fd=%d, flags=0x%x, num_hdl=%d, idx=%d, buf handle=%x, len=%zu, i_ino=%lu pooled=%d",
 		cmd->out.fd, cmd->flags, cmd->num_hdl, idx, cmd->out.buf_handle,
-		tbl.bufq[idx].len, tbl.bufq[idx].i_ino);
+		tbl.bufq[idx].len, tbl.bufq[idx].i_ino, !!pool_entry);
 
+	kfree(pool_entry);
 	return rc;
 
 map_kernel_fail:
@@ -1052,6 +1519,10 @@ map_kernel_fail:
 map_hw_fail:
 	cam_mem_put_slot(idx);
 slot_fail:
+	if (pool_entry) {
+		cam_mem_pool_unmap_entry(pool_entry);
+		kfree(pool_entry);
+	}
 	dma_buf_put(dmabuf);
 	return rc;
 }
@@ -1341,6 +1812,8 @@ static void cam_mem_util_unmap(struct kref *kref)
 {
 	int rc = 0;
 	int32_t idx;
+	bool pooled;
+	dma_addr_t vaddr;
 	enum cam_smmu_region_id region = CAM_SMMU_REGION_SHARED;
 	enum cam_smmu_mapping_client client;
 	struct cam_mem_buf_queue *bufq =
@@ -1368,6 +1841,7 @@ static void cam_mem_util_unmap(struct kref *kref)
 	/* Deactivate the buffer queue to prevent multiple unmap */
 	mutex_lock(&tbl.bufq[idx].q_lock);
 	tbl.bufq[idx].active = false;
+	vaddr = tbl.bufq[idx].vaddr;
 	tbl.bufq[idx].vaddr = 0;
 	mutex_unlock(&tbl.bufq[idx].q_lock);
 	mutex_unlock(&tbl.m_lock);
@@ -1392,9 +1866,11 @@ static void cam_mem_util_unmap(struct kref *kref)
 			region = CAM_SMMU_REGION_IO;
 	}
 
-	if ((tbl.bufq[idx].flags & CAM_MEM_FLAG_HW_READ_WRITE) ||
+	pooled = cam_mem_pool_put(idx, vaddr);
+
+	if (!pooled && ((tbl.bufq[idx].flags & CAM_MEM_FLAG_HW_READ_WRITE) ||
 		(tbl.bufq[idx].flags & CAM_MEM_FLAG_HW_SHARED_ACCESS) ||
-		(tbl.bufq[idx].flags & CAM_MEM_FLAG_PROTECTED_MODE)) {
+		(tbl.bufq[idx].flags & CAM_MEM_FLAG_PROTECTED_MODE))) {
 		if (cam_mem_util_unmap_hw_va(idx, region, client))
 			CAM_ERR(CAM_MEM, "Failed, dmabuf=%pK",
 				tbl.bufq[idx].dma_buf);
@@ -1412,7 +1888,7 @@ static void cam_mem_util_unmap(struct kref *kref)
 		idx, tbl.bufq[idx].fd, tbl.bufq[idx].is_imported, tbl.bufq[idx].dma_buf,
 		tbl.bufq[idx].i_ino);
 
-	if (tbl.bufq[idx].dma_buf)
+	if (tbl.bufq[idx].dma_buf && !pooled)
 		dma_buf_put(tbl.bufq[idx].dma_buf);
 
 	tbl.bufq[idx].fd = -1;
@@ -9,6 +9,8 @@
 
 #include <linux/mutex.h>
 #include <linux/dma-buf.h>
+#include <linux/shrinker.h>
+#include <linux/workqueue.h>
 #if IS_REACHABLE(CONFIG_DMABUF_HEAPS)
 #include <linux/dma-heap.h>
 #endif
@@ -83,6 +85,72 @@ struct cam_mem_buf_queue {
 #endif
 };
 
+/* Size classes of the recycling pool, class n holds up to 2^n pages */
+#define CAM_MEM_POOL_NUM_CLASSES        16
+#define CAM_MEM_POOL_DEFAULT_MAX_SIZE   (256 * 1024 * 1024)
+
+/**
+ * struct cam_mem_pool_entry
+ *
+ * @list:        Link in a size class bucket or in the reclaim list
+ * @dma_buf:     Released buffer, the entry owns the table reference
+ * @fd:          fd the SMMU mappings of the buffer are tracked with
+ * @i_ino:       inode number of the dmabuf
+ * @len:         Mapped length reported to clients
+ * @flags:       Allocation flags of the buffer
+ * @hdls:        SMMU handles the buffer is still mapped on
+ * @num_hdl:     Number of SMMU handles
+ * @vaddr:       IOVA of the buffer
+ */
+struct cam_mem_pool_entry {
+	struct list_head list;
+	struct dma_buf *dma_buf;
+	int32_t fd;
+	unsigned long i_ino;
+	size_t len;
+	uint32_t flags;
+	int32_t hdls[CAM_MEM_MMU_MAX_HANDLE];
+	int32_t num_hdl;
+	dma_addr_t vaddr;
+};
+
+/**
+ * struct cam_mem_pool
+ *
+ * @lock:          Protects the buckets, reclaim list and counters
+ * @bucket:        Released buffers per size class, most recent first
+ * @reclaim_list:  Entries taken by the shrinker, pending teardown
+ * @reclaim_work:  Tears down reclaim_list outside of reclaim context
+ * @shrinker:      Memory pressure callbacks
+ * @shrinker_registered: Whether shrinker is registered
+ * @enable:        Recycle released buffers instead of freeing them
+ * @zero_on_reuse: Clear recycled buffers before handing them out
+ * @max_size:      Upper bound on the bytes held by the pool
+ * @cur_size:      Bytes currently held by the pool
+ * @num_entries:   Buffers currently held by the pool
+ * @hits:          Allocations served from the pool
+ * @misses:        Eligible allocations the pool could not serve
+ * @recycled:      Released buffers taken into the pool
+ * @evicted:       Pooled buffers freed by the shrinker or on unbind
+ */
+struct cam_mem_pool {
+	struct mutex lock;
+	struct list_head bucket[CAM_MEM_POOL_NUM_CLASSES];
+	struct list_head reclaim_list;
+	struct work_struct reclaim_work;
+	struct shrinker shrinker;
+	bool shrinker_registered;
+	bool enable;
+	bool zero_on_reuse;
+	size_t max_size;
+	size_t cur_size;
+	uint32_t num_entries;
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t recycled;
+	uint64_t evicted;
+};
+
 /**
  * struct cam_mem_table
  *
@@ -101,6 +169,7 @@ struct cam_mem_buf_queue {
  * @camera_heap: Handle to camera heap
  * @camera_uncached_heap: Handle to camera uncached heap
  * @secure_display_heap: Handle to secure display heap
+ * @pool: Pool of released buffers kept allocated and mapped
  */
 struct cam_mem_table {
 	struct mutex m_lock;
@@ -119,7 +188,7 @@ struct cam_mem_table {
 	struct dma_heap *camera_uncached_heap;
 	struct dma_heap *secure_display_heap;
 #endif
-
+	struct cam_mem_pool pool;
 };
 
 /**
@@ -177,6 +246,16 @@ int cam_mem_mgr_map(struct cam_mem_mgr_map_cmd *cmd);
  */
 int cam_mem_mgr_cache_ops(struct cam_mem_cache_ops_cmd *cmd);
 
+/**
+ * @brief: Perform cache ops on a batch of buffer ranges
+ *
+ * @cmd:   Vectored cache ops information, num_done is updated with
+ *         the number of ranges processed
+ *
+ * @return Status of operation. Negative in case of error. Zero otherwise.
+ */
+int cam_mem_mgr_cache_ops_v2(struct cam_mem_cache_ops_v2_cmd *cmd);
+
 /**
  * @brief: Initializes the memory manager
  *
@@ -191,6 +270,22 @@ int cam_mem_mgr_init(void);
  */
 void cam_mem_mgr_deinit(void);
 
+/**
+ * @brief:  Sets up the recycling pool. The pool outlives CRM close, pooled
+ *          buffers are only freed by the shrinker or at pool deinit.
+ *
+ * @return None
+ */
+void cam_mem_mgr_pool_init(void);
+
+/**
+ * @brief:  Frees all pooled buffers and unregisters the shrinker. Must run
+ *          before the SMMU handles of the buffers are destroyed.
+ *
+ * @return None
+ */
+void cam_mem_mgr_pool_deinit(void);
+
 /**
  * @brief: Copy buffer content to presil mem for all buffers of
  *       iommu handle
@@ -510,6 +510,133 @@ static int __cam_req_mgr_traverse(struct cam_req_mgr_traverse *traverse_data)
 	return 0;
 }
 
+/**
+ * __cam_req_mgr_slot_hash_home()
+ *
+ * @brief    : Home bucket of a req id in the input queue slot hash
+ * @req_id   : request id
+ *
+ * @return   : bucket index
+ */
+static inline int32_t __cam_req_mgr_slot_hash_home(int64_t req_id)
+{
+	return (int32_t)((uint64_t)req_id & (CAM_REQ_MGR_SLOT_HASH_SIZE - 1));
+}
+
+/**
+ * __cam_req_mgr_slot_hash_reset()
+ *
+ * @brief    : Mark all buckets of the input queue slot hash empty
+ * @in_q     : input queue pointer
+ *
+ */
+static void __cam_req_mgr_slot_hash_reset(struct cam_req_mgr_req_queue *in_q)
+{
+	int i;
+
+	for (i = 0; i < CAM_REQ_MGR_SLOT_HASH_SIZE; i++)
+		in_q->slot_hash[i] = CAM_REQ_MGR_SLOT_HASH_EMPTY;
+}
+
+/**
+ * __cam_req_mgr_slot_hash_remove()
+ *
+ * @brief    : Drop the hash entry of slot idx, keyed on the req id currently
+ *             stored in that slot. Uses backward shift deletion so that the
+ *             probe sequence of the remaining entries stays intact.
+ * @in_q     : input queue pointer
+ * @idx      : slot index whose entry is removed
+ *
+ */
+static void __cam_req_mgr_slot_hash_remove(
+	struct cam_req_mgr_req_queue *in_q, int32_t idx)
+{
+	int32_t i, j, home, n;
+	int64_t req_id = in_q->slot[idx].req_id;
+
+	if (req_id < 0)
+		return;
+
+	i = __cam_req_mgr_slot_hash_home(req_id);
+	for (n = 0; n < CAM_REQ_MGR_SLOT_HASH_SIZE; n++) {
+		if (in_q->slot_hash[i] == idx)
+			break;
+		if (in_q->slot_hash[i] == CAM_REQ_MGR_SLOT_HASH_EMPTY)
+			return;
+		i = (i + 1) & (CAM_REQ_MGR_SLOT_HASH_SIZE - 1);
+	}
+	if (n == CAM_REQ_MGR_SLOT_HASH_SIZE)
+		return;
+
+	in_q->slot_hash[i] = CAM_REQ_MGR_SLOT_HASH_EMPTY;
+	j = i;
+	for (;;) {
+		j = (j + 1) & (CAM_REQ_MGR_SLOT_HASH_SIZE - 1);
+		if (in_q->slot_hash[j] == CAM_REQ_MGR_SLOT_HASH_EMPTY)
+			break;
+
+		home = __cam_req_mgr_slot_hash_home(
+			in_q->slot[in_q->slot_hash[j]].req_id);
+		/* Entry at j may move to i only if i lies on its probe path */
+		if ((i <= j) ? ((home <= i) || (home > j)) :
+			((home <= i) && (home > j))) {
+			in_q->slot_hash[i] = in_q->slot_hash[j];
+			in_q->slot_hash[j] = CAM_REQ_MGR_SLOT_HASH_EMPTY;
+			i = j;
+		}
+	}
+}
+
+/**
+ * __cam_req_mgr_slot_hash_insert()
+ *
+ * @brief    : Add hash entry for slot idx keyed on its current req id
+ * @in_q     : input queue pointer
+ * @idx      : slot index to be indexed
+ *
+ */
+static void __cam_req_mgr_slot_hash_insert(
+	struct cam_req_mgr_req_queue *in_q, int32_t idx)
+{
+	int32_t i, n;
+	int64_t req_id = in_q->slot[idx].req_id;
+
+	if (req_id < 0)
+		return;
+
+	i = __cam_req_mgr_slot_hash_home(req_id);
+	for (n = 0; n < CAM_REQ_MGR_SLOT_HASH_SIZE; n++) {
+		if (in_q->slot_hash[i] == CAM_REQ_MGR_SLOT_HASH_EMPTY) {
+			in_q->slot_hash[i] = idx;
+			return;
+		}
+		i = (i + 1) & (CAM_REQ_MGR_SLOT_HASH_SIZE - 1);
+	}
+
+	CAM_ERR(CAM_CRM, "slot hash full, req %lld idx %d", req_id, idx);
+}
+
+/**
+ * __cam_req_mgr_in_q_set_req_id()
+ *
+ * @brief    : Update req id of an input queue slot and keep the slot hash
+ *             in sync. All writes of slot req_id must go through here.
+ * @in_q     : input queue pointer
+ * @idx      : slot index
+ * @req_id   : new req id, negative to clear the slot
+ *
+ */
+static void __cam_req_mgr_in_q_set_req_id(
+	struct cam_req_mgr_req_queue *in_q, int32_t idx, int64_t req_id)
+{
+	if (in_q->slot[idx].req_id == req_id)
+		return;
+
+	__cam_req_mgr_slot_hash_remove(in_q, idx);
+	in_q->slot[idx].req_id = req_id;
+	__cam_req_mgr_slot_hash_insert(in_q, idx);
+}
+
 /**
  * __cam_req_mgr_in_q_skip_idx()
  *
@@ -523,7 +650,7 @@ static int __cam_req_mgr_traverse(struct cam_req_mgr_traverse *traverse_data)
 static void __cam_req_mgr_in_q_skip_idx(struct cam_req_mgr_req_queue *in_q,
 	int32_t idx)
 {
-	in_q->slot[idx].req_id = -1;
+	__cam_req_mgr_in_q_set_req_id(in_q, idx, -1);
 	in_q->slot[idx].skip_idx = 1;
 	CAM_DBG(CAM_CRM, "SET IDX SKIP on slot= %d", idx);
 }
@@ -603,7 +730,7 @@ static void __cam_req_mgr_flush_req_slot(
 			idx, slot->req_id, slot->status);
 
 		/* Reset input queue slot */
-		slot->req_id = -1;
+		__cam_req_mgr_in_q_set_req_id(in_q, idx, -1);
 		slot->skip_idx = 1;
 		slot->recover = 0;
 		slot->additional_timeout = 0;
@@ -660,7 +787,7 @@ static void __cam_req_mgr_reset_req_slot(struct cam_req_mgr_core_link *link,
 		return;
 
 	/* Reset input queue slot */
-	slot->req_id = -1;
+	__cam_req_mgr_in_q_set_req_id(in_q, idx, -1);
 	slot->skip_idx = 0;
 	slot->recover = 0;
 	slot->additional_timeout = 0;
@@ -1186,6 +1313,95 @@ static int __cam_req_mgr_check_link_is_ready(struct cam_req_mgr_core_link *link,
 	return rc;
 }
 
+/**
+ * __cam_req_mgr_sync_ready_reset()
+ *
+ * @brief    : Drop all cached link readiness of a session
+ * @session  : session pointer, called with session lock held
+ *
+ */
+static void __cam_req_mgr_sync_ready_reset(
+	struct cam_req_mgr_core_session *session)
+{
+	int i;
+
+	for (i = 0; i < CAM_REQ_MGR_SLOT_HASH_SIZE; i++) {
+		session->sync_ready[i].req_id = -1;
+		session->sync_ready[i].ready_mask = 0;
+	}
+}
+
+/**
+ * __cam_req_mgr_sync_ready_clear_link()
+ *
+ * @brief    : Drop the cached readiness of one link for all req ids
+ * @session  : session pointer, called with session lock held
+ * @link     : link whose readiness is no longer valid
+ *
+ */
+static void __cam_req_mgr_sync_ready_clear_link(
+	struct cam_req_mgr_core_session *session,
+	struct cam_req_mgr_core_link *link)
+{
+	uint32_t link_bit = BIT(link - g_links);
+	int i;
+
+	for (i = 0; i < CAM_REQ_MGR_SLOT_HASH_SIZE; i++)
+		session->sync_ready[i].ready_mask &= ~link_bit;
+}
+
+/**
+ * __cam_req_mgr_check_sync_link_is_ready()
+ *
+ * @brief    : Validate only check of a link for the req at idx, done on
+ *             behalf of the sync logic. Every synced link asks about
+ *             itself and each of its peers on every trigger, so once a
+ *             link is found ready for a req id it is flagged in the per
+ *             session bitmap and later asks cost a lookup instead of a
+ *             pd table traverse. Readiness only goes away when the slot
+ *             is flushed, which clears the bit.
+ * @link     : link to check, its session lock must be held
+ * @idx      : slot index in the input queue of link
+ *
+ * @return   : 0 if ready, negative otherwise
+ *
+ */
+static int __cam_req_mgr_check_sync_link_is_ready(
+	struct cam_req_mgr_core_link *link, int32_t idx)
+{
+	int                              rc;
+	int64_t                          req_id;
+	uint32_t                         link_bit;
+	struct cam_req_mgr_core_session *session;
+	struct cam_req_mgr_sync_ready   *sync_ready;
+
+	session = (struct cam_req_mgr_core_session *)link->parent;
+	req_id = link->req.in_q->slot[idx].req_id;
+	if (!session || (req_id < 0))
+		return __cam_req_mgr_check_link_is_ready(link, idx, true);
+
+	link_bit = BIT(link - g_links);
+	sync_ready = &session->sync_ready[__cam_req_mgr_slot_hash_home(req_id)];
+	if ((sync_ready->req_id == req_id) &&
+		(sync_ready->ready_mask & link_bit)) {
+		/* Same side effect as a traverse */
+		link->initial_skip = false;
+		return 0;
+	}
+
+	rc = __cam_req_mgr_check_link_is_ready(link, idx, true);
+	if (rc)
+		return rc;
+
+	if (sync_ready->req_id != req_id) {
+		sync_ready->req_id = req_id;
+		sync_ready->ready_mask = 0;
+	}
+	sync_ready->ready_mask |= link_bit;
+
+	return 0;
+}
+
 /**
  * __cam_req_mgr_find_slot_for_req()
  *
@@ -1202,21 +1418,34 @@ static int32_t __cam_req_mgr_find_slot_for_req(
 	int32_t                   idx, i;
 	struct cam_req_mgr_slot  *slot;
 
-	idx = in_q->rd_idx;
-	for (i = 0; i < in_q->num_slots; i++) {
+	if (!in_q->num_slots)
+		return -1;
+
+	/* Cleared slots are not hashed, fall back to a scan for those */
+	if (req_id < 0) {
+		idx = in_q->rd_idx;
+		for (i = 0; i < in_q->num_slots; i++) {
+			if (in_q->slot[idx].req_id == req_id)
+				return idx;
+			__cam_req_mgr_dec_idx(&idx, 1, in_q->num_slots);
+		}
+		return -1;
+	}
+
+	i = __cam_req_mgr_slot_hash_home(req_id);
+	while (in_q->slot_hash[i] != CAM_REQ_MGR_SLOT_HASH_EMPTY) {
+		idx = in_q->slot_hash[i];
 		slot = &in_q->slot[idx];
 		if (slot->req_id == req_id) {
 			CAM_DBG(CAM_CRM,
 				"req: %lld found at idx: %d status: %d sync_mode: %d",
 				req_id, idx, slot->status, slot->sync_mode);
-			break;
+			return idx;
 		}
-		__cam_req_mgr_dec_idx(&idx, 1, in_q->num_slots);
+		i = (i + 1) & (CAM_REQ_MGR_SLOT_HASH_SIZE - 1);
 	}
-	if (i >= in_q->num_slots)
-		idx = -1;
 
-	return idx;
+	return -1;
 }
 
 /**
@@ -1291,7 +1520,7 @@ static int __cam_req_mgr_check_sync_for_mslave(
 			return -EAGAIN;
 		}
 
-		rc = __cam_req_mgr_check_link_is_ready(link, slot->idx, true);
+		rc = __cam_req_mgr_check_sync_link_is_ready(link, slot->idx);
 		if (rc) {
 			CAM_DBG(CAM_CRM,
 				"Req: %lld [master] not ready on link: %x, rc=%d",
@@ -1332,8 +1561,8 @@ static int __cam_req_mgr_check_sync_for_mslave(
 				return -EINVAL;
 			}
 
-			rc = __cam_req_mgr_check_link_is_ready(sync_link,
-				sync_slot_idx, true);
+			rc = __cam_req_mgr_check_sync_link_is_ready(sync_link,
+				sync_slot_idx);
 			if (rc &&
 				(sync_link->req.in_q->slot[sync_slot_idx].status
 				!= CRM_SLOT_STATUS_REQ_APPLIED)) {
@@ -1348,7 +1577,7 @@ static int __cam_req_mgr_check_sync_for_mslave(
 		if (link->initial_skip)
 			link->initial_skip = false;
 
-		rc = __cam_req_mgr_check_link_is_ready(link, slot->idx, true);
+		rc = __cam_req_mgr_check_sync_link_is_ready(link, slot->idx);
 		if (rc) {
 			CAM_DBG(CAM_CRM,
 				"Req: %lld [slave] not ready on link: %x, rc=%d",
@@ -1390,8 +1619,8 @@ static int __cam_req_mgr_check_sync_for_mslave(
 			}
 
 			sync_slot = &sync_link->req.in_q->slot[sync_slot_idx];
-			rc = __cam_req_mgr_check_link_is_ready(sync_link,
-				sync_slot_idx, true);
+			rc = __cam_req_mgr_check_sync_link_is_ready(sync_link,
+				sync_slot_idx);
 			if (rc && (sync_slot->status !=
 				CRM_SLOT_STATUS_REQ_APPLIED)) {
 				CAM_DBG(CAM_CRM,
@@ -1543,7 +1772,7 @@ static int __cam_req_mgr_check_sync_req_is_ready(
 		return -EAGAIN;
 	}
 
-	rc = __cam_req_mgr_check_link_is_ready(link, slot->idx, true);
+	rc = __cam_req_mgr_check_sync_link_is_ready(link, slot->idx);
 	if (rc) {
 		CAM_DBG(CAM_CRM,
 			"Req: %lld [My link] not ready on link: %x, rc=%d",
@@ -1552,8 +1781,8 @@ static int __cam_req_mgr_check_sync_req_is_ready(
 	}
 
 	if (sync_link->req.in_q) {
-		rc = __cam_req_mgr_check_link_is_ready(sync_link,
-			sync_slot_idx, true);
+		rc = __cam_req_mgr_check_sync_link_is_ready(sync_link,
+			sync_slot_idx);
 		if (rc && (sync_link->req.in_q->slot[sync_slot_idx].status !=
 				CRM_SLOT_STATUS_REQ_APPLIED)) {
 			CAM_DBG(CAM_CRM,
@@ -1795,6 +2024,7 @@ static int __cam_req_mgr_process_req(struct cam_req_mgr_core_link *link,
 	struct cam_req_mgr_core_link        *tmp_link = NULL;
 	uint32_t                             max_retry = 0;
 	enum crm_req_eof_trigger_type        eof_trigger_type;
+	ktime_t                              sync_check_ts;
 
 	session = (struct cam_req_mgr_core_session *)link->parent;
 	if (!session) {
@@ -1873,8 +2103,13 @@ static int __cam_req_mgr_process_req(struct cam_req_mgr_core_link *link,
 
 	if (slot->status != CRM_SLOT_STATUS_REQ_READY) {
 		if (slot->sync_mode == CAM_REQ_MGR_SYNC_MODE_SYNC) {
+			sync_check_ts = cam_req_mgr_debug_lat_start(
+				CAM_REQ_MGR_LAT_SYNC_CHECK);
 			rc = __cam_req_mgr_check_multi_sync_link_ready(
 				link, slot, trigger);
+			cam_req_mgr_debug_lat_record(
+				CAM_REQ_MGR_LAT_SYNC_CHECK,
+				link - g_links, sync_check_ts);
 		} else {
 			if (link->in_msync_mode) {
 				CAM_DBG(CAM_CRM,
@@ -2016,6 +2251,10 @@ static int __cam_req_mgr_process_req(struct cam_req_mgr_core_link *link,
 			(eof_trigger_type == CAM_REQ_EOF_TRIGGER_APPLIED)) &&
 			(trigger == CAM_TRIGGER_POINT_SOF)) {
 			slot->status = CRM_SLOT_STATUS_REQ_APPLIED;
+			cam_req_mgr_debug_lat_record(
+				CAM_REQ_MGR_LAT_ADD_TO_APPLY,
+				link - g_links, slot->add_ts);
+			slot->add_ts = 0;
 
 			CAM_DBG(CAM_CRM, "req %d is applied on link %x",
 				slot->req_id,
@@ -2166,6 +2405,7 @@ static int  __cam_req_mgr_setup_in_q(struct cam_req_mgr_req_data *req)
 
 	mutex_lock(&req->lock);
 	in_q->num_slots = MAX_REQ_SLOTS;
+	__cam_req_mgr_slot_hash_reset(in_q);
 
 	for (i = 0; i < in_q->num_slots; i++) {
 		in_q->slot[i].idx = i;
@@ -2202,6 +2442,7 @@ static int __cam_req_mgr_reset_in_q(struct cam_req_mgr_req_data *req)
 	mutex_lock(&req->lock);
 	memset(in_q->slot, 0,
 		sizeof(struct cam_req_mgr_slot) * in_q->num_slots);
+	__cam_req_mgr_slot_hash_reset(in_q);
 	in_q->num_slots = 0;
 
 	in_q->wr_idx = 0;
@@ -2469,6 +2710,7 @@ static struct cam_req_mgr_core_link *__cam_req_mgr_reserve_link(
 	link->min_delay = CAM_PIPELINE_DELAY_MAX;
 	memset(in_q->slot, 0,
 		sizeof(struct cam_req_mgr_slot) * MAX_REQ_SLOTS);
+	__cam_req_mgr_slot_hash_reset(in_q);
 	link->req.in_q = in_q;
 	in_q->num_slots = 0;
 	link->state = CAM_CRM_LINK_STATE_IDLE;
@@ -2569,6 +2811,7 @@ static void __cam_req_mgr_unreserve_link(
 
 	for (j = 0; j < MAXIMUM_LINKS_PER_SESSION - 1; j++)
 		link->sync_link[j] = NULL;
+	__cam_req_mgr_sync_ready_clear_link(session, link);
 	session->num_links--;
 	CAM_DBG(CAM_CRM, "Active session links (%d)", session->num_links);
 	mutex_unlock(&session->lock);
@@ -2696,6 +2939,7 @@ int cam_req_mgr_process_flush_req(void *priv, void *data)
 	int                                  rc = 0;
 	struct cam_req_mgr_flush_info       *flush_info = NULL;
 	struct cam_req_mgr_core_link        *link = NULL;
+	struct cam_req_mgr_core_session     *session = NULL;
 	struct crm_task_payload             *task_data = NULL;
 
 	if (!data || !priv) {
@@ -2736,6 +2980,14 @@ int cam_req_mgr_process_flush_req(void *priv, void *data)
 		break;
 	}
 
+	/* Flushed req ids may be added again, forget they were ready */
+	session = (struct cam_req_mgr_core_session *)link->parent;
+	if (session) {
+		mutex_lock(&session->lock);
+		__cam_req_mgr_sync_ready_clear_link(session, link);
+		mutex_unlock(&session->lock);
+	}
+
 	complete(&link->workq_comp);
 	mutex_unlock(&link->req.lock);
 
@@ -2786,7 +3038,8 @@ int cam_req_mgr_process_sched_req(void *priv, void *data)
 		CAM_WARN(CAM_CRM, "in_q overwrite %d", slot->status);
 
 	slot->status = CRM_SLOT_STATUS_REQ_ADDED;
-	slot->req_id = sched_req->req_id;
+	__cam_req_mgr_in_q_set_req_id(in_q, in_q->wr_idx, sched_req->req_id);
+	slot->add_ts = 0;
 	slot->sync_mode = sched_req->sync_mode;
 	slot->skip_idx = 0;
 	slot->recover = sched_req->bubble_enable;
@@ -2932,6 +3185,7 @@ int cam_req_mgr_process_add_req(void *priv, void *data)
 
 	slot->state = CRM_REQ_STATE_PENDING;
 	slot->req_ready_map |= (1 << device->dev_bit);
+	link->req.in_q->slot[idx].add_ts = ktime_get();
 
 	CAM_DBG(CAM_CRM, "idx %d dev_hdl %x req_id %lld pd %d ready_map %x",
 		idx, add_req->dev_hdl, add_req->req_id, tbl->pd,
@@ -3912,6 +4166,7 @@ int cam_req_mgr_create_session(
 	cam_session->session_hdl = session_hdl;
 	cam_session->num_links = 0;
 	cam_session->sync_mode = CAM_REQ_MGR_SYNC_MODE_NO_SYNC;
+	__cam_req_mgr_sync_ready_reset(cam_session);
 	list_add(&cam_session->entry, &g_crm_core_dev->session_head);
 	mutex_unlock(&cam_session->lock);
 end:
@@ -4382,12 +4637,12 @@ end:
 }
 
 int cam_req_mgr_sync_config(
-	struct cam_req_mgr_sync_mode *sync_info)
+	struct cam_req_mgr_sync_mode_v2 *sync_info)
 {
 	int                              i, j, rc = 0;
 	int                              sync_idx = 0;
 	struct cam_req_mgr_core_session *cam_session;
-	struct cam_req_mgr_core_link    *link[MAX_LINKS_PER_SESSION];
+	struct cam_req_mgr_core_link    *link[MAX_LINKS_PER_SESSION_V2];
 
 	if (!sync_info) {
 		CAM_ERR(CAM_CRM, "NULL pointer");
@@ -4395,8 +4650,8 @@ int cam_req_mgr_sync_config(
 	}
 
 	if ((sync_info->num_links < 0) ||
-		(sync_info->num_links >
-		MAX_LINKS_PER_SESSION)) {
+		(sync_info->num_links > MAX_LINKS_PER_SESSION_V2) ||
+		(sync_info->num_links > MAXIMUM_LINKS_PER_SESSION)) {
 		CAM_ERR(CAM_CRM, "Invalid num links %d", sync_info->num_links);
 		return -EINVAL;
 	}
@@ -4453,6 +4708,8 @@ int cam_req_mgr_sync_config(
 			link[i]->sync_link[j] = NULL;
 	}
 
+	__cam_req_mgr_sync_ready_reset(cam_session);
+
 	if (sync_info->sync_mode == CAM_REQ_MGR_SYNC_MODE_SYNC) {
 		for (i = 0; i < sync_info->num_links; i++) {
 			j = 0;
@@ -4852,3 +5109,7 @@ int cam_req_mgr_core_device_deinit(void)
 
 	return 0;
 }
+
+#ifdef CONFIG_SPECTRA_KUNIT_TEST
+#include "cam_req_mgr_core_test.c"
+#endif
@@ -15,6 +15,10 @@
 #define CAM_REQ_MGR_MAX_LINKED_DEV     16
 #define MAX_REQ_SLOTS                  48
 
+/* req_id to slot index table, must be a power of 2 above MAX_REQ_SLOTS */
+#define CAM_REQ_MGR_SLOT_HASH_SIZE     64
+#define CAM_REQ_MGR_SLOT_HASH_EMPTY    -1
+
 #define CAM_REQ_MGR_WATCHDOG_TIMEOUT          1000
 #define CAM_REQ_MGR_WATCHDOG_TIMEOUT_DEFAULT  5000
 #define CAM_REQ_MGR_WATCHDOG_TIMEOUT_MAX      50000
@@ -37,7 +41,8 @@
 
 #define SYNC_LINK_SOF_CNT_MAX_LMT 1
 
-#define MAXIMUM_LINKS_PER_SESSION  4
+/* Also bounds the link bit in cam_req_mgr_sync_ready, keep within 32 */
+#define MAXIMUM_LINKS_PER_SESSION  8
 
 #define MAXIMUM_RETRY_ATTEMPTS 3
 
@@ -271,6 +276,7 @@ struct cam_req_mgr_req_tbl {
  * @sync_mode          : Sync mode in which req id in this slot has to applied
  * @additional_timeout : Adjusted watchdog timeout value associated with
  * this request
+ * @add_ts             : time of the latest device add_req for this request
  */
 struct cam_req_mgr_slot {
 	int32_t               idx;
@@ -280,6 +286,7 @@ struct cam_req_mgr_slot {
 	int64_t               req_id;
 	int32_t               sync_mode;
 	int32_t               additional_timeout;
+	ktime_t               add_ts;
 };
 
 /**
@@ -289,6 +296,8 @@ struct cam_req_mgr_slot {
  * @rd_idx      : indicates slot index currently in process.
  * @wr_idx      : indicates slot index to hold new upcoming req.
  * @last_applied_idx : indicates slot index last applied successfully.
+ * @slot_hash   : open addressed (linear probing) req_id to slot index
+ *                table, kept in sync with slot req_id updates
  */
 struct cam_req_mgr_req_queue {
 	int32_t                     num_slots;
@@ -296,6 +305,7 @@ struct cam_req_mgr_req_queue {
 	int32_t                     rd_idx;
 	int32_t                     wr_idx;
 	int32_t                     last_applied_idx;
+	int32_t                     slot_hash[CAM_REQ_MGR_SLOT_HASH_SIZE];
 };
 
 /**
@@ -430,6 +440,18 @@ struct cam_req_mgr_core_link {
 	bool                                 wq_congestion;
 };
 
+/**
+ * struct cam_req_mgr_sync_ready
+ * - Per session readiness of one request id across its synced links
+ * @req_id     : request id this entry is tagged with, -1 if unused
+ * @ready_mask : bit per link (index in g_links) whose pd tables were
+ *               found ready for req_id
+ */
+struct cam_req_mgr_sync_ready {
+	int64_t                       req_id;
+	uint32_t                      ready_mask;
+};
+
 /**
  * struct cam_req_mgr_core_session
  * - Session Properties
@@ -444,6 +466,8 @@ struct cam_req_mgr_core_link {
  * @force_err_recovery : For debugging, we can force bubble recovery
  *                       to be always ON or always OFF using debugfs.
  * @sync_mode          : Sync mode for this session links
+ * @sync_ready         : Readiness bitmap of synced links, hashed by
+ *                       req id, guarded by lock
  */
 struct cam_req_mgr_core_session {
 	int32_t                       session_hdl;
@@ -453,6 +477,8 @@ struct cam_req_mgr_core_session {
 	struct mutex                  lock;
 	int32_t                       force_err_recovery;
 	int32_t                       sync_mode;
+	struct cam_req_mgr_sync_ready
+			sync_ready[CAM_REQ_MGR_SLOT_HASH_SIZE];
 };
 
 /**
@@ -627,7 +653,7 @@ int cam_req_mgr_schedule_request(struct cam_req_mgr_sched_request *sched_req);
  * @brief: sync for links in a session
  * @sync_info: session, links info and master link info
  */
-int cam_req_mgr_sync_config(struct cam_req_mgr_sync_mode *sync_info);
+int cam_req_mgr_sync_config(struct cam_req_mgr_sync_mode_v2 *sync_info);
 
 /**
  * cam_req_mgr_flush_requests()
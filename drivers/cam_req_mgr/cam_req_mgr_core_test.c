@@ -0,0 +1,217 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ */
+
+/*
+ * KUnit tests for the CRM multi link sync check, built into
+ * cam_req_mgr_core.c. All g_links are claimed and wired into one fake
+ * session with a single pd table each, no devices or workq are attached.
+ */
+
+#include "cam_kunit.h"
+
+#define CAM_CRM_SYNC_TEST_NUM_LINKS     MAXIMUM_LINKS_PER_SESSION
+#define CAM_CRM_SYNC_TEST_NUM_SLOTS     4
+#define CAM_CRM_SYNC_TEST_REQ_ID        7
+#define CAM_CRM_SYNC_TEST_PD            CAM_PIPELINE_DELAY_2
+#define CAM_CRM_SYNC_TEST_BENCH_ITER    2000
+
+struct cam_crm_sync_test_ctx {
+	struct cam_req_mgr_core_session *session;
+	int                              num_claimed;
+};
+
+static void cam_crm_sync_test_setup_link(struct kunit *test,
+	struct cam_req_mgr_core_session *session, int n)
+{
+	struct cam_req_mgr_core_link *link = &g_links[n];
+	struct cam_req_mgr_req_queue *in_q;
+	struct cam_req_mgr_req_tbl *tbl;
+	int i, j = 0;
+
+	in_q = kunit_kzalloc(test, sizeof(*in_q), GFP_KERNEL);
+	tbl = kunit_kzalloc(test, sizeof(*tbl), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, in_q);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, tbl);
+
+	in_q->num_slots = CAM_CRM_SYNC_TEST_NUM_SLOTS;
+	__cam_req_mgr_slot_hash_reset(in_q);
+	for (i = 0; i < CAM_CRM_SYNC_TEST_NUM_SLOTS; i++) {
+		in_q->slot[i].idx = i;
+		in_q->slot[i].req_id = -1;
+		tbl->slot[i].idx = i;
+	}
+	__cam_req_mgr_in_q_set_req_id(in_q, 0, CAM_CRM_SYNC_TEST_REQ_ID);
+	in_q->slot[0].status = CRM_SLOT_STATUS_REQ_ADDED;
+	in_q->slot[0].sync_mode = CAM_REQ_MGR_SYNC_MODE_SYNC;
+
+	tbl->pd = CAM_CRM_SYNC_TEST_PD;
+	tbl->num_slots = CAM_CRM_SYNC_TEST_NUM_SLOTS;
+	tbl->slot[0].state = CRM_REQ_STATE_READY;
+
+	cam_req_mgr_core_link_reset(link);
+	link->link_hdl = 0x100 + n;
+	link->state = CAM_CRM_LINK_STATE_READY;
+	link->max_delay = CAM_CRM_SYNC_TEST_PD;
+	link->pd_mask = BIT(CAM_CRM_SYNC_TEST_PD);
+	link->req.in_q = in_q;
+	link->req.l_tbl = tbl;
+	link->req.num_tbl = 1;
+	link->parent = session;
+	link->initial_skip = false;
+
+	for (i = 0; i < CAM_CRM_SYNC_TEST_NUM_LINKS; i++)
+		if (i != n)
+			link->sync_link[j++] = &g_links[i];
+	link->num_sync_links = j;
+	session->links[n] = link;
+}
+
+static int cam_crm_sync_test_init(struct kunit *test)
+{
+	struct cam_crm_sync_test_ctx *ctx;
+	int i;
+
+	ctx = kunit_kzalloc(test, sizeof(*ctx), GFP_KERNEL);
+	if (!ctx)
+		return -ENOMEM;
+
+	ctx->session = kunit_kzalloc(test, sizeof(*ctx->session), GFP_KERNEL);
+	if (!ctx->session)
+		return -ENOMEM;
+
+	mutex_init(&ctx->session->lock);
+	__cam_req_mgr_sync_ready_reset(ctx->session);
+	ctx->session->sync_mode = CAM_REQ_MGR_SYNC_MODE_SYNC;
+	test->priv = ctx;
+
+	/* Readiness bits are indexed by g_links slot, so no stand ins */
+	for (i = 0; i < CAM_CRM_SYNC_TEST_NUM_LINKS; i++) {
+		if (atomic_cmpxchg(&g_links[i].is_used, 0, 1))
+			goto release;
+		ctx->num_claimed++;
+	}
+
+	for (i = 0; i < CAM_CRM_SYNC_TEST_NUM_LINKS; i++)
+		cam_crm_sync_test_setup_link(test, ctx->session, i);
+	ctx->session->num_links = CAM_CRM_SYNC_TEST_NUM_LINKS;
+
+	return 0;
+
+release:
+	CAM_WARN(CAM_CRM, "link %d in use, camera must be idle", i);
+	while (ctx->num_claimed)
+		atomic_set(&g_links[--ctx->num_claimed].is_used, 0);
+	return -EBUSY;
+}
+
+static void cam_crm_sync_test_exit(struct kunit *test)
+{
+	struct cam_crm_sync_test_ctx *ctx = test->priv;
+	int i;
+
+	if (!ctx)
+		return;
+
+	for (i = 0; i < ctx->num_claimed; i++) {
+		cam_req_mgr_core_link_reset(&g_links[i]);
+		atomic_set(&g_links[i].is_used, 0);
+	}
+	mutex_destroy(&ctx->session->lock);
+}
+
+static int cam_crm_sync_test_check(struct cam_crm_sync_test_ctx *ctx, int n)
+{
+	struct cam_req_mgr_core_link *link = &g_links[n];
+	int rc;
+
+	mutex_lock(&ctx->session->lock);
+	rc = __cam_req_mgr_check_multi_sync_link_ready(link,
+		&link->req.in_q->slot[0], CAM_TRIGGER_POINT_SOF);
+	mutex_unlock(&ctx->session->lock);
+
+	return rc;
+}
+
+static void cam_crm_sync_test_all_ready(struct kunit *test)
+{
+	struct cam_crm_sync_test_ctx *ctx = test->priv;
+	struct cam_req_mgr_sync_ready *sync_ready;
+	int i;
+
+	for (i = 0; i < CAM_CRM_SYNC_TEST_NUM_LINKS; i++) {
+		KUNIT_EXPECT_EQ(test, cam_crm_sync_test_check(ctx, i), 0);
+		KUNIT_EXPECT_EQ(test,
+			g_links[i].req.apply_data[CAM_CRM_SYNC_TEST_PD].req_id,
+			(int64_t)CAM_CRM_SYNC_TEST_REQ_ID);
+	}
+
+	sync_ready = &ctx->session->sync_ready[
+		__cam_req_mgr_slot_hash_home(CAM_CRM_SYNC_TEST_REQ_ID)];
+	KUNIT_EXPECT_EQ(test, sync_ready->req_id,
+		(int64_t)CAM_CRM_SYNC_TEST_REQ_ID);
+	KUNIT_EXPECT_EQ(test, sync_ready->ready_mask,
+		(uint32_t)GENMASK(CAM_CRM_SYNC_TEST_NUM_LINKS - 1, 0));
+}
+
+static void cam_crm_sync_test_peer_not_ready(struct kunit *test)
+{
+	struct cam_crm_sync_test_ctx *ctx = test->priv;
+	struct cam_req_mgr_sync_ready *sync_ready;
+	int last = CAM_CRM_SYNC_TEST_NUM_LINKS - 1;
+
+	sync_ready = &ctx->session->sync_ready[
+		__cam_req_mgr_slot_hash_home(CAM_CRM_SYNC_TEST_REQ_ID)];
+
+	/* The last peer is the one checked last, after the others cached */
+	g_links[last].req.l_tbl->slot[0].state = CRM_REQ_STATE_PENDING;
+	KUNIT_EXPECT_LT(test, cam_crm_sync_test_check(ctx, 0), 0);
+	KUNIT_EXPECT_LT(test, cam_crm_sync_test_check(ctx, last), 0);
+	KUNIT_EXPECT_EQ(test, sync_ready->ready_mask &
+		(uint32_t)BIT(last), 0U);
+
+	/* A failed check is not cached, the peer is picked up once ready */
+	g_links[last].req.l_tbl->slot[0].state = CRM_REQ_STATE_READY;
+	KUNIT_EXPECT_EQ(test, cam_crm_sync_test_check(ctx, 0), 0);
+	KUNIT_EXPECT_EQ(test, cam_crm_sync_test_check(ctx, last), 0);
+	KUNIT_EXPECT_EQ(test, sync_ready->ready_mask,
+		(uint32_t)GENMASK(CAM_CRM_SYNC_TEST_NUM_LINKS - 1, 0));
+}
+
+static void cam_crm_sync_test_bench_check(struct kunit *test)
+{
+	struct cam_crm_sync_test_ctx *ctx = test->priv;
+	struct cam_kunit_bench bench;
+	int i, rc = 0;
+	ktime_t start;
+
+	KUNIT_ASSERT_EQ(test, cam_kunit_bench_init(test, &bench,
+		"crm_multi_sync_check_8", CAM_CRM_SYNC_TEST_BENCH_ITER), 0);
+
+	for (i = 0; i < CAM_CRM_SYNC_TEST_BENCH_ITER && !rc; i++) {
+		start = ktime_get();
+		rc = cam_crm_sync_test_check(ctx,
+			i % CAM_CRM_SYNC_TEST_NUM_LINKS);
+		cam_kunit_bench_add(&bench, start);
+	}
+
+	KUNIT_EXPECT_EQ(test, rc, 0);
+	KUNIT_EXPECT_EQ(test, bench.num,
+		(uint32_t)CAM_CRM_SYNC_TEST_BENCH_ITER);
+	cam_kunit_bench_report(test, &bench);
+}
+
+static struct kunit_case cam_req_mgr_core_test_cases[] = {
+	KUNIT_CASE(cam_crm_sync_test_all_ready),
+	KUNIT_CASE(cam_crm_sync_test_peer_not_ready),
+	KUNIT_CASE(cam_crm_sync_test_bench_check),
+	{}
+};
+
+struct kunit_suite cam_req_mgr_core_test_suite = {
+	.name = "cam_req_mgr_core",
+	.init = cam_crm_sync_test_init,
+	.exit = cam_crm_sync_test_exit,
+	.test_cases = cam_req_mgr_core_test_cases,
+};
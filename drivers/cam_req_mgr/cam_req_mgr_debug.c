@@ -3,6 +3,8 @@
  * Copyright (c) 2016-2021, The Linux Foundation. All rights reserved.
  */
 
+#include <linux/percpu.h>
+#include <linux/seq_file.h>
 #include "cam_req_mgr_debug.h"
 
 #define MAX_SESS_INFO_LINE_BUFF_LEN 256
@@ -10,6 +12,44 @@
 static char sess_info_buffer[MAX_SESS_INFO_LINE_BUFF_LEN];
 static int cam_debug_mgr_delay_detect;
 
+/**
+ * struct cam_req_mgr_lat_hist - Per-CPU request latency buckets
+ *
+ * @cnt: Sample count per stage, per instance and per log2 us bucket.
+ *       Instance 0 is the aggregate, instance n + 1 is link/ctx n.
+ */
+struct cam_req_mgr_lat_hist {
+	uint32_t cnt[CAM_REQ_MGR_LAT_MAX][CAM_REQ_MGR_LAT_INST_MAX + 1]
+		[CAM_REQ_MGR_LAT_BUCKETS];
+};
+
+/* Stages timed per IRQ, patch or workq run, off unless asked for */
+#define CAM_REQ_MGR_LAT_HOT_STAGES              \
+	(BIT(CAM_REQ_MGR_LAT_WORKQ_SCHED) |     \
+	BIT(CAM_REQ_MGR_LAT_WORKQ_EXEC) |       \
+	BIT(CAM_REQ_MGR_LAT_SYNC_CB_SCHED) |    \
+	BIT(CAM_REQ_MGR_LAT_IRQ_TH) |           \
+	BIT(CAM_REQ_MGR_LAT_PATCH))
+
+static struct cam_req_mgr_lat_hist __percpu __rcu *cam_req_mgr_lat;
+static bool cam_req_mgr_lat_enable = true;
+static bool cam_req_mgr_lat_hot_enable;
+static ktime_t cam_req_mgr_lat_reset_ts;
+
+static const char * const cam_req_mgr_lat_stage_names[] = {
+	[CAM_REQ_MGR_LAT_ADD_TO_APPLY]    = "add_req_to_apply",
+	[CAM_REQ_MGR_LAT_APPLY_TO_RUP]    = "apply_to_rup_ack",
+	[CAM_REQ_MGR_LAT_SOF_TO_BUF_DONE] = "sof_to_buf_done",
+	[CAM_REQ_MGR_LAT_SUBMIT_TO_DONE]  = "hfi_submit_to_done",
+	[CAM_REQ_MGR_LAT_WORKQ_SCHED]     = "crm_workq_sched",
+	[CAM_REQ_MGR_LAT_WORKQ_EXEC]      = "crm_workq_exec",
+	[CAM_REQ_MGR_LAT_SYNC_CB_SCHED]   = "sync_cb_sched",
+	[CAM_REQ_MGR_LAT_IRQ_TH]          = "irq_ctrl_top_half",
+	[CAM_REQ_MGR_LAT_PATCH]           = "packet_patch",
+	[CAM_REQ_MGR_LAT_FD_SUBMIT_TO_DONE] = "fd_submit_to_done",
+	[CAM_REQ_MGR_LAT_SYNC_CHECK]      = "crm_sync_check",
+};
+
 static int cam_req_mgr_debug_set_bubble_recovery(void *data, u64 val)
 {
 	struct cam_req_mgr_core_device  *core_dev = data;
@@ -111,11 +151,183 @@ static const struct file_operations session_info = {
 	.write = session_info_write,
 };
 
+/* Upper bound in us of log2 bucket @b, bucket 0 holds samples < 1us */
+static inline uint64_t cam_req_mgr_lat_bucket_us(int b)
+{
+	return 1ULL << b;
+}
+
+static uint64_t cam_req_mgr_lat_percentile(const uint32_t *buckets,
+	uint64_t total, uint32_t pct)
+{
+	uint64_t target, acc = 0;
+	int b;
+
+	target = DIV_ROUND_UP_ULL(total * pct, 100);
+	for (b = 0; b < CAM_REQ_MGR_LAT_BUCKETS; b++) {
+		acc += buckets[b];
+		if (acc >= target)
+			return cam_req_mgr_lat_bucket_us(b);
+	}
+
+	return cam_req_mgr_lat_bucket_us(CAM_REQ_MGR_LAT_BUCKETS - 1);
+}
+
+static void cam_req_mgr_lat_show_inst(struct seq_file *m,
+	const uint32_t *buckets, int inst, int64_t window_us)
+{
+	uint64_t total = 0;
+	int b, max_b = 0;
+
+	for (b = 0; b < CAM_REQ_MGR_LAT_BUCKETS; b++) {
+		total += buckets[b];
+		if (buckets[b])
+			max_b = b;
+	}
+
+	if (!total)
+		return;
+
+	if (inst)
+		seq_printf(m, "  %-4d", inst - 1);
+	else
+		seq_puts(m, "  all ");
+
+	seq_printf(m, " %10llu %10llu %8llu %8llu %8llu %8llu |",
+		total, window_us > 0 ?
+		div64_u64(total * USEC_PER_SEC, window_us) : 0,
+		cam_req_mgr_lat_percentile(buckets, total, 50),
+		cam_req_mgr_lat_percentile(buckets, total, 90),
+		cam_req_mgr_lat_percentile(buckets, total, 99),
+		cam_req_mgr_lat_bucket_us(max_b));
+
+	for (b = 0; b <= max_b; b++)
+		seq_printf(m, " %u", buckets[b]);
+	seq_puts(m, "\n");
+}
+
+static int cam_req_mgr_lat_hist_show(struct seq_file *m, void *unused)
+{
+	struct cam_req_mgr_lat_hist __percpu *lat;
+	struct cam_req_mgr_lat_hist *sum, *hist;
+	uint32_t *dst, *src;
+	int64_t window_us;
+	int cpu, stage, inst, b;
+
+	/* debugfs removal waits for this reader before the buckets go */
+	lat = rcu_dereference_protected(cam_req_mgr_lat, true);
+	if (!lat) {
+		seq_puts(m, "latency histograms not allocated\n");
+		return 0;
+	}
+
+	sum = kzalloc(sizeof(*sum), GFP_KERNEL);
+	if (!sum)
+		return -ENOMEM;
+
+	for_each_possible_cpu(cpu) {
+		hist = per_cpu_ptr(lat, cpu);
+		dst = &sum->cnt[0][0][0];
+		src = &hist->cnt[0][0][0];
+		for (b = 0; b < sizeof(*sum) / sizeof(*dst); b++)
+			dst[b] += READ_ONCE(src[b]);
+	}
+
+	window_us = ktime_us_delta(ktime_get(), cam_req_mgr_lat_reset_ts);
+	seq_printf(m, "window %lld ms\n", window_us / USEC_PER_MSEC);
+	seq_puts(m,
+		"bucket n: [2^(n-1), 2^n) us, percentiles are upper bounds\n");
+	for (stage = 0; stage < CAM_REQ_MGR_LAT_MAX; stage++) {
+		seq_printf(m,
+			"%s\n  inst %10s %10s %8s %8s %8s %8s | buckets\n",
+			cam_req_mgr_lat_stage_names[stage], "count",
+			"ops_per_s", "p50_us", "p90_us", "p99_us", "max_us");
+		for (inst = 0; inst <= CAM_REQ_MGR_LAT_INST_MAX; inst++)
+			cam_req_mgr_lat_show_inst(m, sum->cnt[stage][inst],
+				inst, window_us);
+	}
+
+	kfree(sum);
+	return 0;
+}
+
+static int cam_req_mgr_lat_hist_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, cam_req_mgr_lat_hist_show, NULL);
+}
+
+/* Any write clears the histograms */
+static ssize_t cam_req_mgr_lat_hist_write(struct file *t_file,
+	const char *t_char, size_t t_size_t, loff_t *t_loff_t)
+{
+	struct cam_req_mgr_lat_hist __percpu *lat;
+	int cpu;
+
+	lat = rcu_dereference_protected(cam_req_mgr_lat, true);
+	if (lat)
+		for_each_possible_cpu(cpu)
+			memset(per_cpu_ptr(lat, cpu), 0,
+				sizeof(struct cam_req_mgr_lat_hist));
+	cam_req_mgr_lat_reset_ts = ktime_get();
+
+	return t_size_t;
+}
+
+static const struct file_operations latency_hist = {
+	.open = cam_req_mgr_lat_hist_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.write = cam_req_mgr_lat_hist_write,
+	.release = single_release,
+};
+
+static inline bool cam_req_mgr_lat_stage_enabled(
+	enum cam_req_mgr_lat_stage stage)
+{
+	if (!READ_ONCE(cam_req_mgr_lat_enable))
+		return false;
+
+	return !(BIT(stage) & CAM_REQ_MGR_LAT_HOT_STAGES) ||
+		READ_ONCE(cam_req_mgr_lat_hot_enable);
+}
+
+ktime_t cam_req_mgr_debug_lat_start(enum cam_req_mgr_lat_stage stage)
+{
+	return cam_req_mgr_lat_stage_enabled(stage) ? ktime_get() : 0;
+}
+
+void cam_req_mgr_debug_lat_record(enum cam_req_mgr_lat_stage stage,
+	uint32_t inst, ktime_t start)
+{
+	struct cam_req_mgr_lat_hist __percpu *lat;
+	int64_t delta_us;
+	int b;
+
+	if (!start || stage >= CAM_REQ_MGR_LAT_MAX ||
+		!cam_req_mgr_lat_stage_enabled(stage))
+		return;
+
+	delta_us = ktime_us_delta(ktime_get(), start);
+	b = (delta_us > 0) ? fls64(delta_us) : 0;
+	if (b >= CAM_REQ_MGR_LAT_BUCKETS)
+		b = CAM_REQ_MGR_LAT_BUCKETS - 1;
+
+	rcu_read_lock();
+	lat = rcu_dereference(cam_req_mgr_lat);
+	if (lat) {
+		this_cpu_inc(lat->cnt[stage][0][b]);
+		if (inst < CAM_REQ_MGR_LAT_INST_MAX)
+			this_cpu_inc(lat->cnt[stage][inst + 1][b]);
+	}
+	rcu_read_unlock();
+}
+
 static struct dentry *debugfs_root;
 int cam_req_mgr_debug_register(struct cam_req_mgr_core_device *core_dev)
 {
 	int rc = 0;
 	struct dentry *dbgfileptr = NULL;
+	struct cam_req_mgr_lat_hist __percpu *lat;
 
 	dbgfileptr = debugfs_create_dir("cam_req_mgr", NULL);
 	if (!dbgfileptr) {
@@ -134,14 +346,36 @@ int cam_req_mgr_debug_register(struct cam_req_mgr_core_device *core_dev)
 		debugfs_root, &core_dev->recovery_on_apply_fail);
 	debugfs_create_u32("delay_detect_count", 0644, debugfs_root,
 		&cam_debug_mgr_delay_detect);
+
+	lat = alloc_percpu(struct cam_req_mgr_lat_hist);
+	if (!lat)
+		CAM_WARN(CAM_CRM, "Latency histograms not allocated");
+	cam_req_mgr_lat_reset_ts = ktime_get();
+	rcu_assign_pointer(cam_req_mgr_lat, lat);
+	debugfs_create_file("latency_hist", 0644, debugfs_root, NULL,
+		&latency_hist);
+	debugfs_create_bool("latency_hist_enable", 0644, debugfs_root,
+		&cam_req_mgr_lat_enable);
+	debugfs_create_bool("latency_hist_hot_enable", 0644, debugfs_root,
+		&cam_req_mgr_lat_hot_enable);
 end:
 	return rc;
 }
 
 int cam_req_mgr_debug_unregister(void)
 {
+	struct cam_req_mgr_lat_hist __percpu *lat;
+
 	debugfs_remove_recursive(debugfs_root);
 	debugfs_root = NULL;
+
+	lat = rcu_dereference_protected(cam_req_mgr_lat, true);
+	RCU_INIT_POINTER(cam_req_mgr_lat, NULL);
+	if (lat) {
+		synchronize_rcu();
+		free_percpu(lat);
+	}
+
 	return 0;
 }
 
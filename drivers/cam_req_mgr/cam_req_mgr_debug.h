@@ -17,4 +17,60 @@ int cam_req_mgr_debug_unregister(void);
  * @brief    : increment debug_fs varaible by 1 whenever delay occurred.
  */
 void cam_req_mgr_debug_delay_detect(void);
+
+/* Number of log2 microsecond buckets, last one collects >= ~4s */
+#define CAM_REQ_MGR_LAT_BUCKETS     24
+
+/* Instances (link/context index) tracked individually per stage */
+#define CAM_REQ_MGR_LAT_INST_MAX    16
+
+/**
+ * enum cam_req_mgr_lat_stage - Request pipeline stages timed in debugfs
+ *
+ * @CAM_REQ_MGR_LAT_ADD_TO_APPLY:    last device add_req to CRM apply
+ * @CAM_REQ_MGR_LAT_APPLY_TO_RUP:    ISP apply to reg update ack
+ * @CAM_REQ_MGR_LAT_SOF_TO_BUF_DONE: ISP SOF to request buf done
+ * @CAM_REQ_MGR_LAT_SUBMIT_TO_DONE:  HFI frame submit to frame done
+ * @CAM_REQ_MGR_LAT_WORKQ_SCHED:     CRM workq enqueue to work start
+ * @CAM_REQ_MGR_LAT_WORKQ_EXEC:      CRM workq run of all pending tasks
+ * @CAM_REQ_MGR_LAT_SYNC_CB_SCHED:   sync kernel callback queue to dispatch
+ * @CAM_REQ_MGR_LAT_IRQ_TH:          IRQ controller top half
+ * @CAM_REQ_MGR_LAT_PATCH:           packet patch processing
+ * @CAM_REQ_MGR_LAT_FD_SUBMIT_TO_DONE: FD frame start to frame done
+ * @CAM_REQ_MGR_LAT_SYNC_CHECK:     CRM multi link sync readiness check
+ */
+enum cam_req_mgr_lat_stage {
+	CAM_REQ_MGR_LAT_ADD_TO_APPLY,
+	CAM_REQ_MGR_LAT_APPLY_TO_RUP,
+	CAM_REQ_MGR_LAT_SOF_TO_BUF_DONE,
+	CAM_REQ_MGR_LAT_SUBMIT_TO_DONE,
+	CAM_REQ_MGR_LAT_WORKQ_SCHED,
+	CAM_REQ_MGR_LAT_WORKQ_EXEC,
+	CAM_REQ_MGR_LAT_SYNC_CB_SCHED,
+	CAM_REQ_MGR_LAT_IRQ_TH,
+	CAM_REQ_MGR_LAT_PATCH,
+	CAM_REQ_MGR_LAT_FD_SUBMIT_TO_DONE,
+	CAM_REQ_MGR_LAT_SYNC_CHECK,
+	CAM_REQ_MGR_LAT_MAX,
+};
+
+/* cam_req_mgr_debug_lat_start()
+ * @brief    : start timestamp for a stage timed only by its caller,
+ *             zero (and so not recorded) when @stage is disabled.
+ * @stage    : pipeline stage about to be timed
+ */
+ktime_t cam_req_mgr_debug_lat_start(enum cam_req_mgr_lat_stage stage);
+
+/* cam_req_mgr_debug_lat_record()
+ * @brief    : account the time elapsed since @start to the log2 histogram
+ *             of @stage, both in the aggregate and for instance @inst.
+ *             Buckets are per-CPU so this is safe from any context.
+ *             No-op if @start is zero or @stage is disabled.
+ * @stage    : pipeline stage being timed
+ * @inst     : link or context index, instances from
+ *             CAM_REQ_MGR_LAT_INST_MAX only count in the aggregate
+ * @start    : timestamp the stage started at
+ */
+void cam_req_mgr_debug_lat_record(enum cam_req_mgr_lat_stage stage,
+	uint32_t inst, ktime_t start);
 #endif
@@ -169,6 +169,7 @@ static unsigned int cam_req_mgr_poll(struct file *f,
 {
 	int rc = 0;
 	struct v4l2_fh *eventq = f->private_data;
+	struct cam_event_ring *event_ring;
 
 	if (!eventq)
 		return -EINVAL;
@@ -177,6 +178,57 @@ static unsigned int cam_req_mgr_poll(struct file *f,
 	if (v4l2_event_pending(eventq))
 		rc = POLLPRI;
 
+	/* Only freed on release, cannot go away under us */
+	event_ring = READ_ONCE(g_dev.event_ring);
+	if (event_ring)
+		rc |= cam_event_ring_poll(event_ring, f, pll_table);
+
+	return rc;
+}
+
+static int cam_req_mgr_mmap(struct file *filep, struct vm_area_struct *vma)
+{
+	int rc;
+
+	mutex_lock(&g_dev.cam_lock);
+	if (!g_dev.event_ring) {
+		CAM_ERR(CAM_CRM, "Event ring not set up");
+		rc = -ENODEV;
+	} else {
+		rc = cam_event_ring_mmap(g_dev.event_ring, vma);
+	}
+	mutex_unlock(&g_dev.cam_lock);
+
+	return rc;
+}
+
+static int cam_req_mgr_event_ring_setup(struct cam_event_ring_setup *setup)
+{
+	int rc;
+	unsigned long flags;
+	struct cam_event_ring *event_ring = NULL;
+
+	mutex_lock(&g_dev.cam_lock);
+	if (g_dev.event_ring) {
+		CAM_ERR(CAM_CRM, "Event ring already set up");
+		rc = -EBUSY;
+		goto end;
+	}
+
+	rc = cam_event_ring_create(setup->num_entries, &event_ring);
+	if (rc)
+		goto end;
+
+	spin_lock_irqsave(&g_dev.event_ring_lock, flags);
+	g_dev.event_ring = event_ring;
+	spin_unlock_irqrestore(&g_dev.event_ring_lock, flags);
+
+	setup->size = event_ring->size;
+	setup->version = CAM_EVENT_RING_VERSION;
+	CAM_DBG(CAM_CRM, "Event ring entries %u size %u",
+		setup->num_entries, setup->size);
+end:
+	mutex_unlock(&g_dev.cam_lock);
 	return rc;
 }
 
@@ -186,6 +238,8 @@ static int cam_req_mgr_close(struct file *filep)
 	struct cam_subdev *csd;
 	struct v4l2_fh *vfh = filep->private_data;
 	struct v4l2_subdev_fh *subdev_fh = to_v4l2_subdev_fh(vfh);
+	struct cam_event_ring *event_ring;
+	unsigned long flags;
 
 	CAM_WARN(CAM_CRM,
 		"release invoked associated userspace process has died, open_cnt: %d",
@@ -224,6 +278,13 @@ static int cam_req_mgr_close(struct file *filep)
 	g_dev.cam_eventq = NULL;
 	spin_unlock_bh(&g_dev.cam_eventq_lock);
 
+	/* Release only runs once the last mapping of the ring is gone */
+	spin_lock_irqsave(&g_dev.event_ring_lock, flags);
+	event_ring = g_dev.event_ring;
+	g_dev.event_ring = NULL;
+	spin_unlock_irqrestore(&g_dev.event_ring_lock, flags);
+	cam_event_ring_destroy(event_ring);
+
 	cam_req_mgr_util_free_hdls();
 	cam_mem_mgr_deinit();
 	mutex_unlock(&g_dev.cam_lock);
@@ -237,6 +298,7 @@ static struct v4l2_file_operations g_cam_fops = {
 	.owner  = THIS_MODULE,
 	.open   = cam_req_mgr_open,
 	.poll   = cam_req_mgr_poll,
+	.mmap   = cam_req_mgr_mmap,
 	.release = cam_req_mgr_close,
 	.unlocked_ioctl   = video_ioctl2,
 #ifdef CONFIG_COMPAT
@@ -477,6 +539,8 @@ static long cam_private_ioctl(struct file *file, void *fh,
 
 	case CAM_REQ_MGR_SYNC_MODE: {
 		struct cam_req_mgr_sync_mode sync_info;
+		struct cam_req_mgr_sync_mode_v2 sync_info_v2 = {0};
+		int i;
 
 		if (k_ioctl->size != sizeof(sync_info))
 			return -EINVAL;
@@ -487,9 +551,57 @@ static long cam_private_ioctl(struct file *file, void *fh,
 			return -EFAULT;
 		}
 
+		if ((sync_info.num_links < 0) ||
+			(sync_info.num_links > MAX_LINKS_PER_SESSION))
+			return -EINVAL;
+
+		sync_info_v2.session_hdl = sync_info.session_hdl;
+		sync_info_v2.sync_mode = sync_info.sync_mode;
+		sync_info_v2.num_links = sync_info.num_links;
+		sync_info_v2.master_link_hdl = sync_info.master_link_hdl;
+		for (i = 0; i < MAX_LINKS_PER_SESSION; i++)
+			sync_info_v2.link_hdls[i] = sync_info.link_hdls[i];
+
+		rc = cam_req_mgr_sync_config(&sync_info_v2);
+		}
+		break;
+	case CAM_REQ_MGR_SYNC_MODE_V2: {
+		struct cam_req_mgr_sync_mode_v2 sync_info;
+
+		if (k_ioctl->size != sizeof(sync_info))
+			return -EINVAL;
+
+		if (copy_from_user(&sync_info,
+			u64_to_user_ptr(k_ioctl->handle),
+			sizeof(struct cam_req_mgr_sync_mode_v2))) {
+			return -EFAULT;
+		}
+
 		rc = cam_req_mgr_sync_config(&sync_info);
 		}
 		break;
+	case CAM_REQ_MGR_EVENT_RING_SETUP: {
+		struct cam_event_ring_setup setup;
+
+		if (k_ioctl->size != sizeof(setup))
+			return -EINVAL;
+
+		if (copy_from_user(&setup,
+			u64_to_user_ptr(k_ioctl->handle),
+			sizeof(struct cam_event_ring_setup))) {
+			return -EFAULT;
+		}
+
+		rc = cam_req_mgr_event_ring_setup(&setup);
+		if (!rc) {
+			if (copy_to_user(
+				u64_to_user_ptr(k_ioctl->handle),
+				&setup,
+				sizeof(struct cam_event_ring_setup)))
+				rc = -EFAULT;
+		}
+		}
+		break;
 	case CAM_REQ_MGR_ALLOC_BUF: {
 		struct cam_mem_mgr_alloc_cmd cmd;
 
@@ -570,6 +682,43 @@ static long cam_private_ioctl(struct file *file, void *fh,
 			rc = -EINVAL;
 		}
 		break;
+	case CAM_REQ_MGR_CACHE_OPS_V2: {
+		struct cam_mem_cache_ops_v2_cmd *cmd;
+		uint32_t num_ranges;
+		size_t cmd_size;
+
+		if (k_ioctl->size < sizeof(*cmd))
+			return -EINVAL;
+
+		if (copy_from_user(&num_ranges,
+			u64_to_user_ptr(k_ioctl->handle),
+			sizeof(num_ranges)))
+			return -EFAULT;
+
+		if (!num_ranges || (num_ranges > CAM_MEM_CACHE_OPS_MAX_RANGES))
+			return -EINVAL;
+
+		cmd_size = sizeof(*cmd) + ((num_ranges - 1) *
+			sizeof(struct cam_mem_cache_ops_range));
+		if (k_ioctl->size != cmd_size)
+			return -EINVAL;
+
+		cmd = memdup_user(u64_to_user_ptr(k_ioctl->handle), cmd_size);
+		if (IS_ERR(cmd))
+			return PTR_ERR(cmd);
+
+		/* Header may have changed between the two copies */
+		cmd->num_ranges = num_ranges;
+		rc = cam_mem_mgr_cache_ops_v2(cmd);
+
+		if (copy_to_user(u64_to_user_ptr(k_ioctl->handle) +
+			offsetof(struct cam_mem_cache_ops_v2_cmd, num_done),
+			&cmd->num_done, sizeof(cmd->num_done)))
+			rc = -EFAULT;
+
+		kfree(cmd);
+		}
+		break;
 	case CAM_REQ_MGR_LINK_CONTROL: {
 		struct cam_req_mgr_link_control cmd;
 
@@ -677,10 +826,20 @@ int cam_req_mgr_notify_message(struct cam_req_mgr_message *msg,
 {
 	struct v4l2_event event;
 	struct cam_req_mgr_message *ev_header;
+	unsigned long flags;
 
 	if (!msg)
 		return -EINVAL;
 
+	spin_lock_irqsave(&g_dev.event_ring_lock, flags);
+	if (g_dev.event_ring) {
+		cam_event_ring_push(g_dev.event_ring, id, type, msg,
+			sizeof(struct cam_req_mgr_message));
+		spin_unlock_irqrestore(&g_dev.event_ring_lock, flags);
+		return 0;
+	}
+	spin_unlock_irqrestore(&g_dev.event_ring_lock, flags);
+
 	event.id = id;
 	event.type = type;
 	ev_header = CAM_REQ_MGR_GET_PAYLOAD_PTR(event,
@@ -836,6 +995,7 @@ static int cam_req_mgr_component_master_bind(struct device *dev)
 	g_dev.shutdown_state = false;
 	mutex_init(&g_dev.cam_lock);
 	spin_lock_init(&g_dev.cam_eventq_lock);
+	spin_lock_init(&g_dev.event_ring_lock);
 	mutex_init(&g_dev.dev_lock);
 
 	rc = cam_req_mgr_util_init();
@@ -863,6 +1023,8 @@ static int cam_req_mgr_component_master_bind(struct device *dev)
 				g_cam_req_mgr_timer_cachep->name);
 	}
 
+	cam_mem_mgr_pool_init();
+
 	CAM_DBG(CAM_CRM, "All probes done, binding slave components");
 	g_dev.state = true;
 	rc = component_bind_all(dev, NULL);
@@ -887,6 +1049,7 @@ static int cam_req_mgr_component_master_bind(struct device *dev)
 sysfs_fail:
 	sysfs_remove_file(&dev->kobj, &camera_debug_sysfs_attr.attr);
 req_mgr_device_deinit:
+	cam_mem_mgr_pool_deinit();
 	cam_req_mgr_destroy_timer_slab();
 	cam_req_mgr_core_device_deinit();
 req_mgr_core_fail:
@@ -905,6 +1068,9 @@ media_setup_fail:
 
 static void cam_req_mgr_component_master_unbind(struct device *dev)
 {
+	/* Pooled buffers are still mapped on the SMMU handles of the slaves */
+	cam_mem_mgr_pool_deinit();
+
 	/* Unbinding all slave components first */
 	component_unbind_all(dev, NULL);
 
@@ -7,6 +7,7 @@
 #define _CAM_REQ_MGR_DEV_H_
 
 #include "media/cam_req_mgr.h"
+#include "cam_event_ring.h"
 /**
  * struct cam_req_mgr_device - a camera request manager device
  *
@@ -21,6 +22,8 @@
  * @cam_eventq: event queue
  * @cam_eventq_lock: lock for event queue
  * @shutdown_state: shutdown state
+ * @event_ring: shared memory ring events go to instead of cam_eventq
+ * @event_ring_lock: lock for event_ring, serializes pushes to it
  */
 struct cam_req_mgr_device {
 	struct video_device *video;
@@ -34,6 +37,8 @@ struct cam_req_mgr_device {
 	struct v4l2_fh *cam_eventq;
 	spinlock_t cam_eventq_lock;
 	bool shutdown_state;
+	struct cam_event_ring *event_ring;
+	spinlock_t event_ring_lock;
 };
 
 #define CAM_REQ_MGR_GET_PAYLOAD_PTR(ev, type)        \
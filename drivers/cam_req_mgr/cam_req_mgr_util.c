@@ -17,50 +17,93 @@
 #include "cam_debug_util.h"
 #include "cam_subdev.h"
 
-static struct cam_req_mgr_util_hdl_tbl *hdl_tbl;
+static struct cam_req_mgr_util_hdl_tbl __rcu *hdl_tbl;
 static DEFINE_SPINLOCK(hdl_tbl_lock);
 
+/* Table pointer for writers, must be called with hdl_tbl_lock held */
+static inline struct cam_req_mgr_util_hdl_tbl *cam_hdl_tbl_locked(void)
+{
+	return rcu_dereference_protected(hdl_tbl,
+		lockdep_is_held(&hdl_tbl_lock));
+}
+
+/**
+ * cam_hdl_tbl_read() - lockless snapshot of a handle row
+ * @dev_hdl: handle whose row is read
+ * @entry: snapshot of the row, valid when 0 is returned
+ *
+ * Returns -ENODEV if the table is gone, -EINVAL for an out of range index.
+ */
+static int cam_hdl_tbl_read(int32_t dev_hdl, struct handle *entry)
+{
+	struct cam_req_mgr_util_hdl_tbl *tbl;
+	struct handle *hdl;
+	unsigned int seq;
+	int idx;
+
+	idx = CAM_REQ_MGR_GET_HDL_IDX(dev_hdl);
+	if (idx < 0 || idx >= CAM_REQ_MGR_MAX_HANDLES_V2)
+		return -EINVAL;
+
+	rcu_read_lock();
+	tbl = rcu_dereference(hdl_tbl);
+	if (!tbl) {
+		rcu_read_unlock();
+		return -ENODEV;
+	}
+
+	hdl = &tbl->hdl[idx];
+	do {
+		seq = read_seqcount_begin(&hdl->seq);
+		entry->session_hdl = hdl->session_hdl;
+		entry->hdl_value = hdl->hdl_value;
+		entry->type = hdl->type;
+		entry->state = hdl->state;
+		entry->dev_id = hdl->dev_id;
+		entry->ops = hdl->ops;
+		entry->priv = hdl->priv;
+	} while (read_seqcount_retry(&hdl->seq, seq));
+	rcu_read_unlock();
+
+	return 0;
+}
+
 int cam_req_mgr_util_init(void)
 {
-	int rc = 0;
-	int bitmap_size;
+	int i, rc = 0;
 	static struct cam_req_mgr_util_hdl_tbl *hdl_tbl_local;
 
-	if (hdl_tbl) {
+	if (rcu_access_pointer(hdl_tbl)) {
 		rc = -EINVAL;
 		CAM_ERR(CAM_CRM, "Hdl_tbl is already present");
 		goto hdl_tbl_check_failed;
 	}
 
-	hdl_tbl_local = kzalloc(sizeof(*hdl_tbl), GFP_KERNEL);
+	hdl_tbl_local = kzalloc(sizeof(*hdl_tbl_local), GFP_KERNEL);
 	if (!hdl_tbl_local) {
 		rc = -ENOMEM;
 		goto hdl_tbl_alloc_failed;
 	}
-	bitmap_size = BITS_TO_LONGS(CAM_REQ_MGR_MAX_HANDLES_V2) * sizeof(long);
-	hdl_tbl_local->bitmap = kzalloc(bitmap_size, GFP_KERNEL);
-	if (!hdl_tbl_local->bitmap) {
-		rc = -ENOMEM;
-		goto bitmap_alloc_fail;
+
+	for (i = 0; i < CAM_REQ_MGR_MAX_HANDLES_V2; i++) {
+		seqcount_init(&hdl_tbl_local->hdl[i].seq);
+		hdl_tbl_local->free_idx[i] = i;
 	}
-	hdl_tbl_local->bits = bitmap_size * BITS_PER_BYTE;
+	hdl_tbl_local->free_head = 0;
+	hdl_tbl_local->free_cnt = CAM_REQ_MGR_MAX_HANDLES_V2;
 
 	spin_lock_bh(&hdl_tbl_lock);
-	if (hdl_tbl) {
+	if (cam_hdl_tbl_locked()) {
 		spin_unlock_bh(&hdl_tbl_lock);
 		rc = -EEXIST;
-		kfree(hdl_tbl_local->bitmap);
 		kfree(hdl_tbl_local);
 		goto hdl_tbl_check_failed;
 	}
-	hdl_tbl = hdl_tbl_local;
+	rcu_assign_pointer(hdl_tbl, hdl_tbl_local);
 	spin_unlock_bh(&hdl_tbl_lock);
 
 	return rc;
 
-bitmap_alloc_fail:
-	kfree(hdl_tbl_local);
-	hdl_tbl = NULL;
 hdl_tbl_alloc_failed:
 hdl_tbl_check_failed:
 	return rc;
@@ -68,104 +111,115 @@ hdl_tbl_check_failed:
 
 int cam_req_mgr_util_deinit(void)
 {
+	struct cam_req_mgr_util_hdl_tbl *tbl;
+
 	spin_lock_bh(&hdl_tbl_lock);
-	if (!hdl_tbl) {
+	tbl = cam_hdl_tbl_locked();
+	if (!tbl) {
 		CAM_ERR(CAM_CRM, "Hdl tbl is NULL");
 		spin_unlock_bh(&hdl_tbl_lock);
 		return -EINVAL;
 	}
 
-	kfree(hdl_tbl->bitmap);
-	hdl_tbl->bitmap = NULL;
-	kfree(hdl_tbl);
-	hdl_tbl = NULL;
+	RCU_INIT_POINTER(hdl_tbl, NULL);
 	spin_unlock_bh(&hdl_tbl_lock);
 
+	kfree_rcu(tbl, rcu);
+
 	return 0;
 }
 
 int cam_handle_validate(int32_t session_hdl, int32_t handle)
 {
 	int idx, rc = 0;
-
-	spin_lock_bh(&hdl_tbl_lock);
-	if (!hdl_tbl) {
-		CAM_ERR(CAM_CRM, "Hdl tbl is NULL");
-		rc = -EINVAL;
-		goto out;
-	}
+	struct handle entry;
 
 	idx = CAM_REQ_MGR_GET_HDL_IDX(handle);
-	if (idx < 0 || idx >= CAM_REQ_MGR_MAX_HANDLES_V2) {
+	rc = cam_hdl_tbl_read(handle, &entry);
+	if (rc == -ENODEV) {
+		CAM_ERR(CAM_CRM, "Hdl tbl is NULL");
+		return -EINVAL;
+	} else if (rc) {
 		CAM_ERR(CAM_CRM, "Invalid index:%d for handle: 0x%x", idx, handle);
-		rc = -EINVAL;
-		goto out;
+		return -EINVAL;
 	}
 
-	if (hdl_tbl->hdl[idx].state != HDL_ACTIVE) {
-		CAM_ERR(CAM_CRM, "Invalid state:%d", hdl_tbl->hdl[idx].state);
-		rc = -EINVAL;
-		goto out;
+	if (entry.state != HDL_ACTIVE) {
+		CAM_ERR(CAM_CRM, "Invalid state:%d", entry.state);
+		return -EINVAL;
 	}
 
-	if (hdl_tbl->hdl[idx].session_hdl != session_hdl ||
-		hdl_tbl->hdl[idx].hdl_value != handle) {
+	if (entry.session_hdl != session_hdl ||
+		entry.hdl_value != handle) {
 		CAM_ERR(CAM_CRM, "Expected session_hdl: 0x%x, Actual Session_hdl: 0x%x",
-			hdl_tbl->hdl[idx].session_hdl, session_hdl);
+			entry.session_hdl, session_hdl);
 		CAM_ERR(CAM_CRM, "Expected handle: 0x%x, Actual handle: 0x%x",
-			hdl_tbl->hdl[idx].hdl_value, handle);
-		rc = -EINVAL;
-		goto out;
+			entry.hdl_value, handle);
+		return -EINVAL;
 	}
 
-out:
-	spin_unlock_bh(&hdl_tbl_lock);
-	return rc;
+	return 0;
+}
+
+static void cam_put_free_handle_index(
+	struct cam_req_mgr_util_hdl_tbl *tbl, int idx)
+{
+	uint32_t tail;
+
+	tail = (tbl->free_head + tbl->free_cnt) % CAM_REQ_MGR_MAX_HANDLES_V2;
+	tbl->free_idx[tail] = idx;
+	tbl->free_cnt++;
 }
 
 int cam_req_mgr_util_free_hdls(void)
 {
 	int i = 0;
+	struct cam_req_mgr_util_hdl_tbl *tbl;
 
 	spin_lock_bh(&hdl_tbl_lock);
-	if (!hdl_tbl) {
+	tbl = cam_hdl_tbl_locked();
+	if (!tbl) {
 		CAM_ERR(CAM_CRM, "Hdl tbl is NULL");
 		spin_unlock_bh(&hdl_tbl_lock);
 		return -EINVAL;
 	}
 
 	for (i = 0; i < CAM_REQ_MGR_MAX_HANDLES_V2; i++) {
-		if (hdl_tbl->hdl[i].state == HDL_ACTIVE) {
+		if (tbl->hdl[i].state == HDL_ACTIVE) {
 			CAM_WARN(CAM_CRM, "Dev handle = %x session_handle = %x",
-				hdl_tbl->hdl[i].hdl_value,
-				hdl_tbl->hdl[i].session_hdl);
-			hdl_tbl->hdl[i].state = HDL_FREE;
-			clear_bit(i, hdl_tbl->bitmap);
+				tbl->hdl[i].hdl_value,
+				tbl->hdl[i].session_hdl);
+			write_seqcount_begin(&tbl->hdl[i].seq);
+			tbl->hdl[i].state = HDL_FREE;
+			write_seqcount_end(&tbl->hdl[i].seq);
 		}
+		tbl->free_idx[i] = i;
 	}
-	bitmap_zero(hdl_tbl->bitmap, CAM_REQ_MGR_MAX_HANDLES_V2);
+	tbl->free_head = 0;
+	tbl->free_cnt = CAM_REQ_MGR_MAX_HANDLES_V2;
 	spin_unlock_bh(&hdl_tbl_lock);
 
 	return 0;
 }
 
-static int32_t cam_get_free_handle_index(void)
+static int32_t cam_get_free_handle_index(
+	struct cam_req_mgr_util_hdl_tbl *tbl)
 {
 	int idx;
 
-	idx = find_first_zero_bit(hdl_tbl->bitmap, hdl_tbl->bits);
-
-	if (idx >= CAM_REQ_MGR_MAX_HANDLES_V2 || idx < 0) {
-		CAM_ERR(CAM_CRM, "No free index found idx: %d", idx);
+	if (!tbl->free_cnt) {
+		CAM_ERR(CAM_CRM, "No free index found");
 		return -ENOSR;
 	}
 
-	set_bit(idx, hdl_tbl->bitmap);
+	idx = tbl->free_idx[tbl->free_head];
+	tbl->free_head = (tbl->free_head + 1) % CAM_REQ_MGR_MAX_HANDLES_V2;
+	tbl->free_cnt--;
 
 	return idx;
 }
 
-static void cam_dump_tbl_info(void)
+static void cam_dump_tbl_info(struct cam_req_mgr_util_hdl_tbl *tbl)
 {
 	int i;
 
@@ -173,8 +227,24 @@ static void cam_dump_tbl_info(void)
 		CAM_INFO_RATE_LIMIT_CUSTOM(CAM_CRM, CAM_RATE_LIMIT_INTERVAL_5SEC,
 			CAM_REQ_MGR_MAX_HANDLES_V2,
 			"session_hdl=%x hdl_value=%x type=%d state=%d dev_id=%lld",
-			hdl_tbl->hdl[i].session_hdl, hdl_tbl->hdl[i].hdl_value,
-			hdl_tbl->hdl[i].type, hdl_tbl->hdl[i].state, hdl_tbl->hdl[i].dev_id);
+			tbl->hdl[i].session_hdl, tbl->hdl[i].hdl_value,
+			tbl->hdl[i].type, tbl->hdl[i].state, tbl->hdl[i].dev_id);
+}
+
+/* Publish a new handle row, must be called with hdl_tbl_lock held */
+static void cam_set_handle(struct handle *hdl, int32_t session_hdl,
+	int32_t handle, enum hdl_type type, uint64_t dev_id,
+	void *ops, void *priv)
+{
+	write_seqcount_begin(&hdl->seq);
+	hdl->session_hdl = session_hdl;
+	hdl->hdl_value = handle;
+	hdl->type = type;
+	hdl->state = HDL_ACTIVE;
+	hdl->priv = priv;
+	hdl->ops = ops;
+	hdl->dev_id = dev_id;
+	write_seqcount_end(&hdl->seq);
 }
 
 int32_t cam_create_session_hdl(void *priv)
@@ -182,31 +252,28 @@ int32_t cam_create_session_hdl(void *priv)
 	int idx;
 	int rand = 0;
 	int32_t handle = 0;
+	struct cam_req_mgr_util_hdl_tbl *tbl;
 
 	spin_lock_bh(&hdl_tbl_lock);
-	if (!hdl_tbl) {
+	tbl = cam_hdl_tbl_locked();
+	if (!tbl) {
 		CAM_ERR(CAM_CRM, "Hdl tbl is NULL");
 		spin_unlock_bh(&hdl_tbl_lock);
 		return -EINVAL;
 	}
 
-	idx = cam_get_free_handle_index();
+	idx = cam_get_free_handle_index(tbl);
 	if (idx < 0) {
 		CAM_ERR(CAM_CRM, "Unable to create session handle(idx = %d)", idx);
-		cam_dump_tbl_info();
+		cam_dump_tbl_info(tbl);
 		spin_unlock_bh(&hdl_tbl_lock);
 		return idx;
 	}
 
 	get_random_bytes(&rand, CAM_REQ_MGR_RND1_BYTES);
 	handle = GET_DEV_HANDLE(rand, HDL_TYPE_SESSION, idx);
-	hdl_tbl->hdl[idx].session_hdl = handle;
-	hdl_tbl->hdl[idx].hdl_value = handle;
-	hdl_tbl->hdl[idx].type = HDL_TYPE_SESSION;
-	hdl_tbl->hdl[idx].state = HDL_ACTIVE;
-	hdl_tbl->hdl[idx].priv = priv;
-	hdl_tbl->hdl[idx].ops = NULL;
-	hdl_tbl->hdl[idx].dev_id = CAM_CRM;
+	cam_set_handle(&tbl->hdl[idx], handle, handle, HDL_TYPE_SESSION,
+		CAM_CRM, NULL, priv);
 	spin_unlock_bh(&hdl_tbl_lock);
 
 	return handle;
@@ -218,38 +285,34 @@ int32_t cam_create_device_hdl(struct cam_create_dev_hdl *hdl_data)
 	int rand = 0;
 	int32_t handle;
 	bool crm_active;
+	struct cam_req_mgr_util_hdl_tbl *tbl;
 
 	crm_active = cam_req_mgr_is_open();
 	if (!crm_active) {
 		CAM_ERR(CAM_ICP, "CRM is not ACTIVE");
-		spin_unlock_bh(&hdl_tbl_lock);
 		return -EINVAL;
 	}
 
 	spin_lock_bh(&hdl_tbl_lock);
-	if (!hdl_tbl) {
+	tbl = cam_hdl_tbl_locked();
+	if (!tbl) {
 		CAM_ERR(CAM_CRM, "Hdl tbl is NULL");
 		spin_unlock_bh(&hdl_tbl_lock);
 		return -EINVAL;
 	}
 
-	idx = cam_get_free_handle_index();
+	idx = cam_get_free_handle_index(tbl);
 	if (idx < 0) {
 		CAM_ERR(CAM_CRM, "Unable to create device handle(idx= %d)", idx);
-		cam_dump_tbl_info();
+		cam_dump_tbl_info(tbl);
 		spin_unlock_bh(&hdl_tbl_lock);
 		return idx;
 	}
 
 	get_random_bytes(&rand, CAM_REQ_MGR_RND1_BYTES);
 	handle = GET_DEV_HANDLE(rand, HDL_TYPE_DEV, idx);
-	hdl_tbl->hdl[idx].session_hdl = hdl_data->session_hdl;
-	hdl_tbl->hdl[idx].hdl_value = handle;
-	hdl_tbl->hdl[idx].type = HDL_TYPE_DEV;
-	hdl_tbl->hdl[idx].state = HDL_ACTIVE;
-	hdl_tbl->hdl[idx].priv = hdl_data->priv;
-	hdl_tbl->hdl[idx].ops = hdl_data->ops;
-	hdl_tbl->hdl[idx].dev_id = hdl_data->dev_id;
+	cam_set_handle(&tbl->hdl[idx], hdl_data->session_hdl, handle,
+		HDL_TYPE_DEV, hdl_data->dev_id, hdl_data->ops, hdl_data->priv);
 	spin_unlock_bh(&hdl_tbl_lock);
 
 	pr_debug("%s: handle = 0x%x idx = %d\n", __func__, handle, idx);
@@ -261,31 +324,28 @@ int32_t cam_create_link_hdl(struct cam_create_dev_hdl *hdl_data)
 	int idx;
 	int rand = 0;
 	int32_t handle;
+	struct cam_req_mgr_util_hdl_tbl *tbl;
 
 	spin_lock_bh(&hdl_tbl_lock);
-	if (!hdl_tbl) {
+	tbl = cam_hdl_tbl_locked();
+	if (!tbl) {
 		CAM_ERR(CAM_CRM, "Hdl tbl is NULL");
 		spin_unlock_bh(&hdl_tbl_lock);
 		return -EINVAL;
 	}
 
-	idx = cam_get_free_handle_index();
+	idx = cam_get_free_handle_index(tbl);
 	if (idx < 0) {
 		CAM_ERR(CAM_CRM, "Unable to create link handle(idx = %d)", idx);
-		cam_dump_tbl_info();
+		cam_dump_tbl_info(tbl);
 		spin_unlock_bh(&hdl_tbl_lock);
 		return idx;
 	}
 
 	get_random_bytes(&rand, CAM_REQ_MGR_RND1_BYTES);
 	handle = GET_DEV_HANDLE(rand, HDL_TYPE_LINK, idx);
-	hdl_tbl->hdl[idx].session_hdl = hdl_data->session_hdl;
-	hdl_tbl->hdl[idx].hdl_value = handle;
-	hdl_tbl->hdl[idx].type = HDL_TYPE_LINK;
-	hdl_tbl->hdl[idx].state = HDL_ACTIVE;
-	hdl_tbl->hdl[idx].priv = hdl_data->priv;
-	hdl_tbl->hdl[idx].ops = NULL;
-	hdl_tbl->hdl[idx].dev_id = hdl_data->dev_id;
+	cam_set_handle(&tbl->hdl[idx], hdl_data->session_hdl, handle,
+		HDL_TYPE_LINK, hdl_data->dev_id, NULL, hdl_data->priv);
 	spin_unlock_bh(&hdl_tbl_lock);
 
 	CAM_DBG(CAM_CRM, "handle = %x", handle);
@@ -294,48 +354,39 @@ int32_t cam_create_link_hdl(struct cam_create_dev_hdl *hdl_data)
 
 void *cam_get_priv(int32_t dev_hdl, int handle_type)
 {
-	int idx;
+	int rc;
 	int type;
-	void *priv;
+	struct handle entry;
 
-	spin_lock_bh(&hdl_tbl_lock);
-	if (!hdl_tbl) {
+	rc = cam_hdl_tbl_read(dev_hdl, &entry);
+	if (rc == -ENODEV) {
 		CAM_ERR_RATE_LIMIT(CAM_CRM, "Hdl tbl is NULL");
-		goto device_priv_fail;
+		return NULL;
+	} else if (rc) {
+		CAM_ERR_RATE_LIMIT(CAM_CRM, "Invalid idx:%d",
+			CAM_REQ_MGR_GET_HDL_IDX(dev_hdl));
+		return NULL;
 	}
 
-	idx = CAM_REQ_MGR_GET_HDL_IDX(dev_hdl);
-	if (idx >= CAM_REQ_MGR_MAX_HANDLES_V2) {
-		CAM_ERR_RATE_LIMIT(CAM_CRM, "Invalid idx:%d", idx);
-		goto device_priv_fail;
-	}
-
-	if (hdl_tbl->hdl[idx].hdl_value != dev_hdl) {
+	if (entry.hdl_value != dev_hdl) {
 		CAM_ERR_RATE_LIMIT(CAM_CRM, "Invalid hdl [%d] [%d]",
-			dev_hdl, hdl_tbl->hdl[idx].hdl_value);
-		goto device_priv_fail;
+			dev_hdl, entry.hdl_value);
+		return NULL;
 	}
 
-	if (hdl_tbl->hdl[idx].state != HDL_ACTIVE) {
+	if (entry.state != HDL_ACTIVE) {
 		CAM_ERR_RATE_LIMIT(CAM_CRM, "Invalid state:%d",
-			hdl_tbl->hdl[idx].state);
-		goto device_priv_fail;
+			entry.state);
+		return NULL;
 	}
 
 	type = CAM_REQ_MGR_GET_HDL_TYPE(dev_hdl);
 	if (type != handle_type) {
 		CAM_ERR_RATE_LIMIT(CAM_CRM, "Invalid type:%d", type);
-		goto device_priv_fail;
+		return NULL;
 	}
 
-	priv = hdl_tbl->hdl[idx].priv;
-	spin_unlock_bh(&hdl_tbl_lock);
-
-	return priv;
-
-device_priv_fail:
-	spin_unlock_bh(&hdl_tbl_lock);
-	return NULL;
+	return entry.priv;
 }
 
 void *cam_get_device_priv(int32_t dev_hdl)
@@ -368,55 +419,48 @@ struct cam_req_mgr_core_link *cam_get_link_priv(int32_t dev_hdl)
 
 void *cam_get_device_ops(int32_t dev_hdl)
 {
-	int idx;
+	int rc;
 	int type;
-	void *ops;
+	struct handle entry;
 
-	spin_lock_bh(&hdl_tbl_lock);
-	if (!hdl_tbl) {
+	rc = cam_hdl_tbl_read(dev_hdl, &entry);
+	if (rc == -ENODEV) {
 		CAM_ERR(CAM_CRM, "Hdl tbl is NULL");
-		goto device_ops_fail;
-	}
-
-	idx = CAM_REQ_MGR_GET_HDL_IDX(dev_hdl);
-	if (idx >= CAM_REQ_MGR_MAX_HANDLES_V2) {
+		return NULL;
+	} else if (rc) {
 		CAM_ERR(CAM_CRM, "Invalid idx");
-		goto device_ops_fail;
+		return NULL;
 	}
 
-	if (hdl_tbl->hdl[idx].state != HDL_ACTIVE) {
+	if (entry.state != HDL_ACTIVE) {
 		CAM_ERR(CAM_CRM, "Invalid state");
-		goto device_ops_fail;
+		return NULL;
 	}
 
 	type = CAM_REQ_MGR_GET_HDL_TYPE(dev_hdl);
 	if (HDL_TYPE_DEV != type && HDL_TYPE_SESSION != type && HDL_TYPE_LINK != type) {
 		CAM_ERR(CAM_CRM, "Invalid type");
-		goto device_ops_fail;
+		return NULL;
 	}
 
-	if (hdl_tbl->hdl[idx].hdl_value != dev_hdl) {
+	if (entry.hdl_value != dev_hdl) {
 		CAM_ERR(CAM_CRM, "Invalid hdl");
-		goto device_ops_fail;
+		return NULL;
 	}
 
-	ops = hdl_tbl->hdl[idx].ops;
-	spin_unlock_bh(&hdl_tbl_lock);
-
-	return ops;
-
-device_ops_fail:
-	spin_unlock_bh(&hdl_tbl_lock);
-	return NULL;
+	return entry.ops;
 }
 
 static int cam_destroy_hdl(int32_t dev_hdl, int dev_hdl_type)
 {
 	int idx;
 	int type;
+	struct cam_req_mgr_util_hdl_tbl *tbl;
+	struct handle *hdl;
 
 	spin_lock_bh(&hdl_tbl_lock);
-	if (!hdl_tbl) {
+	tbl = cam_hdl_tbl_locked();
+	if (!tbl) {
 		CAM_ERR(CAM_CRM, "Hdl tbl is NULL");
 		goto destroy_hdl_fail;
 	}
@@ -427,7 +471,8 @@ static int cam_destroy_hdl(int32_t dev_hdl, int dev_hdl_type)
 		goto destroy_hdl_fail;
 	}
 
-	if (hdl_tbl->hdl[idx].state != HDL_ACTIVE) {
+	hdl = &tbl->hdl[idx];
+	if (hdl->state != HDL_ACTIVE) {
 		CAM_ERR(CAM_CRM, "Invalid state");
 		goto destroy_hdl_fail;
 	}
@@ -438,15 +483,17 @@ static int cam_destroy_hdl(int32_t dev_hdl, int dev_hdl_type)
 		goto destroy_hdl_fail;
 	}
 
-	if (hdl_tbl->hdl[idx].hdl_value != dev_hdl) {
+	if (hdl->hdl_value != dev_hdl) {
 		CAM_ERR(CAM_CRM, "Invalid hdl");
 		goto destroy_hdl_fail;
 	}
 
-	hdl_tbl->hdl[idx].state = HDL_FREE;
-	hdl_tbl->hdl[idx].ops   = NULL;
-	hdl_tbl->hdl[idx].priv  = NULL;
-	clear_bit(idx, hdl_tbl->bitmap);
+	write_seqcount_begin(&hdl->seq);
+	hdl->state = HDL_FREE;
+	hdl->ops   = NULL;
+	hdl->priv  = NULL;
+	write_seqcount_end(&hdl->seq);
+	cam_put_free_handle_index(tbl, idx);
 	spin_unlock_bh(&hdl_tbl_lock);
 
 	return 0;
@@ -7,6 +7,8 @@
 #ifndef _CAM_REQ_MGR_UTIL_API_H_
 #define _CAM_REQ_MGR_UTIL_API_H_
 
+#include <linux/seqlock.h>
+#include <linux/rcupdate.h>
 #include <media/cam_req_mgr.h>
 #include "cam_req_mgr_util_priv.h"
 
@@ -41,6 +43,7 @@ enum hdl_type {
  * @dev_id: device id for handle
  * @ops: ops structure
  * @priv: private data of a handle
+ * @seq: sequence count guarding lockless reads of this entry
  */
 struct handle {
 	int32_t session_hdl;
@@ -50,18 +53,27 @@ struct handle {
 	uint64_t dev_id;
 	void *ops;
 	void *priv;
+	seqcount_t seq;
 };
 
 /**
  * struct cam_req_mgr_util_hdl_tbl
  * @hdl: row of handles
- * @bitmap: bit map to get free hdl row idx
- * @bits: size of bit map in bits
+ * @free_idx: FIFO of free hdl row indices, oldest freed row is reused first
+ * @free_head: position of the next index to hand out in free_idx
+ * @free_cnt: number of free rows queued in free_idx
+ * @rcu: rcu head used to free the table once all readers are done
+ *
+ * Handle creation and destruction are serialized by the table spinlock.
+ * Lookups are lockless: the table pointer is RCU protected and each row
+ * is read under its sequence count.
  */
 struct cam_req_mgr_util_hdl_tbl {
 	struct handle hdl[CAM_REQ_MGR_MAX_HANDLES_V2];
-	void *bitmap;
-	size_t bits;
+	uint32_t free_idx[CAM_REQ_MGR_MAX_HANDLES_V2];
+	uint32_t free_head;
+	uint32_t free_cnt;
+	struct rcu_head rcu;
 };
 
 /**
@@ -7,6 +7,7 @@
 #include "cam_req_mgr_workq.h"
 #include "cam_debug_util.h"
 #include "cam_common_util.h"
+#include "cam_req_mgr_debug.h"
 
 #define WORKQ_ACQUIRE_LOCK(workq, flags) {\
 	if ((workq)->in_irq) \
@@ -121,6 +122,8 @@ void cam_req_mgr_process_workq(struct work_struct *w)
 		"CRM workq schedule",
 		workq->workq_scheduled_ts,
 		CAM_WORKQ_SCHEDULE_TIME_THRESHOLD);
+	cam_req_mgr_debug_lat_record(CAM_REQ_MGR_LAT_WORKQ_SCHED,
+		CAM_REQ_MGR_LAT_INST_MAX, workq->workq_scheduled_ts);
 	sched_start_time = ktime_get();
 	while (i < CRM_TASK_PRIORITY_MAX) {
 		WORKQ_ACQUIRE_LOCK(workq, flags);
@@ -143,6 +146,8 @@ void cam_req_mgr_process_workq(struct work_struct *w)
 		"CRM workq execution",
 		sched_start_time,
 		CAM_WORKQ_EXE_TIME_THRESHOLD);
+	cam_req_mgr_debug_lat_record(CAM_REQ_MGR_LAT_WORKQ_EXEC,
+		CAM_REQ_MGR_LAT_INST_MAX, sched_start_time);
 }
 
 int cam_req_mgr_workq_enqueue_task(struct crm_workq_task *task,
@@ -302,3 +307,7 @@ void cam_req_mgr_workq_destroy(struct cam_req_mgr_core_workq **crm_workq)
 		*crm_workq = NULL;
 	}
 }
+
+#ifdef CONFIG_SPECTRA_KUNIT_TEST
+#include "cam_req_mgr_workq_test.c"
+#endif
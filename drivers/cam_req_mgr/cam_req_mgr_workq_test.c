@@ -0,0 +1,203 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ */
+
+/*
+ * KUnit tests for the CRM workq, built into cam_req_mgr_workq.c. Tasks run
+ * on a real serial workqueue, the test thread waits on completions.
+ */
+
+#include <linux/completion.h>
+
+#include "cam_kunit.h"
+
+#define CAM_WORKQ_TEST_NUM_TASKS       32
+#define CAM_WORKQ_TEST_ORDER_TASKS     16
+#define CAM_WORKQ_TEST_BENCH_ITER      2000
+#define CAM_WORKQ_TEST_TIMEOUT         msecs_to_jiffies(1000)
+
+struct cam_workq_test_ctx {
+	struct cam_req_mgr_core_workq  *workq;
+	struct completion               gate;
+	struct completion               done;
+	struct cam_kunit_bench          bench;
+	ktime_t                         enqueue_ts;
+	int                             order[CAM_WORKQ_TEST_ORDER_TASKS];
+	int                             num_run;
+	int                             wait_for;
+};
+
+struct cam_workq_test_task {
+	struct cam_workq_test_ctx      *ctx;
+	int                             id;
+};
+
+static int32_t cam_workq_test_run(void *priv, void *data)
+{
+	struct cam_workq_test_task *task = priv;
+	struct cam_workq_test_ctx *ctx = task->ctx;
+
+	if (task->id < 0) {
+		wait_for_completion_timeout(&ctx->gate,
+			CAM_WORKQ_TEST_TIMEOUT);
+		return 0;
+	}
+
+	if (ctx->num_run < CAM_WORKQ_TEST_ORDER_TASKS)
+		ctx->order[ctx->num_run] = task->id;
+	if (++ctx->num_run == ctx->wait_for)
+		complete(&ctx->done);
+
+	return 0;
+}
+
+static int32_t cam_workq_test_bench_run(void *priv, void *data)
+{
+	struct cam_workq_test_ctx *ctx = priv;
+
+	cam_kunit_bench_add(&ctx->bench, ctx->enqueue_ts);
+	complete(&ctx->done);
+
+	return 0;
+}
+
+static int cam_workq_test_enqueue(struct cam_workq_test_ctx *ctx,
+	int32_t (*cb)(void *priv, void *data), void *priv, int32_t prio)
+{
+	struct crm_workq_task *task;
+
+	task = cam_req_mgr_workq_get_task(ctx->workq);
+	if (!task)
+		return -EBUSY;
+
+	task->process_cb = cb;
+
+	return cam_req_mgr_workq_enqueue_task(task, priv, prio);
+}
+
+static int cam_workq_test_init(struct kunit *test)
+{
+	struct cam_workq_test_ctx *ctx;
+	int rc;
+
+	ctx = kunit_kzalloc(test, sizeof(*ctx), GFP_KERNEL);
+	if (!ctx)
+		return -ENOMEM;
+
+	rc = cam_req_mgr_workq_create("kunit", CAM_WORKQ_TEST_NUM_TASKS,
+		&ctx->workq, CRM_WORKQ_USAGE_NON_IRQ,
+		CAM_WORKQ_FLAG_HIGH_PRIORITY | CAM_WORKQ_FLAG_SERIAL,
+		cam_req_mgr_process_workq);
+	if (rc)
+		return rc;
+
+	init_completion(&ctx->gate);
+	init_completion(&ctx->done);
+	test->priv = ctx;
+
+	return 0;
+}
+
+static void cam_workq_test_exit(struct kunit *test)
+{
+	struct cam_workq_test_ctx *ctx = test->priv;
+
+	if (!ctx)
+		return;
+
+	complete_all(&ctx->gate);
+	cam_req_mgr_workq_destroy(&ctx->workq);
+}
+
+static void cam_workq_test_fifo(struct kunit *test)
+{
+	struct cam_workq_test_ctx *ctx = test->priv;
+	struct cam_workq_test_task *tasks;
+	int i;
+
+	tasks = kunit_kcalloc(test, CAM_WORKQ_TEST_ORDER_TASKS,
+		sizeof(*tasks), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, tasks);
+
+	ctx->wait_for = CAM_WORKQ_TEST_ORDER_TASKS;
+	for (i = 0; i < CAM_WORKQ_TEST_ORDER_TASKS; i++) {
+		tasks[i].ctx = ctx;
+		tasks[i].id = i;
+		KUNIT_ASSERT_EQ(test, cam_workq_test_enqueue(ctx,
+			cam_workq_test_run, &tasks[i], CRM_TASK_PRIORITY_0), 0);
+	}
+
+	KUNIT_ASSERT_NE(test, wait_for_completion_timeout(&ctx->done,
+		CAM_WORKQ_TEST_TIMEOUT), 0UL);
+	for (i = 0; i < CAM_WORKQ_TEST_ORDER_TASKS; i++)
+		KUNIT_EXPECT_EQ(test, ctx->order[i], i);
+}
+
+static void cam_workq_test_priority(struct kunit *test)
+{
+	struct cam_workq_test_ctx *ctx = test->priv;
+	struct cam_workq_test_task *blocker, *low, *high;
+
+	/* Tasks may outlive an aborted test case until the workq is gone */
+	blocker = kunit_kcalloc(test, 3, sizeof(*blocker), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, blocker);
+	low = &blocker[1];
+	high = &blocker[2];
+
+	blocker->ctx = low->ctx = high->ctx = ctx;
+	blocker->id = -1;
+	low->id = 1;
+	high->id = 0;
+	ctx->wait_for = 2;
+
+	/* Hold the worker so both tasks are pending when it moves on */
+	KUNIT_ASSERT_EQ(test, cam_workq_test_enqueue(ctx, cam_workq_test_run,
+		blocker, CRM_TASK_PRIORITY_0), 0);
+	KUNIT_ASSERT_EQ(test, cam_workq_test_enqueue(ctx, cam_workq_test_run,
+		low, CRM_TASK_PRIORITY_1), 0);
+	KUNIT_ASSERT_EQ(test, cam_workq_test_enqueue(ctx, cam_workq_test_run,
+		high, CRM_TASK_PRIORITY_0), 0);
+	complete(&ctx->gate);
+
+	KUNIT_ASSERT_NE(test, wait_for_completion_timeout(&ctx->done,
+		CAM_WORKQ_TEST_TIMEOUT), 0UL);
+	KUNIT_EXPECT_EQ(test, ctx->order[0], 0);
+	KUNIT_EXPECT_EQ(test, ctx->order[1], 1);
+}
+
+static void cam_workq_test_bench_latency(struct kunit *test)
+{
+	struct cam_workq_test_ctx *ctx = test->priv;
+	int i;
+
+	KUNIT_ASSERT_EQ(test, cam_kunit_bench_init(test, &ctx->bench,
+		"workq_enqueue_to_exec", CAM_WORKQ_TEST_BENCH_ITER), 0);
+
+	for (i = 0; i < CAM_WORKQ_TEST_BENCH_ITER; i++) {
+		reinit_completion(&ctx->done);
+		ctx->enqueue_ts = ktime_get();
+		KUNIT_ASSERT_EQ(test, cam_workq_test_enqueue(ctx,
+			cam_workq_test_bench_run, ctx, CRM_TASK_PRIORITY_0), 0);
+		KUNIT_ASSERT_NE(test, wait_for_completion_timeout(&ctx->done,
+			CAM_WORKQ_TEST_TIMEOUT), 0UL);
+	}
+
+	KUNIT_EXPECT_EQ(test, ctx->bench.num,
+		(uint32_t)CAM_WORKQ_TEST_BENCH_ITER);
+	cam_kunit_bench_report(test, &ctx->bench);
+}
+
+static struct kunit_case cam_req_mgr_workq_test_cases[] = {
+	KUNIT_CASE(cam_workq_test_fifo),
+	KUNIT_CASE(cam_workq_test_priority),
+	KUNIT_CASE(cam_workq_test_bench_latency),
+	{}
+};
+
+struct kunit_suite cam_req_mgr_workq_test_suite = {
+	.name = "cam_req_mgr_workq",
+	.init = cam_workq_test_init,
+	.exit = cam_workq_test_exit,
+	.test_cases = cam_req_mgr_workq_test_cases,
+};
@@ -939,18 +939,147 @@ static int cam_csiphy_cphy_get_data_rate_lane_idx(
 	return rc;
 }
 
+static void cam_csiphy_cfg_seq_add(struct csiphy_cfg_cache_entry *entry,
+	bool write, uint32_t reg_addr, uint32_t reg_data, int32_t delay)
+{
+	struct csiphy_cfg_seq_reg *seq_reg;
+
+	if (entry->direct_base) {
+		if (write)
+			cam_io_w_mb(reg_data, entry->direct_base + reg_addr);
+		if (delay > 0)
+			usleep_range(delay, delay + 5);
+		return;
+	}
+
+	if (!write) {
+		/* Settle delay of a skipped write still applies */
+		if ((delay > 0) && entry->num_seq)
+			entry->seq[entry->num_seq - 1].delay += delay;
+		return;
+	}
+
+	/* An incomplete sequence is never replayed, see config_dev */
+	if (entry->num_seq >= entry->max_seq) {
+		entry->overflow = true;
+		return;
+	}
+
+	seq_reg = &entry->seq[entry->num_seq++];
+	seq_reg->reg_addr = reg_addr;
+	seq_reg->reg_data = reg_data;
+	seq_reg->delay = (delay > 0) ? delay : 0;
+}
+
+static void cam_csiphy_cfg_seq_replay(void __iomem *csiphybase,
+	struct csiphy_cfg_cache_entry *entry)
+{
+	struct csiphy_cfg_seq_reg *seq_reg;
+	uint32_t i;
+
+	/*
+	 * Writes to the phy are ordered among themselves, a barrier is only
+	 * needed ahead of a settle delay and at the end of the sequence.
+	 */
+	for (i = 0; i < entry->num_seq; i++) {
+		seq_reg = &entry->seq[i];
+		if (!seq_reg->delay && (i < (entry->num_seq - 1))) {
+			cam_io_w(seq_reg->reg_data,
+				csiphybase + seq_reg->reg_addr);
+			continue;
+		}
+
+		cam_io_w_mb(seq_reg->reg_data, csiphybase + seq_reg->reg_addr);
+		if (seq_reg->delay)
+			usleep_range(seq_reg->delay, seq_reg->delay + 5);
+	}
+}
+
+static void cam_csiphy_cfg_cache_release(struct csiphy_cfg_cache_entry *entry)
+{
+	kfree(entry->seq);
+	memset(entry, 0, sizeof(*entry));
+}
+
+void cam_csiphy_cfg_cache_flush(struct csiphy_device *csiphy_dev)
+{
+	int i;
+
+	for (i = 0; i < CSIPHY_CFG_CACHE_ENTRIES; i++)
+		cam_csiphy_cfg_cache_release(&csiphy_dev->cfg_cache[i]);
+}
+
+static void cam_csiphy_cfg_cache_key_fill(struct csiphy_device *csiphy_dev,
+	int32_t index, bool is_3phase, struct csiphy_cfg_cache_key *key)
+{
+	struct cam_csiphy_param *param = &csiphy_dev->csiphy_info[index];
+
+	memset(key, 0, sizeof(*key));
+	key->data_rate = param->data_rate;
+	key->settle_time = param->settle_time;
+	key->aux_mask =
+		g_phy_data[csiphy_dev->soc_info.index].data_rate_aux_mask;
+	key->lane_enable = param->lane_enable;
+	key->lane_assign = param->lane_assign;
+	key->mipi_flags = param->mipi_flags;
+	key->lane_cnt = param->lane_cnt;
+	key->is_3phase = is_3phase;
+	key->combo_mode = csiphy_dev->combo_mode;
+	key->cphy_dphy_combo_mode = csiphy_dev->cphy_dphy_combo_mode;
+}
+
+static struct csiphy_cfg_cache_entry *cam_csiphy_cfg_cache_lookup(
+	struct csiphy_device *csiphy_dev, struct csiphy_cfg_cache_key *key)
+{
+	struct csiphy_cfg_cache_entry *entry;
+	int i;
+
+	if (csiphy_dev->disable_cfg_cache)
+		return NULL;
+
+	for (i = 0; i < CSIPHY_CFG_CACHE_ENTRIES; i++) {
+		entry = &csiphy_dev->cfg_cache[i];
+		if (entry->valid && !memcmp(&entry->key, key, sizeof(*key))) {
+			entry->last_used = ++csiphy_dev->cfg_cache_use_cnt;
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+static struct csiphy_cfg_cache_entry *cam_csiphy_cfg_cache_victim(
+	struct csiphy_device *csiphy_dev)
+{
+	struct csiphy_cfg_cache_entry *entry, *victim = NULL;
+	int i;
+
+	for (i = 0; i < CSIPHY_CFG_CACHE_ENTRIES; i++) {
+		entry = &csiphy_dev->cfg_cache[i];
+		if (!entry->valid) {
+			victim = entry;
+			break;
+		}
+
+		if (!victim || (entry->last_used < victim->last_used))
+			victim = entry;
+	}
+
+	cam_csiphy_cfg_cache_release(victim);
+	return victim;
+}
+
 static int cam_csiphy_cphy_data_rate_config(
-	struct csiphy_device *csiphy_device, int32_t idx)
+	struct csiphy_device *csiphy_device, int32_t idx,
+	struct csiphy_cfg_cache_entry *entry)
 {
 	int i = 0;
 	int lane_idx = -1;
 	uint8_t data_rate_idx;
 	uint64_t required_phy_data_rate = 0;
-	void __iomem *csiphybase = NULL;
 	uint8_t num_data_rates = 0;
 	struct data_rate_settings_t *settings_table = NULL;
 	struct csiphy_cphy_per_lane_info *per_lane = NULL;
-	uint32_t lane_enable = 0;
 	uint8_t lane_cnt = 0;
 	uint16_t lane_assign = 0;
 	uint64_t intermediate_var = 0;
@@ -971,7 +1100,6 @@ static int cam_csiphy_cphy_data_rate_config(
 	}
 
 	required_phy_data_rate = csiphy_device->csiphy_info[idx].data_rate;
-	csiphybase = csiphy_device->soc_info.reg_map[0].mem_base;
 	settings_table = csiphy_device->ctrl_reg->data_rates_settings_table;
 	num_data_rates = settings_table->num_data_rate_settings;
 	lane_cnt = csiphy_device->csiphy_info[idx].lane_cnt;
@@ -997,7 +1125,6 @@ static int cam_csiphy_cphy_data_rate_config(
 
 		CAM_DBG(CAM_CSIPHY, "table[%d] BW : %llu Selected",
 			data_rate_idx, supported_phy_bw);
-		lane_enable = csiphy_device->csiphy_info[idx].lane_enable;
 		lane_assign = csiphy_device->csiphy_info[idx].lane_assign;
 		lane_idx = -1;
 
@@ -1027,41 +1154,46 @@ static int cam_csiphy_cphy_data_rate_config(
 
 				switch (reg_param_type) {
 				case CSIPHY_DEFAULT_PARAMS:
-					cam_io_w_mb(reg_data, csiphybase + reg_addr);
+					cam_csiphy_cfg_seq_add(entry, true,
+						reg_addr, reg_data, delay);
 				break;
 				case CSIPHY_SETTLE_CNT_LOWER_BYTE:
-					cam_io_w_mb(settle_cnt & 0xFF, csiphybase + reg_addr);
+					cam_csiphy_cfg_seq_add(entry, true,
+						reg_addr, settle_cnt & 0xFF, delay);
 				break;
 				case CSIPHY_SETTLE_CNT_HIGHER_BYTE:
-					cam_io_w_mb((settle_cnt >> 8) & 0xFF,
-						csiphybase + reg_addr);
+					cam_csiphy_cfg_seq_add(entry, true,
+						reg_addr, (settle_cnt >> 8) & 0xFF,
+						delay);
 				break;
 				case CSIPHY_SKEW_CAL:
-				if (skew_cal_enable)
-					cam_io_w_mb(reg_data, csiphybase + reg_addr);
+					cam_csiphy_cfg_seq_add(entry,
+						skew_cal_enable, reg_addr,
+						reg_data, delay);
 				break;
 				case CSIPHY_AUXILIARY_SETTING: {
 					uint32_t phy_idx = csiphy_device->soc_info.index;
+					bool aux_en = !!(g_phy_data[phy_idx].data_rate_aux_mask &
+						BIT_ULL(data_rate_idx));
 
-					if (g_phy_data[phy_idx].data_rate_aux_mask &
-						BIT_ULL(data_rate_idx)) {
-						cam_io_w_mb(reg_data, csiphybase + reg_addr);
+					if (aux_en)
 						CAM_DBG(CAM_CSIPHY,
 							"Writing new aux setting  reg_addr: 0x%x reg_val: 0x%x",
 							reg_addr, reg_data);
-					}
+					cam_csiphy_cfg_seq_add(entry, aux_en,
+						reg_addr, reg_data, delay);
 				}
 				break;
 				default:
 					CAM_DBG(CAM_CSIPHY, "Do Nothing");
+					cam_csiphy_cfg_seq_add(entry, false,
+						reg_addr, reg_data, delay);
 				break;
 				}
-				if (delay > 0)
-					usleep_range(delay, delay + 5);
 			}
 		}
 
-		csiphy_device->curr_data_rate_idx = data_rate_idx;
+		entry->data_rate_idx = data_rate_idx;
 		break;
 	}
 
@@ -1100,25 +1232,131 @@ static int __cam_csiphy_prgm_bist_reg(struct csiphy_device *csiphy_dev, bool is_
 	return 0;
 }
 
+/*
+ * Resolve the common, CPHY data rate and per lane tables of a stream on into
+ * entry. An entry with a direct_base gets the registers written right away.
+ */
+static int cam_csiphy_cfg_seq_resolve(struct csiphy_device *csiphy_dev,
+	int32_t index, bool is_3phase,
+	struct csiphy_reg_t (*reg_array)[MAX_SETTINGS_PER_LANE],
+	uint16_t cfg_size, int max_lanes,
+	struct csiphy_cfg_cache_entry *entry)
+{
+	int32_t              rc = 0;
+	uint32_t             lane_enable;
+	uint32_t             size;
+	uint16_t             i = 0;
+	uint16_t             settle_cnt = 0;
+	uint8_t              skew_cal_enable = 0;
+	uint64_t             intermediate_var;
+	uint8_t              lane_pos = 0;
+	struct csiphy_reg_t *csiphy_common_reg = NULL;
+	uint32_t             reg_addr, reg_data;
+	int32_t              delay;
+
+	lane_enable = csiphy_dev->csiphy_info[index].lane_enable;
+	size = csiphy_dev->ctrl_reg->csiphy_reg.csiphy_common_array_size;
+
+	for (i = 0; i < size; i++) {
+		csiphy_common_reg = &csiphy_dev->ctrl_reg->csiphy_common_reg[i];
+		reg_addr = csiphy_common_reg->reg_addr;
+		reg_data = csiphy_common_reg->reg_data;
+		delay = csiphy_common_reg->delay;
+		switch (csiphy_common_reg->csiphy_param_type) {
+		case CSIPHY_LANE_ENABLE:
+			CAM_DBG(CAM_CSIPHY, "LANE_ENABLE: 0x%x", lane_enable);
+			cam_csiphy_cfg_seq_add(entry, true, reg_addr,
+				lane_enable, delay);
+			break;
+		case CSIPHY_DEFAULT_PARAMS:
+			cam_csiphy_cfg_seq_add(entry, true, reg_addr,
+				reg_data, delay);
+			break;
+		case CSIPHY_2PH_REGS:
+			cam_csiphy_cfg_seq_add(entry, !is_3phase, reg_addr,
+				reg_data, delay);
+			break;
+		case CSIPHY_3PH_REGS:
+			cam_csiphy_cfg_seq_add(entry, is_3phase, reg_addr,
+				reg_data, delay);
+			break;
+		default:
+			cam_csiphy_cfg_seq_add(entry, false, reg_addr,
+				reg_data, delay);
+			break;
+		}
+	}
+
+	if (csiphy_dev->csiphy_info[index].csiphy_3phase) {
+		rc = cam_csiphy_cphy_data_rate_config(csiphy_dev, index, entry);
+		if (rc) {
+			CAM_ERR(CAM_CSIPHY,
+				"Date rate specific configuration failed rc: %d",
+				rc);
+			return rc;
+		}
+	}
+
+	intermediate_var = csiphy_dev->csiphy_info[index].settle_time;
+	do_div(intermediate_var, 200000000);
+	settle_cnt = intermediate_var;
+	skew_cal_enable = csiphy_dev->csiphy_info[index].mipi_flags;
+
+	for (lane_pos = 0; lane_pos < max_lanes; lane_pos++) {
+		CAM_DBG(CAM_CSIPHY, "lane_pos: %d is configuring", lane_pos);
+		for (i = 0; i < cfg_size; i++) {
+			reg_addr = reg_array[lane_pos][i].reg_addr;
+			reg_data = reg_array[lane_pos][i].reg_data;
+			delay = reg_array[lane_pos][i].delay;
+			switch (reg_array[lane_pos][i].csiphy_param_type) {
+			case CSIPHY_LANE_ENABLE:
+				cam_csiphy_cfg_seq_add(entry, true, reg_addr,
+					lane_enable, delay);
+			break;
+			case CSIPHY_DEFAULT_PARAMS:
+				cam_csiphy_cfg_seq_add(entry, true, reg_addr,
+					reg_data, delay);
+			break;
+			case CSIPHY_SETTLE_CNT_LOWER_BYTE:
+				cam_csiphy_cfg_seq_add(entry, true, reg_addr,
+					settle_cnt & 0xFF, delay);
+			break;
+			case CSIPHY_SETTLE_CNT_HIGHER_BYTE:
+				cam_csiphy_cfg_seq_add(entry, true, reg_addr,
+					(settle_cnt >> 8) & 0xFF, delay);
+			break;
+			case CSIPHY_SKEW_CAL:
+				cam_csiphy_cfg_seq_add(entry, skew_cal_enable,
+					reg_addr, reg_data, delay);
+			break;
+			default:
+				CAM_DBG(CAM_CSIPHY, "Do Nothing");
+				cam_csiphy_cfg_seq_add(entry, false, reg_addr,
+					reg_data, delay);
+			break;
+			}
+		}
+	}
+
+	return 0;
+}
+
 int32_t cam_csiphy_config_dev(struct csiphy_device *csiphy_dev,
 	int32_t dev_handle)
 {
 	int32_t      rc = 0;
-	uint32_t     lane_enable = 0;
 	uint32_t     size = 0;
-	uint16_t     i = 0, cfg_size = 0;
+	uint16_t     cfg_size = 0;
 	uint16_t     lane_assign = 0;
 	uint8_t      lane_cnt;
 	int          max_lanes = 0;
-	uint16_t     settle_cnt = 0;
-	uint8_t      skew_cal_enable = 0;
-	uint64_t     intermediate_var;
-	uint8_t      lane_pos = 0;
 	int          index;
 	void __iomem *csiphybase;
-	struct csiphy_reg_t *csiphy_common_reg = NULL;
 	struct csiphy_reg_t (*reg_array)[MAX_SETTINGS_PER_LANE];
 	bool         is_3phase = false;
+	struct csiphy_cfg_cache_key    key;
+	struct csiphy_cfg_cache_entry  tmp_entry;
+	struct csiphy_cfg_cache_entry *entry;
 	csiphybase = csiphy_dev->soc_info.reg_map[0].mem_base;
 
 	CAM_DBG(CAM_CSIPHY, "ENTER");
@@ -1210,99 +1448,67 @@ int32_t cam_csiphy_config_dev(struct csiphy_device *csiphy_dev,
 
 	lane_cnt = csiphy_dev->csiphy_info[index].lane_cnt;
 	lane_assign = csiphy_dev->csiphy_info[index].lane_assign;
-	lane_enable = csiphy_dev->csiphy_info[index].lane_enable;
+
+	cam_csiphy_cfg_cache_key_fill(csiphy_dev, index, is_3phase, &key);
+	entry = cam_csiphy_cfg_cache_lookup(csiphy_dev, &key);
+	if (entry) {
+		CAM_DBG(CAM_CSIPHY, "Replaying cached config, %u regs",
+			entry->num_seq);
+		goto replay;
+	}
+
+	entry = csiphy_dev->disable_cfg_cache ? &tmp_entry :
+		cam_csiphy_cfg_cache_victim(csiphy_dev);
+	memset(entry, 0, sizeof(*entry));
+	entry->key = key;
+	entry->data_rate_idx = -1;
 
 	size = csiphy_dev->ctrl_reg->csiphy_reg.csiphy_common_array_size;
-	for (i = 0; i < size; i++) {
-		csiphy_common_reg = &csiphy_dev->ctrl_reg->csiphy_common_reg[i];
-		switch (csiphy_common_reg->csiphy_param_type) {
-		case CSIPHY_LANE_ENABLE:
-			CAM_DBG(CAM_CSIPHY, "LANE_ENABLE: 0x%x", lane_enable);
-			cam_io_w_mb(lane_enable,
-				csiphybase + csiphy_common_reg->reg_addr);
-			break;
-		case CSIPHY_DEFAULT_PARAMS:
-			cam_io_w_mb(csiphy_common_reg->reg_data,
-				csiphybase + csiphy_common_reg->reg_addr);
-			break;
-		case CSIPHY_2PH_REGS:
-			if (!is_3phase) {
-				cam_io_w_mb(csiphy_common_reg->reg_data,
-					csiphybase +
-					csiphy_common_reg->reg_addr);
-			}
-			break;
-		case CSIPHY_3PH_REGS:
-			if (is_3phase) {
-				cam_io_w_mb(csiphy_common_reg->reg_data,
-					csiphybase +
-					csiphy_common_reg->reg_addr);
-			}
-			break;
-		default:
-			break;
-		}
-		if (csiphy_common_reg->delay > 0)
-			usleep_range(csiphy_common_reg->delay,
-				csiphy_common_reg->delay + 5);
+	entry->max_seq = size + (max_lanes * cfg_size);
+	if (is_3phase)
+		entry->max_seq += lane_cnt * MAX_DATA_RATE_REGS;
+	entry->seq = kcalloc(entry->max_seq, sizeof(*entry->seq), GFP_KERNEL);
+	if (!entry->seq) {
+		memset(entry, 0, sizeof(*entry));
+		return -ENOMEM;
 	}
 
-	if (csiphy_dev->csiphy_info[index].csiphy_3phase) {
-		rc = cam_csiphy_cphy_data_rate_config(csiphy_dev, index);
-		if (rc) {
-			CAM_ERR(CAM_CSIPHY,
-				"Date rate specific configuration failed rc: %d",
-				rc);
+	rc = cam_csiphy_cfg_seq_resolve(csiphy_dev, index, is_3phase,
+		reg_array, cfg_size, max_lanes, entry);
+	if (rc) {
+		cam_csiphy_cfg_cache_release(entry);
+		return rc;
+	}
+
+	if (entry->overflow) {
+		CAM_WARN(CAM_CSIPHY,
+			"Config needs more than %u regs, programming uncached",
+			entry->max_seq);
+		cam_csiphy_cfg_cache_release(entry);
+		entry = &tmp_entry;
+		memset(entry, 0, sizeof(*entry));
+		entry->data_rate_idx = -1;
+		entry->direct_base = csiphybase;
+		rc = cam_csiphy_cfg_seq_resolve(csiphy_dev, index, is_3phase,
+			reg_array, cfg_size, max_lanes, entry);
+		if (rc)
 			return rc;
-		}
+
+		goto programmed;
 	}
 
-	intermediate_var = csiphy_dev->csiphy_info[index].settle_time;
-	do_div(intermediate_var, 200000000);
-	settle_cnt = intermediate_var;
-	skew_cal_enable = csiphy_dev->csiphy_info[index].mipi_flags;
+	if (entry != &tmp_entry)
+		entry->valid = true;
+	entry->last_used = ++csiphy_dev->cfg_cache_use_cnt;
 
-	for (lane_pos = 0; lane_pos < max_lanes; lane_pos++) {
-		CAM_DBG(CAM_CSIPHY, "lane_pos: %d is configuring", lane_pos);
-		for (i = 0; i < cfg_size; i++) {
-			switch (reg_array[lane_pos][i].csiphy_param_type) {
-			case CSIPHY_LANE_ENABLE:
-				cam_io_w_mb(lane_enable,
-					csiphybase +
-					reg_array[lane_pos][i].reg_addr);
-			break;
-			case CSIPHY_DEFAULT_PARAMS:
-				cam_io_w_mb(reg_array[lane_pos][i].reg_data,
-					csiphybase +
-					reg_array[lane_pos][i].reg_addr);
-			break;
-			case CSIPHY_SETTLE_CNT_LOWER_BYTE:
-				cam_io_w_mb(settle_cnt & 0xFF,
-					csiphybase +
-					reg_array[lane_pos][i].reg_addr);
-			break;
-			case CSIPHY_SETTLE_CNT_HIGHER_BYTE:
-				cam_io_w_mb((settle_cnt >> 8) & 0xFF,
-					csiphybase +
-					reg_array[lane_pos][i].reg_addr);
-			break;
-			case CSIPHY_SKEW_CAL:
-			if (skew_cal_enable)
-				cam_io_w_mb(reg_array[lane_pos][i].reg_data,
-					csiphybase +
-					reg_array[lane_pos][i].reg_addr);
-			break;
-			default:
-				CAM_DBG(CAM_CSIPHY, "Do Nothing");
-			break;
-			}
+replay:
+	cam_csiphy_cfg_seq_replay(csiphybase, entry);
+programmed:
+	if (entry->data_rate_idx >= 0)
+		csiphy_dev->curr_data_rate_idx = entry->data_rate_idx;
 
-			if (reg_array[lane_pos][i].delay > 0) {
-				usleep_range(reg_array[lane_pos][i].delay,
-					reg_array[lane_pos][i].delay + 5);
-			}
-		}
-	}
+	if (entry == &tmp_entry)
+		cam_csiphy_cfg_cache_release(entry);
 
 	if (csiphy_dev->preamble_enable)
 		__cam_csiphy_prgm_bist_reg(csiphy_dev, is_3phase);
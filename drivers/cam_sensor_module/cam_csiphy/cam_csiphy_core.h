@@ -91,4 +91,11 @@ int cam_csiphy_dump_status_reg(struct csiphy_device *csiphy_dev);
  *
  */
 int cam_csiphy_util_update_aon_registration(uint32_t phy_idx, bool is_aon_user);
+
+/**
+ * @csiphy_dev : CSIPhy device structure
+ *
+ * This API drops all the cached stream on register sequences of the phy
+ */
+void cam_csiphy_cfg_cache_flush(struct csiphy_device *csiphy_dev);
 #endif /* _CAM_CSIPHY_CORE_H_ */
@@ -110,6 +110,9 @@ static int cam_csiphy_debug_register(struct csiphy_device *csiphy_dev)
 	debugfs_create_bool("skip_aux_settings", 0644,
 		dbgfileptr, &csiphy_dev->skip_aux_settings);
 
+	debugfs_create_bool("disable_cfg_cache", 0644,
+		dbgfileptr, &csiphy_dev->disable_cfg_cache);
+
 	return 0;
 }
 
@@ -394,6 +397,7 @@ static void cam_csiphy_component_unbind(struct device *dev,
 	cam_csiphy_soc_release(csiphy_dev);
 	mutex_lock(&csiphy_dev->mutex);
 	cam_csiphy_shutdown(csiphy_dev);
+	cam_csiphy_cfg_cache_flush(csiphy_dev);
 	mutex_unlock(&csiphy_dev->mutex);
 	cam_unregister_subdev(&(csiphy_dev->v4l2_dev_str));
 	kfree(csiphy_dev->ctrl_reg);
@@ -38,6 +38,8 @@
 #define MAX_DATA_RATES              26
 #define MAX_DATA_RATE_REGS          30
 
+#define CSIPHY_CFG_CACHE_ENTRIES    4
+
 #define CAMX_CSIPHY_DEV_NAME "cam-csiphy-driver"
 #define CAM_CSIPHY_RX_CLK_SRC "cphy_rx_src_clk"
 
@@ -299,6 +301,68 @@ struct cam_csiphy_param {
 	struct csiphy_hdl_tbl      hdl_data;
 };
 
+/**
+ * struct csiphy_cfg_seq_reg
+ * @reg_addr : Register offset from the phy base
+ * @reg_data : Resolved register value
+ * @delay    : Delay in us to wait after the write
+ */
+struct csiphy_cfg_seq_reg {
+	uint32_t                   reg_addr;
+	uint32_t                   reg_data;
+	uint32_t                   delay;
+};
+
+/**
+ * struct csiphy_cfg_cache_key
+ * @data_rate            : Data rate in mbps
+ * @settle_time          : Settling time
+ * @aux_mask             : Auxiliary settings mask of the phy
+ * @lane_enable          : Data lane selection
+ * @lane_assign          : Lane sensor will be using
+ * @mipi_flags           : MIPI phy flags
+ * @lane_cnt             : Total number of lanes
+ * @is_3phase            : To identify DPHY or CPHY
+ * @combo_mode           : Combo mode enable
+ * @cphy_dphy_combo_mode : 2ph/3ph combo mode enable
+ */
+struct csiphy_cfg_cache_key {
+	uint64_t                   data_rate;
+	uint64_t                   settle_time;
+	uint64_t                   aux_mask;
+	uint32_t                   lane_enable;
+	uint16_t                   lane_assign;
+	uint16_t                   mipi_flags;
+	uint8_t                    lane_cnt;
+	uint8_t                    is_3phase;
+	uint8_t                    combo_mode;
+	uint8_t                    cphy_dphy_combo_mode;
+};
+
+/**
+ * struct csiphy_cfg_cache_entry
+ * @key           : Parameters the register sequence was resolved for
+ * @seq           : Resolved register sequence
+ * @num_seq       : Number of valid entries in @seq
+ * @max_seq       : Capacity of @seq
+ * @data_rate_idx : Data rate table index selected for CPHY
+ * @last_used     : Use stamp for LRU replacement
+ * @direct_base   : Phy base to write to instead of recording, when set
+ * @valid         : Entry holds a resolved sequence
+ * @overflow      : A write did not fit in @seq, the sequence is incomplete
+ */
+struct csiphy_cfg_cache_entry {
+	struct csiphy_cfg_cache_key  key;
+	struct csiphy_cfg_seq_reg   *seq;
+	uint32_t                     num_seq;
+	uint32_t                     max_seq;
+	int16_t                      data_rate_idx;
+	uint64_t                     last_used;
+	void __iomem                *direct_base;
+	bool                         valid;
+	bool                         overflow;
+};
+
 struct csiphy_work_queue {
 	struct csiphy_device *csiphy_dev;
 	int32_t acquire_idx;
@@ -339,6 +403,9 @@ struct csiphy_work_queue {
  * @en_full_phy_reg_dump       : Debugfs flag to enable the dump for all the Phy registers
  * @skip_aux_settings          : Debugfs flag to ignore calls to update aux settings
  * @preamble_enable            : To enable preamble pattern
+ * @cfg_cache                  : Resolved stream on register sequences
+ * @cfg_cache_use_cnt          : Use counter for cfg cache LRU replacement
+ * @disable_cfg_cache          : Debugfs flag to resolve the sequence on every config
  */
 struct csiphy_device {
 	char                           device_name[CAM_CTX_DEV_NAME_MAX_LENGTH];
@@ -375,6 +442,9 @@ struct csiphy_device {
 	bool                           en_full_phy_reg_dump;
 	bool                           skip_aux_settings;
 	uint16_t                       preamble_enable;
+	struct csiphy_cfg_cache_entry  cfg_cache[CSIPHY_CFG_CACHE_ENTRIES];
+	uint64_t                       cfg_cache_use_cnt;
+	bool                           disable_cfg_cache;
 };
 
 /**
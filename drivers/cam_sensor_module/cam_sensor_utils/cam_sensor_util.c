@@ -16,6 +16,21 @@
 #define VALIDATE_VOLTAGE(min, max, config_val) ((config_val) && \
 	(config_val >= min) && (config_val <= max))
 
+/* Waits above this use msleep, as in Documentation/timers */
+#define CAM_SENSOR_POWER_SEQ_USLEEP_MAX_US      20000
+
+/*
+ * Off by default, the regulator ramp delay is then slept inside the enable
+ * and disable calls and the sequence timing is the same as before deadline
+ * tracking. Setting it only waits max(ramp delay, step delay) instead of
+ * their sum, which is only safe for sensors whose step delays are not
+ * specified from rail stable.
+ */
+static bool power_seq_overlap_rgltr_delay;
+module_param(power_seq_overlap_rgltr_delay, bool, 0644);
+MODULE_PARM_DESC(power_seq_overlap_rgltr_delay,
+	"Overlap regulator ramp delay with step delays, default off");
+
 static struct i2c_settings_list*
 	cam_sensor_get_i2c_ptr(struct i2c_settings_array *i2c_reg_settings,
 		uint32_t size)
@@ -1980,11 +1995,78 @@ static int cam_config_mclk_reg(struct cam_sensor_power_ctrl_t *ctrl,
 	return rc;
 }
 
+/*
+ * Power sequence delays are tracked as a deadline: each step pushes out
+ * the earliest time the next step may start and the sequencer sleeps
+ * only for what is left of it.
+ */
+static void cam_sensor_power_seq_defer(ktime_t *deadline, uint32_t delay_ms)
+{
+	ktime_t next;
+
+	if (!delay_ms)
+		return;
+
+	next = ktime_add_ms(ktime_get(), delay_ms);
+	if (ktime_after(next, *deadline))
+		*deadline = next;
+}
+
+static void cam_sensor_power_seq_wait(ktime_t deadline)
+{
+	s64 remain_us = ktime_us_delta(deadline, ktime_get());
+
+	if (remain_us <= 0)
+		return;
+
+	if (remain_us > CAM_SENSOR_POWER_SEQ_USLEEP_MAX_US)
+		msleep(DIV_ROUND_UP((u32)remain_us, USEC_PER_MSEC));
+	else
+		usleep_range(remain_us, remain_us + 1000);
+}
+
+static int cam_sensor_power_seq_vreg_on(struct cam_hw_soc_info *soc_info,
+	int idx, ktime_t *deadline)
+{
+	int rc;
+
+	rc = cam_soc_util_regulator_enable(soc_info->rgltr[idx],
+		soc_info->rgltr_name[idx],
+		soc_info->rgltr_min_volt[idx],
+		soc_info->rgltr_max_volt[idx],
+		soc_info->rgltr_op_mode[idx],
+		power_seq_overlap_rgltr_delay ? 0 : soc_info->rgltr_delay[idx]);
+	if (!rc && power_seq_overlap_rgltr_delay)
+		cam_sensor_power_seq_defer(deadline,
+			soc_info->rgltr_delay[idx]);
+
+	return rc;
+}
+
+static int cam_sensor_power_seq_vreg_off(struct cam_hw_soc_info *soc_info,
+	int idx, ktime_t *deadline)
+{
+	int rc;
+
+	rc = cam_soc_util_regulator_disable(soc_info->rgltr[idx],
+		soc_info->rgltr_name[idx],
+		soc_info->rgltr_min_volt[idx],
+		soc_info->rgltr_max_volt[idx],
+		soc_info->rgltr_op_mode[idx],
+		power_seq_overlap_rgltr_delay ? 0 : soc_info->rgltr_delay[idx]);
+	if (!rc && power_seq_overlap_rgltr_delay)
+		cam_sensor_power_seq_defer(deadline,
+			soc_info->rgltr_delay[idx]);
+
+	return rc;
+}
+
 int cam_sensor_core_power_up(struct cam_sensor_power_ctrl_t *ctrl,
 		struct cam_hw_soc_info *soc_info)
 {
 	int rc = 0, index = 0, no_gpio = 0, ret = 0, num_vreg, j = 0, i = 0;
 	int32_t vreg_idx = -1;
+	ktime_t start, deadline;
 	struct cam_sensor_power_setting *power_setting = NULL;
 	struct msm_camera_gpio_num_info *gpio_num_info = NULL;
 
@@ -2026,6 +2108,8 @@ int cam_sensor_core_power_up(struct cam_sensor_power_ctrl_t *ctrl,
 
 	CAM_DBG(CAM_SENSOR, "power setting size: %d", ctrl->power_setting_size);
 
+	start = ktime_get();
+	deadline = start;
 	for (index = 0; index < ctrl->power_setting_size; index++) {
 		CAM_DBG(CAM_SENSOR, "index: %d", index);
 		power_setting = &ctrl->power_setting[index];
@@ -2036,6 +2120,8 @@ int cam_sensor_core_power_up(struct cam_sensor_power_ctrl_t *ctrl,
 			return -EINVAL;
 		}
 
+		cam_sensor_power_seq_wait(deadline);
+
 		CAM_DBG(CAM_SENSOR, "seq_type %d", power_setting->seq_type);
 
 		switch (power_setting->seq_type) {
@@ -2064,13 +2150,8 @@ int cam_sensor_core_power_up(struct cam_sensor_power_ctrl_t *ctrl,
 						goto power_up_failed;
 					}
 
-					rc =  cam_soc_util_regulator_enable(
-					soc_info->rgltr[j],
-					soc_info->rgltr_name[j],
-					soc_info->rgltr_min_volt[j],
-					soc_info->rgltr_max_volt[j],
-					soc_info->rgltr_op_mode[j],
-					soc_info->rgltr_delay[j]);
+					rc = cam_sensor_power_seq_vreg_on(
+						soc_info, j, &deadline);
 					if (rc) {
 						CAM_ERR(CAM_SENSOR,
 							"Reg enable failed");
@@ -2158,13 +2239,8 @@ int cam_sensor_core_power_up(struct cam_sensor_power_ctrl_t *ctrl,
 					goto power_up_failed;
 				}
 
-				rc =  cam_soc_util_regulator_enable(
-					soc_info->rgltr[vreg_idx],
-					soc_info->rgltr_name[vreg_idx],
-					soc_info->rgltr_min_volt[vreg_idx],
-					soc_info->rgltr_max_volt[vreg_idx],
-					soc_info->rgltr_op_mode[vreg_idx],
-					soc_info->rgltr_delay[vreg_idx]);
+				rc = cam_sensor_power_seq_vreg_on(
+					soc_info, vreg_idx, &deadline);
 				if (rc) {
 					CAM_ERR(CAM_SENSOR,
 						"Reg Enable failed for %s",
@@ -2192,21 +2268,23 @@ int cam_sensor_core_power_up(struct cam_sensor_power_ctrl_t *ctrl,
 				power_setting->seq_type);
 			break;
 		}
-		if (power_setting->delay > 20)
-			msleep(power_setting->delay);
-		else if (power_setting->delay)
-			usleep_range(power_setting->delay * 1000,
-				(power_setting->delay * 1000) + 1000);
+		cam_sensor_power_seq_defer(&deadline, power_setting->delay);
 	}
 
+	cam_sensor_power_seq_wait(deadline);
+	CAM_DBG(CAM_SENSOR, "power up done in %lld us",
+		ktime_us_delta(ktime_get(), start));
+
 	return 0;
 power_up_failed:
 	CAM_ERR(CAM_SENSOR, "failed. rc:%d", rc);
+	deadline = ktime_get();
 	for (index--; index >= 0; index--) {
 		CAM_DBG(CAM_SENSOR, "index %d",  index);
 		power_setting = &ctrl->power_setting[index];
 		CAM_DBG(CAM_SENSOR, "type %d",
 			power_setting->seq_type);
+		cam_sensor_power_seq_wait(deadline);
 		switch (power_setting->seq_type) {
 		case SENSOR_MCLK:
 			for (i = soc_info->num_clk - 1; i >= 0; i--) {
@@ -2244,13 +2322,8 @@ power_up_failed:
 				CAM_DBG(CAM_SENSOR, "Disable Regulator");
 				vreg_idx = power_setting->seq_val;
 
-				rc =  cam_soc_util_regulator_disable(
-					soc_info->rgltr[vreg_idx],
-					soc_info->rgltr_name[vreg_idx],
-					soc_info->rgltr_min_volt[vreg_idx],
-					soc_info->rgltr_max_volt[vreg_idx],
-					soc_info->rgltr_op_mode[vreg_idx],
-					soc_info->rgltr_delay[vreg_idx]);
+				rc = cam_sensor_power_seq_vreg_off(
+					soc_info, vreg_idx, &deadline);
 
 				if (rc) {
 					CAM_ERR(CAM_SENSOR,
@@ -2280,14 +2353,10 @@ power_up_failed:
 				power_setting->seq_type);
 			break;
 		}
-		if (power_setting->delay > 20) {
-			msleep(power_setting->delay);
-		} else if (power_setting->delay) {
-			usleep_range(power_setting->delay * 1000,
-				(power_setting->delay * 1000) + 1000);
-		}
+		cam_sensor_power_seq_defer(&deadline, power_setting->delay);
 	}
 
+	cam_sensor_power_seq_wait(deadline);
 	if (ctrl->cam_pinctrl_status) {
 		ret = pinctrl_select_state(
 			ctrl->pinctrl_info.pinctrl,
@@ -2328,6 +2397,7 @@ int cam_sensor_util_power_down(struct cam_sensor_power_ctrl_t *ctrl,
 		struct cam_hw_soc_info *soc_info)
 {
 	int index = 0, ret = 0, num_vreg = 0, i;
+	ktime_t start, deadline;
 	struct cam_sensor_power_setting *pd = NULL;
 	struct cam_sensor_power_setting *ps = NULL;
 	struct msm_camera_gpio_num_info *gpio_num_info = NULL;
@@ -2352,6 +2422,8 @@ int cam_sensor_util_power_down(struct cam_sensor_power_ctrl_t *ctrl,
 		return -EINVAL;
 	}
 
+	start = ktime_get();
+	deadline = start;
 	for (index = 0; index < ctrl->power_down_setting_size; index++) {
 		CAM_DBG(CAM_SENSOR, "power_down_index %d",  index);
 		pd = &ctrl->power_down_setting[index];
@@ -2362,6 +2434,8 @@ int cam_sensor_util_power_down(struct cam_sensor_power_ctrl_t *ctrl,
 			return -EINVAL;
 		}
 
+		cam_sensor_power_seq_wait(deadline);
+
 		ps = NULL;
 		CAM_DBG(CAM_SENSOR, "seq_type %d",  pd->seq_type);
 		switch (pd->seq_type) {
@@ -2409,13 +2483,9 @@ int cam_sensor_util_power_down(struct cam_sensor_power_ctrl_t *ctrl,
 				if (pd->seq_val < num_vreg) {
 					CAM_DBG(CAM_SENSOR,
 						"Disable Regulator");
-					ret =  cam_soc_util_regulator_disable(
-					soc_info->rgltr[ps->seq_val],
-					soc_info->rgltr_name[ps->seq_val],
-					soc_info->rgltr_min_volt[ps->seq_val],
-					soc_info->rgltr_max_volt[ps->seq_val],
-					soc_info->rgltr_op_mode[ps->seq_val],
-					soc_info->rgltr_delay[ps->seq_val]);
+					ret = cam_sensor_power_seq_vreg_off(
+						soc_info, ps->seq_val,
+						&deadline);
 					if (ret) {
 						CAM_ERR(CAM_SENSOR,
 						"Reg: %s disable failed",
@@ -2451,13 +2521,13 @@ int cam_sensor_util_power_down(struct cam_sensor_power_ctrl_t *ctrl,
 				pd->seq_type);
 			break;
 		}
-		if (pd->delay > 20)
-			msleep(pd->delay);
-		else if (pd->delay)
-			usleep_range(pd->delay * 1000,
-				(pd->delay * 1000) + 1000);
+		cam_sensor_power_seq_defer(&deadline, pd->delay);
 	}
 
+	cam_sensor_power_seq_wait(deadline);
+	CAM_DBG(CAM_SENSOR, "power down done in %lld us",
+		ktime_us_delta(ktime_get(), start));
+
 	if (ctrl->cam_pinctrl_status) {
 		ret = pinctrl_select_state(
 				ctrl->pinctrl_info.pinctrl,
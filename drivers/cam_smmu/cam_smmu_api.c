@@ -3674,6 +3674,46 @@ put_addr_end:
 }
 EXPORT_SYMBOL(cam_smmu_put_iova);
 
+int cam_smmu_update_user_iova_fd(int handle, int old_fd, int new_fd,
+	struct dma_buf *dma_buf)
+{
+	int idx, rc;
+	struct cam_dma_buff_info *mapping_info;
+
+	rc = cam_smmu_unmap_validate_params(handle);
+	if (rc) {
+		CAM_ERR(CAM_SMMU, "update fd validation failure");
+		return rc;
+	}
+
+	idx = GET_SMMU_TABLE_IDX(handle);
+	mutex_lock(&iommu_cb_set.cb_info[idx].lock);
+	if (iommu_cb_set.cb_info[idx].handle != handle) {
+		CAM_ERR(CAM_SMMU,
+			"Error: hdl is not valid, table_hdl = %x, hdl = %x",
+			iommu_cb_set.cb_info[idx].handle, handle);
+		rc = -EINVAL;
+		goto update_end;
+	}
+
+	mapping_info = cam_smmu_find_mapping_by_ion_index(idx, old_fd, dma_buf);
+	if (!mapping_info) {
+		rc = -ENOENT;
+		goto update_end;
+	}
+
+	CAM_DBG(CAM_SMMU, "cb:%s idx:%d fd %d -> %d i_ino:%lu",
+		iommu_cb_set.cb_info[idx].name[0], idx, old_fd, new_fd,
+		mapping_info->i_ino);
+	mapping_info->ion_fd = new_fd;
+	CAM_GET_TIMESTAMP(mapping_info->ts);
+
+update_end:
+	mutex_unlock(&iommu_cb_set.cb_info[idx].lock);
+	return rc;
+}
+EXPORT_SYMBOL(cam_smmu_update_user_iova_fd);
+
 int cam_smmu_destroy_handle(int handle)
 {
 	int idx;
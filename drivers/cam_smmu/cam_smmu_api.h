@@ -260,6 +260,19 @@ void cam_smmu_set_client_page_fault_handler(int handle,
  */
 void cam_smmu_unset_client_page_fault_handler(int handle, void *token);
 
+/**
+ * @brief Updates the fd an existing user mapping is tracked with
+ *
+ * @param handle: SMMU handle identifying the context bank
+ * @param old_fd: fd the buffer was mapped with
+ * @param new_fd: fd to track the mapping with from now on
+ * @param dma_buf: DMA buf of the mapped memory
+ *
+ * @return Status of operation. Negative in case of error. Zero otherwise.
+ */
+int cam_smmu_update_user_iova_fd(int handle, int old_fd, int new_fd,
+	struct dma_buf *dma_buf);
+
 /**
  * @brief Maps memory from an ION fd into IOVA space
  *
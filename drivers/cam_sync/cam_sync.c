@@ -791,6 +791,50 @@ static int cam_sync_handle_deregister_user_payload(
 	return 0;
 }
 
+static int cam_sync_handle_event_ring_setup(
+	struct cam_private_ioctl_arg *k_ioctl)
+{
+	struct cam_event_ring_setup setup;
+	struct cam_event_ring *event_ring = NULL;
+	unsigned long flags;
+	int rc;
+
+	if (k_ioctl->size != sizeof(struct cam_event_ring_setup))
+		return -EINVAL;
+
+	if (!k_ioctl->ioctl_ptr)
+		return -EINVAL;
+
+	if (copy_from_user(&setup,
+		u64_to_user_ptr(k_ioctl->ioctl_ptr),
+		k_ioctl->size))
+		return -EFAULT;
+
+	mutex_lock(&sync_dev->table_lock);
+	if (sync_dev->event_ring) {
+		CAM_ERR(CAM_SYNC, "Event ring already set up");
+		rc = -EBUSY;
+		goto end;
+	}
+
+	rc = cam_event_ring_create(setup.num_entries, &event_ring);
+	if (rc)
+		goto end;
+
+	spin_lock_irqsave(&sync_dev->event_ring_lock, flags);
+	sync_dev->event_ring = event_ring;
+	spin_unlock_irqrestore(&sync_dev->event_ring_lock, flags);
+
+	setup.size = event_ring->size;
+	setup.version = CAM_EVENT_RING_VERSION;
+	if (copy_to_user(u64_to_user_ptr(k_ioctl->ioctl_ptr),
+		&setup, k_ioctl->size))
+		rc = -EFAULT;
+end:
+	mutex_unlock(&sync_dev->table_lock);
+	return rc;
+}
+
 static long cam_sync_dev_ioctl(struct file *filep, void *fh,
 		bool valid_prio, unsigned int cmd, void *arg)
 {
@@ -839,6 +883,9 @@ static long cam_sync_dev_ioctl(struct file *filep, void *fh,
 		((struct cam_private_ioctl_arg *)arg)->result =
 			k_ioctl.result;
 		break;
+	case CAM_SYNC_EVENT_RING_SETUP:
+		rc = cam_sync_handle_event_ring_setup(&k_ioctl);
+		break;
 	default:
 		rc = -ENOIOCTLCMD;
 	}
@@ -851,6 +898,7 @@ static unsigned int cam_sync_poll(struct file *f,
 {
 	int rc = 0;
 	struct v4l2_fh *eventq = f->private_data;
+	struct cam_event_ring *event_ring;
 
 	if (!eventq)
 		return -EINVAL;
@@ -860,6 +908,27 @@ static unsigned int cam_sync_poll(struct file *f,
 	if (v4l2_event_pending(eventq))
 		rc = POLLPRI;
 
+	/* Only freed on release, cannot go away under us */
+	event_ring = READ_ONCE(sync_dev->event_ring);
+	if (event_ring)
+		rc |= cam_event_ring_poll(event_ring, f, pll_table);
+
+	return rc;
+}
+
+static int cam_sync_mmap(struct file *filep, struct vm_area_struct *vma)
+{
+	int rc;
+
+	mutex_lock(&sync_dev->table_lock);
+	if (!sync_dev->event_ring) {
+		CAM_ERR(CAM_SYNC, "Event ring not set up");
+		rc = -ENODEV;
+	} else {
+		rc = cam_event_ring_mmap(sync_dev->event_ring, vma);
+	}
+	mutex_unlock(&sync_dev->table_lock);
+
 	return rc;
 }
 
@@ -898,6 +967,8 @@ static int cam_sync_close(struct file *filep)
 	int rc = 0;
 	int i;
 	struct sync_device *sync_dev = video_drvdata(filep);
+	struct cam_event_ring *event_ring;
+	unsigned long flags;
 
 	if (!sync_dev) {
 		CAM_ERR(CAM_SYNC, "Sync device NULL");
@@ -956,6 +1027,13 @@ static int cam_sync_close(struct file *filep)
 	spin_unlock_bh(&sync_dev->cam_sync_eventq_lock);
 	v4l2_fh_release(filep);
 
+	/* Release only runs once the last mapping of the ring is gone */
+	spin_lock_irqsave(&sync_dev->event_ring_lock, flags);
+	event_ring = sync_dev->event_ring;
+	sync_dev->event_ring = NULL;
+	spin_unlock_irqrestore(&sync_dev->event_ring_lock, flags);
+	cam_event_ring_destroy(event_ring);
+
 	return rc;
 }
 
@@ -1024,6 +1102,7 @@ static struct v4l2_file_operations cam_sync_v4l2_fops = {
 	.open  = cam_sync_open,
 	.release = cam_sync_close,
 	.poll = cam_sync_poll,
+	.mmap = cam_sync_mmap,
 	.unlocked_ioctl   = video_ioctl2,
 #ifdef CONFIG_COMPAT
 	.compat_ioctl32 = video_ioctl2,
@@ -1198,6 +1277,7 @@ static int cam_sync_component_bind(struct device *dev,
 
 	mutex_init(&sync_dev->table_lock);
 	spin_lock_init(&sync_dev->cam_sync_eventq_lock);
+	spin_lock_init(&sync_dev->event_ring_lock);
 
 	for (idx = 0; idx < CAM_SYNC_MAX_OBJS; idx++)
 		spin_lock_init(&sync_dev->row_spinlocks[idx]);
@@ -18,6 +18,7 @@
 #include <media/v4l2-event.h>
 #include <media/v4l2-ioctl.h>
 #include "cam_sync_api.h"
+#include "cam_event_ring.h"
 
 #if IS_REACHABLE(CONFIG_MSM_GLOBAL_SYNX)
 #include <synx_api.h>
@@ -189,6 +190,9 @@ struct cam_signalable_info {
  * @bitmap          : Bitmap representation of all sync objects
  * @params          : Parameters for synx call back registration
  * @version         : version support
+ * @event_ring      : Shared memory ring events go to instead of
+ *                    cam_sync_eventq, if set up
+ * @event_ring_lock : Lock for event_ring, serializes pushes to it
  */
 struct sync_device {
 	struct video_device *vdev;
@@ -206,6 +210,8 @@ struct sync_device {
 	struct synx_register_params params;
 #endif
 	uint32_t version;
+	struct cam_event_ring *event_ring;
+	spinlock_t event_ring_lock;
 };
 
 
@@ -6,6 +6,7 @@
 
 #include "cam_sync_util.h"
 #include "cam_req_mgr_workq.h"
+#include "cam_req_mgr_debug.h"
 #include "cam_common_util.h"
 
 int cam_sync_util_find_and_set_empty_row(struct sync_device *sync_dev,
@@ -312,6 +313,7 @@ int cam_sync_deinit_object(struct sync_table_row *table, uint32_t idx)
 			&row->callback_list, list) {
 		sync_cb->status = CAM_SYNC_STATE_SIGNALED_CANCEL;
 		list_del_init(&sync_cb->list);
+		sync_cb->workq_scheduled_ts = ktime_get();
 		queue_work(sync_dev->work_queue,
 			&sync_cb->cb_dispatch_work);
 	}
@@ -338,6 +340,8 @@ void cam_sync_util_cb_dispatch(struct work_struct *cb_dispatch_work)
 		"CAM-SYNC workq schedule",
 		cb_info->workq_scheduled_ts,
 		CAM_WORKQ_SCHEDULE_TIME_THRESHOLD);
+	cam_req_mgr_debug_lat_record(CAM_REQ_MGR_LAT_SYNC_CB_SCHED,
+		CAM_REQ_MGR_LAT_INST_MAX, cb_info->workq_scheduled_ts);
 	sync_data(cb_info->sync_obj, cb_info->status, cb_info->cb_data);
 
 	kfree(cb_info);
@@ -365,6 +369,7 @@ void cam_sync_util_dispatch_signaled_cb(int32_t sync_obj,
 		temp_sync_cb, &signalable_row->callback_list, list) {
 		sync_cb->status = status;
 		list_del_init(&sync_cb->list);
+		sync_cb->workq_scheduled_ts = ktime_get();
 		queue_work(sync_dev->work_queue,
 			&sync_cb->cb_dispatch_work);
 	}
@@ -411,6 +416,7 @@ void cam_sync_util_send_v4l2_event(uint32_t id,
 {
 	struct v4l2_event event;
 	__u64 *payload_data = NULL;
+	unsigned long flags;
 
 	if (sync_dev->version == CAM_SYNC_V4L_EVENT_V2) {
 		struct cam_sync_ev_header_v2 *ev_header = NULL;
@@ -438,7 +444,15 @@ void cam_sync_util_send_v4l2_event(uint32_t id,
 	}
 
 	memcpy(payload_data, payload, len);
-	v4l2_event_queue(sync_dev->vdev, &event);
+
+	spin_lock_irqsave(&sync_dev->event_ring_lock, flags);
+	if (sync_dev->event_ring)
+		cam_event_ring_push(sync_dev->event_ring, event.id,
+			event.type, event.u.data, sizeof(event.u.data));
+	else
+		v4l2_event_queue(sync_dev->vdev, &event);
+	spin_unlock_irqrestore(&sync_dev->event_ring_lock, flags);
+
 	CAM_DBG(CAM_SYNC, "send v4l2 event version %d for sync_obj :%d",
 		sync_dev->version,
 		sync_obj);
@@ -7,6 +7,8 @@
 #include <linux/dma-mapping.h>
 #include <linux/of_address.h>
 #include <linux/slab.h>
+#include <linux/sched.h>
+#include <uapi/linux/sched/types.h>
 
 #include "cam_compat.h"
 #include "cam_debug_util.h"
@@ -422,6 +424,62 @@ int cam_get_ddr_type(void)
 }
 #endif
 
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 10, 0)
+int cam_compat_util_dmabuf_sync_partial(struct dma_buf *dmabuf,
+	enum dma_data_direction begin_dir, enum dma_data_direction end_dir,
+	unsigned int offset, unsigned int len)
+{
+	int rc;
+
+	rc = dma_buf_begin_cpu_access_partial(dmabuf, begin_dir, offset, len);
+	if (rc)
+		return rc;
+
+	return dma_buf_end_cpu_access_partial(dmabuf, end_dir, offset, len);
+}
+#else
+int cam_compat_util_dmabuf_sync_partial(struct dma_buf *dmabuf,
+	enum dma_data_direction begin_dir, enum dma_data_direction end_dir,
+	unsigned int offset, unsigned int len)
+{
+	int rc;
+
+	/* No partial cpu access on older kernels, maintain the whole buffer */
+	rc = dma_buf_begin_cpu_access(dmabuf, begin_dir);
+	if (rc)
+		return rc;
+
+	return dma_buf_end_cpu_access(dmabuf, end_dir);
+}
+#endif
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 0, 0)
+int cam_compat_register_shrinker(struct shrinker *shrinker, const char *name)
+{
+	return register_shrinker(shrinker, "%s", name);
+}
+#else
+int cam_compat_register_shrinker(struct shrinker *shrinker, const char *name)
+{
+	return register_shrinker(shrinker);
+}
+#endif
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 9, 0)
+void cam_compat_sched_set_fifo(struct task_struct *task)
+{
+	sched_set_fifo(task);
+}
+#else
+void cam_compat_sched_set_fifo(struct task_struct *task)
+{
+	/* Same priority sched_set_fifo() picks on newer kernels */
+	struct sched_param param = { .sched_priority = MAX_RT_PRIO / 2 };
+
+	sched_setscheduler_nocheck(task, SCHED_FIFO, &param);
+}
+#endif
+
 #if KERNEL_VERSION(5, 15, 0) <= LINUX_VERSION_CODE
 int cam_get_subpart_info(uint32_t *part_info, uint32_t max_num_cam)
 {
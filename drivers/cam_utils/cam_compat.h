@@ -13,6 +13,7 @@
 #include <linux/iommu.h>
 #include <linux/qcom_scm.h>
 #include <linux/list_sort.h>
+#include <linux/shrinker.h>
 #include <linux/dma-iommu.h>
 
 #include "cam_csiphy_dev.h"
@@ -51,6 +52,11 @@ void cam_check_iommu_faults(struct iommu_domain *domain,
 int cam_get_ddr_type(void);
 int cam_compat_util_get_dmabuf_va(struct dma_buf *dmabuf, uintptr_t *vaddr);
 void cam_compat_util_put_dmabuf_va(struct dma_buf *dmabuf, void *vaddr);
+int cam_compat_util_dmabuf_sync_partial(struct dma_buf *dmabuf,
+	enum dma_data_direction begin_dir, enum dma_data_direction end_dir,
+	unsigned int offset, unsigned int len);
+int cam_compat_register_shrinker(struct shrinker *shrinker, const char *name);
+void cam_compat_sched_set_fifo(struct task_struct *task);
 void cam_smmu_util_iommu_custom(struct device *dev,
 	dma_addr_t discard_start, size_t discard_length);
 
@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ */
+
+#include <linux/slab.h>
+#include <linux/vmalloc.h>
+#include <linux/log2.h>
+#include <linux/timekeeping.h>
+
+#include "cam_event_ring.h"
+#include "cam_debug_util.h"
+
+int cam_event_ring_create(uint32_t num_entries, struct cam_event_ring **ring)
+{
+	struct cam_event_ring *new_ring;
+	size_t                 size;
+
+	if (!ring)
+		return -EINVAL;
+
+	if (!is_power_of_2(num_entries) ||
+		(num_entries < CAM_EVENT_RING_MIN_ENTRIES) ||
+		(num_entries > CAM_EVENT_RING_MAX_ENTRIES)) {
+		CAM_ERR(CAM_UTIL, "Invalid number of ring entries %u",
+			num_entries);
+		return -EINVAL;
+	}
+
+	new_ring = kzalloc(sizeof(*new_ring), GFP_KERNEL);
+	if (!new_ring)
+		return -ENOMEM;
+
+	size = PAGE_ALIGN(sizeof(struct cam_event_ring_hdr) +
+		num_entries * sizeof(struct cam_event_ring_entry));
+	new_ring->hdr = vmalloc_user(size);
+	if (!new_ring->hdr) {
+		kfree(new_ring);
+		return -ENOMEM;
+	}
+
+	new_ring->entries = (struct cam_event_ring_entry *)(new_ring->hdr + 1);
+	new_ring->size = size;
+	new_ring->mask = num_entries - 1;
+	init_waitqueue_head(&new_ring->wait);
+
+	new_ring->hdr->version = CAM_EVENT_RING_VERSION;
+	new_ring->hdr->num_entries = num_entries;
+	new_ring->hdr->entry_size = sizeof(struct cam_event_ring_entry);
+	new_ring->hdr->entries_offset = sizeof(struct cam_event_ring_hdr);
+
+	CAM_DBG(CAM_UTIL, "Event ring entries %u size %zu", num_entries, size);
+	*ring = new_ring;
+
+	return 0;
+}
+
+void cam_event_ring_destroy(struct cam_event_ring *ring)
+{
+	if (!ring)
+		return;
+
+	if (ring->dropped)
+		CAM_INFO(CAM_UTIL, "Event ring queued %u dropped %u",
+			ring->head, ring->dropped);
+
+	vfree(ring->hdr);
+	kfree(ring);
+}
+
+bool cam_event_ring_push(struct cam_event_ring *ring, uint32_t id,
+	uint32_t type, const void *data, size_t len)
+{
+	struct cam_event_ring_entry *entry;
+	uint32_t                     tail;
+
+	/* Pairs with the consumer's release store of tail */
+	tail = smp_load_acquire(&ring->hdr->tail);
+
+	/*
+	 * tail is user written, anything more than a ring behind head,
+	 * sane or not, is treated as full.
+	 */
+	if ((ring->head - tail) > ring->mask) {
+		ring->dropped++;
+		WRITE_ONCE(ring->hdr->dropped, ring->dropped);
+		CAM_WARN_RATE_LIMIT(CAM_UTIL,
+			"Event ring full, dropped id %u type 0x%x total %u",
+			id, type, ring->dropped);
+		return false;
+	}
+
+	entry = &ring->entries[ring->head & ring->mask];
+	entry->id = id;
+	entry->type = type;
+	entry->timestamp = ktime_get_ns();
+	len = min_t(size_t, len, CAM_EVENT_RING_PAYLOAD_SIZE);
+	memcpy(entry->data, data, len);
+	memset(entry->data + len, 0, CAM_EVENT_RING_PAYLOAD_SIZE - len);
+
+	/* Publish the entry before the new head */
+	ring->head++;
+	smp_store_release(&ring->hdr->head, ring->head);
+
+	if (wq_has_sleeper(&ring->wait))
+		wake_up_interruptible(&ring->wait);
+
+	return true;
+}
+
+unsigned int cam_event_ring_poll(struct cam_event_ring *ring,
+	struct file *filep, struct poll_table_struct *pll_table)
+{
+	poll_wait(filep, &ring->wait, pll_table);
+
+	if (READ_ONCE(ring->hdr->tail) != READ_ONCE(ring->head))
+		return POLLIN | POLLRDNORM;
+
+	return 0;
+}
+
+int cam_event_ring_mmap(struct cam_event_ring *ring,
+	struct vm_area_struct *vma)
+{
+	if (vma->vm_pgoff ||
+		((vma->vm_end - vma->vm_start) > ring->size)) {
+		CAM_ERR(CAM_UTIL, "Invalid event ring mapping pgoff %lu len %lu",
+			vma->vm_pgoff, vma->vm_end - vma->vm_start);
+		return -EINVAL;
+	}
+
+	return remap_vmalloc_range(vma, ring->hdr, 0);
+}
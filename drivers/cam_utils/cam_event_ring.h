@@ -0,0 +1,103 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ */
+
+#ifndef _CAM_EVENT_RING_H_
+#define _CAM_EVENT_RING_H_
+
+#include <linux/types.h>
+#include <linux/fs.h>
+#include <linux/mm.h>
+#include <linux/poll.h>
+#include <linux/wait.h>
+#include <media/cam_defs.h>
+
+/**
+ * struct cam_event_ring - Kernel side of a shared memory event ring
+ *
+ * @hdr:       Header of the ring, start of the user mappable memory
+ * @entries:   Entries of the ring, right after the header
+ * @size:      Size of the user mappable memory
+ * @mask:      Number of entries minus one
+ * @head:      Kernel copy of hdr->head, the user mapping is not trusted
+ * @dropped:   Kernel copy of hdr->dropped
+ * @wait:      Wait queue for consumers polling on the ring
+ */
+struct cam_event_ring {
+	struct cam_event_ring_hdr   *hdr;
+	struct cam_event_ring_entry *entries;
+	size_t                       size;
+	uint32_t                     mask;
+	uint32_t                     head;
+	uint32_t                     dropped;
+	wait_queue_head_t            wait;
+};
+
+/**
+ * cam_event_ring_create()
+ *
+ * @brief:       Allocate a zeroed, user mappable event ring
+ *
+ * @num_entries: Number of entries, power of 2 within
+ *               [CAM_EVENT_RING_MIN_ENTRIES, CAM_EVENT_RING_MAX_ENTRIES]
+ * @ring:        Output pointer to the ring
+ *
+ * @return:      0 on success, negative on failure
+ */
+int cam_event_ring_create(uint32_t num_entries, struct cam_event_ring **ring);
+
+/**
+ * cam_event_ring_destroy()
+ *
+ * @brief:       Free an event ring, must no longer be mapped or pushed to
+ *
+ * @ring:        Ring to free, may be NULL
+ */
+void cam_event_ring_destroy(struct cam_event_ring *ring);
+
+/**
+ * cam_event_ring_push()
+ *
+ * @brief:       Queue an event and wake up the consumer. Callers serialize
+ *               pushes on the same ring, this is the single producer.
+ *
+ * @ring:        Ring to queue to
+ * @id:          Event id
+ * @type:        Event type
+ * @data:        Event payload
+ * @len:         Payload length, truncated to CAM_EVENT_RING_PAYLOAD_SIZE
+ *
+ * @return:      true if queued, false if dropped because the ring is full
+ */
+bool cam_event_ring_push(struct cam_event_ring *ring, uint32_t id,
+	uint32_t type, const void *data, size_t len);
+
+/**
+ * cam_event_ring_poll()
+ *
+ * @brief:       Poll helper for the node owning the ring
+ *
+ * @ring:        Ring to poll
+ * @filep:       File being polled
+ * @pll_table:   Poll table
+ *
+ * @return:      POLLIN | POLLRDNORM if there are unconsumed events
+ */
+unsigned int cam_event_ring_poll(struct cam_event_ring *ring,
+	struct file *filep, struct poll_table_struct *pll_table);
+
+/**
+ * cam_event_ring_mmap()
+ *
+ * @brief:       Map the ring to user space, only at offset 0
+ *
+ * @ring:        Ring to map
+ * @vma:         User vma to map the ring into
+ *
+ * @return:      0 on success, negative on failure
+ */
+int cam_event_ring_mmap(struct cam_event_ring *ring,
+	struct vm_area_struct *vma);
+
+#endif /* _CAM_EVENT_RING_H_ */
@@ -7,9 +7,62 @@
 #include <linux/delay.h>
 #include <linux/io.h>
 #include <linux/err.h>
+#include <linux/atomic.h>
+#include <linux/math64.h>
+#include <linux/module.h>
 #include "cam_io_util.h"
 #include "cam_debug_util.h"
 
+static uint cam_io_accounting;
+module_param(cam_io_accounting, uint, 0644);
+
+static struct {
+	atomic64_t barriers;
+	atomic64_t relaxed_writes;
+	atomic64_t txns;
+	atomic64_t frames;
+} cam_io_stats;
+
+#define CAM_IO_ACCOUNT(__field, __n)                                   \
+do {                                                                   \
+	if (unlikely(cam_io_accounting))                               \
+		atomic64_add((__n), &cam_io_stats.__field);            \
+} while (0)
+
+static int cam_io_stats_get(char *buf, const struct kernel_param *kp)
+{
+	int64_t frames = atomic64_read(&cam_io_stats.frames);
+	int64_t barriers = atomic64_read(&cam_io_stats.barriers);
+
+	return scnprintf(buf, PAGE_SIZE,
+		"frames %lld barriers %lld relaxed_writes %lld txns %lld barriers_per_frame %llu\n",
+		frames, barriers,
+		atomic64_read(&cam_io_stats.relaxed_writes),
+		atomic64_read(&cam_io_stats.txns),
+		frames ? div64_u64(barriers, frames) : 0);
+}
+
+static int cam_io_stats_set(const char *val, const struct kernel_param *kp)
+{
+	atomic64_set(&cam_io_stats.barriers, 0);
+	atomic64_set(&cam_io_stats.relaxed_writes, 0);
+	atomic64_set(&cam_io_stats.txns, 0);
+	atomic64_set(&cam_io_stats.frames, 0);
+
+	return 0;
+}
+
+static const struct kernel_param_ops cam_io_stats_ops = {
+	.set = cam_io_stats_set,
+	.get = cam_io_stats_get,
+};
+module_param_cb(cam_io_stats, &cam_io_stats_ops, NULL, 0644);
+
+void cam_io_account_frame(void)
+{
+	CAM_IO_ACCOUNT(frames, 1);
+}
+
 int cam_io_w(uint32_t data, void __iomem *addr)
 {
 	if (!addr)
@@ -17,6 +70,7 @@ int cam_io_w(uint32_t data, void __iomem *addr)
 
 	CAM_DBG(CAM_IO_ACCESS, "0x%pK %08x", addr, data);
 	writel_relaxed(data, addr);
+	CAM_IO_ACCOUNT(relaxed_writes, 1);
 
 	return 0;
 }
@@ -28,10 +82,50 @@ int cam_io_w_mb(uint32_t data, void __iomem *addr)
 
 	CAM_DBG(CAM_IO_ACCESS, "0x%pK %08x", addr, data);
 	writel(data, addr);
+	CAM_IO_ACCOUNT(barriers, 1);
+
+	return 0;
+}
+
+void cam_io_txn_begin(struct cam_io_txn *txn)
+{
+	txn->ordered = false;
+	txn->num_writes = 0;
+}
+
+int cam_io_txn_w(struct cam_io_txn *txn, uint32_t data, void __iomem *addr)
+{
+	if (!txn || !addr)
+		return -EINVAL;
+
+	if (!txn->ordered) {
+		/* Order the whole transaction after prior accesses */
+		wmb();
+		txn->ordered = true;
+		CAM_IO_ACCOUNT(barriers, 1);
+	}
+
+	CAM_DBG(CAM_IO_ACCESS, "0x%pK %08x", addr, data);
+	writel_relaxed(data, addr);
+	txn->num_writes++;
+	CAM_IO_ACCOUNT(relaxed_writes, 1);
 
 	return 0;
 }
 
+uint32_t cam_io_txn_commit(struct cam_io_txn *txn)
+{
+	uint32_t num_writes = txn->num_writes;
+
+	if (num_writes)
+		CAM_IO_ACCOUNT(txns, 1);
+
+	txn->ordered = false;
+	txn->num_writes = 0;
+
+	return num_writes;
+}
+
 uint32_t cam_io_r(void __iomem *addr)
 {
 	uint32_t data;
@@ -78,6 +172,7 @@ int cam_io_memcpy(void __iomem *dest_addr,
 		CAM_DBG(CAM_IO_ACCESS, "0x%pK %08x", d, *s);
 		writel_relaxed(*s++, d++);
 	}
+	CAM_IO_ACCOUNT(relaxed_writes, len / 4);
 
 	return 0;
 }
@@ -105,6 +200,8 @@ int  cam_io_memcpy_mb(void __iomem *dest_addr,
 	}
 	/* Ensure previous writes are done */
 	wmb();
+	CAM_IO_ACCOUNT(barriers, 2);
+	CAM_IO_ACCOUNT(relaxed_writes, len / 4);
 
 	return 0;
 }
@@ -171,6 +268,7 @@ int cam_io_w_same_offset_block(const uint32_t *data, void __iomem *addr,
 			i, len, data[i], addr);
 		writel_relaxed(data[i], addr);
 	}
+	CAM_IO_ACCOUNT(relaxed_writes, len);
 
 	return 0;
 }
@@ -190,6 +288,7 @@ int cam_io_w_mb_same_offset_block(const uint32_t *data, void __iomem *addr,
 		wmb();
 		writel_relaxed(data[i], addr);
 	}
+	CAM_IO_ACCOUNT(barriers, len);
 
 	return 0;
 }
@@ -210,6 +309,7 @@ int cam_io_w_offset_val_block(const uint32_t data[][2],
 			i, len, __VAL(i), addr_base, __OFFSET(i));
 		writel_relaxed(__VAL(i), addr_base + __OFFSET(i));
 	}
+	CAM_IO_ACCOUNT(relaxed_writes, len);
 
 	return 0;
 }
@@ -230,6 +330,8 @@ int cam_io_w_mb_offset_val_block(const uint32_t data[][2],
 			i, len, __VAL(i), addr_base, __OFFSET(i));
 		writel_relaxed(__VAL(i), addr_base + __OFFSET(i));
 	}
+	CAM_IO_ACCOUNT(barriers, 1);
+	CAM_IO_ACCOUNT(relaxed_writes, len);
 
 	return 0;
 }
@@ -8,6 +8,22 @@
 
 #include <linux/types.h>
 
+/**
+ * struct cam_io_txn
+ *
+ * @brief:              Register write transaction. Writes issued through
+ *                      the transaction are relaxed, the ordering barrier is
+ *                      paid once ahead of the first write instead of once
+ *                      per write as with cam_io_w_mb().
+ *
+ * @ordered:            Barrier for this transaction has been issued
+ * @num_writes:         Number of writes issued in this transaction
+ */
+struct cam_io_txn {
+	bool                 ordered;
+	uint32_t             num_writes;
+};
+
 /**
  * cam_io_w()
  *
@@ -35,6 +51,60 @@ int cam_io_w(uint32_t data, void __iomem *addr);
  */
 int cam_io_w_mb(uint32_t data, void __iomem *addr);
 
+/**
+ * cam_io_txn_begin()
+ *
+ * @brief:              Start a register write transaction
+ *
+ * @txn:                Transaction to be started
+ */
+void cam_io_txn_begin(struct cam_io_txn *txn);
+
+/**
+ * cam_io_txn_w()
+ *
+ * @brief:              Camera IO util for register write as part of a
+ *                      transaction. The first write of the transaction is
+ *                      preceded by a single wmb() so that all the writes are
+ *                      ordered after prior memory and register accesses, the
+ *                      same guarantee a run of cam_io_w_mb() gives. Writes
+ *                      within the transaction are relaxed and keep program
+ *                      order towards the device. Callers must not rely on
+ *                      ordering between these writes and normal memory
+ *                      stores made after the first write of the
+ *                      transaction.
+ *
+ * @txn:                Transaction the write belongs to
+ * @data:               Value to be written
+ * @addr:               Address used to write the value
+ *
+ * @return:             Success or Failure
+ */
+int cam_io_txn_w(struct cam_io_txn *txn, uint32_t data, void __iomem *addr);
+
+/**
+ * cam_io_txn_commit()
+ *
+ * @brief:              Close a register write transaction. No trailing
+ *                      barrier is issued, if the writes need to be flushed
+ *                      call wmb() independently in the caller.
+ *
+ * @txn:                Transaction to be closed
+ *
+ * @return:             Number of writes issued in the transaction
+ */
+uint32_t cam_io_txn_commit(struct cam_io_txn *txn);
+
+/**
+ * cam_io_account_frame()
+ *
+ * @brief:              Mark a frame boundary for register access
+ *                      accounting. Only counts when the cam_io_accounting
+ *                      module parameter is set, the totals and the write
+ *                      barriers per frame are read from cam_io_stats.
+ */
+void cam_io_account_frame(void);
+
 /**
  * cam_io_r()
  *
@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ */
+
+#include <linux/math64.h>
+#include <linux/sort.h>
+
+#include "cam_kunit.h"
+#include "cam_debug_util.h"
+
+/*
+ * The suites are run from the camera module init rather than through
+ * kunit_test_suites(), which defines its own module_init on older kernels.
+ */
+static struct kunit_suite *cam_kunit_suites[] = {
+#ifdef CONFIG_SPECTRA_ISP
+	&cam_irq_controller_test_suite,
+#endif
+	&cam_packet_util_test_suite,
+	&cam_req_mgr_core_test_suite,
+	&cam_req_mgr_workq_test_suite,
+};
+
+static int cam_kunit_cmp_u64(const void *a, const void *b)
+{
+	u64 l = *(const u64 *)a;
+	u64 r = *(const u64 *)b;
+
+	if (l < r)
+		return -1;
+
+	return (l > r) ? 1 : 0;
+}
+
+int cam_kunit_bench_init(struct kunit *test, struct cam_kunit_bench *bench,
+	const char *name, uint32_t max)
+{
+	bench->samples_ns = kunit_kcalloc(test, max, sizeof(u64), GFP_KERNEL);
+	if (!bench->samples_ns)
+		return -ENOMEM;
+
+	bench->name = name;
+	bench->num = 0;
+	bench->max = max;
+	bench->start = 0;
+
+	return 0;
+}
+
+u64 cam_kunit_bench_report(struct kunit *test, struct cam_kunit_bench *bench)
+{
+	u64 elapsed_ns, ops_per_sec = 0, p50, p99;
+
+	if (!bench->num)
+		return 0;
+
+	elapsed_ns = ktime_to_ns(ktime_sub(ktime_get(), bench->start));
+	if (elapsed_ns)
+		ops_per_sec = div64_u64((u64)bench->num * NSEC_PER_SEC,
+			elapsed_ns);
+
+	sort(bench->samples_ns, bench->num, sizeof(u64),
+		cam_kunit_cmp_u64, NULL);
+	p50 = bench->samples_ns[(bench->num - 1) / 2];
+	p99 = bench->samples_ns[div_u64((u64)(bench->num - 1) * 99, 100)];
+
+	kunit_info(test, "%s: %u ops, %llu ops/s, p50 %llu ns, p99 %llu ns",
+		bench->name, bench->num, ops_per_sec, p50, p99);
+
+	return p99;
+}
+
+void __iomem *cam_kunit_alloc_regs(struct kunit *test, size_t size)
+{
+	return (void __force __iomem *)kunit_kzalloc(test, size, GFP_KERNEL);
+}
+
+int cam_kunit_init_module(void)
+{
+	int i, rc;
+
+	for (i = 0; i < ARRAY_SIZE(cam_kunit_suites); i++) {
+		rc = kunit_run_tests(cam_kunit_suites[i]);
+		if (rc)
+			CAM_WARN(CAM_UTIL, "suite %s failed rc = %d",
+				cam_kunit_suites[i]->name, rc);
+	}
+
+	return 0;
+}
+
+void cam_kunit_exit_module(void)
+{
+}
@@ -0,0 +1,128 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/*
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ */
+
+#ifndef _CAM_KUNIT_H_
+#define _CAM_KUNIT_H_
+
+#ifdef CONFIG_SPECTRA_KUNIT_TEST
+
+#include <linux/types.h>
+#include <linux/ktime.h>
+#include <kunit/test.h>
+
+/**
+ * struct cam_kunit_bench - Latency samples of one benchmarked operation
+ *
+ * @name:       Operation name used in the report
+ * @samples_ns: Duration of each operation in ns
+ * @num:        Number of samples recorded
+ * @max:        Capacity of samples_ns
+ * @start:      Time of the first sample, used for ops/s
+ */
+struct cam_kunit_bench {
+	const char *name;
+	u64        *samples_ns;
+	uint32_t    num;
+	uint32_t    max;
+	ktime_t     start;
+};
+
+/**
+ * cam_kunit_bench_init()
+ *
+ * @brief:      Allocate the sample buffer of a benchmark, freed with the
+ *              test
+ *
+ * @test:       Test running the benchmark
+ * @bench:      Benchmark to initialize
+ * @name:       Operation name used in the report
+ * @max:        Maximum number of samples
+ *
+ * @return:     0 on success, negative on failure
+ */
+int cam_kunit_bench_init(struct kunit *test, struct cam_kunit_bench *bench,
+	const char *name, uint32_t max);
+
+/**
+ * cam_kunit_bench_add()
+ *
+ * @brief:      Record one operation that started at @start
+ *
+ * @bench:      Benchmark to record in
+ * @start:      Start time of the operation
+ */
+static inline void cam_kunit_bench_add(struct cam_kunit_bench *bench,
+	ktime_t start)
+{
+	if (!bench->num)
+		bench->start = start;
+	if (bench->num < bench->max)
+		bench->samples_ns[bench->num++] =
+			ktime_to_ns(ktime_sub(ktime_get(), start));
+}
+
+/**
+ * cam_kunit_bench_report()
+ *
+ * @brief:      Log ops/s, p50 and p99 of the recorded operations
+ *
+ * @test:       Test running the benchmark
+ * @bench:      Benchmark to report, samples are sorted in place
+ *
+ * @return:     p99 in ns, 0 if nothing was recorded
+ */
+u64 cam_kunit_bench_report(struct kunit *test, struct cam_kunit_bench *bench);
+
+/**
+ * cam_kunit_alloc_regs()
+ *
+ * @brief:      Allocate a zeroed, memory backed register block to stand in
+ *              for a mapped device, freed with the test
+ *
+ * @test:       Test using the registers
+ * @size:       Size of the register block in bytes
+ *
+ * @return:     Base of the register block, NULL on failure
+ */
+void __iomem *cam_kunit_alloc_regs(struct kunit *test, size_t size);
+
+static inline uint32_t cam_kunit_reg_r(void __iomem *base, uint32_t offset)
+{
+	return *(uint32_t __force *)(base + offset);
+}
+
+static inline void cam_kunit_reg_w(void __iomem *base, uint32_t offset,
+	uint32_t val)
+{
+	*(uint32_t __force *)(base + offset) = val;
+}
+
+#ifdef CONFIG_SPECTRA_ISP
+extern struct kunit_suite cam_irq_controller_test_suite;
+#endif
+extern struct kunit_suite cam_packet_util_test_suite;
+extern struct kunit_suite cam_req_mgr_core_test_suite;
+extern struct kunit_suite cam_req_mgr_workq_test_suite;
+
+/**
+ * cam_kunit_init_module()
+ *
+ * @brief:      Run all camera KUnit suites. Results are reported in the
+ *              kernel log, a failing suite does not fail module load.
+ *
+ * @return:     0
+ */
+int cam_kunit_init_module(void);
+
+/**
+ * cam_kunit_exit_module()
+ *
+ * @brief:      Counterpart of cam_kunit_init_module(), nothing to release
+ */
+void cam_kunit_exit_module(void);
+
+#endif /* CONFIG_SPECTRA_KUNIT_TEST */
+
+#endif /* _CAM_KUNIT_H_ */
@@ -11,6 +11,7 @@
 #include "cam_packet_util.h"
 #include "cam_debug_util.h"
 #include "cam_common_util.h"
+#include "cam_req_mgr_debug.h"
 
 #define CAM_UNIQUE_SRC_HDL_MAX 50
 #define CAM_PRESIL_UNIQUE_HDL_MAX 50
@@ -299,23 +300,70 @@ static int cam_packet_util_get_patch_iova(
 	return rc;
 }
 
+/**
+ * cam_packet_util_write_patch()
+ *
+ * @brief:          Write the patched source address into the destination
+ *                  buffer, after checking the patch fits in it
+ *
+ * @patch_desc:     Patch to apply
+ * @iova_addr:      Device address of the source buffer
+ * @flags:          Memory flags of the source buffer
+ * @cpu_addr:       Kernel address of the destination buffer
+ * @dst_buf_len:    Length of the destination buffer
+ *
+ * @return:         0 on success, -EINVAL if the patch is out of bounds
+ */
+static int cam_packet_util_write_patch(struct cam_patch_desc *patch_desc,
+	dma_addr_t iova_addr, uint32_t flags, uintptr_t cpu_addr,
+	size_t dst_buf_len)
+{
+	uint32_t  *dst_cpu_addr;
+	dma_addr_t temp;
+
+	if ((dst_buf_len < sizeof(void *)) ||
+		((dst_buf_len - sizeof(void *)) <
+		(size_t)patch_desc->dst_offset)) {
+		CAM_ERR(CAM_UTIL,
+			"Invalid dst buf patch offset");
+		return -EINVAL;
+	}
+
+	dst_cpu_addr = (uint32_t *)((uint8_t *)cpu_addr +
+		patch_desc->dst_offset);
+	temp = iova_addr + patch_desc->src_offset;
+
+	if ((flags & CAM_MEM_FLAG_HW_SHARED_ACCESS) ||
+		(flags & CAM_MEM_FLAG_CMD_BUF_TYPE))
+		*dst_cpu_addr = temp;
+	else
+		*dst_cpu_addr = cam_smmu_is_expanded_memory() ?
+			CAM_36BIT_INTF_GET_IOVA_BASE(temp) : temp;
+
+	CAM_DBG(CAM_UTIL,
+		"patch is done for dst %pk with src 0x%llx value 0x%llx",
+		dst_cpu_addr, iova_addr, *((uint64_t *)dst_cpu_addr));
+
+	return 0;
+}
+
 int cam_packet_util_process_patches(struct cam_packet *packet,
 	int32_t iommu_hdl, int32_t sec_mmu_hdl)
 {
 	struct cam_patch_desc *patch_desc = NULL;
 	dma_addr_t iova_addr;
 	uintptr_t  cpu_addr = 0;
-	dma_addr_t temp;
-	uint32_t  *dst_cpu_addr;
 	size_t     dst_buf_len;
 	size_t     src_buf_size;
 	int        i  = 0;
 	int        rc = 0;
 	uint32_t   flags = 0;
 	int32_t    hdl;
+	ktime_t    start;
 	struct cam_patch_unique_src_buf_tbl
 		tbl[CAM_UNIQUE_SRC_HDL_MAX];
 
+	start = cam_req_mgr_debug_lat_start(CAM_REQ_MGR_LAT_PATCH);
 	memset(tbl, 0, CAM_UNIQUE_SRC_HDL_MAX *
 		sizeof(struct cam_patch_unique_src_buf_tbl));
 
@@ -347,46 +395,27 @@ int cam_packet_util_process_patches(struct cam_packet *packet,
 			return -EINVAL;
 		}
 
-		temp = iova_addr;
-
 		rc = cam_mem_get_cpu_buf(patch_desc[i].dst_buf_hdl,
 			&cpu_addr, &dst_buf_len);
 		if (rc < 0 || !cpu_addr || (dst_buf_len == 0)) {
 			CAM_ERR(CAM_UTIL, "unable to get dst buf address");
 			return rc;
 		}
-		dst_cpu_addr = (uint32_t *)cpu_addr;
 
 		CAM_DBG(CAM_UTIL, "i = %d patch info = %x %x %x %x", i,
 			patch_desc[i].dst_buf_hdl, patch_desc[i].dst_offset,
 			patch_desc[i].src_buf_hdl, patch_desc[i].src_offset);
 
-		if ((dst_buf_len < sizeof(void *)) ||
-			((dst_buf_len - sizeof(void *)) <
-			(size_t)patch_desc[i].dst_offset)) {
-			CAM_ERR(CAM_UTIL,
-				"Invalid dst buf patch offset");
-			cam_mem_put_cpu_buf((int32_t)patch_desc[i].dst_buf_hdl);
-			return -EINVAL;
-		}
-
-		dst_cpu_addr = (uint32_t *)((uint8_t *)dst_cpu_addr +
-			patch_desc[i].dst_offset);
-		temp += patch_desc[i].src_offset;
-
-		if ((flags & CAM_MEM_FLAG_HW_SHARED_ACCESS) ||
-			(flags & CAM_MEM_FLAG_CMD_BUF_TYPE))
-			*dst_cpu_addr = temp;
-		else
-			*dst_cpu_addr = cam_smmu_is_expanded_memory() ?
-				CAM_36BIT_INTF_GET_IOVA_BASE(temp) : temp;
-
-		CAM_DBG(CAM_UTIL,
-			"patch is done for dst %pk with src 0x%llx value 0x%llx",
-			dst_cpu_addr, iova_addr, *((uint64_t *)dst_cpu_addr));
+		rc = cam_packet_util_write_patch(&patch_desc[i], iova_addr,
+			flags, cpu_addr, dst_buf_len);
 		cam_mem_put_cpu_buf((int32_t)patch_desc[i].dst_buf_hdl);
+		if (rc)
+			return rc;
 	}
 
+	cam_req_mgr_debug_lat_record(CAM_REQ_MGR_LAT_PATCH,
+		CAM_REQ_MGR_LAT_INST_MAX, start);
+
 	return rc;
 }
 
@@ -652,3 +681,7 @@ send_cmd_buffers:
 end:
 	return rc;
 }
+
+#ifdef CONFIG_SPECTRA_KUNIT_TEST
+#include "cam_packet_util_test.c"
+#endif
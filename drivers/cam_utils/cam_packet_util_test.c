@@ -0,0 +1,153 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Copyright (c) 2021, The Linux Foundation. All rights reserved.
+ */
+
+/*
+ * KUnit tests for packet patching, built into cam_packet_util.c. Source
+ * buffers are served from a prefilled unique handle table, so patching runs
+ * without the memory manager.
+ */
+
+#include "cam_kunit.h"
+
+#define CAM_PACKET_TEST_DST_LEN         4096
+#define CAM_PACKET_TEST_NUM_SRC         8
+#define CAM_PACKET_TEST_NUM_PATCHES     64
+#define CAM_PACKET_TEST_BENCH_ITER      2000
+#define CAM_PACKET_TEST_SRC_HDL(n)      (0x10000 + (n))
+#define CAM_PACKET_TEST_SRC_IOVA(n)     (0x10000000 + ((n) * 0x100000))
+
+static void cam_packet_test_fill_tbl(struct cam_patch_unique_src_buf_tbl *tbl)
+{
+	int i;
+
+	memset(tbl, 0, CAM_UNIQUE_SRC_HDL_MAX * sizeof(*tbl));
+	for (i = 0; i < CAM_PACKET_TEST_NUM_SRC; i++) {
+		tbl[i].hdl = CAM_PACKET_TEST_SRC_HDL(i);
+		tbl[i].iova = CAM_PACKET_TEST_SRC_IOVA(i);
+		tbl[i].buf_size = 0x100000;
+		tbl[i].flags = CAM_MEM_FLAG_CMD_BUF_TYPE;
+	}
+}
+
+static void cam_packet_test_write(struct kunit *test)
+{
+	struct cam_patch_desc patch = {0};
+	uint32_t *dst;
+
+	dst = kunit_kzalloc(test, 64, GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, dst);
+
+	patch.dst_offset = 8;
+	patch.src_offset = 0x40;
+	KUNIT_EXPECT_EQ(test, cam_packet_util_write_patch(&patch, 0x10000000,
+		CAM_MEM_FLAG_CMD_BUF_TYPE, (uintptr_t)dst, 64), 0);
+	KUNIT_EXPECT_EQ(test, dst[2], 0x10000040U);
+	KUNIT_EXPECT_EQ(test, dst[1], 0U);
+	KUNIT_EXPECT_EQ(test, dst[3], 0U);
+}
+
+static void cam_packet_test_write_bounds(struct kunit *test)
+{
+	struct cam_patch_desc patch = {0};
+	uint32_t *dst;
+
+	dst = kunit_kzalloc(test, 64, GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, dst);
+
+	/* Patch must leave room for a pointer sized write */
+	patch.dst_offset = 64 - sizeof(void *) + 4;
+	KUNIT_EXPECT_EQ(test, cam_packet_util_write_patch(&patch, 0x10000000,
+		CAM_MEM_FLAG_CMD_BUF_TYPE, (uintptr_t)dst, 64), -EINVAL);
+
+	patch.dst_offset = 0;
+	KUNIT_EXPECT_EQ(test, cam_packet_util_write_patch(&patch, 0x10000000,
+		CAM_MEM_FLAG_CMD_BUF_TYPE, (uintptr_t)dst,
+		sizeof(void *) - 1), -EINVAL);
+
+	patch.dst_offset = 64 - sizeof(void *);
+	KUNIT_EXPECT_EQ(test, cam_packet_util_write_patch(&patch, 0x10000000,
+		CAM_MEM_FLAG_CMD_BUF_TYPE, (uintptr_t)dst, 64), 0);
+}
+
+static void cam_packet_test_iova_cache(struct kunit *test)
+{
+	struct cam_patch_unique_src_buf_tbl *tbl;
+	dma_addr_t iova = 0;
+	size_t size = 0;
+	uint32_t flags = 0;
+
+	tbl = kunit_kcalloc(test, CAM_UNIQUE_SRC_HDL_MAX, sizeof(*tbl),
+		GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, tbl);
+	cam_packet_test_fill_tbl(tbl);
+
+	KUNIT_EXPECT_EQ(test, cam_packet_util_get_patch_iova(tbl, 0,
+		CAM_PACKET_TEST_SRC_HDL(5), &iova, &size, &flags), 0);
+	KUNIT_EXPECT_EQ(test, (u64)iova, (u64)CAM_PACKET_TEST_SRC_IOVA(5));
+	KUNIT_EXPECT_EQ(test, size, (size_t)0x100000);
+	KUNIT_EXPECT_EQ(test, flags, (uint32_t)CAM_MEM_FLAG_CMD_BUF_TYPE);
+}
+
+static void cam_packet_test_bench_patch(struct kunit *test)
+{
+	struct cam_patch_unique_src_buf_tbl *tbl;
+	struct cam_patch_desc *patches;
+	struct cam_kunit_bench bench;
+	dma_addr_t iova;
+	size_t size;
+	uint32_t flags, *dst;
+	int i, j, rc = 0;
+	ktime_t start;
+
+	tbl = kunit_kcalloc(test, CAM_UNIQUE_SRC_HDL_MAX, sizeof(*tbl),
+		GFP_KERNEL);
+	patches = kunit_kcalloc(test, CAM_PACKET_TEST_NUM_PATCHES,
+		sizeof(*patches), GFP_KERNEL);
+	dst = kunit_kzalloc(test, CAM_PACKET_TEST_DST_LEN, GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, tbl);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, patches);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, dst);
+	KUNIT_ASSERT_EQ(test, cam_kunit_bench_init(test, &bench,
+		"patch_packet_64", CAM_PACKET_TEST_BENCH_ITER), 0);
+
+	cam_packet_test_fill_tbl(tbl);
+	for (i = 0; i < CAM_PACKET_TEST_NUM_PATCHES; i++) {
+		patches[i].src_buf_hdl =
+			CAM_PACKET_TEST_SRC_HDL(i % CAM_PACKET_TEST_NUM_SRC);
+		patches[i].src_offset = i * 0x100;
+		patches[i].dst_offset = i * 16;
+	}
+
+	for (i = 0; i < CAM_PACKET_TEST_BENCH_ITER && !rc; i++) {
+		start = ktime_get();
+		for (j = 0; j < CAM_PACKET_TEST_NUM_PATCHES && !rc; j++) {
+			rc = cam_packet_util_get_patch_iova(tbl, 0,
+				patches[j].src_buf_hdl, &iova, &size, &flags);
+			if (!rc)
+				rc = cam_packet_util_write_patch(&patches[j],
+					iova, flags, (uintptr_t)dst,
+					CAM_PACKET_TEST_DST_LEN);
+		}
+		cam_kunit_bench_add(&bench, start);
+	}
+
+	KUNIT_EXPECT_EQ(test, rc, 0);
+	KUNIT_EXPECT_EQ(test, dst[(5 * 16) / 4],
+		(uint32_t)(CAM_PACKET_TEST_SRC_IOVA(5) + (5 * 0x100)));
+	cam_kunit_bench_report(test, &bench);
+}
+
+static struct kunit_case cam_packet_util_test_cases[] = {
+	KUNIT_CASE(cam_packet_test_write),
+	KUNIT_CASE(cam_packet_test_write_bounds),
+	KUNIT_CASE(cam_packet_test_iova_cache),
+	KUNIT_CASE(cam_packet_test_bench_patch),
+	{}
+};
+
+struct kunit_suite cam_packet_util_test_suite = {
+	.name = "cam_packet_util",
+	.test_cases = cam_packet_util_test_cases,
+};
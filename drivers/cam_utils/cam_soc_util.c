@@ -27,6 +27,18 @@
 static uint skip_mmrm_set_rate;
 module_param(skip_mmrm_set_rate, uint, 0644);
 
+/* IRQ registration mode for thread capable devices */
+#define CAM_SOC_IRQ_MODE_DT               0
+#define CAM_SOC_IRQ_MODE_THREADED         1
+#define CAM_SOC_IRQ_MODE_HARD             2
+
+static uint cam_soc_irq_mode = CAM_SOC_IRQ_MODE_DT;
+module_param(cam_soc_irq_mode, uint, 0644);
+
+/* CPU mask for thread capable device IRQs, overrides DT when non zero */
+static uint cam_soc_irq_cpu_mask;
+module_param(cam_soc_irq_cpu_mask, uint, 0644);
+
 /**
  * struct cam_clk_wrapper_clk: This represents an entry corresponding to a
  *                             shared clock in Clk wrapper. Clients that share
@@ -2360,6 +2372,16 @@ static int cam_soc_util_get_dt_regulator_info
 	return rc;
 }
 
+static void cam_soc_util_fill_cpumask(uint32_t mask, struct cpumask *cpus)
+{
+	int cpu;
+
+	for (cpu = 0; cpu < BITS_PER_TYPE(mask); cpu++) {
+		if ((mask & BIT(cpu)) && (cpu < nr_cpu_ids))
+			cpumask_set_cpu(cpu, cpus);
+	}
+}
+
 #ifdef CONFIG_CAM_PRESIL
 static uint32_t next_dummy_irq_line_num = 0x000f;
 struct resource dummy_irq_line[512];
@@ -2369,6 +2391,7 @@ int cam_soc_util_get_dt_properties(struct cam_hw_soc_info *soc_info)
 {
 	struct device_node *of_node = NULL;
 	int count = 0, i = 0, rc = 0;
+	uint32_t irq_cpu_mask = 0;
 
 	if (!soc_info || !soc_info->dev)
 		return -EINVAL;
@@ -2446,6 +2469,12 @@ int cam_soc_util_get_dt_properties(struct cam_hw_soc_info *soc_info)
 				soc_info->irq_line->start);
 #endif
 		}
+
+		soc_info->irq_thread_dt = of_property_read_bool(of_node,
+			"irq-threaded");
+		cpumask_clear(&soc_info->irq_affinity);
+		if (!of_property_read_u32(of_node, "irq-cpu-mask", &irq_cpu_mask))
+			cam_soc_util_fill_cpumask(irq_cpu_mask, &soc_info->irq_affinity);
 	}
 
 
@@ -2964,6 +2993,82 @@ int cam_soc_util_request_irq(struct device *dev,
 }
 #endif
 
+static bool cam_soc_util_use_threaded_irq(struct cam_hw_soc_info *soc_info)
+{
+	if (!soc_info->irq_latch_handler)
+		return false;
+
+#ifdef CONFIG_CAM_PRESIL
+	return false;
+#else
+	switch (cam_soc_irq_mode) {
+	case CAM_SOC_IRQ_MODE_THREADED:
+		return true;
+	case CAM_SOC_IRQ_MODE_HARD:
+		return false;
+	default:
+		return soc_info->irq_thread_dt;
+	}
+#endif
+}
+
+/*
+ * The hard IRQ latches and clears the status, the device handler then runs
+ * in the IRQ thread (SCHED_FIFO) with the line kept masked until it returns.
+ */
+static int cam_soc_util_request_threaded_irq(struct cam_hw_soc_info *soc_info,
+	irq_handler_t handler, void *irq_data)
+{
+	int rc;
+
+	rc = devm_request_threaded_irq(soc_info->dev,
+		soc_info->irq_line->start,
+		soc_info->irq_latch_handler,
+		handler,
+		IRQF_TRIGGER_RISING | IRQF_ONESHOT,
+		soc_info->irq_name,
+		irq_data);
+	if (rc) {
+		CAM_ERR(CAM_UTIL, "threaded irq request fail %s rc %d",
+			soc_info->irq_name, rc);
+		return -EBUSY;
+	}
+
+	disable_irq(soc_info->irq_line->start);
+	soc_info->irq_threaded = true;
+	CAM_DBG(CAM_UTIL, "%s: threaded irq %u", soc_info->dev_name,
+		soc_info->irq_line->start);
+
+	return 0;
+}
+
+static void cam_soc_util_set_irq_affinity(struct cam_hw_soc_info *soc_info)
+{
+	int rc;
+
+	if (!soc_info->irq_latch_handler)
+		return;
+
+	if (cam_soc_irq_cpu_mask) {
+		cpumask_clear(&soc_info->irq_affinity);
+		cam_soc_util_fill_cpumask(cam_soc_irq_cpu_mask,
+			&soc_info->irq_affinity);
+	}
+
+	if (cpumask_empty(&soc_info->irq_affinity))
+		return;
+
+	rc = irq_set_affinity_hint(soc_info->irq_line->start,
+		&soc_info->irq_affinity);
+	if (rc)
+		CAM_WARN(CAM_UTIL, "%s: irq affinity %*pbl not set rc %d",
+			soc_info->dev_name, cpumask_pr_args(&soc_info->irq_affinity), rc);
+	else
+		CAM_DBG(CAM_UTIL, "%s: irq %u affinity %*pbl", soc_info->dev_name,
+			soc_info->irq_line->start,
+			cpumask_pr_args(&soc_info->irq_affinity));
+}
+
 int cam_soc_util_request_platform_resource(
 	struct cam_hw_soc_info *soc_info,
 	irq_handler_t handler, void *irq_data)
@@ -3012,11 +3117,15 @@ int cam_soc_util_request_platform_resource(
 
 	if (soc_info->irq_line) {
 
-		rc = cam_soc_util_request_irq(soc_info->dev,
-			soc_info->irq_line->start,
-			handler, IRQF_TRIGGER_RISING,
-			soc_info->irq_name, irq_data,
-			soc_info->mem_block[0]->start);
+		if (cam_soc_util_use_threaded_irq(soc_info))
+			rc = cam_soc_util_request_threaded_irq(soc_info,
+				handler, irq_data);
+		else
+			rc = cam_soc_util_request_irq(soc_info->dev,
+				soc_info->irq_line->start,
+				handler, IRQF_TRIGGER_RISING,
+				soc_info->irq_name, irq_data,
+				soc_info->mem_block[0]->start);
 		if (rc) {
 			CAM_ERR(CAM_UTIL, "irq request fail");
 			rc = -EBUSY;
@@ -3024,6 +3133,7 @@ int cam_soc_util_request_platform_resource(
 		}
 
 		soc_info->irq_data = irq_data;
+		cam_soc_util_set_irq_affinity(soc_info);
 	}
 
 	/* Get Clock */
@@ -3144,8 +3254,10 @@ put_clk:
 
 	if (soc_info->irq_line) {
 		disable_irq(soc_info->irq_line->start);
+		irq_set_affinity_hint(soc_info->irq_line->start, NULL);
 		devm_free_irq(soc_info->dev,
 			soc_info->irq_line->start, irq_data);
+		soc_info->irq_threaded = false;
 	}
 
 put_regulator:
@@ -3226,8 +3338,10 @@ int cam_soc_util_release_platform_resource(struct cam_hw_soc_info *soc_info)
 		}
 
 		disable_irq(soc_info->irq_line->start);
+		irq_set_affinity_hint(soc_info->irq_line->start, NULL);
 		devm_free_irq(soc_info->dev,
 			soc_info->irq_line->start, soc_info->irq_data);
+		soc_info->irq_threaded = false;
 	}
 
 	cam_soc_util_release_pinctrl(soc_info);
@@ -3245,10 +3359,12 @@ int cam_soc_util_enable_platform_resource(struct cam_hw_soc_info *soc_info,
 	bool enable_clocks, enum cam_vote_level clk_level, bool enable_irq)
 {
 	int rc = 0;
+	ktime_t start;
 
 	if (!soc_info)
 		return -EINVAL;
 
+	start = ktime_get();
 	rc = cam_soc_util_regulator_enable_default(soc_info);
 	if (rc) {
 		CAM_ERR(CAM_UTIL, "Regulators enable failed");
@@ -3267,6 +3383,10 @@ int cam_soc_util_enable_platform_resource(struct cam_hw_soc_info *soc_info,
 			goto disable_clk;
 	}
 
+	CAM_DBG(CAM_PERF, "%s platform resource enable took %lld us",
+		soc_info->dev_name,
+		ktime_us_delta(ktime_get(), start));
+
 	return rc;
 
 disable_clk:
@@ -12,6 +12,7 @@
 #include <linux/slab.h>
 #include <linux/clk.h>
 #include <linux/interrupt.h>
+#include <linux/cpumask.h>
 #include <linux/io.h>
 #include <linux/delay.h>
 #include <linux/platform_device.h>
@@ -155,6 +156,12 @@ struct cam_soc_gpio_data {
  * @label_name:             label name
  * @irq_line:               Irq resource
  * @irq_data:               Private data that is passed when IRQ is requested
+ * @irq_latch_handler:      Hard IRQ handler that only latches and clears the
+ *                          IRQ status, so the IRQ handler can run in an IRQ
+ *                          thread. Set by drivers that support it, else NULL
+ * @irq_thread_dt:          Threaded IRQ requested through devicetree
+ * @irq_threaded:           IRQ is registered as a threaded IRQ
+ * @irq_affinity:           CPU affinity hint for the IRQ, empty if unset
  * @compatible:             Compatible string associated with the device
  * @num_mem_block:          Number of entry in the "reg-names"
  * @mem_block_name:         Array of the reg block name
@@ -221,6 +228,10 @@ struct cam_hw_soc_info {
 	const char                     *label_name;
 	struct resource                *irq_line;
 	void                           *irq_data;
+	irq_handler_t                   irq_latch_handler;
+	bool                            irq_thread_dt;
+	bool                            irq_threaded;
+	struct cpumask                  irq_affinity;
 	const char                     *compatible;
 
 	uint32_t                        num_mem_block;
@@ -57,6 +57,7 @@
 #include "cam_tfe_dev.h"
 #include "cam_tfe_csid.h"
 #include "cam_csid_ppi100.h"
+#include "cam_kunit.h"
 #include "camera_main.h"
 
 #ifdef CONFIG_CAM_PRESIL
@@ -175,6 +176,12 @@ static const struct camera_submodule_component camera_presil[] = {
 #endif
 };
 
+static const struct camera_submodule_component camera_kunit[] = {
+#ifdef CONFIG_SPECTRA_KUNIT_TEST
+	{&cam_kunit_init_module, &cam_kunit_exit_module},
+#endif
+};
+
 static const struct camera_submodule submodule_table[] = {
 	{
 		.name = "Camera BASE",
@@ -235,6 +242,11 @@ static const struct camera_submodule submodule_table[] = {
 		.name = "Camera Presil",
 		.num_component = ARRAY_SIZE(camera_presil),
 		.component = camera_presil,
+	},
+	{
+		.name = "Camera KUnit",
+		.num_component = ARRAY_SIZE(camera_kunit),
+		.component = camera_kunit,
 	}
 };
 
@@ -903,4 +903,74 @@ struct cam_dump_req_cmd {
 	__s32           dev_handle;
 };
 
+/* Shared memory event ring, mmap-ed from the node it is set up on */
+#define CAM_EVENT_RING_VERSION                  1
+#define CAM_EVENT_RING_MIN_ENTRIES              16
+#define CAM_EVENT_RING_MAX_ENTRIES              4096
+#define CAM_EVENT_RING_PAYLOAD_SIZE             64
+
+/**
+ * struct cam_event_ring_entry - One event in the shared event ring
+ *
+ * @id             : Event id, same as the v4l2 event id
+ * @type           : Event type, same as the v4l2 event type
+ * @timestamp      : Monotonic time the event was queued at, in ns
+ * @data           : Event payload, same as the v4l2 event payload
+ */
+struct cam_event_ring_entry {
+	__u32           id;
+	__u32           type;
+	__u64           timestamp;
+	__u8            data[CAM_EVENT_RING_PAYLOAD_SIZE];
+};
+
+/**
+ * struct cam_event_ring_hdr - Header at the start of the shared event ring
+ *
+ * The kernel is the only producer and the process owning the node the
+ * only consumer. Entry i lives at index (i & (num_entries - 1)).
+ * Entries from tail up to head are valid, the consumer reads them and
+ * then advances tail. When the ring is full new events are dropped.
+ *
+ * @version        : Layout version, CAM_EVENT_RING_VERSION
+ * @num_entries    : Number of entries, a power of 2
+ * @entry_size     : Size of struct cam_event_ring_entry
+ * @entries_offset : Offset of the first entry from the header
+ * @head           : Free running count of queued events, kernel written
+ * @dropped        : Free running count of dropped events, kernel written
+ * @reserved0      : Reserved, keeps tail on its own cache line
+ * @tail           : Free running count of consumed events, user written
+ * @reserved1      : Reserved
+ */
+struct cam_event_ring_hdr {
+	__u32           version;
+	__u32           num_entries;
+	__u32           entry_size;
+	__u32           entries_offset;
+	__u32           head;
+	__u32           dropped;
+	__u32           reserved0[10];
+	__u32           tail;
+	__u32           reserved1[15];
+};
+
+/**
+ * struct cam_event_ring_setup - Set up the shared event ring of a node
+ *
+ * Once set up, events of the node are delivered through the ring
+ * instead of the v4l2 event queue until the node is closed.
+ *
+ * @num_entries    : Input - Number of ring entries, a power of 2 in
+ *                   [CAM_EVENT_RING_MIN_ENTRIES, CAM_EVENT_RING_MAX_ENTRIES]
+ * @size           : Output - Length to mmap the node with, at offset 0
+ * @version        : Output - Ring layout version
+ * @reserved       : Reserved
+ */
+struct cam_event_ring_setup {
+	__u32           num_entries;
+	__u32           size;
+	__u32           version;
+	__u32           reserved;
+};
+
 #endif /* __UAPI_CAM_DEFS_H__ */
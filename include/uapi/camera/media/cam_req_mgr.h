@@ -47,6 +47,7 @@
 #define CAM_REQ_MGR_MAX_HANDLES           64
 #define CAM_REQ_MGR_MAX_HANDLES_V2        256
 #define MAX_LINKS_PER_SESSION             2
+#define MAX_LINKS_PER_SESSION_V2          8
 
 /* Interval for cam_info_rate_limit_custom() */
 #define CAM_RATE_LIMIT_INTERVAL_5SEC 5
@@ -234,6 +235,29 @@ struct cam_req_mgr_sync_mode {
 	__s32 reserved;
 };
 
+/**
+ * struct cam_req_mgr_sync_mode_v2
+ * @session_hdl:         Input param - Identifier for CSL session
+ * @sync_mode:           Input Param - Type of sync mode
+ * @num_links:           Input Param - Num of links in sync mode (Valid only
+ *                             when sync_mode is one of SYNC enabled modes)
+ * @master_link_hdl:     Input Param - To dictate which link's SOF drives system
+ *                             (Valid only when sync_mode is one of SYNC
+ *                             enabled modes)
+ * @link_hdls:           Input Param - Array of link handles to be in sync mode
+ *                             (Valid only when sync_mode is one of SYNC
+ *                             enabled modes)
+ *
+ * @opcode: CAM_REQ_MGR_SYNC_MODE_V2
+ */
+struct cam_req_mgr_sync_mode_v2 {
+	__s32 session_hdl;
+	__s32 sync_mode;
+	__s32 num_links;
+	__s32 master_link_hdl;
+	__s32 link_hdls[MAX_LINKS_PER_SESSION_V2];
+};
+
 /**
  * struct cam_req_mgr_link_control
  * @ops:                 Link operations: activate/deactive
@@ -274,6 +298,9 @@ struct cam_req_mgr_link_control {
 #define CAM_REQ_MGR_LINK_CONTROL                (CAM_COMMON_OPCODE_MAX + 13)
 #define CAM_REQ_MGR_LINK_V2                     (CAM_COMMON_OPCODE_MAX + 14)
 #define CAM_REQ_MGR_REQUEST_DUMP                (CAM_COMMON_OPCODE_MAX + 15)
+#define CAM_REQ_MGR_CACHE_OPS_V2                (CAM_COMMON_OPCODE_MAX + 16)
+#define CAM_REQ_MGR_SYNC_MODE_V2                (CAM_COMMON_OPCODE_MAX + 17)
+#define CAM_REQ_MGR_EVENT_RING_SETUP            (CAM_COMMON_OPCODE_MAX + 18)
 
 /* end of cam_req_mgr opcodes */
 
@@ -341,6 +368,9 @@ struct cam_req_mgr_link_control {
 #define CAM_MEM_INV_CACHE                       2
 #define CAM_MEM_CLEAN_INV_CACHE                 3
 
+/* Maximum number of ranges in a single vectored cache operation */
+#define CAM_MEM_CACHE_OPS_MAX_RANGES            64
+
 
 /**
  * struct cam_mem_alloc_out_params
@@ -427,6 +457,33 @@ struct cam_mem_cache_ops_cmd {
 	__u32 mem_cache_ops;
 };
 
+/**
+ * struct cam_mem_cache_ops_range
+ * @buf_handle: buffer handle
+ * @mem_cache_ops: cache operation for this range
+ * @offset: start of the range, in bytes from the start of the buffer
+ * @length: length of the range in bytes, 0 for up to the end of the buffer
+ */
+struct cam_mem_cache_ops_range {
+	__s32 buf_handle;
+	__u32 mem_cache_ops;
+	__u64 offset;
+	__u64 length;
+};
+
+/**
+ * struct cam_mem_cache_ops_v2_cmd
+ * @num_ranges: number of entries in ranges
+ * @num_done: out, number of ranges processed before the first failure
+ * @ranges: variable length array of ranges
+ */
+/* CAM_REQ_MGR_CACHE_OPS_V2 */
+struct cam_mem_cache_ops_v2_cmd {
+	__u32                          num_ranges;
+	__u32                          num_done;
+	struct cam_mem_cache_ops_range ranges[1];
+};
+
 /**
  * Request Manager : error message type
  * @CAM_REQ_MGR_ERROR_TYPE_DEVICE: Device error message, fatal to session
@@ -263,5 +263,7 @@ struct cam_private_ioctl_arg {
 #define CAM_SYNC_REGISTER_PAYLOAD                4
 #define CAM_SYNC_DEREGISTER_PAYLOAD              5
 #define CAM_SYNC_WAIT                            6
+/* Takes struct cam_event_ring_setup from cam_defs.h */
+#define CAM_SYNC_EVENT_RING_SETUP                7
 
 #endif /* __UAPI_CAM_SYNC_H__ */